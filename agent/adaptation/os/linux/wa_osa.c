@@ -51,6 +51,7 @@
  *****************************************************************************/
 #include "wa_osa.h"
 #include "wa_debug.h"
+#include "wa_metrics.h"
 
 /*****************************************************************************
  * GLOBAL VARIABLE DEFINITIONS
@@ -62,6 +63,13 @@
 #define WA_OSA_Q_NAME_PREFIX "/wa_q_hwst_" /* Fix for COLBO-67, DELIA-38417 */
 #define WA_OSA_Q_NAME_SIZE (sizeof(WA_OSA_Q_NAME_PREFIX) + (sizeof(uint16_t)<<1)/* qCnt */)
 
+/* every message is prefixed with its send timestamp, see QPack() */
+#define WA_OSA_Q_HDR_SIZE sizeof(uint64_t)
+
+/* limits of the POSIX message queues, checked when mq_open() refuses the attributes */
+#define WA_OSA_MQ_MSGSIZE_MAX "/proc/sys/fs/mqueue/msgsize_max"
+#define WA_OSA_MQ_MSG_MAX "/proc/sys/fs/mqueue/msg_max"
+
 /*****************************************************************************
  * LOCAL TYPES
  *****************************************************************************/
@@ -80,11 +88,42 @@ typedef struct
     bool quitFlag;
 }WA_OSA_task_t;
 
+typedef struct WA_OSA_queue_tag
+{
+    struct WA_OSA_queue_tag *next; /* in the queues list */
+    WA_OSA_qBackend_t backend;
+    mqd_t mq;
+    long msgSize; /* including the header */
+    long capacity;
+    long hwm;
+    unsigned long timeouts;
+    const char *name;
+    int latencyMetric;
+    /* WA_OSA_Q_BACKEND_LOCAL: capacity slots of msgSize, count of them from head on in the receive order */
+    pthread_mutex_t mutex;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    char *ring;
+    size_t *ringSize;
+    unsigned int *ringPrio;
+    long head;
+    long count;
+}WA_OSA_queue_t;
+
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
 static void *TaskWrapper(void *p);
 static void SigQuitHandler(int sig);
+static bool QValid(const WA_OSA_queue_t *pQ);
+static void QPack(char *buf, const char *pMsg, size_t size);
+static ssize_t QUnpack(WA_OSA_queue_t *pQ, char *pMsg, long maxSize, const char *buf, ssize_t rsize);
+static void QUpdateHwm(WA_OSA_queue_t *pQ);
+static long MqLimit(const char *file);
+static int LocalCreate(WA_OSA_queue_t *pQ);
+static void LocalDestroy(WA_OSA_queue_t *pQ);
+static int LocalSend(WA_OSA_queue_t *pQ, const char *buf, size_t size, unsigned int prio, const struct timespec *pAbsTime);
+static ssize_t LocalReceive(WA_OSA_queue_t *pQ, char *buf, unsigned int *pPrio, const struct timespec *pAbsTime);
 
 /*****************************************************************************
  * LOCAL VARIABLE DECLARATIONS
@@ -98,6 +137,10 @@ static const int osaSchedulingPolicy[WA_OSA_SCHED_POLICY_MAX] =
 };
 
 static pthread_key_t keyContext;
+
+static WA_OSA_queue_t *queues; /* all the existing queues, see WA_OSA_QGetStats() */
+static pthread_mutex_t queuesMutex = PTHREAD_MUTEX_INITIALIZER;
+static WA_OSA_qBackend_t qBackend = WA_OSA_Q_BACKEND_MQ;
 /*****************************************************************************
  * FUNCTION DEFINITIONS
  *****************************************************************************/
@@ -1003,6 +1046,9 @@ int WA_OSA_CondUnlock(void *handle)
 
 void *WA_OSA_Malloc(size_t size)
 {
+#ifdef WA_BENCH
+    WA_METRICS_Inc(WA_METRICS_ALLOCS);
+#endif
     return (void *)malloc(size);
 }
 
@@ -1032,8 +1078,9 @@ void *WA_OSA_QCreate(const unsigned int deep, long maxSize)
     /* Unique name for each queue */
     static uint16_t qCnt = 0;
     char qName[WA_OSA_Q_NAME_SIZE];
-    mqd_t qHandle = 0;
+    WA_OSA_queue_t *pQ = NULL;
     struct mq_attr qAttrs;
+    long limit;
 
     WA_ENTER("WA_OSA_QCreate()\n");
 
@@ -1043,6 +1090,29 @@ void *WA_OSA_QCreate(const unsigned int deep, long maxSize)
         goto end;
     }
 
+    pQ = calloc(1, sizeof(WA_OSA_queue_t));
+    if(pQ == NULL)
+    {
+        WA_ERROR("WA_OSA_QCreate(): calloc(): error\n");
+        goto end;
+    }
+    pQ->msgSize = maxSize + WA_OSA_Q_HDR_SIZE;
+    pQ->capacity = (long)deep;
+    pQ->latencyMetric = -1;
+    pQ->backend = qBackend;
+
+    if(pQ->backend == WA_OSA_Q_BACKEND_LOCAL)
+    {
+        if(LocalCreate(pQ) != 0)
+        {
+            WA_ERROR("WA_OSA_QCreate(): LocalCreate(): unable to create queue\n");
+            free(pQ);
+            pQ = NULL;
+            goto end;
+        }
+        goto add;
+    }
+
     (void)snprintf(qName, WA_OSA_Q_NAME_SIZE, "%s%04x", WA_OSA_Q_NAME_PREFIX, qCnt++);
     qName[WA_OSA_Q_NAME_SIZE-1]='\0';
 
@@ -1054,28 +1124,53 @@ void *WA_OSA_QCreate(const unsigned int deep, long maxSize)
     WA_INFO("WA_OSA_QCreate(): name:\"%s\"\n", qName);
 
     qAttrs.mq_maxmsg = (long)deep;
-    qAttrs.mq_msgsize = maxSize;
+    qAttrs.mq_msgsize = pQ->msgSize;
     qAttrs.mq_flags = O_RDWR;
 
-    qHandle = mq_open(qName, O_RDWR | O_CREAT, 0666, &qAttrs);
-    if(qHandle == (mqd_t)-1)
+    /* O_EXCL: a queue left over by an older agent, which could not be unlinked above,
+       may carry messages of another size or without the timestamp header */
+    pQ->mq = mq_open(qName, O_RDWR | O_CREAT | O_EXCL, 0666, &qAttrs);
+    if(pQ->mq == (mqd_t)-1)
     {
-        qHandle = 0;
         WA_ERROR("WA_OSA_QCreate(): mq_open(): unable to create queue: %d\n", errno);
-        if(errno == EINVAL)
+        if(errno == EEXIST)
         {
-            WA_ERROR("WA_OSA_QCreate(): Check the mq_maxmsg against /proc/sys/fs/mqueue/msg_max\n");
+            WA_ERROR("WA_OSA_QCreate(): \"%s\" left over and cannot be removed\n", qName);
         }
+        else if(errno == EINVAL)
+        {
+            limit = MqLimit(WA_OSA_MQ_MSGSIZE_MAX);
+            if((limit >= 0) && (pQ->msgSize > limit))
+            {
+                WA_ERROR("WA_OSA_QCreate(): mq_msgsize %ld (%ld + %zu header) exceeds %s %ld\n",
+                        pQ->msgSize, maxSize, WA_OSA_Q_HDR_SIZE, WA_OSA_MQ_MSGSIZE_MAX, limit);
+            }
+            limit = MqLimit(WA_OSA_MQ_MSG_MAX);
+            if((limit >= 0) && ((long)deep > limit))
+            {
+                WA_ERROR("WA_OSA_QCreate(): mq_maxmsg %u exceeds %s %ld\n", deep, WA_OSA_MQ_MSG_MAX, limit);
+            }
+        }
+        free(pQ);
+        pQ = NULL;
         goto end;
     }
+
+    add:
+    pthread_mutex_lock(&queuesMutex);
+    pQ->next = queues;
+    queues = pQ;
+    pthread_mutex_unlock(&queuesMutex);
     end:
-    WA_RETURN("WA_OSA_QCreate(): %p\n", (void *)(uintptr_t)qHandle);
-    return (void *)(uintptr_t)qHandle;
+    WA_RETURN("WA_OSA_QCreate(): %p\n", pQ);
+    return pQ;
 }
 
 /* unlink not implemented */
 int WA_OSA_QDestroy(void * const qHandle)
 {
+    WA_OSA_queue_t *pQ = (WA_OSA_queue_t *)qHandle;
+    WA_OSA_queue_t **ppQ;
     int status = -1;
 
     WA_ENTER("WA_OSA_QDestroy(qHandle=%p)\n", qHandle);
@@ -1086,21 +1181,117 @@ int WA_OSA_QDestroy(void * const qHandle)
         goto end;
     }
 
-    status = mq_close((mqd_t)(uintptr_t)qHandle);
-    if(status != 0)
+    if(!QValid(pQ))
     {
         WA_ERROR("WA_OSA_QDestroy(): mq_close(): unable to close queue: %d\n", errno);
+        goto end;
+    }
+
+    pthread_mutex_lock(&queuesMutex);
+    for(ppQ = &queues; *ppQ != NULL; ppQ = &(*ppQ)->next)
+    {
+        if(*ppQ == pQ)
+        {
+            *ppQ = pQ->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&queuesMutex);
+
+    if(pQ->backend == WA_OSA_Q_BACKEND_LOCAL)
+    {
+        LocalDestroy(pQ);
+        status = 0;
     }
+    else
+    {
+        status = mq_close(pQ->mq);
+        if(status != 0)
+        {
+            WA_ERROR("WA_OSA_QDestroy(): mq_close(): unable to close queue: %d\n", errno);
+        }
+    }
+    free(pQ);
     end:
     WA_RETURN("WA_OSA_QDestroy(): %d\n", status);
     return status;
 }
 
+int WA_OSA_QSetBackend(WA_OSA_qBackend_t backend)
+{
+    WA_ENTER("WA_OSA_QSetBackend(backend=%d)\n", backend);
+
+    if((backend < 0) || (backend >= WA_OSA_Q_BACKEND_MAX))
+    {
+        WA_ERROR("WA_OSA_QSetBackend(): invalid backend\n");
+        return -1;
+    }
+    qBackend = backend;
+
+    WA_RETURN("WA_OSA_QSetBackend(): 0\n");
+    return 0;
+}
+
+int WA_OSA_QSetMetrics(void * const qHandle, const char *name, int latencyMetric)
+{
+    WA_OSA_queue_t *pQ = (WA_OSA_queue_t *)qHandle;
+
+    WA_ENTER("WA_OSA_QSetMetrics(qHandle=%p, name=%s, latencyMetric=%d)\n", qHandle, name, latencyMetric);
+
+    if((pQ == NULL) || (latencyMetric >= WA_METRICS_MAX))
+    {
+        WA_ERROR("WA_OSA_QSetMetrics(): invalid parameters\n");
+        return -1;
+    }
+    pQ->name = name;
+    pQ->latencyMetric = latencyMetric;
+
+    WA_RETURN("WA_OSA_QSetMetrics(): 0\n");
+    return 0;
+}
+
+size_t WA_OSA_QGetStats(WA_OSA_QStats_t *pStats, size_t max)
+{
+    struct mq_attr qAttrs;
+    WA_OSA_queue_t *pQ;
+    size_t n = 0;
+
+    WA_ENTER("WA_OSA_QGetStats(pStats=%p, max=%zu)\n", pStats, max);
+
+    pthread_mutex_lock(&queuesMutex);
+    for(pQ = queues; pQ != NULL; pQ = pQ->next, n++)
+    {
+        if(n >= max)
+        {
+            continue;
+        }
+        pStats[n].name = pQ->name;
+        if(pQ->backend == WA_OSA_Q_BACKEND_LOCAL)
+        {
+            pthread_mutex_lock(&pQ->mutex);
+            pStats[n].depth = pQ->count;
+            pthread_mutex_unlock(&pQ->mutex);
+        }
+        else
+        {
+            pStats[n].depth = (mq_getattr(pQ->mq, &qAttrs) == 0) ? qAttrs.mq_curmsgs : -1;
+        }
+        pStats[n].hwm = __atomic_load_n(&pQ->hwm, __ATOMIC_RELAXED);
+        pStats[n].capacity = pQ->capacity;
+        pStats[n].timeouts = __atomic_load_n(&pQ->timeouts, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&queuesMutex);
+
+    WA_RETURN("WA_OSA_QGetStats(): %zu\n", n);
+    return n;
+}
+
 int WA_OSA_QSend(void * const qHandle,
         const char * const pMsg,
         const size_t size,
         const unsigned int prio)
 {
+    WA_OSA_queue_t *pQ = (WA_OSA_queue_t *)qHandle;
     int status = -1;
 
     WA_ENTER("WA_OSA_QSend(qHandle=%p, pMsg=%p, size=%zu, prio=%d)\n",
@@ -1112,11 +1303,25 @@ int WA_OSA_QSend(void * const qHandle,
         goto end;
     }
 
-    status = mq_send((mqd_t)(uintptr_t)qHandle, (const char *)pMsg, size, prio);
+    if(!QValid(pQ))
+    {
+        WA_ERROR("WA_OSA_QSend(): mq_send(): unable to send: %d\n", errno);
+        goto end;
+    }
+
+    {
+        char buf[WA_OSA_Q_HDR_SIZE + size];
+
+        QPack(buf, pMsg, size);
+        status = (pQ->backend == WA_OSA_Q_BACKEND_LOCAL) ? LocalSend(pQ, buf, sizeof(buf), prio, NULL) :
+                mq_send(pQ->mq, buf, sizeof(buf), prio);
+    }
     if(status != 0)
     {
         WA_ERROR("WA_OSA_QSend(): mq_send(): unable to send: %d\n", errno);
+        goto end;
     }
+    QUpdateHwm(pQ);
     end:
     WA_RETURN("WA_OSA_QSend(): %d\n", status);
     return status;
@@ -1128,6 +1333,7 @@ int WA_OSA_QTimedSend(void * const qHandle,
         const unsigned int prio,
         unsigned int ms)
 {
+    WA_OSA_queue_t *pQ = (WA_OSA_queue_t *)qHandle;
     int status = -1;
     struct timespec absTime;
     struct timeval  timeOfDay;
@@ -1141,21 +1347,36 @@ int WA_OSA_QTimedSend(void * const qHandle,
         goto end;
     }
 
+    if(!QValid(pQ))
+    {
+        WA_ERROR("WA_OSA_QTimedSend(): mq_send(): unable to send: %d\n", errno);
+        goto end;
+    }
+
     gettimeofday(&timeOfDay, NULL);
 
     absTime.tv_nsec = timeOfDay.tv_usec * 1000 + (ms % 1000) * 1000000;
     absTime.tv_sec  = timeOfDay.tv_sec + (ms / 1000) + (absTime.tv_nsec / 1000000000);
     absTime.tv_nsec %= 1000000000;
 
-    status = mq_timedsend((mqd_t)(uintptr_t)qHandle, (const char *)pMsg, size, prio, &absTime);
+    {
+        char buf[WA_OSA_Q_HDR_SIZE + size];
+
+        QPack(buf, pMsg, size);
+        status = (pQ->backend == WA_OSA_Q_BACKEND_LOCAL) ? LocalSend(pQ, buf, sizeof(buf), prio, &absTime) :
+                mq_timedsend(pQ->mq, buf, sizeof(buf), prio, &absTime);
+    }
     if(status != 0)
     {
         WA_ERROR("WA_OSA_QTimedSend(): mq_send(): unable to send: %d\n", errno);
         if(errno == ETIMEDOUT)
         {
+            __atomic_add_fetch(&pQ->timeouts, 1, __ATOMIC_RELAXED);
             status = 1;
         }
+        goto end;
     }
+    QUpdateHwm(pQ);
     end:
     WA_RETURN("WA_OSA_QTimedSend(): %d\n", status);
     return status;
@@ -1192,7 +1413,8 @@ ssize_t WA_OSA_QReceive(void * const qHandle,
         long maxSize,
         unsigned int * const pPrio)
 {
-    unsigned int prio;
+    WA_OSA_queue_t *pQ = (WA_OSA_queue_t *)qHandle;
+    unsigned int prio = 0;
     ssize_t rsize = -1;
 
     WA_ENTER("WA_OSA_QReceive(qHandle=%p, pMsg=%p, pPrio=%p)\n",
@@ -1204,15 +1426,27 @@ ssize_t WA_OSA_QReceive(void * const qHandle,
         goto end;
     }
 
-    rsize = mq_receive((mqd_t)(uintptr_t)qHandle,
-            (char *)pMsg,
-            maxSize,
-            &prio);
-    if(rsize == -1)
+    if(!QValid(pQ))
     {
         WA_ERROR("WA_OSA_QReceive(): mq_receive(): unable to receive: %d\n", errno);
         goto end;
     }
+
+    {
+        char buf[pQ->msgSize];
+
+        rsize = (pQ->backend == WA_OSA_Q_BACKEND_LOCAL) ? LocalReceive(pQ, buf, &prio, NULL) :
+                mq_receive(pQ->mq,
+                buf,
+                sizeof(buf),
+                &prio);
+        if(rsize == -1)
+        {
+            WA_ERROR("WA_OSA_QReceive(): mq_receive(): unable to receive: %d\n", errno);
+            goto end;
+        }
+        rsize = QUnpack(pQ, pMsg, maxSize, buf, rsize);
+    }
     if(pPrio != NULL)
     {
         *pPrio = prio;
@@ -1229,7 +1463,8 @@ ssize_t WA_OSA_QTimedReceive(void * const qHandle,
         unsigned int * const pPrio,
         unsigned int ms)
 {
-    unsigned int prio;
+    WA_OSA_queue_t *pQ = (WA_OSA_queue_t *)qHandle;
+    unsigned int prio = 0;
     ssize_t rsize = -1;
     struct timespec absTime;
     struct timeval  timeOfDay;
@@ -1243,25 +1478,38 @@ ssize_t WA_OSA_QTimedReceive(void * const qHandle,
         goto end;
     }
 
+    if(!QValid(pQ))
+    {
+        WA_ERROR("WA_OSA_QTimedReceive(): mq_receive(): unable to receive: %d\n", errno);
+        goto end;
+    }
+
     gettimeofday(&timeOfDay, NULL);
 
     absTime.tv_nsec = timeOfDay.tv_usec * 1000 + (ms % 1000) * 1000000;
     absTime.tv_sec  = timeOfDay.tv_sec + (ms / 1000) + (absTime.tv_nsec / 1000000000);
     absTime.tv_nsec %= 1000000000;
 
-    rsize = mq_timedreceive((mqd_t)(uintptr_t)qHandle,
-            (char *)pMsg,
-            maxSize,
-            &prio,
-            &absTime);
-    if(rsize == -1)
     {
-        WA_ERROR("WA_OSA_QTimedReceive(): mq_receive(): unable to receive: %d\n", errno);
-        if(errno == ETIMEDOUT)
+        char buf[pQ->msgSize];
+
+        rsize = (pQ->backend == WA_OSA_Q_BACKEND_LOCAL) ? LocalReceive(pQ, buf, &prio, &absTime) :
+                mq_timedreceive(pQ->mq,
+                buf,
+                sizeof(buf),
+                &prio,
+                &absTime);
+        if(rsize == -1)
         {
-            rsize = -2;
+            if(errno == ETIMEDOUT)
+            {
+                rsize = -2;
+                goto end;
+            }
+            WA_ERROR("WA_OSA_QTimedReceive(): mq_receive(): unable to receive: %d\n", errno);
+            goto end;
         }
-        goto end;
+        rsize = QUnpack(pQ, pMsg, maxSize, buf, rsize);
     }
     if(pPrio != NULL)
     {
@@ -1275,6 +1523,225 @@ ssize_t WA_OSA_QTimedReceive(void * const qHandle,
 /*****************************************************************************
  * LOCAL FUNCTIONS
  *****************************************************************************/
+/* a bad handle fails with EBADF, as mq_*() did on the raw descriptor */
+static bool QValid(const WA_OSA_queue_t *pQ)
+{
+    if((pQ == NULL) || (pQ->backend < 0) || (pQ->backend >= WA_OSA_Q_BACKEND_MAX))
+    {
+        errno = EBADF;
+        return false;
+    }
+    return true;
+}
+
+static void QPack(char *buf, const char *pMsg, size_t size)
+{
+    uint64_t sent = WA_METRICS_Now();
+
+    memcpy(buf, &sent, WA_OSA_Q_HDR_SIZE);
+    memcpy(buf + WA_OSA_Q_HDR_SIZE, pMsg, size);
+}
+
+static ssize_t QUnpack(WA_OSA_queue_t *pQ, char *pMsg, long maxSize, const char *buf, ssize_t rsize)
+{
+    uint64_t sent;
+
+    if(rsize < (ssize_t)WA_OSA_Q_HDR_SIZE)
+    {
+        WA_ERROR("QUnpack(): short message: %zd\n", rsize);
+        return -1;
+    }
+    memcpy(&sent, buf, WA_OSA_Q_HDR_SIZE);
+    if(pQ->latencyMetric >= 0)
+    {
+        WA_METRICS_Since((WA_METRICS_Id_t)pQ->latencyMetric, sent);
+    }
+
+    rsize -= WA_OSA_Q_HDR_SIZE;
+    if(rsize > maxSize)
+    {
+        WA_ERROR("QUnpack(): message too long: %zd\n", rsize);
+        return -1;
+    }
+    memcpy(pMsg, buf + WA_OSA_Q_HDR_SIZE, rsize);
+    return rsize;
+}
+
+static void QUpdateHwm(WA_OSA_queue_t *pQ)
+{
+    struct mq_attr qAttrs;
+    long hwm;
+
+    /* kept by LocalSend() */
+    if(pQ->backend == WA_OSA_Q_BACKEND_LOCAL)
+    {
+        return;
+    }
+
+    if(mq_getattr(pQ->mq, &qAttrs) != 0)
+    {
+        return;
+    }
+    hwm = __atomic_load_n(&pQ->hwm, __ATOMIC_RELAXED);
+    while((qAttrs.mq_curmsgs > hwm) &&
+          !__atomic_compare_exchange_n(&pQ->hwm, &hwm, qAttrs.mq_curmsgs, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/* reads one of the /proc/sys/fs/mqueue limits, -1 when unknown */
+static long MqLimit(const char *file)
+{
+    FILE *f;
+    long limit = -1;
+
+    f = fopen(file, "r");
+    if(f != NULL)
+    {
+        if(fscanf(f, "%ld", &limit) != 1)
+        {
+            limit = -1;
+        }
+        fclose(f);
+    }
+    return limit;
+}
+
+static int LocalCreate(WA_OSA_queue_t *pQ)
+{
+    if(pQ->capacity <= 0)
+    {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pQ->ring = malloc(pQ->capacity * pQ->msgSize);
+    pQ->ringSize = malloc(pQ->capacity * sizeof(size_t));
+    pQ->ringPrio = malloc(pQ->capacity * sizeof(unsigned int));
+    if(!pQ->ring || !pQ->ringSize || !pQ->ringPrio)
+    {
+        goto err_alloc;
+    }
+
+    if(pthread_mutex_init(&pQ->mutex, NULL) != 0)
+    {
+        goto err_alloc;
+    }
+    if(pthread_cond_init(&pQ->notEmpty, NULL) != 0)
+    {
+        goto err_not_empty;
+    }
+    if(pthread_cond_init(&pQ->notFull, NULL) != 0)
+    {
+        goto err_not_full;
+    }
+    pQ->head = 0;
+    pQ->count = 0;
+    return 0;
+
+    err_not_full:
+    pthread_cond_destroy(&pQ->notEmpty);
+    err_not_empty:
+    pthread_mutex_destroy(&pQ->mutex);
+    err_alloc:
+    free(pQ->ring);
+    free(pQ->ringSize);
+    free(pQ->ringPrio);
+    return -1;
+}
+
+static void LocalDestroy(WA_OSA_queue_t *pQ)
+{
+    pthread_cond_destroy(&pQ->notFull);
+    pthread_cond_destroy(&pQ->notEmpty);
+    pthread_mutex_destroy(&pQ->mutex);
+    free(pQ->ring);
+    free(pQ->ringSize);
+    free(pQ->ringPrio);
+}
+
+/* mq_send()/mq_timedsend() of the local queue, the wait is not interrupted by signals */
+static int LocalSend(WA_OSA_queue_t *pQ, const char *buf, size_t size, unsigned int prio, const struct timespec *pAbsTime)
+{
+    long i, from, to;
+    int status = 0;
+
+    if((long)size > pQ->msgSize)
+    {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    pthread_mutex_lock(&pQ->mutex);
+    while((pQ->count == pQ->capacity) && (status == 0))
+    {
+        status = pAbsTime ? pthread_cond_timedwait(&pQ->notFull, &pQ->mutex, pAbsTime) :
+                pthread_cond_wait(&pQ->notFull, &pQ->mutex);
+    }
+    if(status != 0)
+    {
+        pthread_mutex_unlock(&pQ->mutex);
+        errno = status;
+        return -1;
+    }
+
+    /* as mq: higher priority first, the order of sending within a priority */
+    for(i = pQ->count; i > 0; i--)
+    {
+        from = (pQ->head + i - 1) % pQ->capacity;
+        if(pQ->ringPrio[from] >= prio)
+        {
+            break;
+        }
+        to = (pQ->head + i) % pQ->capacity;
+        memcpy(pQ->ring + to * pQ->msgSize, pQ->ring + from * pQ->msgSize, pQ->ringSize[from]);
+        pQ->ringSize[to] = pQ->ringSize[from];
+        pQ->ringPrio[to] = pQ->ringPrio[from];
+    }
+    to = (pQ->head + i) % pQ->capacity;
+    memcpy(pQ->ring + to * pQ->msgSize, buf, size);
+    pQ->ringSize[to] = size;
+    pQ->ringPrio[to] = prio;
+
+    if(++pQ->count > pQ->hwm)
+    {
+        __atomic_store_n(&pQ->hwm, pQ->count, __ATOMIC_RELAXED);
+    }
+    pthread_cond_signal(&pQ->notEmpty);
+    pthread_mutex_unlock(&pQ->mutex);
+    return 0;
+}
+
+/* mq_receive()/mq_timedreceive() of the local queue, buf takes msgSize */
+static ssize_t LocalReceive(WA_OSA_queue_t *pQ, char *buf, unsigned int *pPrio, const struct timespec *pAbsTime)
+{
+    ssize_t rsize;
+    int status = 0;
+
+    pthread_mutex_lock(&pQ->mutex);
+    while((pQ->count == 0) && (status == 0))
+    {
+        status = pAbsTime ? pthread_cond_timedwait(&pQ->notEmpty, &pQ->mutex, pAbsTime) :
+                pthread_cond_wait(&pQ->notEmpty, &pQ->mutex);
+    }
+    if(status != 0)
+    {
+        pthread_mutex_unlock(&pQ->mutex);
+        errno = status;
+        return -1;
+    }
+
+    rsize = (ssize_t)pQ->ringSize[pQ->head];
+    memcpy(buf, pQ->ring + pQ->head * pQ->msgSize, rsize);
+    *pPrio = pQ->ringPrio[pQ->head];
+    pQ->head = (pQ->head + 1) % pQ->capacity;
+    pQ->count--;
+
+    pthread_cond_signal(&pQ->notFull);
+    pthread_mutex_unlock(&pQ->mutex);
+    return rsize;
+}
+
 static void *TaskWrapper(void *p)
 {
     WA_OSA_task_t *pThd = (WA_OSA_task_t *)p;
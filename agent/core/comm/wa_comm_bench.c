@@ -0,0 +1,1039 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_comm_bench.c
+ *
+ * @brief End-to-end benchmark of the RPC pipeline - implementation
+ *
+ * Client n only calls "bench_<n>", so its diag is never busy with another client.
+ * Still, the ack of the next request may race the instance collector of the previous
+ * one, a request answered "Already in progress" is sent again and counted as a retry.
+ *
+ * The "ws" clients share the one connection the WebSocket adapter accepts, a reader
+ * task routes the acks by the "id" and the "eod"s by the "client" of the echoed params.
+ */
+
+/** @addtogroup WA_COMM_BENCH
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_comm_bench.h"
+#include "wa_config.h"
+#include "wa_diag_bench.h"
+#include "wa_metrics.h"
+#include "wa_osa.h"
+#include "wa_log.h"
+#include "wa_debug.h"
+
+/*****************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ *****************************************************************************/
+extern void WA_MAIN_Quit(bool);
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define DEFAULT_PORT 8003
+#define DEFAULT_CONCURRENCY 4
+#define DEFAULT_REQUESTS 10000
+#define DEFAULT_WARMUP 200
+#define DEFAULT_SIZE 64
+#define DEFAULT_REPORT "/tmp/hwst_bench.json"
+
+#define REPLY_TIMEOUT 10000 /* [ms] */
+#define BUSY_MESSAGE "Already in progress"
+
+#define REPLY_ACK   (1 << 0)
+#define REPLY_EOD   (1 << 1)
+#define REPLY_BUSY  (1 << 2)
+#define REPLY_ERROR (1 << 3)
+
+#define WS_KEY "dGhlIHNhbXBsZSBub25jZQ=="
+#define WS_HANDSHAKE_MAX 1024
+#define WS_FRAME_HEADER_MAX 14 /* 2 + 8 bytes of length + 4 bytes of mask */
+#define WS_MSG_MAX (16 * 1024 * 1024)
+#define WS_FIN 0x80
+#define WS_OPCODE_TEXT 0x1
+#define WS_OPCODE_CLOSE 0x8
+#define WS_OPCODE_CONTROL 0x8
+
+#define HOPS_COUNT 6
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+struct WA_COMM_BENCH_context_tag;
+
+typedef struct
+{
+    struct WA_COMM_BENCH_context_tag *pContext;
+    unsigned int index;
+    void *commHandle;
+    void *cond;
+    unsigned int replies; /* REPLY_ flags, under cond */
+    char *request; /* the text, or its WS frame */
+    size_t requestLen;
+    unsigned int todo;
+    bool measure;
+    uint64_t *ack; /* [us] */
+    uint64_t *eod; /* [us] */
+    unsigned int done;
+    unsigned int retries;
+    unsigned int errors;
+    void *taskHandle;
+}WA_COMM_BENCH_client_t;
+
+typedef struct
+{
+    uint64_t hops[HOPS_COUNT][WA_METRICS_FINE_BUCKETS];
+    uint64_t allocs;
+    uint64_t time; /* [us] */
+}WA_COMM_BENCH_snapshot_t;
+
+typedef struct WA_COMM_BENCH_context_tag
+{
+    const WA_COMM_adaptersConfig_t *pConfig;
+    bool ws;
+    int port;
+    unsigned int concurrency;
+    unsigned int requests;
+    unsigned int warmup;
+    unsigned int size;
+    const char *report;
+    const char *label;
+    const char *queue;
+    bool taskRun;
+    void *taskHandle;
+    int wsFd;
+    void *wsMutex;
+    void *wsTaskHandle;
+    WA_COMM_BENCH_snapshot_t before;
+    WA_COMM_BENCH_snapshot_t after;
+    WA_COMM_BENCH_client_t clients[WA_DIAG_BENCH_COUNT];
+}WA_COMM_BENCH_context_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static void *BenchTask(void *p);
+static void *ClientTask(void *p);
+static void *WsTask(void *p);
+static int RunPhase(WA_COMM_BENCH_context_t *pContext, unsigned int requests, bool measure);
+static char *BuildRequest(unsigned int index, unsigned int size, bool ws, size_t *pLen);
+static int Send(WA_COMM_BENCH_client_t *pClient);
+static void Post(WA_COMM_BENCH_client_t *pClient, unsigned int reply);
+static unsigned int Wait(WA_COMM_BENCH_client_t *pClient, unsigned int want);
+static void Route(WA_COMM_BENCH_context_t *pContext, const char *msg);
+static long Field(const char *msg, const char *key);
+static int WsConnect(WA_COMM_BENCH_context_t *pContext);
+static void WsClose(WA_COMM_BENCH_context_t *pContext);
+static int SendAll(int fd, const char *buf, size_t len);
+static int RecvAll(int fd, char *buf, size_t len);
+static void Snapshot(WA_COMM_BENCH_snapshot_t *pSnapshot);
+static void Report(WA_COMM_BENCH_context_t *pContext);
+static json_int_t Percentile(const uint64_t *sorted, unsigned int n, unsigned int permille);
+static json_int_t FinePercentile(const uint64_t *counts, uint64_t total, unsigned int permille);
+static int Compare(const void *a, const void *b);
+static void ReleaseClients(WA_COMM_BENCH_context_t *pContext);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+static const WA_METRICS_Id_t hops[HOPS_COUNT] =
+{
+    WA_METRICS_HOP_INIT, WA_METRICS_HOP_DIAG, WA_METRICS_HOP_INSTANCE,
+    WA_METRICS_HOP_COLLECTOR, WA_METRICS_HOP_COMM, WA_METRICS_WS_TX_STALL
+};
+
+static const char * const hopNames[HOPS_COUNT] =
+{
+    "init", "diag", "instance", "collector", "comm", "ws_tx_stall"
+};
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+void * WA_COMM_BENCH_Init(WA_COMM_adaptersConfig_t *config)
+{
+    WA_COMM_BENCH_context_t *pContext;
+    WA_COMM_BENCH_client_t *pClient;
+    const char *transport = "direct";
+    const char *queue;
+    int port = DEFAULT_PORT;
+    int concurrency = DEFAULT_CONCURRENCY;
+    int requests = DEFAULT_REQUESTS;
+    int warmup = DEFAULT_WARMUP;
+    int size = DEFAULT_SIZE;
+    unsigned int i;
+
+    WA_ENTER("WA_COMM_BENCH_Init(config=%p)\n", config);
+
+    pContext = calloc(1, sizeof(WA_COMM_BENCH_context_t));
+    if(pContext == NULL)
+    {
+        WA_ERROR("WA_COMM_BENCH_Init(): calloc(): error\n");
+        goto end;
+    }
+    pContext->pConfig = config;
+    pContext->report = DEFAULT_REPORT;
+    pContext->label = "";
+    pContext->queue = "mq";
+    pContext->wsFd = -1;
+
+    if(config->config && json_unpack(config->config, "{s?s,s?i,s?i,s?i,s?i,s?i,s?s,s?s}",
+            "transport", &transport, "port", &port, "concurrency", &concurrency, "requests", &requests,
+            "warmup", &warmup, "size", &size, "report", &pContext->report, "label", &pContext->label))
+    {
+        WA_ERROR("WA_COMM_BENCH_Init(): invalid config\n");
+        goto err_config;
+    }
+
+    if((strcmp(transport, "direct") && strcmp(transport, "ws")) ||
+       (concurrency < 1) || (concurrency > WA_DIAG_BENCH_COUNT) ||
+       (requests < 1) || (warmup < 0) || (size < 0))
+    {
+        WA_ERROR("WA_COMM_BENCH_Init(): invalid config, concurrency is 1..%d\n", WA_DIAG_BENCH_COUNT);
+        goto err_config;
+    }
+
+    if(json_unpack(WA_CONFIG_GetSection("osa"), "{s:s}", "queue", &queue) == 0)
+    {
+        pContext->queue = queue;
+    }
+
+    pContext->ws = !strcmp(transport, "ws");
+    pContext->port = port;
+    pContext->concurrency = concurrency;
+    pContext->requests = requests;
+    pContext->warmup = warmup;
+    pContext->size = size;
+
+    for(i = 0; i < pContext->concurrency; ++i)
+    {
+        pClient = &pContext->clients[i];
+        pClient->pContext = pContext;
+        pClient->index = i;
+        pClient->ack = malloc((pContext->requests / pContext->concurrency + 1) * sizeof(uint64_t));
+        pClient->eod = malloc((pContext->requests / pContext->concurrency + 1) * sizeof(uint64_t));
+        pClient->request = BuildRequest(i, pContext->size, pContext->ws, &pClient->requestLen);
+        pClient->cond = WA_OSA_CondCreate();
+        if(!pClient->ack || !pClient->eod || !pClient->request || !pClient->cond)
+        {
+            WA_ERROR("WA_COMM_BENCH_Init(): client %u: error\n", i);
+            goto err_clients;
+        }
+
+        if(!pContext->ws)
+        {
+            pClient->commHandle = WA_COMM_Register(config, (void *)pClient);
+            if(pClient->commHandle == NULL)
+            {
+                WA_ERROR("WA_COMM_BENCH_Init(): WA_COMM_Register(): null\n");
+                goto err_clients;
+            }
+        }
+    }
+
+    if(pContext->ws)
+    {
+        pContext->wsMutex = WA_OSA_MutexCreate();
+        if(pContext->wsMutex == NULL)
+        {
+            WA_ERROR("WA_COMM_BENCH_Init(): WA_OSA_MutexCreate(): error\n");
+            goto err_clients;
+        }
+    }
+
+    WA_INFO("WA_COMM_BENCH_Init(): %s, queue %s, concurrency %u, %u requests of %u bytes\n",
+            transport, pContext->queue, pContext->concurrency, pContext->requests, pContext->size);
+
+    pContext->taskRun = true;
+    pContext->taskHandle = WA_OSA_TaskCreate("bench", 0, BenchTask, pContext, WA_OSA_SCHED_POLICY_NORMAL, 0);
+    if(pContext->taskHandle == NULL)
+    {
+        WA_ERROR("WA_COMM_BENCH_Init(): WA_OSA_TaskCreate(BenchTask): error\n");
+        goto err_task;
+    }
+
+    goto end;
+
+err_task:
+    if(pContext->wsMutex)
+    {
+        WA_OSA_MutexDestroy(pContext->wsMutex);
+    }
+err_clients:
+    ReleaseClients(pContext);
+err_config:
+    free(pContext);
+    pContext = NULL;
+end:
+    WA_RETURN("WA_COMM_BENCH_Init(): %p\n", pContext);
+    return (void *)pContext;
+}
+
+int WA_COMM_BENCH_Exit(void *handle)
+{
+    WA_COMM_BENCH_context_t *pContext = (WA_COMM_BENCH_context_t *)handle;
+    int status = 0;
+    unsigned int i;
+
+    WA_ENTER("WA_COMM_BENCH_Exit(handle=%p)\n", handle);
+
+    /* the waiting clients give up, then the bench task ends */
+    pContext->taskRun = false;
+    for(i = 0; i < pContext->concurrency; ++i)
+    {
+        WA_OSA_CondLock(pContext->clients[i].cond);
+        WA_OSA_CondSignalBroadcast(pContext->clients[i].cond);
+        WA_OSA_CondUnlock(pContext->clients[i].cond);
+    }
+
+    if((WA_OSA_TaskJoin(pContext->taskHandle, NULL) != 0) ||
+       (WA_OSA_TaskDestroy(pContext->taskHandle) != 0))
+    {
+        WA_ERROR("WA_COMM_BENCH_Exit(): BenchTask: error\n");
+        status = -1;
+    }
+
+    if(pContext->wsMutex)
+    {
+        WA_OSA_MutexDestroy(pContext->wsMutex);
+    }
+    ReleaseClients(pContext);
+    free(pContext);
+
+    WA_RETURN("WA_COMM_BENCH_Exit(): %d\n", status);
+    return status;
+}
+
+int WA_COMM_BENCH_Callback(void *cookie, json_t *json)
+{
+    const char *method, *message;
+    unsigned int reply;
+
+    if(json_unpack(json, "{s:s}", "method", &method) == 0)
+    {
+        /* notifications other than the "eod" are of no interest */
+        reply = strcmp(method, "eod") ? 0 : REPLY_EOD;
+    }
+    else if(json_unpack(json, "{s:{s:n,s:s}}", "result", "diag", "message", &message) == 0)
+    {
+        reply = strcmp(message, BUSY_MESSAGE) ? REPLY_ERROR : REPLY_BUSY;
+    }
+    else
+    {
+        reply = json_object_get(json, "result") ? REPLY_ACK : REPLY_ERROR;
+    }
+
+    if(reply)
+    {
+        Post((WA_COMM_BENCH_client_t *)cookie, reply);
+    }
+    json_decref(json);
+    return 0;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+static void *BenchTask(void *p)
+{
+    WA_COMM_BENCH_context_t *pContext = (WA_COMM_BENCH_context_t *)p;
+    int status;
+
+    WA_ENTER("BenchTask(p=%p)\n", p);
+
+    /* no WebSocket client is coming, the agent must not time out */
+    WA_MAIN_Quit(false);
+
+    if(pContext->ws && (WsConnect(pContext) != 0))
+    {
+        goto end;
+    }
+
+    status = RunPhase(pContext, pContext->warmup, false);
+    if(status == 0)
+    {
+        Snapshot(&pContext->before);
+        status = RunPhase(pContext, pContext->requests, true);
+        Snapshot(&pContext->after);
+    }
+
+    if((status == 0) && pContext->taskRun)
+    {
+        Report(pContext);
+    }
+
+    if(pContext->ws)
+    {
+        WsClose(pContext);
+    }
+
+end:
+    WA_MAIN_Quit(true);
+    WA_RETURN("BenchTask(): %p\n", p);
+    return p;
+}
+
+/* Closed loop: the next request goes when the previous one has its "eod" */
+static void *ClientTask(void *p)
+{
+    WA_COMM_BENCH_client_t *pClient = (WA_COMM_BENCH_client_t *)p;
+    unsigned int reply;
+    uint64_t start, ack;
+
+    while(pClient->done < pClient->todo)
+    {
+        start = WA_METRICS_Now();
+        do
+        {
+            reply = (Send(pClient) == 0) ? Wait(pClient, REPLY_ACK | REPLY_BUSY | REPLY_ERROR) : REPLY_ERROR;
+            pClient->retries += !!(reply & REPLY_BUSY);
+        }
+        while(reply & REPLY_BUSY);
+        ack = WA_METRICS_Now() - start;
+
+        if(!(reply & REPLY_ACK) || !(Wait(pClient, REPLY_EOD | REPLY_ERROR) & REPLY_EOD))
+        {
+            /* a late reply would be taken for one of the next request, the client stops */
+            WA_ERROR("ClientTask(): client %u, request %u failed\n", pClient->index, pClient->done);
+            ++pClient->errors;
+            break;
+        }
+
+        if(pClient->measure)
+        {
+            pClient->ack[pClient->done] = ack;
+            pClient->eod[pClient->done] = WA_METRICS_Now() - start;
+        }
+        ++pClient->done;
+    }
+
+    return NULL;
+}
+
+static void *WsTask(void *p)
+{
+    WA_COMM_BENCH_context_t *pContext = (WA_COMM_BENCH_context_t *)p;
+    unsigned char header[WS_FRAME_HEADER_MAX];
+    char *msg = NULL, *tmp;
+    size_t msgLen = 0, msgSize = 0;
+    uint64_t len;
+    unsigned int i, b;
+
+    for(;;)
+    {
+        if(RecvAll(pContext->wsFd, (char *)header, 2) != 0)
+        {
+            break;
+        }
+
+        /* the server frames are not masked */
+        len = header[1] & 0x7f;
+        if(len >= 126)
+        {
+            i = (len == 126) ? 2 : 8;
+            if(RecvAll(pContext->wsFd, (char *)header + 2, i) != 0)
+            {
+                break;
+            }
+            for(len = 0, b = 0; b < i; ++b)
+            {
+                len = (len << 8) | header[2 + b];
+            }
+        }
+        if(msgLen + len >= WS_MSG_MAX)
+        {
+            WA_ERROR("WsTask(): message too big\n");
+            break;
+        }
+
+        if(msgLen + len + 1 > msgSize)
+        {
+            tmp = realloc(msg, msgLen + len + 1);
+            if(tmp == NULL)
+            {
+                WA_ERROR("WsTask(): realloc(): error\n");
+                break;
+            }
+            msg = tmp;
+            msgSize = msgLen + len + 1;
+        }
+
+        if(RecvAll(pContext->wsFd, msg + msgLen, len) != 0)
+        {
+            break;
+        }
+
+        if((header[0] & 0x0f) == WS_OPCODE_CLOSE)
+        {
+            break;
+        }
+        if(header[0] & WS_OPCODE_CONTROL)
+        {
+            /* ping/pong, the payload is dropped */
+            continue;
+        }
+
+        msgLen += len;
+        if(header[0] & WS_FIN)
+        {
+            msg[msgLen] = '\0';
+            Route(pContext, msg);
+            msgLen = 0;
+        }
+    }
+    free(msg);
+
+    /* nothing more comes, the waiting clients fail now rather than on the timeout */
+    for(i = 0; i < pContext->concurrency; ++i)
+    {
+        Post(&pContext->clients[i], REPLY_ERROR);
+    }
+
+    return NULL;
+}
+
+static int RunPhase(WA_COMM_BENCH_context_t *pContext, unsigned int requests, bool measure)
+{
+    WA_COMM_BENCH_client_t *pClient;
+    unsigned int i, started;
+    int status = 0;
+
+    for(i = 0; i < pContext->concurrency; ++i)
+    {
+        pClient = &pContext->clients[i];
+        pClient->todo = requests / pContext->concurrency + (i < requests % pContext->concurrency);
+        pClient->measure = measure;
+        pClient->done = 0;
+        pClient->retries = 0;
+        pClient->errors = 0;
+        pClient->replies = 0;
+    }
+
+    for(started = 0; started < pContext->concurrency; ++started)
+    {
+        pClient = &pContext->clients[started];
+        pClient->taskHandle = WA_OSA_TaskCreate("benchclient", 0, ClientTask, pClient, WA_OSA_SCHED_POLICY_NORMAL, 0);
+        if(pClient->taskHandle == NULL)
+        {
+            WA_ERROR("RunPhase(): WA_OSA_TaskCreate(ClientTask): error\n");
+            status = -1;
+            break;
+        }
+    }
+
+    for(i = 0; i < started; ++i)
+    {
+        pClient = &pContext->clients[i];
+        WA_OSA_TaskJoin(pClient->taskHandle, NULL);
+        WA_OSA_TaskDestroy(pClient->taskHandle);
+        pClient->taskHandle = NULL;
+    }
+
+    return status;
+}
+
+/* The request text, or for the "ws" a masked text frame of it */
+static char *BuildRequest(unsigned int index, unsigned int size, bool ws, size_t *pLen)
+{
+    unsigned char *frame;
+    char *text;
+    size_t len, off, i;
+
+    text = malloc(size + 128);
+    if(text == NULL)
+    {
+        return NULL;
+    }
+
+    /* the params come back as the result, "client" routes the "eod" */
+    len = snprintf(text, 128, "{\"jsonrpc\":\"2.0\",\"method\":\"bench_%u\",\"params\":{\"client\":%u,\"pad\":\"", index, index);
+    memset(text + len, 'x', size);
+    len += size;
+    len += sprintf(text + len, "\"},\"id\":%u}", index + 1);
+
+    if(!ws)
+    {
+        *pLen = len;
+        return text;
+    }
+
+    frame = malloc(len + WS_FRAME_HEADER_MAX);
+    if(frame == NULL)
+    {
+        free(text);
+        return NULL;
+    }
+
+    frame[0] = WS_FIN | WS_OPCODE_TEXT;
+    if(len < 126)
+    {
+        frame[1] = 0x80 | len;
+        off = 2;
+    }
+    else if(len < 65536)
+    {
+        frame[1] = 0x80 | 126;
+        frame[2] = len >> 8;
+        frame[3] = len & 0xff;
+        off = 4;
+    }
+    else
+    {
+        frame[1] = 0x80 | 127;
+        for(i = 0; i < 8; ++i)
+        {
+            frame[2 + i] = ((uint64_t)len >> (56 - 8 * i)) & 0xff;
+        }
+        off = 10;
+    }
+
+    /* a client must mask, the zero key leaves the payload as it is */
+    memset(frame + off, 0, 4);
+    off += 4;
+    memcpy(frame + off, text, len);
+    free(text);
+
+    *pLen = off + len;
+    return (char *)frame;
+}
+
+static int Send(WA_COMM_BENCH_client_t *pClient)
+{
+    WA_COMM_BENCH_context_t *pContext = pClient->pContext;
+    int status;
+
+    if(!pContext->ws)
+    {
+        return WA_COMM_SendTxt(pClient->commHandle, pClient->request, pClient->requestLen);
+    }
+
+    WA_OSA_MutexLock(pContext->wsMutex);
+    status = SendAll(pContext->wsFd, pClient->request, pClient->requestLen);
+    WA_OSA_MutexUnlock(pContext->wsMutex);
+
+    return status;
+}
+
+static void Post(WA_COMM_BENCH_client_t *pClient, unsigned int reply)
+{
+    WA_OSA_CondLock(pClient->cond);
+    pClient->replies |= reply;
+    WA_OSA_CondSignal(pClient->cond);
+    WA_OSA_CondUnlock(pClient->cond);
+}
+
+/* Returns the wanted replies that came, none on the timeout or the exit */
+static unsigned int Wait(WA_COMM_BENCH_client_t *pClient, unsigned int want)
+{
+    unsigned int got;
+
+    WA_OSA_CondLock(pClient->cond);
+    while(!(pClient->replies & want) && pClient->pContext->taskRun)
+    {
+        if(WA_OSA_CondTimedWait(pClient->cond, REPLY_TIMEOUT) == 1)
+        {
+            break;
+        }
+    }
+    got = pClient->replies & want;
+    pClient->replies &= ~got;
+    WA_OSA_CondUnlock(pClient->cond);
+
+    return got;
+}
+
+/* The text is only searched, parsing it would count in the allocations of the agent */
+static void Route(WA_COMM_BENCH_context_t *pContext, const char *msg)
+{
+    unsigned int reply;
+    long index;
+
+    if(strstr(msg, "\"eod\""))
+    {
+        reply = REPLY_EOD;
+        index = Field(msg, "\"client\"");
+    }
+    else
+    {
+        reply = !strstr(msg, "\"message\"") ? REPLY_ACK :
+                strstr(msg, BUSY_MESSAGE) ? REPLY_BUSY : REPLY_ERROR;
+        index = Field(msg, "\"id\"") - 1;
+    }
+
+    if((index < 0) || (index >= (long)pContext->concurrency))
+    {
+        WA_WARN("Route(): unexpected message: %.64s\n", msg);
+        return;
+    }
+
+    Post(&pContext->clients[index], reply);
+}
+
+static long Field(const char *msg, const char *key)
+{
+    const char *p = strstr(msg, key);
+
+    if(p == NULL)
+    {
+        return -1;
+    }
+
+    p += strlen(key);
+    p += strspn(p, " :");
+    return isdigit((unsigned char)*p) ? strtol(p, NULL, 10) : -1;
+}
+
+static int WsConnect(WA_COMM_BENCH_context_t *pContext)
+{
+    struct sockaddr_in address;
+    char buf[WS_HANDSHAKE_MAX];
+    size_t n;
+    int fd, on = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+    {
+        WA_ERROR("WsConnect(): socket() error: %i (%s)\n", errno, strerror(errno));
+        return -1;
+    }
+
+    /* the frames are small, they must not wait for each other */
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(pContext->port);
+    if(connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+        WA_ERROR("WsConnect(): port %i: %i (%s)\n", pContext->port, errno, strerror(errno));
+        goto err;
+    }
+
+    n = snprintf(buf, sizeof(buf), "GET / HTTP/1.1\r\nHost: 127.0.0.1:%d\r\nUpgrade: websocket\r\n"
+            "Connection: Upgrade\r\nSec-WebSocket-Key: " WS_KEY "\r\nSec-WebSocket-Version: 13\r\n\r\n", pContext->port);
+    if(SendAll(fd, buf, n) != 0)
+    {
+        WA_ERROR("WsConnect(): handshake not sent\n");
+        goto err;
+    }
+
+    /* byte by byte, nothing past the handshake is to be read here */
+    for(n = 0; n < sizeof(buf) - 1; )
+    {
+        if(RecvAll(fd, buf + n, 1) != 0)
+        {
+            break;
+        }
+        ++n;
+        if((n >= 4) && !memcmp(buf + n - 4, "\r\n\r\n", 4))
+        {
+            break;
+        }
+    }
+    buf[n] = '\0';
+    if(strncmp(buf, "HTTP/1.1 101", 12))
+    {
+        WA_ERROR("WsConnect(): handshake refused: %.32s\n", buf);
+        goto err;
+    }
+
+    pContext->wsFd = fd;
+    pContext->wsTaskHandle = WA_OSA_TaskCreate("benchws", 0, WsTask, pContext, WA_OSA_SCHED_POLICY_NORMAL, 0);
+    if(pContext->wsTaskHandle == NULL)
+    {
+        WA_ERROR("WsConnect(): WA_OSA_TaskCreate(WsTask): error\n");
+        pContext->wsFd = -1;
+        goto err;
+    }
+
+    return 0;
+
+err:
+    close(fd);
+    return -1;
+}
+
+static void WsClose(WA_COMM_BENCH_context_t *pContext)
+{
+    if(pContext->wsFd < 0)
+    {
+        return;
+    }
+
+    shutdown(pContext->wsFd, SHUT_RDWR);
+    WA_OSA_TaskJoin(pContext->wsTaskHandle, NULL);
+    WA_OSA_TaskDestroy(pContext->wsTaskHandle);
+    pContext->wsTaskHandle = NULL;
+    close(pContext->wsFd);
+    pContext->wsFd = -1;
+}
+
+static int SendAll(int fd, const char *buf, size_t len)
+{
+    ssize_t n;
+
+    while(len > 0)
+    {
+        n = send(fd, buf, len, MSG_NOSIGNAL);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int RecvAll(int fd, char *buf, size_t len)
+{
+    ssize_t n;
+
+    while(len > 0)
+    {
+        n = recv(fd, buf, len, 0);
+        if(n <= 0)
+        {
+            if((n < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static void Snapshot(WA_COMM_BENCH_snapshot_t *pSnapshot)
+{
+    unsigned int h;
+
+    for(h = 0; h < HOPS_COUNT; ++h)
+    {
+        WA_METRICS_GetFine(hops[h], pSnapshot->hops[h]);
+    }
+    pSnapshot->allocs = WA_METRICS_Count(WA_METRICS_ALLOCS);
+    pSnapshot->time = WA_METRICS_Now();
+}
+
+static void Report(WA_COMM_BENCH_context_t *pContext)
+{
+    WA_COMM_BENCH_client_t *pClient;
+    uint64_t counts[WA_METRICS_FINE_BUCKETS], total;
+    uint64_t *ack, *eod;
+    unsigned int n = 0, retries = 0, errors = 0, i, b;
+    double seconds;
+    json_t *jhops, *jreport;
+    char *line;
+    FILE *f;
+
+    for(i = 0; i < pContext->concurrency; ++i)
+    {
+        n += pContext->clients[i].done;
+    }
+
+    ack = malloc((n + 1) * sizeof(uint64_t));
+    eod = malloc((n + 1) * sizeof(uint64_t));
+    jhops = json_object();
+    if(!ack || !eod || !jhops)
+    {
+        WA_ERROR("Report(): out of memory\n");
+        goto end;
+    }
+
+    for(n = 0, i = 0; i < pContext->concurrency; ++i)
+    {
+        pClient = &pContext->clients[i];
+        memcpy(ack + n, pClient->ack, pClient->done * sizeof(uint64_t));
+        memcpy(eod + n, pClient->eod, pClient->done * sizeof(uint64_t));
+        n += pClient->done;
+        retries += pClient->retries;
+        errors += pClient->errors;
+    }
+    qsort(ack, n, sizeof(uint64_t), Compare);
+    qsort(eod, n, sizeof(uint64_t), Compare);
+
+    for(i = 0; i < HOPS_COUNT; ++i)
+    {
+        for(total = 0, b = 0; b < WA_METRICS_FINE_BUCKETS; ++b)
+        {
+            counts[b] = pContext->after.hops[i][b] - pContext->before.hops[i][b];
+            total += counts[b];
+        }
+        json_object_set_new(jhops, hopNames[i], json_pack("{s:I,s:I,s:I,s:I}",
+                "count", (json_int_t)total,
+                "p50", FinePercentile(counts, total, 500),
+                "p99", FinePercentile(counts, total, 990),
+                "p999", FinePercentile(counts, total, 999)));
+    }
+
+    seconds = (pContext->after.time - pContext->before.time) / 1000000.0;
+    jreport = json_pack("{s:s,s:s,s:s,s:i,s:i,s:i,s:i,s:i,s:f,s:f,s:{s:I,s:I,s:I,s:I},s:{s:I,s:I,s:I,s:I},s:o,s:f}",
+            "label", pContext->label,
+            "transport", pContext->ws ? "ws" : "direct",
+            "queue", pContext->queue,
+            "concurrency", (int)pContext->concurrency,
+            "size", (int)pContext->size,
+            "requests", (int)n,
+            "retries", (int)retries,
+            "errors", (int)errors,
+            "seconds", seconds,
+            "throughput", (seconds > 0) ? n / seconds : 0.0,
+            "ack_us", "p50", Percentile(ack, n, 500), "p99", Percentile(ack, n, 990),
+                      "p999", Percentile(ack, n, 999), "max", Percentile(ack, n, 1000),
+            "eod_us", "p50", Percentile(eod, n, 500), "p99", Percentile(eod, n, 990),
+                      "p999", Percentile(eod, n, 999), "max", Percentile(eod, n, 1000),
+            "hops_us", jhops,
+            "allocs_per_request", n ? (double)(pContext->after.allocs - pContext->before.allocs) / n : 0.0);
+    jhops = NULL;
+    if(jreport == NULL)
+    {
+        WA_ERROR("Report(): json_pack(): error\n");
+        goto end;
+    }
+
+    line = json_dumps(jreport, JSON_COMPACT | JSON_PRESERVE_ORDER);
+    json_decref(jreport);
+    if(line == NULL)
+    {
+        WA_ERROR("Report(): json_dumps(): error\n");
+        goto end;
+    }
+
+    f = fopen(pContext->report, "a");
+    if(f != NULL)
+    {
+        fprintf(f, "%s\n", line);
+        fclose(f);
+    }
+    else
+    {
+        WA_ERROR("Report(): fopen(%s): %i (%s)\n", pContext->report, errno, strerror(errno));
+    }
+    free(line);
+
+    CLIENT_LOG("Bench %s/%s c=%u: %u requests, %u errors, %.0f/s, eod p50 %lluus p99 %lluus\n",
+            pContext->ws ? "ws" : "direct", pContext->queue, pContext->concurrency, n, errors,
+            (seconds > 0) ? n / seconds : 0.0,
+            (unsigned long long)Percentile(eod, n, 500), (unsigned long long)Percentile(eod, n, 990));
+
+end:
+    json_decref(jhops);
+    free(ack);
+    free(eod);
+}
+
+static json_int_t Percentile(const uint64_t *sorted, unsigned int n, unsigned int permille)
+{
+    if(n == 0)
+    {
+        return 0;
+    }
+    return (json_int_t)sorted[((uint64_t)n * permille + 999) / 1000 - 1];
+}
+
+/* The upper bound of the bucket the percentile falls into */
+static json_int_t FinePercentile(const uint64_t *counts, uint64_t total, unsigned int permille)
+{
+    uint64_t rank, seen = 0;
+    int b;
+
+    if(total == 0)
+    {
+        return 0;
+    }
+
+    rank = (total * permille + 999) / 1000;
+    for(b = 0; b < WA_METRICS_FINE_BUCKETS - 1; ++b)
+    {
+        seen += counts[b];
+        if(seen >= rank)
+        {
+            break;
+        }
+    }
+    return (json_int_t)WA_METRICS_FineBound(b);
+}
+
+static int Compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void ReleaseClients(WA_COMM_BENCH_context_t *pContext)
+{
+    WA_COMM_BENCH_client_t *pClient;
+    unsigned int i;
+
+    for(i = 0; i < pContext->concurrency; ++i)
+    {
+        pClient = &pContext->clients[i];
+        if(pClient->commHandle)
+        {
+            WA_COMM_Unregister(pClient->commHandle);
+        }
+        if(pClient->cond)
+        {
+            WA_OSA_CondDestroy(pClient->cond);
+        }
+        free(pClient->request);
+        free(pClient->ack);
+        free(pClient->eod);
+    }
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,97 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_comm_bench.h
+ *
+ * @brief End-to-end benchmark of the RPC pipeline, a comm adapter of the benchmark builds.
+ *
+ * Closed-loop clients call the no-op "bench_<n>" diags, either straight through
+ * \c WA_COMM_SendTxt() ("direct") or over the WebSocket adapter ("ws"), and time
+ * the ack and the "eod" of every request. With the fine histograms of the queue
+ * hops and the allocation count the run is appended as one JSON line to the report.
+ *
+ * Configured by "adapters"."comm_bench": transport, port, concurrency, requests,
+ * warmup, size (request pad bytes), report (file) and label.
+ */
+
+/** @addtogroup WA_COMM_BENCH
+ *  @{
+ */
+
+#ifndef WA_COMM_BENCH_H
+#define WA_COMM_BENCH_H
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_comm.h"
+#include "wa_json.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * Initialize the benchmark and start its run.
+ *
+ * @param config the configuration
+ *
+ * @returns handle to provide in \c WA_COMM_BENCH_Exit()
+ * @retval null error
+ */
+extern void * WA_COMM_BENCH_Init(WA_COMM_adaptersConfig_t *config);
+
+/**
+ * Stop the benchmark.
+ *
+ * @param handle a handle provided by \c WA_COMM_BENCH_Init()
+ *
+ * @retval 0 success.
+ * @retval -1 error
+ */
+extern int WA_COMM_BENCH_Exit(void *handle);
+
+/**
+ * A callback to receive message from agent, for the "direct" clients.
+ *
+ * @param cookie a cookie that is provided with \c WA_COMM_Register()
+ * @param json the message body
+ *
+ * @retval 0 success.
+ * @retval -1 error
+ */
+extern int WA_COMM_BENCH_Callback(void *cookie, json_t *json);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_COMM_BENCH_H */
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
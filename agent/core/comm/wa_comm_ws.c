@@ -40,6 +40,7 @@
 
 #include "wa_comm_ws.h"
 #include "wa_json.h"
+#include "wa_metrics.h"
 #include "wa_osa.h"
 #include "wa_debug.h"
 
@@ -303,14 +304,22 @@ int WA_COMM_WS_Callback(void *cookie, json_t *json)
     }
     if(pConnection->valid)
     {
-        while(pConnection->txMsg != NULL)
+        if(pConnection->txMsg != NULL)
         {
-            status = WA_OSA_CondTimedWait(pConnection->conVarSend, pConnection->pContext->txTimeout);
-            if((status != 0) || !pConnection->valid)
+            /* the previous message is still being written */
+            uint64_t stallStart = WA_METRICS_Now();
+
+            while(pConnection->txMsg != NULL)
             {
-                /* error or timeout */
-                goto closing;
+                status = WA_OSA_CondTimedWait(pConnection->conVarSend, pConnection->pContext->txTimeout);
+                if((status != 0) || !pConnection->valid)
+                {
+                    /* error or timeout */
+                    WA_METRICS_Inc(WA_METRICS_WS_TX_DROPS);
+                    goto closing;
+                }
             }
+            WA_METRICS_Since(WA_METRICS_WS_TX_STALL, stallStart);
         }
 
         pConnection->txMsgSize = s;
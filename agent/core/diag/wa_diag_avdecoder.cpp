@@ -46,6 +46,7 @@
 #include "wa_diag.h"
 #include "wa_debug.h"
 #include "wa_fileops.h"
+#include "wa_throttle.h"
 
 /* module interface */
 #include "wa_diag_avdecoder.h"
@@ -469,7 +470,7 @@ int WA_DIAG_AVDECODER_VideoDecoderStatus(void)
     char *o = NULL;
     WA_ERROR("WA_DIAG_AVDECODER_status()VIDEO---XIONE \n");
     sprintf(cmd, "sh /lib/rdk/get_avstatus.sh > /tmp/av.log");
-    if(system(cmd) != 0)
+    if(WA_DIAG_System(cmd) != 0)
     {
        WA_ERROR("WA_DIAG_AVDECODER_status(): AV script not working--XIONE\n");
        return -1;
@@ -493,7 +494,7 @@ int WA_DIAG_AVDECODER_VideoDecoderStatus(void)
        free(o);
        char command[256]={'\0'};
        sprintf(command, "rm /tmp/av.log");
-       if(system(command) != 0)
+       if(WA_DIAG_System(command) != 0)
        {
           WA_ERROR("WA_DIAG_AVDECODER_status(): File not deleted- XIONE\n");
        }
@@ -560,7 +561,7 @@ int WA_DIAG_AVDECODER_AudioDecoderStatus(void)
     char *o = NULL;
     WA_ERROR("WA_DIAG_AVDECODER_status()AUDIO---XIONE \n");
     sprintf(cmd, "sh /lib/rdk/get_avstatus.sh > /tmp/av.log");
-    if(system(cmd) != 0)
+    if(WA_DIAG_System(cmd) != 0)
     {
        WA_ERROR("WA_DIAG_AVDECODER_status(): AV script not working- XIONE\n");
        return -1;
@@ -582,7 +583,7 @@ int WA_DIAG_AVDECODER_AudioDecoderStatus(void)
        free(o);
        char command[256]={'\0'};
        sprintf(command, "rm /tmp/av.log");
-       if(system(command) != 0)
+       if(WA_DIAG_System(command) != 0)
        {
          WA_ERROR("WA_DIAG_AVDECODER_status(): File not deleted- XIONE\n");
        }
@@ -763,7 +764,8 @@ int WA_DIAG_AVDECODER_status(void* instanceHandle, void *initHandle, json_t ** p
     parametersNum = 1; // setting this to 1 as there is no SI CACHE for Xi devices to get this value
 
     /* Use the URL from config if present */
-    if (!config || (json_unpack(config, "{ss}", "url", &url) != 0))
+    url = const_cast<char*>(WA_DIAG_GetSettings((WA_DIAG_proceduresConfig_t*)initHandle)->url);
+    if (!url)
     {
         WA_DBG("WA_DIAG_AVDECODER_status(): Unable to retrieve url from av_decoder_qam configuration.\n");
     }
@@ -817,7 +819,7 @@ int WA_DIAG_AVDECODER_status(void* instanceHandle, void *initHandle, json_t ** p
         strcpy(testUrl, videoUrlFormat);
         char * hostName = strtok(&testUrl[7], "/");
         sprintf(host, "ping -c 1 -W 1 %s> /dev/null", hostName);
-        if(system(host) != 0)
+        if(WA_DIAG_System(host) != 0)
         {
             WA_DBG("WA_DIAG_AVDECODER_status(): Unable to reach AV URL\n");
             return WA_DIAG_ERRCODE_AV_URL_NOT_REACHABLE;
@@ -889,6 +891,12 @@ int WA_DIAG_AVDECODER_status(void* instanceHandle, void *initHandle, json_t ** p
 
         try
         {
+            /* every parameter set starts a new playback, let the foreground load go first */
+            if(WA_THROTTLE_Point())
+            {
+                throw TestException(WA_DIAG_ERRCODE_CANCELLED, "Test cancelled.");
+            }
+
             playError = false;
             avUnderflow = false;
             videoPES = false;
@@ -1253,5 +1261,9 @@ static int getInteger(json_t * json, const char * key, bool * pOk)
 }
 #endif /* AVD_USE_RMF */
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("avdecoder_qam_status", WA_DIAG_AVDECODER_init, NULL, WA_DIAG_AVDECODER_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
@@ -0,0 +1,56 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_diag_bench.c
+ *
+ * @brief No-op diags of the benchmark builds - implementation
+ */
+
+/** @addtogroup WA_DIAG_BENCH
+ *  @{
+ */
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_debug.h"
+#include "wa_diag_bench.h"
+#include "wa_diag_errcodes.h"
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+int WA_DIAG_BENCH_Noop(void *instanceHandle, void *initHandle, json_t **params)
+{
+    WA_ENTER("WA_DIAG_BENCH_Noop(instanceHandle=%p, initHandle=%p, params=%p)\n",
+             instanceHandle, initHandle, params);
+
+    /* *params stays, it is the result */
+
+    WA_RETURN("WA_DIAG_BENCH_Noop(): %d\n", WA_DIAG_ERRCODE_SUCCESS);
+
+    return WA_DIAG_ERRCODE_SUCCESS;
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
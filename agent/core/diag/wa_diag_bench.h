@@ -0,0 +1,71 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_diag_bench.h
+ *
+ * @brief No-op diags of the benchmark builds - interface
+ */
+
+/** @addtogroup WA_DIAG_BENCH
+ *  @{
+ */
+
+#ifndef WA_DIAG_BENCH_H
+#define WA_DIAG_BENCH_H
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_json.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED DEFINITIONS
+ *****************************************************************************/
+
+/** Number of the "bench_<n>" diags, a diag runs one instance at a time */
+#define WA_DIAG_BENCH_COUNT 16
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * Does nothing and returns the params as its result, so the result is as big as the request.
+ *
+ * @retval 0 success.
+ */
+int WA_DIAG_BENCH_Noop(void *instanceHandle, void *initHandle, json_t **params);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_DIAG_BENCH_H */
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
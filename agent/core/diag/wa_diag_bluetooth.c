@@ -177,7 +177,7 @@ int WA_DIAG_BLUETOOTH_GetInternalInterfaces(hci_t hci)
 
     WA_ENTER("WA_DIAG_BLUETOOTH_GetInternalInterfaces()\n");
 
-    p = popen("/bin/ls -d " DIR_PATTERN " 2>/dev/null", "r");
+    p = WA_DIAG_Popen("/bin/ls -d " DIR_PATTERN " 2>/dev/null", "r");
     if (p == NULL)
         goto end;
 
@@ -210,7 +210,7 @@ int WA_DIAG_BLUETOOTH_Verify(int hci)
     WA_ENTER("WA_DIAG_BLUETOOTH_Verify(hci=%d)\n", hci);
 
     snprintf(buf, STR_MAX, "/usr/bin/hciconfig hci%d 2>/dev/null | grep -q \" *DOWN\" 2>/dev/null", hci);
-    if(system(buf) == 0)
+    if(WA_DIAG_System(buf) == 0)
     {
         WA_ERROR("hci%d is down\n", hci);
         status = -1;
@@ -218,7 +218,7 @@ int WA_DIAG_BLUETOOTH_Verify(int hci)
     else
     {
         snprintf(buf, STR_MAX, "/usr/bin/hciconfig hci%d version &>/dev/null", hci);
-        if(system(buf) != 0)
+        if(WA_DIAG_System(buf) != 0)
         {
             WA_DBG("hci%d is not DOWN, but unable to read version\n", hci);
             status = 1;
@@ -260,5 +260,9 @@ static bool bluetooth_supported(void)
     return status;
 }
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("bluetooth_status", NULL, NULL, WA_DIAG_BLUETOOTH_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
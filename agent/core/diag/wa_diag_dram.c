@@ -83,23 +83,19 @@ int WA_DIAG_DRAM_status(void* instanceHandle, void *initHandle, json_t **pJsonIn
 {
     int result = WA_DIAG_ERRCODE_FAILURE;
     const char * ramDiskPath = NULL;
-    json_t * config = NULL;
+    const WA_DIAG_settings_t *settings;
     char *filepath = NULL;
-    int applicable;
 
     json_decref(*pJsonInOut);
     *pJsonInOut = NULL;
 
         /* Determine if the test is applicable: */
-    config = ((WA_DIAG_proceduresConfig_t*)initHandle)->config;
-    if(config && !json_unpack(config, "{sb}", "applicable", &applicable))
+    settings = WA_DIAG_GetSettings((WA_DIAG_proceduresConfig_t*)initHandle);
+    if(!settings->applicable)
     {
-        if(!applicable)
-        {
-            WA_INFO("dram_status: Not applicable\n");
-            *pJsonInOut = json_string("Not applicable.");
-            return WA_DIAG_ERRCODE_NOT_APPLICABLE;
-        }
+        WA_INFO("dram_status: Not applicable\n");
+        *pJsonInOut = json_string("Not applicable.");
+        return WA_DIAG_ERRCODE_NOT_APPLICABLE;
     }
 
     ramDiskPath = WA_UTILS_FILEOPS_OptionFind("/etc/include.properties", "RAMDISK_PATH=");
@@ -120,7 +116,7 @@ int WA_DIAG_DRAM_status(void* instanceHandle, void *initHandle, json_t **pJsonIn
         return WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
     }
 
-    result = WA_DIAG_FileTest((const char *)filepath, defaultTotalSize, ((WA_DIAG_proceduresConfig_t*) initHandle)->config, pJsonInOut);
+    result = WA_DIAG_FileTest((const char *)filepath, defaultTotalSize, settings, pJsonInOut);
 
     free(filepath);
 
@@ -132,6 +128,10 @@ int WA_DIAG_DRAM_status(void* instanceHandle, void *initHandle, json_t **pJsonIn
  * LOCAL FUNCTIONS
  *****************************************************************************/
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("dram_status", NULL, NULL, WA_DIAG_DRAM_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
 
@@ -42,6 +42,7 @@
 #include <string.h>
 #include <errno.h>
 #include <sys/time.h>
+#include <sys/param.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
@@ -49,6 +50,7 @@
 
 #include "wa_diag.h"
 #include "wa_debug.h"
+#include "wa_throttle.h"
 
 /*****************************************************************************
  * GLOBAL VARIABLE DEFINITIONS
@@ -58,6 +60,9 @@
  * LOCAL DEFINITIONS
  *****************************************************************************/
 
+/* files are written and read in chunks of that size, with a throttling point in between */
+#define FILE_CHUNK_SIZE (1024 * 1024)
+
 /*****************************************************************************
  * LOCAL TYPES
  *****************************************************************************/
@@ -83,23 +88,14 @@ static int loadBuffer(const char * filename, char * buffer, size_t totalSize);
  * EXPORTED FUNCTIONS
  *****************************************************************************/
 
-int WA_DIAG_FileTest(const char * defaultFileName, size_t defaultTotalSize, json_t * jsonConfig, json_t ** pJsonOut)
+int WA_DIAG_FileTest(const char * defaultFileName, size_t defaultTotalSize, const WA_DIAG_settings_t * settings, json_t ** pJsonOut)
 {
     static const char constantPatterns[] = {0x55, 0xAA};
 
     int result = WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
     char pattern[256];
-    int totalSize = 0;
-    const char * filename = NULL;
-
-    if (!jsonConfig || (json_unpack(jsonConfig, "{si}", "filesize", &totalSize) != 0) || (totalSize <= 0))
-    {
-        totalSize = defaultTotalSize;
-    }
-    if (!jsonConfig || (json_unpack(jsonConfig, "{ss}", "filename", &filename) != 0))
-    {
-        filename = defaultFileName;
-    }
+    int totalSize = (settings->fileSize > 0) ? settings->fileSize : (int)defaultTotalSize;
+    const char * filename = settings->fileName ? settings->fileName : defaultFileName;
 
     WA_DBG("Using file: %s, size: %i\n", (char*)filename, (int)totalSize);
 
@@ -126,7 +122,7 @@ int WA_DIAG_FileTest(const char * defaultFileName, size_t defaultTotalSize, json
         size_t i;
         for (i = 0; i < sizeof(constantPatterns) / sizeof(constantPatterns[0]); ++i)
         {
-            if(WA_OSA_TaskCheckQuit())
+            if(WA_THROTTLE_Point())
             {
                 result = WA_DIAG_ERRCODE_CANCELLED;
                 goto free_exit;
@@ -275,13 +271,13 @@ static int storeBuffer(const char * filename, char * buffer, size_t totalSize)
     size_t processed = 0;
     while (processed < totalSize)
     {
-        if(WA_OSA_TaskCheckQuit())
+        if(WA_THROTTLE_Point())
         {
             close(f);
             return WA_DIAG_ERRCODE_CANCELLED;
         }
 
-        int rc = write(f, buffer + processed, totalSize - processed);
+        int rc = write(f, buffer + processed, MIN(totalSize - processed, FILE_CHUNK_SIZE));
         if (rc <= 0)
         {
             WA_ERROR("Unable to write to %s : %i (%s)\n", filename, errno, strerror(errno));
@@ -310,13 +306,13 @@ static int loadBuffer(const char * filename, char * buffer, size_t totalSize)
     size_t processed = 0;
     while (processed < totalSize)
     {
-        if(WA_OSA_TaskCheckQuit())
+        if(WA_THROTTLE_Point())
         {
             close(f);
             return WA_DIAG_ERRCODE_CANCELLED;
         }
 
-        int rc = read(f, buffer + processed, totalSize - processed);
+        int rc = read(f, buffer + processed, MIN(totalSize - processed, FILE_CHUNK_SIZE));
         if (rc == -1)
         {
             WA_ERROR("Unable to read %s : %i (%s)\n", filename, errno, strerror(errno));
@@ -60,7 +60,7 @@ extern "C"
  * EXPORTED FUNCTIONS
  *****************************************************************************/
 
-int WA_DIAG_FileTest(const char * defaultFileName, size_t defaultTotalSize, json_t * jsonConfig, json_t ** pJsonOut);
+int WA_DIAG_FileTest(const char * defaultFileName, size_t defaultTotalSize, const WA_DIAG_settings_t * settings, json_t ** pJsonOut);
 
 /*****************************************************************************
  * LOCAL FUNCTIONS
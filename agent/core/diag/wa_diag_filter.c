@@ -46,6 +46,7 @@
 #include "wa_log.h"
 #include "wa_json.h"
 #include "wa_osa.h"
+#include "wa_phash.h"
 #include "wa_iarm.h"
 #include "wa_diag_errcodes.h"
 
@@ -106,6 +107,9 @@ static bufferFile diags[] =
     {NULL, NULL, {0}, {0}}
 };
 
+/* index of a diag in the above by its diag_name */
+static WA_UTILS_PHASH_t diag_names;
+
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
@@ -143,7 +147,7 @@ static int getResultFilterParam_IARM(char* param, char* value)
         memset(stMsgDataParam, 0, sizeof(*stMsgDataParam));
         snprintf(stMsgDataParam->paramName, TR69HOSTIFMGR_MAX_PARAM_LEN, "%s%s", TR181_RESULT_FILTER, param);
 
-        iarm_result = IARM_Bus_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
+        iarm_result = WA_UTILS_IARM_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
 
         if (iarm_result != IARM_RESULT_SUCCESS)
         {
@@ -477,6 +481,21 @@ int WA_FILTER_FilterInit()
         status = -1;
     }
 
+    if (!status)
+    {
+        const char *names[sizeof(diags) / sizeof(diags[0])];
+        unsigned int count = 0;
+
+        for (bufferFile *diag = &diags[0]; diag->diag_name; diag++)
+            names[count++] = diag->diag_name;
+
+        if (WA_UTILS_PHASH_Init(&diag_names, names, count))
+        {
+            WA_ERROR("WA_FILTER_FilterInit(): WA_UTILS_PHASH_Init() failed\n");
+            status = -1;
+        }
+    }
+
     WA_RETURN("WA_FILTER_FilterInit(): %d\n", status);
     return status;
 }
@@ -490,6 +509,7 @@ int WA_FILTER_FilterExit()
         if (WA_OSA_MutexDestroy(buffer_mutex))
             WA_ERROR("WA_FILTER_FilterExit(): WA_OSA_MutexDestroy() failed\n");
     }
+    WA_UTILS_PHASH_Exit(&diag_names);
 
     WA_RETURN("WA_FILTER_FilterExit(): %d\n", 0);
     return 0;
@@ -548,68 +568,61 @@ int WA_FILTER_GetFilteredResult(const char *testDiag, int status)
         return filter_status;
     }
 
-    for (bufferFile *diag = &diags[0]; diag && diag->diag_name; diag++)
+    int i = WA_UTILS_PHASH_Find(&diag_names, testDiag);
+    if (i >= 0 && strstr(diags[i].diag_name, "_status")) // considering only the tests
     {
-        if (!strstr(diag->diag_name, "_status")) // considering only the tests
-        {
-            continue;
-        }
+        bufferFile *diag = &diags[i];
 
-        int len = strlen(testDiag);
-        if (strncmp(testDiag, diag->diag_name, len) == 0)
-        {
-            size_t leng = strlen(diag->result_history);
-            status_result = (filter_status == WA_DIAG_ERRCODE_FAILURE) ? 'F' : 'P'; // Setting Fail or Pass based on the current test result
-            snprintf(res_buf, sizeof(res_buf),"%c%s", status_result, diag->result_history); // Appending the result history with the current result added in beginning
-            res_buf[strlen(res_buf) - 1] = '\0'; // Removing the oldest result in buffer which is at the end
-            memset(&diag->result_history, 0, sizeof(diag->result_history));
-            strncpy(diag->result_history, res_buf, leng);
+        size_t leng = strlen(diag->result_history);
+        status_result = (filter_status == WA_DIAG_ERRCODE_FAILURE) ? 'F' : 'P'; // Setting Fail or Pass based on the current test result
+        snprintf(res_buf, sizeof(res_buf),"%c%s", status_result, diag->result_history); // Appending the result history with the current result added in beginning
+        res_buf[strlen(res_buf) - 1] = '\0'; // Removing the oldest result in buffer which is at the end
+        memset(&diag->result_history, 0, sizeof(diag->result_history));
+        strncpy(diag->result_history, res_buf, leng);
 
-            WA_DBG("WA_FILTER_GetFilteredResult(): res_buf from buffer file with current result: %s\n", res_buf);
+        WA_DBG("WA_FILTER_GetFilteredResult(): res_buf from buffer file with current result: %s\n", res_buf);
 
-            // filter_type must not have any spaces
-            // Samples: P90 (90% failure) / S7 (7 failures in sequence)
-            value = (diag->filter_type[1] != '\0') ? &diag->filter_type[1] : NULL;
-            limit = value ? atoi(value) : 0;
+        // filter_type must not have any spaces
+        // Samples: P90 (90% failure) / S7 (7 failures in sequence)
+        value = (diag->filter_type[1] != '\0') ? &diag->filter_type[1] : NULL;
+        limit = value ? atoi(value) : 0;
 
-            if ((diag->filter_type[0] == 'P' || diag->filter_type[0] == 'p') && (limit > 0 && limit <= 100)) // Percentage (1%-100%), otherwise No Filter 'N'
+        if ((diag->filter_type[0] == 'P' || diag->filter_type[0] == 'p') && (limit > 0 && limit <= 100)) // Percentage (1%-100%), otherwise No Filter 'N'
+        {
+            for (int i = 0; i < resultFilter.queue_depth; i++)
             {
-                for (int i = 0; i < resultFilter.queue_depth; i++)
-                {
-                    if (res_buf[i] == '\0')
-                        break;
+                if (res_buf[i] == '\0')
+                    break;
 
-                    if (res_buf[i] == 'F')
-                        fail++;
-                }
-
-                result = (fail * 100) / resultFilter.queue_depth;
-                filter_status = (result < limit) ? WA_DIAG_ERRCODE_SUCCESS : WA_DIAG_ERRCODE_FAILURE;
+                if (res_buf[i] == 'F')
+                    fail++;
             }
-            else if ((diag->filter_type[0] == 'S' || diag->filter_type[0] == 's') && (limit > 0)) // Sequence (must be greater than 0), otherwise No Filter 'N'
+
+            result = (fail * 100) / resultFilter.queue_depth;
+            filter_status = (result < limit) ? WA_DIAG_ERRCODE_SUCCESS : WA_DIAG_ERRCODE_FAILURE;
+        }
+        else if ((diag->filter_type[0] == 'S' || diag->filter_type[0] == 's') && (limit > 0)) // Sequence (must be greater than 0), otherwise No Filter 'N'
+        {
+            for (int i = 0; i < resultFilter.queue_depth; i++)
             {
-                for (int i = 0; i < resultFilter.queue_depth; i++)
+                if (res_buf[i] == '\0')
+                    break;
+
+                if (res_buf[i] == 'F')
+                    fail++;
+                else
                 {
-                    if (res_buf[i] == '\0')
-                        break;
-
-                    if (res_buf[i] == 'F')
-                        fail++;
-                    else
-                    {
-                        result = (result < fail) ? fail : result;
-                        fail = 0;
-                    }
+                    result = (result < fail) ? fail : result;
+                    fail = 0;
                 }
-
-                result = (result < fail) ? fail : result;
-                limit = (limit > resultFilter.queue_depth) ? resultFilter.queue_depth : limit; // Validating the limit which must not exceed queue_depth
-                filter_status = (result < limit) ? WA_DIAG_ERRCODE_SUCCESS : WA_DIAG_ERRCODE_FAILURE;
             }
 
-            WA_INFO("WA_FILTER_GetFilteredResult(): diag: %s, filter_type: %c, limit: %i, status: %d, history: %s\n", diag->name, diag->filter_type[0], limit, filter_status, diag->result_history);
-            break;
+            result = (result < fail) ? fail : result;
+            limit = (limit > resultFilter.queue_depth) ? resultFilter.queue_depth : limit; // Validating the limit which must not exceed queue_depth
+            filter_status = (result < limit) ? WA_DIAG_ERRCODE_SUCCESS : WA_DIAG_ERRCODE_FAILURE;
         }
+
+        WA_INFO("WA_FILTER_GetFilteredResult(): diag: %s, filter_type: %c, limit: %i, status: %d, history: %s\n", diag->name, diag->filter_type[0], limit, filter_status, diag->result_history);
     }
 
     if (WA_OSA_MutexUnlock(buffer_mutex))
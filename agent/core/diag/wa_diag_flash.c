@@ -207,7 +207,7 @@ static int checkEMMCLifeLapseParam(char *param)
         memset(stMsgDataParam, 0, sizeof(*stMsgDataParam));
         snprintf(stMsgDataParam->paramName, TR69HOSTIFMGR_MAX_PARAM_LEN, "%s", param);
 
-        iarm_result = IARM_Bus_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
+        iarm_result = WA_UTILS_IARM_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
 
         if (iarm_result != IARM_RESULT_SUCCESS)
         {
@@ -305,7 +305,7 @@ static int checkEMMCPreEOLState(char* param)
         snprintf(stMsgDataParam->paramName, TR69HOSTIFMGR_MAX_PARAM_LEN, "%s%s", TR181_XEMMC_FLASH, param);
 
         WA_DBG("checkEMMCPreEOLState(): IARM_Bus_Call('%s', '%s', %s)\n", IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, param);
-        iarm_result = IARM_Bus_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
+        iarm_result = WA_UTILS_IARM_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
 
         if (iarm_result != IARM_RESULT_SUCCESS)
         {
@@ -383,24 +383,19 @@ int WA_DIAG_FLASH_status(void* instanceHandle, void *initHandle, json_t **pJsonI
 
 #else
 
-    int applicable;
-    json_t *config;
+    const WA_DIAG_settings_t *settings;
 
     /* Determine if the test is applicable: */
-    config = ((WA_DIAG_proceduresConfig_t*)initHandle)->config;
-    if(config && !json_unpack(config, "{sb}", "applicable", &applicable))
+    settings = WA_DIAG_GetSettings((WA_DIAG_proceduresConfig_t*)initHandle);
+    if(!settings->applicable)
     {
-        if(!applicable)
-        {
-            WA_INFO("Not applicable\n");
-            *pJsonInOut = json_string("Not applicable.");
-            return WA_DIAG_ERRCODE_NOT_APPLICABLE;
-        }
+        WA_INFO("Not applicable\n");
+        *pJsonInOut = json_string("Not applicable.");
+        return WA_DIAG_ERRCODE_NOT_APPLICABLE;
     }
 
     /* Perform the FLASH test */
-    result = WA_DIAG_FileTest(defaultFileName, defaultTotalSize,
-             ((WA_DIAG_proceduresConfig_t*)initHandle)->config, pJsonInOut);
+    result = WA_DIAG_FileTest(defaultFileName, defaultTotalSize, settings, pJsonInOut);
 
     WA_RETURN("flash_status: returns \"%d\"\n", result);
     return result;
@@ -412,6 +407,10 @@ int WA_DIAG_FLASH_status(void* instanceHandle, void *initHandle, json_t **pJsonI
  * LOCAL FUNCTIONS
  *****************************************************************************/
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("flash_status", NULL, NULL, WA_DIAG_FLASH_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
 
@@ -113,7 +113,7 @@ static int get_device_name(char *deviceName)
 {
     FILE *fp;
 
-    fp = popen(HDD_NODE, FILE_MODE);
+    fp = WA_DIAG_Popen(HDD_NODE, FILE_MODE);
     if (fp == NULL)
     {
         WA_ERROR("HDD Test, get_device_name(): Failed to get the device name '%s'\n", HDD_NODE);
@@ -166,7 +166,7 @@ static int attribute_list_status(const char* deviceName)
 
     snprintf(cmd, sizeof(cmd), "smartctl --attributes %s", deviceName);
 
-    fp = popen(cmd, FILE_MODE);
+    fp = WA_DIAG_Popen(cmd, FILE_MODE);
     if(fp == NULL)
     {
         WA_ERROR("HDD Test: attribute_list_status(): Failed to execute the command '%s'\n", cmd);
@@ -446,6 +446,10 @@ int WA_DIAG_HDD_status(void *instanceHandle, void *initHandle, json_t **params)
     return setReturnData(ret, params);
 }
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("hdd_status", NULL, NULL, WA_DIAG_HDD_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
 
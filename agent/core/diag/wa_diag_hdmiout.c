@@ -269,6 +269,10 @@ end:
     return ret;
 }
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("hdmiout_status", NULL, NULL, WA_DIAG_HDMIOUT_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
 
@@ -50,6 +50,7 @@
 #include "wa_diag.h"
 #include "wa_debug.h"
 #include "wa_fileops.h"
+#include "wa_sim.h"
 
 /* module interface */
 #include "wa_diag_ir.h"
@@ -206,7 +207,7 @@ static LogFindResult findLogEntryInFile(const char * filename, regex_t *r, char
     size_t st;
     int rc;
 
-    file = fopen(filename, "r");
+    file = fopen(WA_UTILS_SIM_PATH(filename), "r");
     if (!file)
     {
         *params = json_string("Unable to open log file");
@@ -366,35 +367,31 @@ static int checkIRLogFile(void * instanceHandle, const char * filename, const ch
  */
 int WA_DIAG_IR_status(void *instanceHandle, void *initHandle, json_t **params)
 {
-    json_t * jsonConfig = NULL;
+    const WA_DIAG_settings_t *settings;
     const char * logpattern = NULL;
     const char * logfile = IR_LOG_FILE_NAME;
-    int applicable;
 
     json_decref(*params);
     *params = NULL;
 
-    jsonConfig = ((WA_DIAG_proceduresConfig_t*)initHandle)->config;
+    settings = WA_DIAG_GetSettings((WA_DIAG_proceduresConfig_t*)initHandle);
 
     /* Determine if the test is applicable: */
-    if(jsonConfig && !json_unpack(jsonConfig, "{sb}", "applicable", &applicable))
+    if(!settings->applicable)
     {
-        if(!applicable)
-        {
-            WA_INFO("Device does not have IR.\n");
-            *params = json_string("Not applicable.");
-            return WA_DIAG_ERRCODE_NOT_APPLICABLE;
-        }
+        WA_INFO("Device does not have IR.\n");
+        *params = json_string("Not applicable.");
+        return WA_DIAG_ERRCODE_NOT_APPLICABLE;
     }
 
     /* Use log file name from config if present */
-    if (jsonConfig)
-        json_unpack(jsonConfig, "{ss}", "logfile", &logfile);
-    
-    if (!jsonConfig || (json_unpack(jsonConfig, "{ss}", "logpattern", &logpattern) != 0))
+    if (settings->logFile)
+        logfile = settings->logFile;
+
+    logpattern = settings->logPattern;
+    if (!logpattern)
     {
         WA_ERROR("Log pattern not provided\n");
-        logpattern = NULL;
     }
 
     if (!logpattern)
@@ -406,6 +403,10 @@ int WA_DIAG_IR_status(void *instanceHandle, void *initHandle, json_t **params)
     return checkIRLogFile(instanceHandle, logfile, logpattern, params);
 }
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("ir_status", NULL, NULL, WA_DIAG_IR_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
 
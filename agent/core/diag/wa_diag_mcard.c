@@ -286,22 +286,16 @@ int WA_DIAG_MCARD_status(void* instanceHandle, void *initHandle, json_t **params
     int ret;
     char value[256];
     size_t size = sizeof(value);
-    json_t *config;
-    int applicable;
 
     json_decref(*params); // not used
 
     WA_ENTER("mcard_status\n");
 
     /* Determine if the test is applicable: */
-    config = ((WA_DIAG_proceduresConfig_t*)initHandle)->config;
-    if(config && !json_unpack(config, "{sb}", "applicable", &applicable))
+    if(!WA_DIAG_GetSettings((WA_DIAG_proceduresConfig_t*)initHandle)->applicable)
     {
-        if(!applicable)
-        {
-            WA_INFO("Device does not have MCard.\n");
-            return setReturnData(WA_DIAG_ERRCODE_NOT_APPLICABLE, params);
-        }
+        WA_INFO("Device does not have MCard.\n");
+        return setReturnData(WA_DIAG_ERRCODE_NOT_APPLICABLE, params);
     }
 
     WA_DBG("MCard supported.\n");
@@ -365,5 +359,9 @@ int WA_DIAG_MCARD_status(void* instanceHandle, void *initHandle, json_t **params
 }
 
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("mcard_status", NULL, NULL, WA_DIAG_MCARD_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
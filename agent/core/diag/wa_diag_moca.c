@@ -266,6 +266,8 @@ static int getMocaOptionStatus(MocaOption_t opt, int index, WA_UTILS_SNMP_Resp_t
 {
     int ret = -1;
     char oid[256];
+    char args[512];
+    bool cached = false;
 
     WA_UTILS_SNMP_Resp_t val;
     val.type = value->type;
@@ -287,7 +289,14 @@ static int getMocaOptionStatus(MocaOption_t opt, int index, WA_UTILS_SNMP_Resp_t
 
     WA_DBG("getMocaOptionStatus, oid generated: %s, oid len %d\n", oid, strlen(oid));
 
-    if(!WA_UTILS_SNMP_GetNumber(SNMP_SERVER, oid, &val, reqType))
+    /* MoCA state is read by both moca and sysinfo diags, share it within the test run */
+    snprintf(args, sizeof(args), "%s %s", SNMP_SERVER, oid);
+    if(!WA_DIAG_ProbeCacheGet(WA_DIAG_PROBE_SNMP(reqType == WA_UTILS_SNMP_REQ_TYPE_WALK), args, &val, sizeof(val)))
+    {
+        WA_DBG("getMocaOptionStatus, option: %s cached.\n", MocaOptions[opt]);
+        cached = true;
+    }
+    else if(!WA_UTILS_SNMP_GetNumber(SNMP_SERVER, oid, &val, reqType))
     {
         if(reqType == WA_UTILS_SNMP_REQ_TYPE_GET)
         {
@@ -312,6 +321,9 @@ static int getMocaOptionStatus(MocaOption_t opt, int index, WA_UTILS_SNMP_Resp_t
         }
     }
 
+    if(!cached)
+        WA_DIAG_ProbeCachePut(WA_DIAG_PROBE_SNMP(reqType == WA_UTILS_SNMP_REQ_TYPE_WALK), args, &val, sizeof(val), WA_DIAG_PROBE_CACHE_MAX_AGE);
+
     switch(value->type)
     {
         case WA_UTILS_SNMP_RESP_TYPE_LONG:
@@ -633,7 +645,7 @@ static int getMocaParam_IARM(char *param, char **value)
         memset(stMsgDataParam, 0, sizeof(*stMsgDataParam));
         snprintf(stMsgDataParam->paramName, TR69HOSTIFMGR_MAX_PARAM_LEN, "%s", param);
 
-        iarm_result = IARM_Bus_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
+        iarm_result = WA_UTILS_IARM_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
 
         if (iarm_result != IARM_RESULT_SUCCESS)
         {
@@ -672,7 +684,7 @@ static int getMocaParam_IARM(char *param, char **value)
 int WA_DIAG_MOCA_status(void* instanceHandle, void *initHandle, json_t **params)
 {
     int ret;
-    json_t * jsonConfig = NULL;
+    const WA_DIAG_settings_t *settings = WA_DIAG_GetSettings((WA_DIAG_proceduresConfig_t*)initHandle);
     const char *interface = MOCA_AVAILABLE_STR;
 #ifndef MEDIA_CLIENT
     WA_UTILS_SNMP_Resp_t value;
@@ -685,11 +697,9 @@ int WA_DIAG_MOCA_status(void* instanceHandle, void *initHandle, json_t **params)
 
     WA_ENTER("moca_status\n");
 
-    jsonConfig = ((WA_DIAG_proceduresConfig_t*)initHandle)->config;
-
     /* Use interface name from config if present */
-    if (jsonConfig)
-        json_unpack(jsonConfig, "{ss}", "interface", &interface);
+    if (settings->interface)
+        interface = settings->interface;
 
     ret = moca_supported(interface);
     if(ret < 0)
@@ -944,6 +954,10 @@ int getMocaNodeSNR_IARM(char *value)
 }
 #endif /* MEDIA_CLEINT */
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("moca_status", NULL, NULL, WA_DIAG_MOCA_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
 
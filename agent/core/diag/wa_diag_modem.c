@@ -90,6 +90,7 @@
  *****************************************************************************/
 static bool modem_supported(void);
 static char *get_modem_ip(void);
+static bool get_snmp_number(const char *snmp_server, const char *oid, WA_UTILS_SNMP_Resp_t *resp, WA_UTILS_SNMP_ReqType_t reqType);
 static int is_modem_operational(const char *snmp_server);
 static int validate_modem_state(void* instanceHandle, const char *snmp_server);
 
@@ -137,7 +138,7 @@ int WA_DIAG_MODEM_status(void* instanceHandle, void *initHandle, json_t **params
     if(modem_ip != NULL)
     {
         snprintf(buf, STR_MAX, "ping -c 1 -W 1 %s &> /dev/null", modem_ip);
-        if(system(buf) != 0)
+        if(WA_DIAG_System(buf) != 0)
         {
             *params = json_string("HW not accessible.");
             WA_ERROR("modem_status: ping failed to gateway ip %s\n", modem_ip);
@@ -251,6 +252,24 @@ static char *get_modem_ip(void)
     return addr;
 }
 
+/**
+ * @brief Reads SNMP number, sharing it with other diags of the test run.
+ */
+static bool get_snmp_number(const char *snmp_server, const char *oid, WA_UTILS_SNMP_Resp_t *resp, WA_UTILS_SNMP_ReqType_t reqType)
+{
+    char args[256];
+
+    snprintf(args, sizeof(args), "%s %s", snmp_server, oid);
+    if (!WA_DIAG_ProbeCacheGet(WA_DIAG_PROBE_SNMP(reqType == WA_UTILS_SNMP_REQ_TYPE_WALK), args, resp, sizeof(*resp)))
+        return true;
+
+    if (!WA_UTILS_SNMP_GetNumber(snmp_server, oid, resp, reqType))
+        return false;
+
+    WA_DIAG_ProbeCachePut(WA_DIAG_PROBE_SNMP(reqType == WA_UTILS_SNMP_REQ_TYPE_WALK), args, resp, sizeof(*resp), WA_DIAG_PROBE_CACHE_MAX_AGE);
+    return true;
+}
+
 /**
  * @brief Check ig CM is operational
  *
@@ -265,7 +284,7 @@ static int is_modem_operational(const char *snmp_server)
     int status = WA_DIAG_ERRCODE_SUCCESS;
 
     oper.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
-    if(!WA_UTILS_SNMP_GetNumber(snmp_server, OID_MODEM_STATUS, &oper, WA_UTILS_SNMP_REQ_TYPE_WALK))
+    if(!get_snmp_number(snmp_server, OID_MODEM_STATUS, &oper, WA_UTILS_SNMP_REQ_TYPE_WALK))
     {
         return WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
     }
@@ -277,7 +296,7 @@ static int is_modem_operational(const char *snmp_server)
     }
 
     width.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
-    if(!WA_UTILS_SNMP_GetNumber(snmp_server, OID_DOWN_WIDTH, &width, WA_UTILS_SNMP_REQ_TYPE_WALK))
+    if(!get_snmp_number(snmp_server, OID_DOWN_WIDTH, &width, WA_UTILS_SNMP_REQ_TYPE_WALK))
     {
         return WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
     }
@@ -289,7 +308,7 @@ static int is_modem_operational(const char *snmp_server)
     }
 
     mod.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
-    if(!WA_UTILS_SNMP_GetNumber(snmp_server, OID_DOWN_MODULATION, &mod, WA_UTILS_SNMP_REQ_TYPE_WALK))
+    if(!get_snmp_number(snmp_server, OID_DOWN_MODULATION, &mod, WA_UTILS_SNMP_REQ_TYPE_WALK))
     {
         return WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
     }
@@ -301,7 +320,7 @@ static int is_modem_operational(const char *snmp_server)
     }
 
     interleave.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
-    if(!WA_UTILS_SNMP_GetNumber(snmp_server, OID_DOWN_INTERLEAVE, &interleave, WA_UTILS_SNMP_REQ_TYPE_WALK))
+    if(!get_snmp_number(snmp_server, OID_DOWN_INTERLEAVE, &interleave, WA_UTILS_SNMP_REQ_TYPE_WALK))
     {
         return WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
     }
@@ -357,6 +376,10 @@ static int validate_modem_state(void* instanceHandle, const char *snmp_server)
     return status;
 }
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("modem_status", NULL, NULL, WA_DIAG_MODEM_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
 
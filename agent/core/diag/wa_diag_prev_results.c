@@ -54,7 +54,7 @@ int WA_DIAG_PREV_RESULTS_Info(void *instanceHandle, void *initHandle, json_t **p
     WA_ENTER("WA_DIAG_PREV_RESULTS_Info(instanceHandle=%p, initHandle=%p, params=%p)\n",
             instanceHandle, initHandle, params);
 
-    json_t * config = NULL;
+    const WA_DIAG_settings_t *settings = WA_DIAG_GetSettings((WA_DIAG_proceduresConfig_t *)initHandle);
     int status = 1;
     int expiry_time = DEFAULT_EXPIRY_TIME; // minutes
 
@@ -62,9 +62,8 @@ int WA_DIAG_PREV_RESULTS_Info(void *instanceHandle, void *initHandle, json_t **p
     *params = NULL;
 
     /* try to get expiry time from config file */
-    config = ((WA_DIAG_proceduresConfig_t *)initHandle)->config;
-    if (config)
-        json_unpack(config, "{s:i}", "expiry_time", &expiry_time);
+    if (settings->expiryTime >= 0)
+        expiry_time = settings->expiryTime;
 
     WA_DBG("WA_DIAG_PREV_RESULTS_Info(): results expiry time is %d min (0=never)\n", expiry_time);
 
@@ -184,7 +184,7 @@ static int checkRCULastKeyInfo()
         last_key_info_param->api_revision = CTRLM_MAIN_IARM_BUS_API_REVISION;
 
         WA_DBG("checkRCULastKeyInfo(): IARM_Bus_Call('%s', '%s', ...)\n", CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_LAST_KEY_INFO_GET);
-        iarm_result = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_LAST_KEY_INFO_GET,
+        iarm_result = WA_UTILS_IARM_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_LAST_KEY_INFO_GET,
                                                     (void *)last_key_info_param, sizeof(*last_key_info_param));
 
         if (iarm_result == IARM_RESULT_SUCCESS)
@@ -287,7 +287,7 @@ static int checkRf4ceStatusViaRf4ceMgr()
             param->msg.index = 0;
 
             WA_DBG("checkRf4ceStatusViaRf4ceMgr(): IARM_Bus_Call('%s', '%s', ...)\n", RFAPI_MGR_NAME, RFAPI_REQUEST_NAME);
-            iarm_result = IARM_Bus_Call(RFAPI_MGR_NAME, RFAPI_REQUEST_NAME, (void *)param, sizeof(*param));
+            iarm_result = WA_UTILS_IARM_Call(RFAPI_MGR_NAME, RFAPI_REQUEST_NAME, (void *)param, sizeof(*param));
             if (iarm_result == IARM_RESULT_SUCCESS)
             {
                 if ((param->msg.msgId == RFAPI_MSG_RFSTATUS_ID) && (param->msg.length == sizeof(RFAPI_MSG_RFSTATUS_T)))
@@ -352,7 +352,7 @@ static int checkRf4ceStatusViaCtrlMgr()
         ctrm_status_param->api_revision = CTRLM_MAIN_IARM_BUS_API_REVISION;
 
         WA_DBG("checkRf4ceStatusViaCtrlMgr(): IARM_Bus_Call('%s', '%s', ...)\n", CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_STATUS_GET);
-        iarm_result = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_STATUS_GET,
+        iarm_result = WA_UTILS_IARM_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_STATUS_GET,
                                    (void *)ctrm_status_param, sizeof(*ctrm_status_param));
 
         if (iarm_result == IARM_RESULT_SUCCESS)
@@ -396,7 +396,7 @@ static int checkRf4ceStatusViaCtrlMgr()
             network_status_param->network_id = rf4ce_network_id;
 
             WA_DBG("checkRf4ceStatusViaCtrlMgr(): IARM_Bus_Call('%s', '%s', ...)\n", CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_NETWORK_STATUS_GET);
-            iarm_result = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_NETWORK_STATUS_GET,
+            iarm_result = WA_UTILS_IARM_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_NETWORK_STATUS_GET,
                                         (void *)network_status_param, sizeof(*network_status_param));
 
             if (iarm_result == IARM_RESULT_SUCCESS)
@@ -461,7 +461,7 @@ static int checkRf4ceChipStatus()
     rf4ce_chip_status.network_id = 1;
 
     WA_DBG("checkRf4ceChipStatus(): IARM_Bus_Call('%s', '%s', ...)\n", CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_CHIP_STATUS_GET);
-    iarm_result = IARM_Bus_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_CHIP_STATUS_GET, (void*)&rf4ce_chip_status, sizeof(rf4ce_chip_status));
+    iarm_result = WA_UTILS_IARM_Call(CTRLM_MAIN_IARM_BUS_NAME, CTRLM_MAIN_IARM_CALL_CHIP_STATUS_GET, (void*)&rf4ce_chip_status, sizeof(rf4ce_chip_status));
 
     if (iarm_result == IARM_RESULT_SUCCESS)
     {
@@ -691,6 +691,10 @@ int isRF4CEPaired()
 }
 
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("rf4ce_status", NULL, NULL, WA_DIAG_RF4CE_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
 
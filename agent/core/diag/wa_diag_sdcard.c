@@ -91,7 +91,7 @@ static int checkTSBStatus()
         return ret;
     }
 
-    iarm_result = IARM_Bus_Call(IARM_BUS_STMGR_NAME, "GetTSBStatus", (void *)&status, sizeof(status));
+    iarm_result = WA_UTILS_IARM_Call(IARM_BUS_STMGR_NAME, "GetTSBStatus", (void *)&status, sizeof(status));
     if (iarm_result == IARM_RESULT_SUCCESS)
     {
         if (status == RDK_STMGR_TSB_STATUS_UNKNOWN) // Defined in rdkStorageMgrTypes.h whose decimal value is 64
@@ -125,7 +125,7 @@ static int checkTSBMaxMinutes()
         return ret;
     }
 
-    iarm_result = IARM_Bus_Call(IARM_BUS_STMGR_NAME, "GetTSBMaxMinutes", (void *)&minutes, sizeof(minutes));
+    iarm_result = WA_UTILS_IARM_Call(IARM_BUS_STMGR_NAME, "GetTSBMaxMinutes", (void *)&minutes, sizeof(minutes));
     if (iarm_result == IARM_RESULT_SUCCESS)
     {
         if (minutes == 0)
@@ -250,6 +250,10 @@ int WA_DIAG_SDCARD_status(void* instanceHandle, void *initHandle, json_t **param
  * LOCAL FUNCTIONS
  *****************************************************************************/
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("sdcard_status", NULL, NULL, WA_DIAG_SDCARD_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
 
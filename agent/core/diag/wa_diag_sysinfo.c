@@ -293,14 +293,14 @@ static json_t *sysinfo_Get()
 #ifndef MEDIA_CLIENT
     getDateAndTime(&date_time[0], sizeof(date_time));
     snprintf(num_ch, sizeof(num_ch), "%s | grep \"SRCID\" | wc -l", SI_PATH);
-    fp = popen(num_ch, "r");
+    fp = WA_DIAG_Popen(num_ch, "r");
     fscanf(fp, "%s", channels);
     pclose(fp);
 
     if (channels[0] == '\0' || channels[0] == '0') {
         WA_DBG("grep from %s failed\n", SI_PATH);
         snprintf(num_ch, sizeof(num_ch), "%s | grep \"SRCID\" | wc -l", TMP_SI_PATH);
-        fp = popen(num_ch, "r");
+        fp = WA_DIAG_Popen(num_ch, "r");
         fscanf(fp, "%s", channels);
         pclose(fp);
         if (channels[0] == '\0') {
@@ -512,7 +512,7 @@ static bool getUpnpResults()
         memset(param, 0, sizeof(*param));
         param->bufLength = MESSAGE_LENGTH;
 
-        iarm_result = IARM_Bus_Call(_IARM_XUPNP_NAME, IARM_BUS_XUPNP_API_GetXUPNPDeviceInfo, (void *)param, sizeof(IARM_Bus_SYSMGR_GetXUPNPDeviceInfo_Param_t) + MESSAGE_LENGTH + 1);
+        iarm_result = WA_UTILS_IARM_Call(_IARM_XUPNP_NAME, IARM_BUS_XUPNP_API_GetXUPNPDeviceInfo, (void *)param, sizeof(IARM_Bus_SYSMGR_GetXUPNPDeviceInfo_Param_t) + MESSAGE_LENGTH + 1);
 
         if (iarm_result != IARM_RESULT_SUCCESS)
         {
@@ -822,7 +822,7 @@ static int temperatureGet(char *cpuTemp, size_t size)
         /* Code to find high, critical threshold values through IARM */
         IARM_Bus_PWRMgr_GetTempThresholds_Param_t param;
 
-        IARM_Result_t res = IARM_Bus_Call(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_API_GetTemperatureThresholds, (void *)&param, sizeof(param));
+        IARM_Result_t res = WA_UTILS_IARM_Call(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_API_GetTemperatureThresholds, (void *)&param, sizeof(param));
 
         if (res == IARM_RESULT_SUCCESS)
         {
@@ -982,7 +982,7 @@ int getSysInfoParam_IARM(char *param, char **value)
         snprintf(stMsgDataParam->paramName, TR69HOSTIFMGR_MAX_PARAM_LEN, "%s", param);
 
         WA_DBG("getSysInfoParam_IARM(): IARM_Bus_Call('%s', '%s', %s)\n", IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, stMsgDataParam->paramName);
-        iarm_result = IARM_Bus_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
+        iarm_result = WA_UTILS_IARM_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
 
         if (iarm_result != IARM_RESULT_SUCCESS)
         {
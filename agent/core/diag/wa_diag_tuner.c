@@ -50,6 +50,7 @@
 #include <ifaddrs.h>
 #include <poll.h>
 #include <sys/time.h>
+#include <sys/timerfd.h>
 #include <time.h>
 
 /*****************************************************************************
@@ -62,7 +63,9 @@
 #include "wa_diag.h"
 #include "wa_debug.h"
 #include "wa_fileops.h"
+#include "wa_sim.h"
 #include "wa_snmp_client.h"
+#include "wa_throttle.h"
 
 /* rdk specific */
 #include "wa_sicache.h"
@@ -155,16 +158,25 @@
 #define TRM_TUNER_RESERVATION_TIME              (1000) /* time to resevere the tuner for, ms */
 #define TRM_TUNER_RESERVATION_TIMEOUT           (30000) /* time to wait for tuner reservation response, ms */
 #define TRM_TUNER_RESERVATION_RELEASE_TIMEOUT   (TRM_TUNER_RESERVATION_TIME) /* time to wait for tuner release response, ms */
-#define TRM_TUNER_SESSIONS_TIMEOUT              (120) /* max time for tunning all tuners on one locator, seconds */
 #endif /* USE_TRM */
 
+/* the sweep sessions time out after SWEEP_TIMEOUT + SWEEP_SESSION_TIMEOUT * sessions */
+#ifdef USE_TRM
+/* All reservations are requested at once, so the sweep waits for the slowest one. */
+#define SWEEP_TIMEOUT (TRM_TUNER_RESERVATION_TIMEOUT + 2 * TRM_TUNER_RESERVATION_TIME) /* in [ms] */
+#define SWEEP_SESSION_TIMEOUT 0 /* in [ms] */
+#else
+#define SWEEP_TIMEOUT 0 /* in [ms] */
+#define SWEEP_SESSION_TIMEOUT TUNE_RESPONSE_TIMEOUT /* in [ms] */
+#endif
+
 #define NUM_SI_ENTRIES 2
 
-#define USE_SEVERAL_LOCK_PROBES 1
-#ifdef USE_SEVERAL_LOCK_PROBES
-#define LOCK_LOOP_TIME 200 /* in [ms] but less than 1s */
-#define LOCK_LOOP_COUNT 15 /* gives 3s */
-#endif
+#define LOCK_LOOP_TIME 200 /* lock probe period in [ms] but less than 1s */
+#define LOCK_LOOP_COUNT 15 /* probes after all sessions completed, gives 3s */
+
+#define TTL_HISTOGRAM_BUCKETS 6 /* time-to-lock buckets, see ttlBucketLimits */
+
 #define TMP_DATA_LEN 128
 /*****************************************************************************
  * LOCAL TYPES
@@ -180,15 +192,41 @@ typedef enum TunerStateSnmp_tag
 typedef struct TuneSession_tag
 {
     int socket; /**< Main socket + 1 */
+#ifdef USE_TRM
+    void *reservation; /**< TRH reservation handle */
+#endif
+    bool done; /**< response received (or tuner released), nothing more to wait for */
 } TuneSession_t;
 
+typedef struct TuneSweepStats_tag
+{
+    unsigned int ttl[TTL_HISTOGRAM_BUCKETS + 1]; /**< time-to-lock histogram, the last bucket counts passes without lock */
+} TuneSweepStats_t;
+
+typedef struct TuneSweep_tag
+{
+    void *instanceHandle;
+    TuneSession_t *sessions;
+    size_t sessionCount;
+    WA_DIAG_TUNER_TunerStatus_t *statuses;
+    size_t statusCount;
+    char *freq; /**< frequency the lock is expected on, "" for any */
+    Frontend_t *frontendStatus;
+    bool standAloneTest;
+    TuneSweepStats_t *stats; /**< statusCount entries, might be NULL */
+    struct timespec start; /**< time the tune requests were issued */
+    int numLocked;
+    bool freqLocked;
+} TuneSweep_t;
+
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
 
-static unsigned int getNumberOfTuners(json_t * config);
+static unsigned int getNumberOfTuners(const WA_DIAG_settings_t * settings);
 static json_t * getTuneUrls(char* tuneData, int *frequency);
 static int checkQamConnection(unsigned int tunersCount, json_t **pJsonInOut);
+static bool getSnmpNumber(const char *server, const char *oid, WA_UTILS_SNMP_Resp_t *resp, WA_UTILS_SNMP_ReqType_t reqType);
 static int getTuneData(json_t *pJson, char *tuneData, size_t size);
 static int verifyStandbyState();
 static int saveDecoderTuneResults(VideoDecoder_t* hvd, int num_hvd, ParserBand_t* parserBand, int num_parser, PIDChannel_t* pidChannel, int num_pid, Frontend_t* frontendStatus);
@@ -197,16 +235,22 @@ static int saveTuneFailureMsg(const char *errString);
 static bool getBER(char* ber, size_t size, int frontend);
 static void freeDecoderTransportData(VideoDecoder_t* hvd, ParserBand_t* parserBand, PIDChannel_t* pidChannel);
 
-static bool startTuneSessions(void * instanceHandle,
-        TuneSession_t * sessions,
+static bool startTuneSessions(TuneSession_t * sessions,
         size_t sessionCount,
-        const char * url,
-        unsigned int currentPass,
-        unsigned int totalPasses,
-        WA_DIAG_TUNER_TunerStatus_t * statuses);
+        const char * url);
 
 static bool closeTuneSessions(TuneSession_t * sessions, size_t sessionCount);
 
+static int sessionFd(const TuneSession_t * session);
+static bool sessionEvent(TuneSession_t * session);
+
+static bool WaitSweep(TuneSweep_t * sweep,
+        unsigned int currentPass,
+        unsigned int totalPasses);
+
+static bool isLockSufficient(const TuneSweep_t * sweep);
+static void reportSweepStats(const TuneSweepStats_t * stats, size_t statusCount);
+
 void SendSessionProgress(void * instanceHandle,
         unsigned int sessionsDone,
         unsigned int sessionCount,
@@ -214,14 +258,6 @@ void SendSessionProgress(void * instanceHandle,
         unsigned int passesCount);
 
 #ifdef USE_RMF
-static void WaitSessions(void* instanceHandle,
-        TuneSession_t * sessions,
-        size_t sessionCount,
-        unsigned int currentPass,
-        unsigned int totalPasses,
-        WA_DIAG_TUNER_TunerStatus_t * statuses,
-        size_t statusCount);
-
 static int IssueRequest(uint32_t sourceIP, uint32_t serverIP, unsigned short int serverPort, const char *request);
 
 static uint32_t FindNonexistentIf(uint32_t lastIP);
@@ -236,10 +272,11 @@ static uint32_t FindNonexistentIf(uint32_t lastIP);
 
 /* IP Address 127.0.0.1 is reserved, use 127.0.0.2 */
  static const uint32_t firstLocalIP = 0x200007f; // in network byte order
-
- static const bool tuneAllAtOnce = true;
 #endif /* USE_RMF */
 
+/* Upper limits of the time-to-lock buckets, in [ms]. The last bucket is open. */
+static const unsigned int ttlBucketLimits[TTL_HISTOGRAM_BUCKETS - 1] = { 250, 500, 1000, 2000, 4000 };
+
  /*****************************************************************************
   * FUNCTION DEFINITIONS
   *****************************************************************************/
@@ -293,26 +330,13 @@ static uint32_t FindNonexistentIf(uint32_t lastIP);
      return result;
  }
 
- static unsigned int getNumberOfTuners(json_t * config)
+ static unsigned int getNumberOfTuners(const WA_DIAG_settings_t * settings)
  {
-     int result = 0;
-
-     // Use value from test configuration, if provided
-     if (config && (json_unpack(config, "{si}", "tuners_count", &result) == 0))
-     {
-         if (result < 0)
-         {
-             WA_ERROR("getNumberOfTuners(): Invalid tuners_count configuration (non-negative integer expected)\n");
-             return 0;
-         }
-         WA_DBG("getNumberOfTuners(): Tuner count from test config: %i\n", result);
-         return result;
-     }
-
-     if (config && (json_object_get(config, "tuners_count") != NULL))
+     // Use value from test configuration, if provided (validated on config load)
+     if (settings->tunersCount >= 0)
      {
-         WA_ERROR("getNumberOfTuners(): Invalid tune_count configuration (integer expected)\n");
-         return 0;
+         WA_DBG("getNumberOfTuners(): Tuner count from test config: %i\n", settings->tunersCount);
+         return settings->tunersCount;
      }
 
      // If number of tuners not provided in test config, check RMF configuration
@@ -357,7 +381,7 @@ static int checkQamConnection(unsigned int tunersCount, json_t **pJsonInOut)
         WA_UTILS_SNMP_Resp_t tunerResp;
         tunerResp.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
         tunerResp.data.l = 0;
-        if (!WA_UTILS_SNMP_GetNumber(SNMP_SERVER_ESTB, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
+        if (!getSnmpNumber(SNMP_SERVER_ESTB, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
         {
             WA_ERROR("checkQamConnection(): Tuner %i failed to get QAM status\n", (int)tunerIndex);
             return WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
@@ -382,7 +406,7 @@ static int checkQamConnection(unsigned int tunersCount, json_t **pJsonInOut)
 
        tunerResp.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
        tunerResp.data.l = 0;
-       if (!WA_UTILS_SNMP_GetNumber(SNMP_SERVER_ESTB, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
+       if (!getSnmpNumber(SNMP_SERVER_ESTB, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
        {
            WA_ERROR("checkQamConnection(): Tuner %i failed to get QAM Down Stream Signal\n", (int )tunerIndex);
            return WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
@@ -407,6 +431,27 @@ static int checkQamConnection(unsigned int tunersCount, json_t **pJsonInOut)
     return WA_DIAG_ERRCODE_FAILURE;
 }
 
+/* SNMP reads shared with other diags of the test run (sysinfo, modem) go through the probe cache. */
+static bool getSnmpNumber(const char *server, const char *oid, WA_UTILS_SNMP_Resp_t *resp, WA_UTILS_SNMP_ReqType_t reqType)
+{
+    char args[BUFFER_LEN * 2];
+
+    snprintf(args, sizeof(args), "%s %s", server, oid);
+    if (!WA_DIAG_ProbeCacheGet(WA_DIAG_PROBE_SNMP(reqType == WA_UTILS_SNMP_REQ_TYPE_WALK), args, resp, sizeof(*resp)))
+    {
+        WA_DBG("getSnmpNumber(): %s cached\n", args);
+        return true;
+    }
+
+    if (!WA_UTILS_SNMP_GetNumber(server, oid, resp, reqType))
+    {
+        return false;
+    }
+
+    WA_DIAG_ProbeCachePut(WA_DIAG_PROBE_SNMP(reqType == WA_UTILS_SNMP_REQ_TYPE_WALK), args, resp, sizeof(*resp), WA_DIAG_PROBE_CACHE_MAX_AGE);
+    return true;
+}
+
 static int getTuneData(json_t *pJson, char *tuneData, size_t size)
 {
     char* tuneValue = NULL;
@@ -468,13 +513,9 @@ static int getTuneData(json_t *pJson, char *tuneData, size_t size)
  *
  */
 
- static bool startTuneSessions(void * instanceHandle,
-    TuneSession_t * sessions,
+ static bool startTuneSessions(TuneSession_t * sessions,
     size_t sessionCount,
-    const char * urlBase,
-    unsigned int currentPass,
-    unsigned int totalPasses,
-    WA_DIAG_TUNER_TunerStatus_t * statuses)
+    const char * urlBase)
  {
      uint32_t localIP = firstLocalIP;
      uint32_t serverIP;
@@ -530,7 +571,8 @@ static int getTuneData(json_t *pJson, char *tuneData, size_t size)
 
          //at first use 127.0.0.1 so it can be reused by av_play immediately after tuners
          sessions[sessionIndex].socket = IssueRequest(localIP, serverIP, htons(WA_UTILS_RMF_GetMediastreamerPort()), url) + 1;
-         if(sessions[sessionIndex].socket < 0)
+         sessions[sessionIndex].done = (sessions[sessionIndex].socket <= 0);
+         if(sessions[sessionIndex].done)
          {
              result = false;
          }
@@ -543,39 +585,6 @@ static int getTuneData(json_t *pJson, char *tuneData, size_t size)
          }
 
          WA_DBG("startTuneSessions(): Returned socket fd: %i\n", (int)sessions[sessionIndex].socket);
-
-         if (!tuneAllAtOnce)
-         {
-             if (sessions[sessionIndex].socket > 0)
-             {
-                 WaitSessions(instanceHandle,
-                     sessions + sessionIndex,
-                     1,
-                     sessionIndex + currentPass * sessionCount,
-                     totalPasses * sessionCount,
-                     statuses,
-                     sessionCount);
-
-                 if(WA_OSA_TaskCheckQuit())
-                 {
-                     WA_DBG("startTuneSessions(): test cancelled #3\n");
-                     result = false;
-                     goto end_free_url;
-                 }
-             }
-         }
-
-         if(WA_OSA_TaskCheckQuit())
-         {
-             WA_DBG("startTuneSessions(): test cancelled #4\n");
-             result = false;
-             goto end_free_url;
-         }
-     }
-
-     if (tuneAllAtOnce)
-     {
-         WaitSessions(instanceHandle, sessions, sessionCount, currentPass, totalPasses, statuses, sessionCount);
      }
 
      end_free_url:
@@ -604,6 +613,7 @@ static int getTuneData(json_t *pJson, char *tuneData, size_t size)
              close(socket);
              sessions[sessionIndex].socket = 0;
          }
+         sessions[sessionIndex].done = true;
      }
      return true;
  }
@@ -655,132 +665,26 @@ static int getTuneData(json_t *pJson, char *tuneData, size_t size)
  }
 #endif
 
- static void WaitSessions(void* instanceHandle,
-    TuneSession_t * sessions,
-    size_t sessionCount,
-    unsigned int currentPass,
-    unsigned int totalPasses,
-    WA_DIAG_TUNER_TunerStatus_t * statuses,
-    size_t statusCount)
+ static int sessionFd(const TuneSession_t * session)
  {
-     int i, k, status;
-     struct pollfd *pfds;
-     int timeout;
-     struct timeval timeOfDayStart, timeOfDay;
-     int numLocked;
-     bool freqLocked = false;
-
-     WA_INFO("WaitSessions(): %p\n", (void*)sessions);
-
-     pfds = malloc(sizeof(struct pollfd) * sessionCount);
-     if(pfds == NULL)
-         return;
-
-     for(i = 0, k=0; i < sessionCount; ++i)
-     {
-
-         if(WA_OSA_TaskCheckQuit())
-         {
-             WA_DBG("WaitSessions(): test cancelled #1\n");
-             goto end;
-         }
+     return session->done ? -1 : session->socket - 1;
+ }
 
-         if(sessions[i].socket <= 0)
-         {
-             ++k;
-         }
-         pfds[i].fd = sessions[i].socket - 1;
-         pfds[i].events = POLLIN;
-         //printf("HWST_DBG |Socket[%d]: %d\n", i, pfds[i].fd);
-     }
-     if(k == sessionCount)
-     {
-         WA_ERROR("WaitSessions(): No sockets\n");
-         goto end;
-     }
+ static bool sessionEvent(TuneSession_t * session)
+ {
+     char buf[MAX_REQUEST];
+     int rc = recv(session->socket - 1, buf, MAX_REQUEST-1, 0);
 
-     if (tuneAllAtOnce)
+     WA_DBG("sessionEvent(): recv result: %i (errno: %i: %s)\n", (int)rc, (int)errno, (char*)strerror(errno));
+     if(rc > 0)
      {
-         if(k > 0)
-         {
-             SendSessionProgress(instanceHandle, k, sessionCount, currentPass, totalPasses);
-         }
+         dump(buf, rc);
      }
+     fflush(stdout);
 
-     timeout = TUNE_RESPONSE_TIMEOUT*sessionCount;
-     gettimeofday(&timeOfDayStart, NULL);
-     do
-     {
-         if(WA_OSA_TaskCheckQuit())
-         {
-             WA_DBG("WaitSessions(): test cancelled #2\n");
-             goto end;
-         }
-
-         status = poll(pfds, sessionCount, timeout);
-         switch (status)
-         {
-         case -1:
-             WA_ERROR("WaitSessions(): poll() error\n");
-             goto end;
-         case 0:
-             WA_ERROR("WaitSessions(): poll() timeout\n");
-             goto end;
-         default:
-             for(i=0, k=0; i<sessionCount; ++i)
-             {
-                 if(pfds[i].fd < 0)
-                 {
-                     ++k;
-                     continue;
-                 }
-                 WA_DBG("WaitSessions(): event[%d]: %x\n", i, pfds[i].revents);
-                 if(pfds[i].revents != 0)
-                 {
-                     {
-                         char buf[MAX_REQUEST];
-                         int rc = recv(pfds[i].fd, buf , MAX_REQUEST-1, 0);
-                         WA_DBG("WaitSessions(): recv result: %i (errno: %i: %s)\n", (int)rc, (int)errno, (char*)strerror(errno));
-                         fflush(stdout);
-                         if(rc > 0)
-                         {
-                             dump(buf, rc);
-                         }
-                         fflush(stdout);
-                         /* ignore response content */
-                     }
-                     pfds[i].fd = -1;
-                     ++k;
-                 }
-                 /* ignore response content */
-             }
-             if (tuneAllAtOnce)
-             {
-                 if(k > 0)
-                 {
-                     SendSessionProgress(instanceHandle, k, sessionCount, currentPass, totalPasses);
-                 }
-             }
-             if(k == sessionCount)
-             {
-                 WA_DBG("WaitSessions(): all events served\n");
-                 goto end;
-             }
-             WA_DBG("WaitSessions(): Remaining tuners: %d\n", sessionCount-k);
-             /* ignore response content */
-             break;
-         }
-
-         gettimeofday(&timeOfDay, NULL);
-         timeout = (TUNE_RESPONSE_TIMEOUT*sessionCount) - (timeOfDay.tv_sec - timeOfDayStart.tv_sec)*1000;
-
-         WA_DIAG_TUNER_GetTunerStatuses(statuses, sessionCount, &numLocked, &freqLocked, "", NULL);
-     }while((status > 0) && (timeout > 0));
-
-     end:
-
-     free(pfds);
-     return;
+     /* ignore response content, the lock is checked in the frontend status */
+     session->done = true;
+     return true;
  }
 
  /**
@@ -980,20 +884,235 @@ static int getTuneData(json_t *pJson, char *tuneData, size_t size)
      WA_DIAG_SendProgress(instanceHandle, value);
  }
 
+ static unsigned int elapsedMs(const struct timespec * start)
+ {
+     struct timespec now;
+
+     clock_gettime(CLOCK_MONOTONIC, &now);
+     return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+ }
+
+ static unsigned int ttlBucket(unsigned int ms)
+ {
+     unsigned int bucket = 0;
+
+     while ((bucket < TTL_HISTOGRAM_BUCKETS - 1) && (ms > ttlBucketLimits[bucket]))
+     {
+         ++bucket;
+     }
+     return bucket;
+ }
+
+ static bool isLockSufficient(const TuneSweep_t * sweep)
+ {
+     if (sweep->freqLocked)
+     {
+         return true;
+     }
+#if defined(USE_FRONTEND_PROCFS) && defined(USE_UNRELIABLE_PROCFS_WORKAROUND)
+     return (sweep->numLocked > 0);
+#else
+     return (sweep->numLocked >= (int)sweep->statusCount);
+#endif
+ }
+
+ /*
+  * Waits for the tune sessions and the tuner lock at the same time.
+  *
+  * The session descriptors (HTTP sockets or TRM reservation events) and a periodic
+  * timer are multiplexed in a single poll(). The frontend status can not be polled,
+  * so it is sampled on every timer tick, which also gives the time-to-lock of each
+  * tuner relative to the moment the sweep was started.
+  *
+  * The wait ends as soon as the lock is sufficient, when LOCK_LOOP_COUNT samples were
+  * taken after all sessions have completed, or when the sessions time out.
+  *
+  * Returns false if the tuner status could not be read.
+  */
+ static bool WaitSweep(TuneSweep_t * sweep,
+    unsigned int currentPass,
+    unsigned int totalPasses)
+ {
+     struct pollfd pfds[sweep->sessionCount + 1];
+     bool wasLocked[sweep->statusCount];
+     bool gotLock[sweep->statusCount];
+     struct itimerspec period = {
+         .it_interval = { .tv_sec = 0, .tv_nsec = LOCK_LOOP_TIME * 1000000 },
+         .it_value = { .tv_sec = 0, .tv_nsec = 1000000 } /* first sample almost immediately */
+     };
+     unsigned int timeout = SWEEP_TIMEOUT + SWEEP_SESSION_TIMEOUT * sweep->sessionCount + LOCK_LOOP_COUNT * LOCK_LOOP_TIME;
+     unsigned int probesLeft = LOCK_LOOP_COUNT;
+     size_t i, done;
+     bool probed = false;
+     bool result = false;
+     int timer;
+
+     WA_ENTER("WaitSweep(sweep=%p, sessionCount=%zu, currentPass=%u, totalPasses=%u)\n",
+         (void*)sweep, sweep->sessionCount, currentPass, totalPasses);
+
+     /* tuners locked before the sweep do not contribute to the time-to-lock statistics */
+     for (i = 0; i < sweep->statusCount; ++i)
+     {
+         wasLocked[i] = sweep->statuses[i].locked;
+         gotLock[i] = false;
+     }
+
+     timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+     if ((timer < 0) || timerfd_settime(timer, 0, &period, NULL))
+     {
+         WA_ERROR("WaitSweep(): timer setup failed (%s)\n", strerror(errno));
+         goto end;
+     }
+     pfds[0].fd = timer;
+     pfds[0].events = POLLIN;
+
+     for (;;)
+     {
+         if (WA_OSA_TaskCheckQuit())
+         {
+             WA_DBG("WaitSweep(): test cancelled\n");
+             goto end;
+         }
+
+         for (i = 0, done = 0; i < sweep->sessionCount; ++i)
+         {
+             pfds[i + 1].fd = sessionFd(&sweep->sessions[i]);
+             pfds[i + 1].events = POLLIN;
+             pfds[i + 1].revents = 0;
+             done += (pfds[i + 1].fd < 0);
+         }
+
+         int remaining = (int)timeout - (int)elapsedMs(&sweep->start);
+         if (remaining <= 0)
+         {
+             WA_ERROR("WaitSweep(): timeout, %zu/%zu sessions completed\n", done, sweep->sessionCount);
+             break;
+         }
+
+         int status = poll(pfds, sweep->sessionCount + 1, remaining);
+         if (status < 0)
+         {
+             if (errno == EINTR)
+             {
+                 continue;
+             }
+             WA_ERROR("WaitSweep(): poll() error\n");
+             break;
+         }
+
+         bool progress = false;
+         for (i = 0; i < sweep->sessionCount; ++i)
+         {
+             if ((pfds[i + 1].fd >= 0) && pfds[i + 1].revents)
+             {
+                 WA_DBG("WaitSweep(): event[%zu]: %x\n", i, pfds[i + 1].revents);
+                 if (!sessionEvent(&sweep->sessions[i]))
+                 {
+                     WA_ERROR("WaitSweep(): session %zu failed\n", i);
+                 }
+                 if (sweep->sessions[i].done)
+                 {
+                     ++done;
+                     progress = true;
+                 }
+             }
+         }
+         if (progress)
+         {
+             WA_DBG("WaitSweep(): remaining sessions: %zu\n", sweep->sessionCount - done);
+             SendSessionProgress(sweep->instanceHandle, done, sweep->sessionCount, currentPass, totalPasses);
+         }
+
+         if (!(pfds[0].revents & POLLIN))
+         {
+             continue;
+         }
+
+         uint64_t ticks;
+         if (read(timer, &ticks, sizeof(ticks)) != sizeof(ticks))
+         {
+             WA_DBG("WaitSweep(): spurious timer wakeup\n");
+             continue;
+         }
+
+         if (!WA_DIAG_TUNER_GetTunerStatuses(sweep->statuses, sweep->statusCount, &sweep->numLocked, &sweep->freqLocked, sweep->freq, sweep->frontendStatus))
+         {
+             WA_ERROR("WaitSweep(): failed to read tuner status\n");
+             probed = false;
+             break;
+         }
+         probed = true;
+
+         for (i = 0; i < sweep->statusCount; ++i)
+         {
+             if (sweep->statuses[i].locked && !wasLocked[i] && !gotLock[i])
+             {
+                 unsigned int ttl = elapsedMs(&sweep->start);
+
+                 WA_DBG("WaitSweep(): tuner %zu locked after %u ms\n", i, ttl);
+                 gotLock[i] = true;
+                 if (sweep->stats)
+                 {
+                     ++sweep->stats[i].ttl[ttlBucket(ttl)];
+                 }
+             }
+         }
+
+         if (isLockSufficient(sweep))
+         {
+             WA_DBG("WaitSweep(): lock sufficient after %u ms\n", elapsedMs(&sweep->start));
+             break;
+         }
+
+         if ((done == sweep->sessionCount) && (--probesLeft == 0))
+         {
+             WA_DBG("WaitSweep(): no sufficient lock after all sessions completed\n");
+             break;
+         }
+     }
+
+     result = probed;
+
+     if (sweep->stats)
+     {
+         for (i = 0; i < sweep->statusCount; ++i)
+         {
+             if (!wasLocked[i] && !gotLock[i])
+             {
+                 ++sweep->stats[i].ttl[TTL_HISTOGRAM_BUCKETS];
+             }
+         }
+     }
+
+ end:
+     if (timer >= 0)
+     {
+         close(timer);
+     }
+
+     WA_RETURN("WaitSweep(): %d (locked: %d)\n", result, sweep->numLocked);
+
+     return result;
+ }
+
+ static void reportSweepStats(const TuneSweepStats_t * stats, size_t statusCount)
+ {
+     for (size_t i = 0; i < statusCount; ++i)
+     {
+         WA_INFO("WA_DIAG_TUNER_status(): tuner %zu time-to-lock [ms] <=250:%u <=500:%u <=1000:%u <=2000:%u <=4000:%u >4000:%u none:%u\n",
+             i, stats[i].ttl[0], stats[i].ttl[1], stats[i].ttl[2], stats[i].ttl[3], stats[i].ttl[4], stats[i].ttl[5], stats[i].ttl[6]);
+     }
+ }
+
 #ifdef USE_TRM
-static bool startTuneSessions(void *instanceHandle,
-    TuneSession_t * sessions,
+static bool startTuneSessions(TuneSession_t * sessions,
     size_t sessionCount,
-    const char *urlBase,
-    unsigned int currentPass,
-    unsigned int totalPasses,
-    WA_DIAG_TUNER_TunerStatus_t *statuses)
+    const char *urlBase)
 {
-    (void)statuses;
     bool result = false;
 
-    WA_ENTER("startTuneSessions(instanceHandle=%p, sessions=%p, sessionCount=%u, urlBase='%s', currentPass=%u, totalPasses=%u, statuses=%p)\n",
-                instanceHandle, sessions, sessionCount, urlBase, currentPass, totalPasses, statuses);
+    WA_ENTER("startTuneSessions(sessions=%p, sessionCount=%u, urlBase='%s')\n",
+                sessions, sessionCount, urlBase);
 
     if (!closeTuneSessions(sessions, sessionCount))
         WA_ERROR("startTuneSessions(): closeTuneSessions() failed\n");
@@ -1011,17 +1130,10 @@ static bool startTuneSessions(void *instanceHandle,
         goto end;
     }
 
-    time_t start_time = time(NULL);
-
+    /* All reservations are requested up front, TRM tunes them concurrently and WaitSweep() collects the events. */
     result = true;
     for (int i = 0; i < sessionCount; i++)
     {
-        if (time(NULL) - start_time > TRM_TUNER_SESSIONS_TIMEOUT)
-        {
-            WA_ERROR("startTuneSessions(): sessions timeout!\n");
-            WA_OSA_TaskSignalQuit(WA_OSA_TaskGet());
-        }
-
         if (WA_OSA_TaskCheckQuit())
         {
             WA_DBG("startTuneSessions(): test cancelled #1\n");
@@ -1031,30 +1143,14 @@ static bool startTuneSessions(void *instanceHandle,
 
         /* For each reserve request adjust frequency slightly, so it's different to TRM, but close enough to still be lockable. */
         snprintf(adj_url, max_url_len, REQUEST_PATTERN, freq + i, mod, pgmo);
-        if (!WA_UTILS_TRH_ReserveTuner(strstr(adj_url, "ocap://"), 0 /* now */, TRM_TUNER_RESERVATION_TIME, TRM_TUNER_RESERVATION_TIMEOUT, (int)sessionCount, (void **)&sessions[i].socket))
-        {
-            if (WA_OSA_TaskCheckQuit())
-            {
-                WA_DBG("startTuneSessions(): test cancelled #2\n");
-                result = false;
-                break;
-            }
-
-            if (WA_UTILS_TRH_WaitForTunerRelease((void *)sessions[i].socket, (2 * TRM_TUNER_RESERVATION_TIME)))
-            {
-                WA_ERROR("startTuneSessions(): tuner release timed out\n");
-                result = false;
-            }
-            else
-                WA_DBG("startTuneSessions(): tuner from reservation request %i successfully released\n", i);
-        }
-        else
+        if (WA_UTILS_TRH_RequestTuner(strstr(adj_url, "ocap://"), 0 /* now */, TRM_TUNER_RESERVATION_TIME, &sessions[i].reservation))
         {
             WA_ERROR("startTuneSessions(): failed to issue reservation request %i\n", i);
+            sessions[i].done = true;
             result = false;
         }
-
-        SendSessionProgress(instanceHandle, i, sessionCount, currentPass, totalPasses);
+        else
+            sessions[i].done = false;
     }
 
 end:
@@ -1065,6 +1161,32 @@ end:
     return result;
 }
 
+static int sessionFd(const TuneSession_t *session)
+{
+    return session->done ? -1 : WA_UTILS_TRH_GetEventFd(session->reservation);
+}
+
+static bool sessionEvent(TuneSession_t *session)
+{
+    switch (WA_UTILS_TRH_GetState(session->reservation))
+    {
+    case WA_UTILS_TRH_STATE_RELEASED:
+        WA_DBG("sessionEvent(): tuner from reservation %p released\n", session->reservation);
+        session->done = true;
+        break;
+
+    case WA_UTILS_TRH_STATE_FAILED:
+        WA_ERROR("sessionEvent(): reservation %p failed\n", session->reservation);
+        session->done = true;
+        return false;
+
+    default:
+        break;
+    }
+
+    return true;
+}
+
 static bool closeTuneSessions(TuneSession_t *sessions, size_t sessionCount)
 {
     bool result = true;
@@ -1073,16 +1195,17 @@ static bool closeTuneSessions(TuneSession_t *sessions, size_t sessionCount)
 
     for (int i = 0; i < sessionCount; i++)
     {
-        if (sessions[i].socket)
+        if (sessions[i].reservation)
         {
-            if (WA_UTILS_TRH_ReleaseTuner((void *)sessions[i].socket, TRM_TUNER_RESERVATION_RELEASE_TIMEOUT))
+            if (WA_UTILS_TRH_ReleaseTuner(sessions[i].reservation, TRM_TUNER_RESERVATION_RELEASE_TIMEOUT))
             {
                WA_ERROR("closeTuneSessions(): failed to free reservation %i\n", i);
                result = false; /* but continue anyway */
             }
 
-            sessions[i].socket = 0;
+            sessions[i].reservation = NULL;
         }
+        sessions[i].done = true;
     }
 
     WA_RETURN("closeTuneSessions(): %d\n", result);
@@ -1111,7 +1234,7 @@ bool WA_DIAG_TUNER_GetDocsisParams(WA_DIAG_TUNER_DocsisParams_t * params)
     /* Check if DOCSIS is in operational state */
     tunerResp.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
     tunerResp.data.l = 0;
-    if (!WA_UTILS_SNMP_GetNumber(SNMP_SERVER_ECM, OID_DOCSIS_BOOTSTATE, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_WALK))
+    if (!getSnmpNumber(SNMP_SERVER_ECM, OID_DOCSIS_BOOTSTATE, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_WALK))
     {
         WA_ERROR("Error Tuner failed to get DOCSIS server boot state\n");
         return false;
@@ -1136,7 +1259,7 @@ bool WA_DIAG_TUNER_GetDocsisParams(WA_DIAG_TUNER_DocsisParams_t * params)
 
     tunerResp.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
     tunerResp.data.l = 0;
-    if (!WA_UTILS_SNMP_GetNumber(SNMP_SERVER_ECM, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
+    if (!getSnmpNumber(SNMP_SERVER_ECM, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
     {
         WA_ERROR("Error Tuner failed to get DOCSIS Down Stream Signal\n");
     }
@@ -1155,7 +1278,7 @@ bool WA_DIAG_TUNER_GetDocsisParams(WA_DIAG_TUNER_DocsisParams_t * params)
 
     tunerResp.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
     tunerResp.data.l = 0;
-    if (!WA_UTILS_SNMP_GetNumber(SNMP_SERVER_ECM, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
+    if (!getSnmpNumber(SNMP_SERVER_ECM, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
     {
         WA_ERROR("Error Tuner failed to get DOCSIS Up Stream Signal\n");
     }
@@ -1173,7 +1296,7 @@ bool WA_DIAG_TUNER_GetDocsisParams(WA_DIAG_TUNER_DocsisParams_t * params)
 
     tunerResp.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
     tunerResp.data.l = 0;
-    if (!WA_UTILS_SNMP_GetNumber(SNMP_SERVER_ECM, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
+    if (!getSnmpNumber(SNMP_SERVER_ECM, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
     {
         WA_ERROR("Error Tuner failed to get DOCSIS SNR\n");
     }
@@ -1224,7 +1347,7 @@ bool WA_DIAG_TUNER_GetQamParams(WA_DIAG_TUNER_QamParams_t * params)
         WA_UTILS_SNMP_Resp_t tunerResp;
         tunerResp.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
         tunerResp.data.l = 0;
-        if (!WA_UTILS_SNMP_GetNumber(SNMP_SERVER_ESTB, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
+        if (!getSnmpNumber(SNMP_SERVER_ESTB, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
         {
             WA_ERROR("Tuner %i failed to get QAM status\n", (int)tunerIndex);
             return false;
@@ -1248,7 +1371,7 @@ bool WA_DIAG_TUNER_GetQamParams(WA_DIAG_TUNER_QamParams_t * params)
 
             tunerResp.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
             tunerResp.data.l = 0;
-            if (!WA_UTILS_SNMP_GetNumber(SNMP_SERVER_ESTB, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
+            if (!getSnmpNumber(SNMP_SERVER_ESTB, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
             {
                 WA_ERROR("Tuner %i failed to get QAM Down Stream Signal\n", (int)tunerIndex);
                 return false;
@@ -1268,7 +1391,7 @@ bool WA_DIAG_TUNER_GetQamParams(WA_DIAG_TUNER_QamParams_t * params)
 
             tunerResp.type = WA_UTILS_SNMP_RESP_TYPE_LONG;
             tunerResp.data.l = 0;
-            if (!WA_UTILS_SNMP_GetNumber(SNMP_SERVER_ESTB, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
+            if (!getSnmpNumber(SNMP_SERVER_ESTB, oid, &tunerResp, WA_UTILS_SNMP_REQ_TYPE_GET))
             {
                 WA_ERROR("Tuner %i failed to get QAM SNR\n", (int)tunerIndex);
                 return false;
@@ -1366,7 +1489,7 @@ bool WA_DIAG_TUNER_GetVideoDecoderData(VideoDecoder_t* hvd, int* num_hvd)
 
     parseMode_t parseMode = parseHVD;
 
-    if ((fd = fopen(VIDEO_DECODER_STATUS_FILE, "r")) == NULL)
+    if ((fd = fopen(WA_UTILS_SIM_PATH(VIDEO_DECODER_STATUS_FILE), "r")) == NULL)
     {
         WA_ERROR("GetVideoDecoderData(): Cannot read the file %s\n", VIDEO_DECODER_STATUS_FILE);
         return false;
@@ -1511,7 +1634,7 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
 
     parseMode_t parseMode = parseParserBand;
 
-    if ((fd = fopen(TRANSPORT_STATUS_FILE, "r")) == NULL)
+    if ((fd = fopen(WA_UTILS_SIM_PATH(TRANSPORT_STATUS_FILE), "r")) == NULL)
     {
         WA_ERROR("GetTransportData(): Cannot read the file %s\n", TRANSPORT_STATUS_FILE);
         return false;
@@ -1667,7 +1790,7 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
     WA_DBG("GetTunerStatusses(): Freq: %s\n", freq);
 
     *pNumLocked = 0;
-    if ((fd = fopen(PROCFS_STATUS_FILE,"r")) == NULL)
+    if ((fd = fopen(WA_UTILS_SIM_PATH(PROCFS_STATUS_FILE),"r")) == NULL)
     {
         WA_ERROR("GetTunerStatusses(): Cannot get statuses.\n");
         return false;
@@ -1805,7 +1928,7 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
  int WA_DIAG_TUNER_status(void* instanceHandle, void *initHandle, json_t **pJsonInOut)
  {
      int result = WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
-     json_t * config = NULL;
+     const WA_DIAG_settings_t * settings;
      json_t * tuneUrls;
      char tuneData[128];
      char freq[64];
@@ -1823,10 +1946,12 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
      ParserBand_t* parserBand = NULL;
      PIDChannel_t* pidChannel = NULL;
      Frontend_t* frontendStatus = NULL;
-#ifdef USE_SEVERAL_LOCK_PROBES
-     int i;
-     struct timespec sTime = {.tv_nsec=(LOCK_LOOP_TIME * 1000000), .tv_sec=0};
+     int sweepSessions = 1;
+#ifdef USE_TRM
+     int freeTuners;
 #endif
+     int stopOnLock = 0;
+     TuneSweep_t sweep;
 
      // Read the input json before setting it to null, for ngan tune test and to decide whether it is ngan test or general test
      getTuneData(*pJsonInOut, &tuneData[0], sizeof(tuneData));
@@ -1902,8 +2027,8 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
      }
 
      /* Determine if the test is applicable: */
-     config = ((WA_DIAG_proceduresConfig_t*)initHandle)->config;
-     unsigned int tunersCount = getNumberOfTuners(config);
+     settings = WA_DIAG_GetSettings((WA_DIAG_proceduresConfig_t*)initHandle);
+     unsigned int tunersCount = getNumberOfTuners(settings);
 
      if (tunersCount <= 0)
      {
@@ -1958,14 +2083,45 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
          return WA_DIAG_ERRCODE_SI_CACHE_MISSING;
      }
 
-     numTestTuner = 1; // Testing only one tuner is enough for tuner diagnostics with only one session
+#ifdef USE_TRM
+     /* TRM grants only the free tuners, so all of them are swept at once by default,
+        the ones in use stay untouched */
+     sweepSessions = (int)tunersCount;
+#else
+     /* Nothing arbitrates the HTTP sessions, testing one tuner leaves the others to the viewer;
+        more sessions can be tuned concurrently when configured */
+#endif
+     if (settings->sweepSessions > 0)
+         sweepSessions = settings->sweepSessions;
+#ifdef USE_TRM
+     freeTuners = WA_UTILS_TRH_GetFreeTuners();
+     if ((freeTuners > 0) && (sweepSessions > freeTuners))
+     {
+         WA_INFO("WA_DIAG_TUNER_status(): %i sweep sessions, TRM has %i tuners free\n", sweepSessions, freeTuners);
+         sweepSessions = freeTuners;
+     }
+#endif /* USE_TRM */
+     stopOnLock = settings->sweepStopOnLock;
+     numTestTuner = (sweepSessions < 1) ? 1 : (sweepSessions > (int)tunersCount) ? (int)tunersCount : sweepSessions;
      TuneSession_t sessions[numTestTuner];
      memset(sessions, 0, sizeof(sessions));
 
      WA_DIAG_TUNER_TunerStatus_t statuses[tunersCount];
      memset(statuses, 0, sizeof(statuses));
+     TuneSweepStats_t stats[tunersCount];
+     memset(stats, 0, sizeof(stats));
      frontendStatus = (Frontend_t*) malloc(sizeof(Frontend_t)); // Needs deallocation
 
+     memset(&sweep, 0, sizeof(sweep));
+     sweep.instanceHandle = instanceHandle;
+     sweep.sessions = sessions;
+     sweep.statuses = statuses;
+     sweep.statusCount = tunersCount;
+     sweep.freq = freq;
+     sweep.frontendStatus = frontendStatus;
+     sweep.standAloneTest = standAloneTest;
+     sweep.stats = stats;
+
      if (decoderData) // NGAN Phase-2
      {
          if (!frontendStatus)
@@ -1977,19 +2133,10 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
              return WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
          }
 
-#ifndef USE_SEVERAL_LOCK_PROBES
-         retCode = WA_DIAG_TUNER_GetTunerStatuses(statuses, tunersCount, &numLocked, &freqLocked, freq, frontendStatus);
-#else
-         for (i = 0; i < LOCK_LOOP_COUNT && !freqLocked; i++)
-         {
-             retCode = WA_DIAG_TUNER_GetTunerStatuses(statuses, tunersCount, &numLocked, &freqLocked, freq, frontendStatus);
-             if (retCode && !freqLocked)
-             {
-                 WA_DBG("WA_DIAG_TUNER_status(): retrying status check for standalone tuner test (%i)...\n", i);
-                 nanosleep(&sTime, NULL);
-             }
-         }
-#endif /* USE_SEVERAL_LOCK_PROBES */
+         /* No tune sessions, the decoders already run, only wait for the frontend lock */
+         clock_gettime(CLOCK_MONOTONIC, &sweep.start);
+         retCode = WaitSweep(&sweep, 0, 1);
+         freqLocked = sweep.freqLocked;
          if (!freqLocked && frontendStatus)
          {
              free(frontendStatus);
@@ -2007,7 +2154,8 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
      {
          numLocked = 0;
 
-         if(WA_OSA_TaskCheckQuit())
+         /* each URL tunes all the tested tuners, let the foreground load go first */
+         if(WA_THROTTLE_Point())
          {
              WA_DBG("WA_DIAG_TUNER_status(): test cancelled #2\n");
              result = WA_DIAG_ERRCODE_CANCELLED;
@@ -2031,13 +2179,10 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
              continue;
          }
 
-         retCode = startTuneSessions(instanceHandle,
-             sessions,
+         clock_gettime(CLOCK_MONOTONIC, &sweep.start);
+         retCode = startTuneSessions(sessions,
              numTestTuner,
-             url,
-             urlIndex,
-             urlCount,
-             statuses);
+             url);
 
          if(WA_OSA_TaskCheckQuit())
          {
@@ -2051,28 +2196,22 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
              WA_ERROR("WA_DIAG_TUNER_status(): Could not start tune sessions for URL: %s\n", url);
          }
 
-#ifndef USE_SEVERAL_LOCK_PROBES
-         retCode = WA_DIAG_TUNER_GetTunerStatuses(statuses, tunersCount, &numLocked, &freqLocked, freq, frontendStatus);
-#else
-         for(i=0, retCode=true, numLocked=0;
-             retCode && (i<LOCK_LOOP_COUNT) && (numLocked < tunersCount) && !WA_OSA_TaskCheckQuit() && !freqLocked; ++i)
-         {
-             retCode = WA_DIAG_TUNER_GetTunerStatuses(statuses, tunersCount, &numLocked, &freqLocked, freq, frontendStatus);
-
-#if defined(USE_FRONTEND_PROCFS) && defined(USE_UNRELIABLE_PROCFS_WORKAROUND)
-             if(retCode && (numLocked == 0))
-#else
-             if(retCode && (numLocked < tunersCount))
-#endif
-             {
-                 WA_DBG("WA_DIAG_TUNER_status(): retrying status check (%i)...\n", i);
-                 nanosleep(&sTime, NULL);
-             }
-         }
-#endif /* USE_SEVERAL_LOCK_PROBES */
+         sweep.sessionCount = numTestTuner;
+         sweep.numLocked = 0;
+         sweep.freqLocked = false;
+         retCode = WaitSweep(&sweep, urlIndex, urlCount);
+         numLocked = sweep.numLocked;
+         freqLocked = sweep.freqLocked;
 
          closeTuneSessions(sessions, numTestTuner);
 
+         if(WA_OSA_TaskCheckQuit())
+         {
+             WA_DBG("WA_DIAG_TUNER_status(): test cancelled #4\n");
+             result = WA_DIAG_ERRCODE_CANCELLED;
+             break;
+         }
+
          WA_UTILS_SICACHE_TuningSetLuckyId(numLocked ? urlIndex : -1);
 
          if(!retCode)
@@ -2092,6 +2231,12 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
              WA_INFO("WA_DIAG_TUNER_status(): All tuners locked.\n");
              saveTuneResults(frontendStatus);
              result = WA_DIAG_ERRCODE_SUCCESS;
+
+             if (stopOnLock)
+             {
+                 WA_DBG("WA_DIAG_TUNER_status(): URL[%zu]: sufficient lock, sweep stopped\n", urlIndex);
+                 break;
+             }
          }
          else
          {
@@ -2115,6 +2260,7 @@ bool WA_DIAG_TUNER_GetTransportData(ParserBand_t* parserBand, int* num_parser, P
 
          WA_DBG("WA_DIAG_TUNER_status(): URL[%d]: result=%d\n", urlIndex, result);
      }
+     reportSweepStats(stats, tunersCount);
 end:
      if (frontendStatus)
      {
@@ -2139,6 +2285,12 @@ end:
          {
              json_t * stateData = json_object();
              json_object_set_new(stateData, "lock", json_integer(statuses[i].locked));
+             json_t * ttl = json_array();
+             for (int j = 0; j <= TTL_HISTOGRAM_BUCKETS; ++j)
+             {
+                 json_array_append_new(ttl, json_integer(stats[i].ttl[j]));
+             }
+             json_object_set_new(stateData, "ttl", ttl);
              json_array_append_new(*pJsonInOut, stateData);
          }
          break;
@@ -2198,7 +2350,7 @@ int verifyStandbyState()
     }
 
     IARM_Bus_PWRMgr_GetPowerState_Param_t param;
-    IARM_Result_t res = IARM_Bus_Call(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_API_GetPowerState,(void *)&param, sizeof(param));
+    IARM_Result_t res = WA_UTILS_IARM_Call(IARM_BUS_PWRMGR_NAME, IARM_BUS_PWRMGR_API_GetPowerState,(void *)&param, sizeof(param));
 
     /* Query current Power state  */
     if (IARM_RESULT_SUCCESS == res)
@@ -2495,5 +2647,9 @@ static void freeDecoderTransportData(VideoDecoder_t* hvd, ParserBand_t* parserBa
     }
 }
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("tuner_status", NULL, NULL, WA_DIAG_TUNER_status);
+#endif
+
  /* End of doxygen group */
  /*! @} */
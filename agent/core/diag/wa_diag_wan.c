@@ -43,6 +43,7 @@
 #include "wa_diag.h"
 #include "wa_debug.h"
 #include "wa_fileops.h"
+#include "wa_sim.h"
 
 /* rdk specific */
 #include "wa_iarm.h"
@@ -178,7 +179,7 @@ int gatewayConnection()
     IARM_Result_t iarm_result = IARM_RESULT_IPCCORE_FAIL;
 
     IARM_BUS_NetSrvMgr_DefaultRoute_t netSrvMgrParam;
-    iarm_result = IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface, (void*)&netSrvMgrParam, sizeof(netSrvMgrParam));
+    iarm_result = WA_UTILS_IARM_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface, (void*)&netSrvMgrParam, sizeof(netSrvMgrParam));
 
     if (iarm_result != IARM_RESULT_SUCCESS)
     {
@@ -196,12 +197,17 @@ int gatewayConnection()
         HOSTIF_MsgData_t stMsgDataParam;
         memset(&stMsgDataParam, 0, sizeof(stMsgDataParam));
         snprintf(stMsgDataParam.paramName, TR69HOSTIFMGR_MAX_PARAM_LEN, "%s", TR69_WIFI_OPER_STATUS);
-        iarm_result = IARM_Bus_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)&stMsgDataParam, sizeof(stMsgDataParam));
-
-        if (iarm_result != IARM_RESULT_SUCCESS)
+        /* the wifi diag reads the same status, share it within the test run */
+        if (WA_DIAG_ProbeCacheGet(WA_DIAG_PROBE_TR69, TR69_WIFI_OPER_STATUS, stMsgDataParam.paramValue, sizeof(stMsgDataParam.paramValue)))
         {
-            WA_ERROR("gatewayConnection(): IARM_Bus_Call('%s') failed\n", IARM_BUS_TR69HOSTIFMGR_NAME);
-            return result;
+            iarm_result = WA_UTILS_IARM_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)&stMsgDataParam, sizeof(stMsgDataParam));
+
+            if (iarm_result != IARM_RESULT_SUCCESS)
+            {
+                WA_ERROR("gatewayConnection(): IARM_Bus_Call('%s') failed\n", IARM_BUS_TR69HOSTIFMGR_NAME);
+                return result;
+            }
+            WA_DIAG_ProbeCachePut(WA_DIAG_PROBE_TR69, TR69_WIFI_OPER_STATUS, stMsgDataParam.paramValue, sizeof(stMsgDataParam.paramValue), WA_DIAG_PROBE_CACHE_MAX_AGE);
         }
 
         char wifiStatus[64] = {'\0'};
@@ -214,7 +220,7 @@ int gatewayConnection()
             char ether_state[64] = {'\0'};
             char eth_operState[STR_MAX] = {'\0'};
             snprintf(eth_operState, sizeof(eth_operState), "cat /sys/class/net/%s/operstate", defaultInterface);
-            FILE *fp = popen(eth_operState, "r");
+            FILE *fp = WA_DIAG_Popen(eth_operState, "r");
             fscanf(fp, "%s", ether_state);
             WA_DBG("gatewayConnection(): Ethernet state is \"%s\"\n", ether_state);
             if (!strcasecmp(ether_state, "up"))
@@ -233,7 +239,7 @@ int gatewayConnection()
 
 #endif
 
-    FILE *dfltroute = fopen(HWST_DFLT_ROUTE_FILE, "r"); /* File containing IP's retreived through script in nlmon.cfg */
+    FILE *dfltroute = fopen(WA_UTILS_SIM_PATH(HWST_DFLT_ROUTE_FILE), "r"); /* File containing IP's retreived through script in nlmon.cfg */
 
     if (dfltroute != NULL)
     {
@@ -247,7 +253,7 @@ int gatewayConnection()
 
             char buf[STR_MAX] = {'\0'};
             snprintf(buf, var_size, "ping -c 1 -W 1 %s > /dev/null", gtw_ip);
-            if (system(buf) == 0)
+            if (WA_DIAG_System(buf) == 0)
             {
                 WA_DBG("gatewayConnection(): Ping successful to IP \"%s\"\n", gtw_ip);
                 fclose(dfltroute);
@@ -309,7 +315,7 @@ int comcastNetwork()
         memset(stMsgDataParam, 0, sizeof(*stMsgDataParam));
         snprintf(stMsgDataParam->paramName, TR69HOSTIFMGR_MAX_PARAM_LEN, "%s", TR69_WAN_XRE_CONN_STATUS);
 
-        iarm_result = IARM_Bus_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
+        iarm_result = WA_UTILS_IARM_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
 
         if (iarm_result != IARM_RESULT_SUCCESS)
         {
@@ -359,7 +365,7 @@ int publicNetwork()
             memset(stMsgDataParam, 0, sizeof(*stMsgDataParam));
             snprintf(stMsgDataParam->paramName, TR69HOSTIFMGR_MAX_PARAM_LEN, "%s", TR69_WAN_RFC_PUBLIC_URL);
 
-            iarm_result = IARM_Bus_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
+            iarm_result = WA_UTILS_IARM_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
 
             if (iarm_result == IARM_RESULT_SUCCESS)
             {
@@ -398,7 +404,7 @@ int publicNetwork()
     char IPv6[128] = {'\0'};
     FILE *fp;
     snprintf(nslookup_command, var_size, "nslookup %s | grep 'Address' | sed -n '2 p' | awk '{print $3}'", host);
-    fp = popen(nslookup_command, "r");
+    fp = WA_DIAG_Popen(nslookup_command, "r");
     if (fp == NULL)
     {
         WA_DBG("publicNetwork(): Unable to fetch IPv6 for URL through 'nslookup'\n");
@@ -424,7 +430,7 @@ int publicNetwork()
     int pingCount = 0;
     for (int i = 0; i < NUM_PINGS; i++)
     {
-        if (system(buf) == 0)
+        if (WA_DIAG_System(buf) == 0)
         {
             pingCount++;
         }
@@ -555,3 +561,7 @@ int WA_DIAG_WAN_status(void *instanceHandle, void *initHandle, json_t **params)
 
     return setReturnData(status, params);
 }
+
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("wan_status", NULL, NULL, WA_DIAG_WAN_status);
+#endif
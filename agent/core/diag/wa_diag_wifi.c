@@ -155,14 +155,19 @@ int getWifiParam_IARM(char *param, char **value)
         memset(stMsgDataParam, 0, sizeof(*stMsgDataParam));
         snprintf(stMsgDataParam->paramName, TR69HOSTIFMGR_MAX_PARAM_LEN, "%s", param);
 
-        WA_DBG("getWifiParam_IARM(): IARM_Bus_Call('%s', '%s', %s)\n", IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, stMsgDataParam->paramName);
-        iarm_result = IARM_Bus_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
-
-        if (iarm_result != IARM_RESULT_SUCCESS)
+        /* the wan diag reads the WiFi status too, share the parameters within the test run */
+        if (WA_DIAG_ProbeCacheGet(WA_DIAG_PROBE_TR69, param, stMsgDataParam->paramValue, sizeof(stMsgDataParam->paramValue)))
         {
-            WA_ERROR("getWifiParam_IARM(): IARM_Bus_Call('%s') failed\n", IARM_BUS_TR69HOSTIFMGR_NAME);
-            IARM_Free(IARM_MEMTYPE_PROCESSLOCAL, stMsgDataParam);
-            return -1;
+            WA_DBG("getWifiParam_IARM(): IARM_Bus_Call('%s', '%s', %s)\n", IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, stMsgDataParam->paramName);
+            iarm_result = WA_UTILS_IARM_Call(IARM_BUS_TR69HOSTIFMGR_NAME, IARM_BUS_TR69HOSTIFMGR_API_GetParams, (void *)stMsgDataParam, sizeof(*stMsgDataParam));
+
+            if (iarm_result != IARM_RESULT_SUCCESS)
+            {
+                WA_ERROR("getWifiParam_IARM(): IARM_Bus_Call('%s') failed\n", IARM_BUS_TR69HOSTIFMGR_NAME);
+                IARM_Free(IARM_MEMTYPE_PROCESSLOCAL, stMsgDataParam);
+                return -1;
+            }
+            WA_DIAG_ProbeCachePut(WA_DIAG_PROBE_TR69, param, stMsgDataParam->paramValue, sizeof(stMsgDataParam->paramValue), WA_DIAG_PROBE_CACHE_MAX_AGE);
         }
 
         if(!strcmp(param, TR69_WIFI_SIGNAL_STRENGTH))
@@ -355,7 +360,7 @@ int isWiFiConfigured()
 
     IARM_Result_t iarm_result = IARM_RESULT_IPCCORE_FAIL;
     IARM_BUS_NetSrvMgr_DefaultRoute_t param;
-    iarm_result = IARM_Bus_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface, (void*)&param, sizeof(param));
+    iarm_result = WA_UTILS_IARM_Call(IARM_BUS_NM_SRV_MGR_NAME, IARM_BUS_NETSRVMGR_API_getDefaultInterface, (void*)&param, sizeof(param));
 
     if (iarm_result != IARM_RESULT_SUCCESS)
     {
@@ -395,6 +400,10 @@ int isWiFiConfigured()
     return result;
 }
 
+#ifdef WA_DIAG_PLUGIN
+WA_DIAG_PLUGIN("wifi_status", NULL, NULL, WA_DIAG_WIFI_status);
+#endif
+
 /* End of doxygen group */
 /*! @} */
 
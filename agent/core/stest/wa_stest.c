@@ -64,6 +64,7 @@
 
 extern int WA_STEST_OSA_Run(void);
 extern int WA_STEST_ID_Run(void);
+extern int WA_STEST_SOAK_Run(void);
 
 int WA_STEST_Run(int i)
 {
@@ -88,6 +89,14 @@ int WA_STEST_Run(int i)
         goto end;
     }
     WA_INFO("WA_STEST_Run(): WA_STEST_ID_Run(): PASS\n");
+
+    status = WA_STEST_SOAK_Run();
+    if(status !=0)
+    {
+        WA_ERROR("WA_STEST_SOAK_Run(): %d\n", status);
+        goto end;
+    }
+    WA_INFO("WA_STEST_Run(): WA_STEST_SOAK_Run(): PASS\n");
 end:
     WA_RETURN("WA_STEST_Run():%d\n", status);
     return status;
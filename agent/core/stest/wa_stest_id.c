@@ -30,6 +30,8 @@
 /*****************************************************************************
  * STANDARD INCLUDE FILES
  *****************************************************************************/
+#include <string.h>
+#include <time.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
@@ -44,7 +46,8 @@
 /*****************************************************************************
  * LOCAL DEFINITIONS
  *****************************************************************************/
-#define PREPROCESSOR_ASSERT(x) (void)(sizeof(char[-!(x)]))
+#define STRESS_CYCLES 1000000
+#define STRESS_LIVE (WA_UTILS_ID_COUNT / 2)
 
 /*****************************************************************************
  * LOCAL TYPES
@@ -53,10 +56,13 @@
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
+static int Stress(void);
 
 /*****************************************************************************
  * LOCAL VARIABLE DECLARATIONS
  *****************************************************************************/
+/* dummy owners, one per id */
+static char owners[WA_UTILS_ID_COUNT];
 
 /*****************************************************************************
  * FUNCTION DEFINITIONS
@@ -68,8 +74,6 @@ int WA_STEST_ID_Run(void)
     int i;
     WA_UTILS_ID_t id;
 
-    PREPROCESSOR_ASSERT((WA_UTILS_ID_t)(-1) == WA_UTILS_LIST_MAX_LIST_SIZE-1);
-
     WA_ENTER("WA_STEST_ID_Run()\n");
 
     status = WA_UTILS_ID_Init();
@@ -157,8 +161,12 @@ int WA_STEST_ID_Run(void)
     if(status != 0)
     {
         WA_ERROR("WA_INIT_Init(): WA_UTILS_ID_Exit():%d\n", status);
+        goto end;
     }
 
+    WA_INFO("WA_STEST_ID_Run() step #8\n");
+    status = Stress();
+
 end:
     WA_RETURN("WA_STEST_ID_Run():%d\n", status);
     return status;
@@ -170,6 +178,101 @@ end:
  * LOCAL FUNCTIONS
  *****************************************************************************/
 
+/* Keeps STRESS_LIVE ids taken in a private box, releasing the oldest one for every new one.
+ * The taken ids always form a window so each new id must follow the previous one,
+ * a just released id is not handed out again until the generator wraps around.
+ */
+static int Stress(void)
+{
+    int status = 0;
+    unsigned long i;
+    WA_UTILS_ID_t id, prev, oldest;
+    WA_UTILS_ID_box_t box;
+    struct timespec start, stop;
+    unsigned long long ns;
+
+    memset(&box, 0, sizeof(box));
+
+    for(i = 0; i < STRESS_LIVE; ++i)
+    {
+        status = WA_UTILS_ID_GenerateUnsafe(&box, &id);
+        if(status != 0)
+        {
+            WA_ERROR("Stress(): WA_UTILS_ID_GenerateUnsafe():%d\n", status);
+            goto end;
+        }
+        status = WA_UTILS_ID_SetOwnerUnsafe(&box, id, &owners[id]);
+        if(status != 0)
+        {
+            WA_ERROR("Stress(): WA_UTILS_ID_SetOwnerUnsafe():%d\n", status);
+            goto end;
+        }
+    }
+    oldest = (WA_UTILS_ID_t)(id - STRESS_LIVE + 1);
+    prev = id;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i = 0; i < STRESS_CYCLES; ++i)
+    {
+        if(WA_UTILS_ID_GetOwnerUnsafe(&box, oldest) != &owners[oldest])
+        {
+            WA_ERROR("Stress(): invalid owner of id:%d\n", oldest);
+            status = -1;
+            goto end;
+        }
+        status = WA_UTILS_ID_ReleaseUnsafe(&box, oldest);
+        if(status != 0)
+        {
+            WA_ERROR("Stress(): WA_UTILS_ID_ReleaseUnsafe(%d):%d\n", oldest, status);
+            goto end;
+        }
+        if(WA_UTILS_ID_GetOwnerUnsafe(&box, oldest) != NULL)
+        {
+            WA_ERROR("Stress(): released id:%d still owned\n", oldest);
+            status = -1;
+            goto end;
+        }
+        ++oldest;
+
+        status = WA_UTILS_ID_GenerateUnsafe(&box, &id);
+        if(status != 0)
+        {
+            WA_ERROR("Stress(): WA_UTILS_ID_GenerateUnsafe():%d\n", status);
+            goto end;
+        }
+        if(id != (WA_UTILS_ID_t)(prev + 1))
+        {
+            WA_ERROR("Stress(): invalid id:%d after:%d\n", id, prev);
+            status = -1;
+            goto end;
+        }
+        prev = id;
+
+        status = WA_UTILS_ID_SetOwnerUnsafe(&box, id, &owners[id]);
+        if(status != 0)
+        {
+            WA_ERROR("Stress(): WA_UTILS_ID_SetOwnerUnsafe():%d\n", status);
+            goto end;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+
+    if(box.count != STRESS_LIVE)
+    {
+        WA_ERROR("Stress(): invalid count:%lu\n", box.count);
+        status = -1;
+        goto end;
+    }
+
+    ns = (unsigned long long)(stop.tv_sec - start.tv_sec) * 1000000000ULL + stop.tv_nsec - start.tv_nsec;
+    WA_INFO("Stress(): %d cycles of %lu live ids, %llu ns per release/generate\n",
+            STRESS_CYCLES, (unsigned long)STRESS_LIVE, ns / STRESS_CYCLES);
+
+end:
+    WA_UTILS_ID_ClearUnsafe(&box);
+    return status;
+}
+
 /* End of doxygen group */
 /*! @} */
 
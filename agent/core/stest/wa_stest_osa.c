@@ -49,6 +49,10 @@
 /*****************************************************************************
  * LOCAL TYPES
  *****************************************************************************/
+typedef struct
+{
+    char string[32];
+}WA_STEST_OSA_msg_t;
 
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
@@ -79,12 +83,12 @@ static int Qtest(void)
     int status = -1;
     void *q;
     int lenLow, lenHigh;
-    WA_OSA_QMsg_t msg;
+    WA_STEST_OSA_msg_t msg;
     unsigned int qprio;
 
     WA_ENTER("Qtest()\n");
 
-    q = WA_OSA_QCreate(10, sizeof(WA_OSA_QMsg_t));
+    q = WA_OSA_QCreate(10, sizeof(WA_STEST_OSA_msg_t));
     if(q == NULL)
     {
         WA_ERROR("Qtest(): WA_OSA_QCreate() error\n");
@@ -93,7 +97,7 @@ static int Qtest(void)
 
     strcpy(msg.string, "message low");
     lenLow = strlen(msg.string)+1;
-    status = WA_OSA_QSend(q, &msg, lenLow, 0);
+    status = WA_OSA_QSend(q, (const char *)&msg, lenLow, 0);
     if(status != 0)
     {
         WA_ERROR("Qtest(): WA_OSA_QSend(): %d\n", status);
@@ -101,7 +105,7 @@ static int Qtest(void)
 
     strcpy(msg.string, "message high");
     lenHigh = strlen(msg.string)+1;
-    status = WA_OSA_QSend(q, &msg, lenHigh, 7);
+    status = WA_OSA_QSend(q, (const char *)&msg, lenHigh, 7);
     if(status != 0)
     {
         WA_ERROR("Qtest(): WA_OSA_QSend(): %d\n", status);
@@ -109,7 +113,7 @@ static int Qtest(void)
 
     strcpy(msg.string, "dummy string");
 
-    status = WA_OSA_QReceive(q, &msg, sizeof(WA_OSA_QMsg_t), &qprio);
+    status = WA_OSA_QReceive(q, (char *)&msg, sizeof(WA_STEST_OSA_msg_t), &qprio);
     if((status != lenHigh) || strcmp(msg.string, "message high"))
     {
         WA_ERROR("Qtest(): WA_OSA_QReceive(): %d\n", status);
@@ -118,7 +122,7 @@ static int Qtest(void)
     {
         WA_INFO("Qtest(): WA_OSA_QReceive(): \"%s\" prio=%u\n", msg.string, qprio);
     }
-    status = WA_OSA_QReceive(q, &msg, sizeof(WA_OSA_QMsg_t), &qprio);
+    status = WA_OSA_QReceive(q, (char *)&msg, sizeof(WA_STEST_OSA_msg_t), &qprio);
     if((status != lenLow) || strcmp(msg.string, "message low"))
     {
         WA_ERROR("Qtest(): WA_OSA_QReceive(): %d\n", status);
@@ -0,0 +1,718 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_stest_soak.c
+ *
+ * @brief This file contains the soak test, the stress mode of the self tests.
+ *
+ * It runs when the config has "stest": {"soak": {...}}. The agent is brought up
+ * and down "restarts" times, each init must finish within "init_limit" [ms]. Then
+ * "runs" test runs are done back to back through the real dispatcher, each one
+ * a TESTRUN of the simulated _status diags followed by a burst of "burst" requests
+ * to the simulated burst diags, most of them answered "Already in progress".
+ *
+ * Every "sample" runs the usage at rest is sampled, the first sample is the baseline.
+ * The soak fails on a thread, fd or queue leak, on messages left in the queues, on
+ * RSS growing in every sample or by more than "rss_slack" [kB], and on the mean run
+ * time drifting up by more than "drift" [%].
+ */
+
+/** @addtogroup WA_STEST
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <dirent.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_debug.h"
+#include "wa_comm.h"
+#include "wa_config.h"
+#include "wa_diag.h"
+#include "wa_diag_errcodes.h"
+#include "wa_init.h"
+#include "wa_metrics.h"
+#include "wa_osa.h"
+#include "wa_throttle.h"
+
+/*****************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define DEFAULT_RUNS 2000
+#define DEFAULT_BURST 32
+#define DEFAULT_SAMPLE 100
+#define DEFAULT_RESTARTS 5
+#define DEFAULT_INIT_LIMIT 1000 /* [ms], the parent waits CHILD_INIT_TIMEOUT, see DELIA-42225 */
+#define DEFAULT_RSS_SLACK 1024 /* [kB] */
+#define DEFAULT_DRIFT 50 /* [%] */
+
+#define DRIFT_FLOOR 1000 /* [us], a smaller drift is noise */
+#define RSS_RISES 4 /* samples in a row RSS must rise in to be a leak */
+#define REPLY_TIMEOUT 10000 /* [ms] */
+#define SETTLE_TIMEOUT 2000 /* [ms] for the collector to join the instance tasks */
+#define SETTLE_STEP 10 /* [ms] */
+#define SLOW_MS 2
+#define BURST_DIAGS 4
+#define QUEUES_MAX 64
+#define MSG_MAX 256
+
+#define MQUEUE_DIR "/dev/mqueue"
+#define MQUEUE_PREFIX "wa_q_hwst_" /* WA_OSA_Q_NAME_PREFIX */
+#define BUSY_MESSAGE "Already in progress"
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+typedef struct
+{
+    long rss; /* [kB] */
+    long threads;
+    long fds;
+    long queues; /* of the agent, by WA_OSA_QGetStats() */
+    long depth; /* messages waiting in them */
+    long mqLeft; /* bytes in the agent's POSIX queues, -1 if /dev/mqueue is not mounted */
+}WA_STEST_SOAK_usage_t;
+
+typedef struct
+{
+    int runs;
+    int burst;
+    int sample;
+    int restarts;
+    int initLimit;
+    int rssSlack;
+    int drift;
+}WA_STEST_SOAK_config_t;
+
+/* reply counters, under cond */
+typedef struct
+{
+    void *cond;
+    void *commHandle;
+    unsigned int acks;
+    unsigned int finals; /* "eod"s and rejected requests */
+    unsigned int busy;
+    unsigned int failed;
+    unsigned int results; /* of the agent procedures */
+    unsigned int id;
+}WA_STEST_SOAK_context_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static int Pass(void *instanceHandle, void *initHandle, json_t **params);
+static int Fail(void *instanceHandle, void *initHandle, json_t **params);
+static int Slow(void *instanceHandle, void *initHandle, json_t **params);
+static void *AdapterInit(WA_COMM_adaptersConfig_t *config);
+static int AdapterExit(void *handle);
+static int Callback(void *cookie, json_t *json);
+static int Up(const WA_STEST_SOAK_config_t *pConfig);
+static int Down(void);
+static int Restarts(const WA_STEST_SOAK_config_t *pConfig);
+static int Soak(const WA_STEST_SOAK_config_t *pConfig);
+static int Run(uint64_t *pUs);
+static int Burst(int count);
+static int Send(const char *method, const char *params, bool notification);
+static int WaitFor(const unsigned int *pCounter, unsigned int target);
+static int Check(const WA_STEST_SOAK_usage_t *pBase, const WA_STEST_SOAK_usage_t *pNow);
+static void Settle(long threads, WA_STEST_SOAK_usage_t *pUsage);
+static void ReadUsage(WA_STEST_SOAK_usage_t *pUsage);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+static WA_COMM_adaptersConfig_t adapters[] =
+{
+    {"stest_soak", AdapterInit, AdapterExit, Callback, NULL, NULL},
+    {NULL, NULL, NULL, NULL, NULL, NULL}
+};
+
+/* the _status diags are the test run, the burst diags are the first BURST_DIAGS after them */
+static WA_DIAG_proceduresConfig_t diags[] =
+{
+    {"soak_pass_status", NULL, NULL, Pass, NULL, NULL, NULL, "SoakPass", NULL, 0},
+    {"soak_fail_status", NULL, NULL, Fail, NULL, NULL, NULL, "SoakFail", NULL, 0},
+    {"soak_slow_status", NULL, NULL, Slow, NULL, NULL, NULL, "SoakSlow", NULL, 0},
+    {"soak_burst_0", NULL, NULL, Pass, NULL, NULL, NULL, NULL, NULL, 0},
+    {"soak_burst_1", NULL, NULL, Pass, NULL, NULL, NULL, NULL, NULL, 0},
+    {"soak_burst_2", NULL, NULL, Slow, NULL, NULL, NULL, NULL, NULL, 0},
+    {"soak_burst_3", NULL, NULL, Fail, NULL, NULL, NULL, NULL, NULL, 0},
+    {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, 0}
+};
+
+#define RUN_DIAGS 3
+
+static WA_STEST_SOAK_context_t soak;
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+int WA_STEST_SOAK_Run(void)
+{
+    int status = 0;
+    json_t *jconfig;
+    WA_STEST_SOAK_config_t config =
+    {
+        DEFAULT_RUNS, DEFAULT_BURST, DEFAULT_SAMPLE, DEFAULT_RESTARTS,
+        DEFAULT_INIT_LIMIT, DEFAULT_RSS_SLACK, DEFAULT_DRIFT
+    };
+
+    WA_ENTER("WA_STEST_SOAK_Run()\n");
+
+    if(json_unpack(WA_CONFIG_GetSection("stest"), "{s:o}", "soak", &jconfig) != 0)
+    {
+        WA_INFO("WA_STEST_SOAK_Run(): not configured, skipped\n");
+        goto end;
+    }
+
+    if(json_unpack(jconfig, "{s?i,s?i,s?i,s?i,s?i,s?i,s?i}",
+            "runs", &config.runs, "burst", &config.burst, "sample", &config.sample,
+            "restarts", &config.restarts, "init_limit", &config.initLimit,
+            "rss_slack", &config.rssSlack, "drift", &config.drift) ||
+       (config.sample < 1) || (config.runs < 3 * config.sample) || (config.burst < 0) || (config.restarts < 0))
+    {
+        WA_ERROR("WA_STEST_SOAK_Run(): invalid config, runs must be at least 3 samples\n");
+        status = -1;
+        goto end;
+    }
+
+    soak.cond = WA_OSA_CondCreate();
+    if(soak.cond == NULL)
+    {
+        WA_ERROR("WA_STEST_SOAK_Run(): WA_OSA_CondCreate() error\n");
+        status = -1;
+        goto end;
+    }
+
+    status = WA_THROTTLE_Init(WA_CONFIG_GetSection("throttle"));
+    if(status != 0)
+    {
+        WA_ERROR("WA_STEST_SOAK_Run(): WA_THROTTLE_Init(): %d\n", status);
+        goto err_throttle;
+    }
+
+    status = WA_METRICS_Init(WA_CONFIG_GetSection("metrics"));
+    if(status != 0)
+    {
+        WA_ERROR("WA_STEST_SOAK_Run(): WA_METRICS_Init(): %d\n", status);
+        goto err_metrics;
+    }
+
+    status = Restarts(&config);
+    if(status == 0)
+    {
+        status = Soak(&config);
+    }
+
+    WA_METRICS_Exit();
+err_metrics:
+    WA_THROTTLE_Exit();
+
+err_throttle:
+    WA_OSA_CondDestroy(soak.cond);
+end:
+    WA_RETURN("WA_STEST_SOAK_Run(): %d\n", status);
+    return status;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+static int Pass(void *instanceHandle, void *initHandle, json_t **params)
+{
+    (void)instanceHandle;
+    (void)initHandle;
+    (void)params;
+
+    return WA_DIAG_ERRCODE_SUCCESS;
+}
+
+static int Fail(void *instanceHandle, void *initHandle, json_t **params)
+{
+    (void)instanceHandle;
+    (void)initHandle;
+
+    json_decref(*params);
+    *params = json_string("simulated failure");
+    return WA_DIAG_ERRCODE_FAILURE;
+}
+
+static int Slow(void *instanceHandle, void *initHandle, json_t **params)
+{
+    (void)instanceHandle;
+    (void)initHandle;
+
+    WA_OSA_TaskSleep(SLOW_MS);
+
+    json_decref(*params);
+    *params = json_pack("{s:i}", "slept", SLOW_MS);
+    return WA_DIAG_ERRCODE_SUCCESS;
+}
+
+static void *AdapterInit(WA_COMM_adaptersConfig_t *config)
+{
+    soak.commHandle = WA_COMM_Register(config, &soak);
+    return soak.commHandle;
+}
+
+static int AdapterExit(void *handle)
+{
+    soak.commHandle = NULL;
+    return WA_COMM_Unregister(handle);
+}
+
+static int Callback(void *cookie, json_t *json)
+{
+    WA_STEST_SOAK_context_t *pContext = (WA_STEST_SOAK_context_t *)cookie;
+    const char *method, *message, *diag;
+
+    WA_OSA_CondLock(pContext->cond);
+    if(json_unpack(json, "{s:s}", "method", &method) == 0)
+    {
+        pContext->finals += !strcmp(method, "eod");
+    }
+    else if(json_unpack(json, "{s:{s:n,s:s}}", "result", "diag", "message", &message) == 0)
+    {
+        ++pContext->finals;
+        if(!strcmp(message, BUSY_MESSAGE))
+        {
+            ++pContext->busy;
+        }
+        else
+        {
+            WA_ERROR("Callback(): rejected: %s\n", message);
+            ++pContext->failed;
+        }
+    }
+    else if(json_unpack(json, "{s:{s:s}}", "result", "diag", &diag) == 0)
+    {
+        ++pContext->acks;
+    }
+    else
+    {
+        /* a procedure result, or an error that takes its place */
+        pContext->failed += (json_object_get(json, "error") != NULL);
+        ++pContext->results;
+    }
+    WA_OSA_CondSignalBroadcast(pContext->cond);
+    WA_OSA_CondUnlock(pContext->cond);
+
+    json_decref(json);
+    return 0;
+}
+
+static int Up(const WA_STEST_SOAK_config_t *pConfig)
+{
+    uint64_t start = WA_METRICS_Now(), ms;
+    int status;
+
+    status = WA_INIT_Init(adapters, diags);
+    ms = (WA_METRICS_Now() - start) / 1000;
+    if(status != 0)
+    {
+        WA_ERROR("Up(): WA_INIT_Init(): %d\n", status);
+        return -1;
+    }
+
+    WA_INFO("Up(): init in %llu ms\n", (unsigned long long)ms);
+    if(ms > (uint64_t)pConfig->initLimit)
+    {
+        WA_ERROR("Up(): init took %llu ms, limit %d ms\n", (unsigned long long)ms, pConfig->initLimit);
+        Down();
+        return -1;
+    }
+    return 0;
+}
+
+static int Down(void)
+{
+    int status = WA_INIT_Exit();
+
+    if(status != 0)
+    {
+        WA_ERROR("Down(): WA_INIT_Exit(): %d\n", status);
+    }
+    return status;
+}
+
+/* Each restart must come back to the usage before the first one */
+static int Restarts(const WA_STEST_SOAK_config_t *pConfig)
+{
+    WA_STEST_SOAK_usage_t base, now;
+    int i;
+
+    ReadUsage(&base);
+    for(i = 0; i < pConfig->restarts; ++i)
+    {
+        if((Up(pConfig) != 0) || (Run(NULL) != 0) || (Down() != 0))
+        {
+            WA_ERROR("Restarts(): restart %d failed\n", i);
+            return -1;
+        }
+
+        Settle(base.threads, &now);
+        if(Check(&base, &now) != 0)
+        {
+            WA_ERROR("Restarts(): leak after restart %d\n", i);
+            return -1;
+        }
+    }
+
+    WA_INFO("Restarts(): %d restarts: PASS\n", pConfig->restarts);
+    return 0;
+}
+
+static int Soak(const WA_STEST_SOAK_config_t *pConfig)
+{
+    WA_STEST_SOAK_usage_t base, now;
+    uint64_t us, sum = 0, reference = 0;
+    long rss = 0;
+    int run, sample, rises = 0, status = -1;
+
+    if(Up(pConfig) != 0)
+    {
+        return -1;
+    }
+
+    memset(&base, 0, sizeof(base));
+    for(run = 1; run <= pConfig->runs; ++run)
+    {
+        if((Run(&us) != 0) || (Burst(pConfig->burst) != 0))
+        {
+            WA_ERROR("Soak(): run %d failed\n", run);
+            goto end;
+        }
+        sum += us;
+
+        if(run % pConfig->sample)
+        {
+            continue;
+        }
+
+        sample = run / pConfig->sample;
+        Settle(sample == 1 ? -1 : base.threads, &now);
+        WA_INFO("Soak(): sample %d: rss %ld kB, threads %ld, fds %ld, queues %ld, run %llu us\n",
+                sample, now.rss, now.threads, now.fds, now.queues,
+                (unsigned long long)(sum / pConfig->sample));
+
+        if(sample == 1)
+        {
+            /* the first runs open what is kept open, this is the baseline */
+            base = now;
+        }
+        else if(Check(&base, &now) != 0)
+        {
+            goto end;
+        }
+
+        /* the first sample may include the cold start, the second one is the reference */
+        if(sample == 2)
+        {
+            reference = sum / pConfig->sample;
+        }
+        else if((sample > 2) && (sum / pConfig->sample > reference * (100 + pConfig->drift) / 100) &&
+                (sum / pConfig->sample > reference + DRIFT_FLOOR))
+        {
+            WA_ERROR("Soak(): run time drifted from %llu us to %llu us\n",
+                    (unsigned long long)reference, (unsigned long long)(sum / pConfig->sample));
+            goto end;
+        }
+
+        rises = (sample > 1) && (now.rss > rss) ? rises + 1 : 0;
+        rss = now.rss;
+        if((rises >= RSS_RISES) || (now.rss - base.rss > pConfig->rssSlack))
+        {
+            WA_ERROR("Soak(): RSS grew from %ld kB to %ld kB\n", base.rss, now.rss);
+            goto end;
+        }
+        sum = 0;
+    }
+
+    WA_INFO("Soak(): %d runs with bursts of %d: PASS\n", pConfig->runs, pConfig->burst);
+    status = 0;
+
+end:
+    if(Down() != 0)
+    {
+        status = -1;
+    }
+    return status;
+}
+
+/* A test run of the _status diags, one after the other like the client does */
+static int Run(uint64_t *pUs)
+{
+    uint64_t start = WA_METRICS_Now();
+    unsigned int finals, results, busy, failed;
+    int i;
+
+    WA_OSA_CondLock(soak.cond);
+    finals = soak.finals;
+    results = soak.results;
+    busy = soak.busy;
+    failed = soak.failed;
+    WA_OSA_CondUnlock(soak.cond);
+
+    if(Send("TESTRUN", "{\"state\":\"start\",\"client\":\"stest\"}", true) != 0)
+    {
+        return -1;
+    }
+
+    for(i = 0; i < RUN_DIAGS; ++i)
+    {
+        if((Send(diags[i].name, "{}", false) != 0) || (WaitFor(&soak.finals, ++finals) != 0))
+        {
+            WA_ERROR("Run(): %s: no result\n", diags[i].name);
+            return -1;
+        }
+    }
+
+    /* the METRICS answer comes after the TESTRUN finish is done */
+    if((Send("TESTRUN", "{\"state\":\"finish\"}", true) != 0) ||
+       (Send("METRICS", "{}", false) != 0) ||
+       (WaitFor(&soak.results, results + 1) != 0))
+    {
+        WA_ERROR("Run(): test run not finished\n");
+        return -1;
+    }
+
+    if(pUs)
+    {
+        *pUs = WA_METRICS_Now() - start;
+    }
+
+    /* the previous instance of a diag must be gone by its next run */
+    WA_OSA_CondLock(soak.cond);
+    busy = soak.busy - busy;
+    failed = soak.failed - failed;
+    WA_OSA_CondUnlock(soak.cond);
+    if(busy || failed)
+    {
+        WA_ERROR("Run(): %u busy, %u failed\n", busy, failed);
+        return -1;
+    }
+    return 0;
+}
+
+/* Requests without waiting, each is either run or rejected as busy */
+static int Burst(int count)
+{
+    unsigned int finals, failed;
+    int i;
+
+    WA_OSA_CondLock(soak.cond);
+    finals = soak.finals;
+    failed = soak.failed;
+    WA_OSA_CondUnlock(soak.cond);
+
+    for(i = 0; i < count; ++i)
+    {
+        if(Send(diags[RUN_DIAGS + i % BURST_DIAGS].name, "{}", false) != 0)
+        {
+            return -1;
+        }
+    }
+
+    if(WaitFor(&soak.finals, finals + count) != 0)
+    {
+        WA_ERROR("Burst(): replies missing\n");
+        return -1;
+    }
+
+    WA_OSA_CondLock(soak.cond);
+    failed = soak.failed - failed;
+    WA_OSA_CondUnlock(soak.cond);
+    return failed ? -1 : 0;
+}
+
+static int Send(const char *method, const char *params, bool notification)
+{
+    char msg[MSG_MAX];
+    int len;
+
+    if(notification)
+    {
+        len = snprintf(msg, sizeof(msg), "{\"jsonrpc\":\"2.0\",\"method\":\"%s\",\"params\":%s,\"id\":null}",
+                method, params);
+    }
+    else
+    {
+        len = snprintf(msg, sizeof(msg), "{\"jsonrpc\":\"2.0\",\"method\":\"%s\",\"params\":%s,\"id\":%u}",
+                method, params, ++soak.id);
+    }
+
+    if(WA_COMM_SendTxt(soak.commHandle, msg, len) != 0)
+    {
+        WA_ERROR("Send(): WA_COMM_SendTxt(%s) error\n", method);
+        return -1;
+    }
+    return 0;
+}
+
+static int WaitFor(const unsigned int *pCounter, unsigned int target)
+{
+    int status = 0;
+
+    WA_OSA_CondLock(soak.cond);
+    while(((int)(*pCounter - target) < 0) && (status == 0))
+    {
+        status = WA_OSA_CondTimedWait(soak.cond, REPLY_TIMEOUT);
+    }
+    WA_OSA_CondUnlock(soak.cond);
+
+    return status;
+}
+
+static int Check(const WA_STEST_SOAK_usage_t *pBase, const WA_STEST_SOAK_usage_t *pNow)
+{
+    int status = 0;
+
+    if(pNow->threads != pBase->threads)
+    {
+        WA_ERROR("Check(): threads %ld, were %ld\n", pNow->threads, pBase->threads);
+        status = -1;
+    }
+    if(pNow->fds != pBase->fds)
+    {
+        WA_ERROR("Check(): fds %ld, were %ld\n", pNow->fds, pBase->fds);
+        status = -1;
+    }
+    if(pNow->queues != pBase->queues)
+    {
+        WA_ERROR("Check(): queues %ld, were %ld\n", pNow->queues, pBase->queues);
+        status = -1;
+    }
+    if(pNow->depth || (pNow->mqLeft > 0))
+    {
+        /* DELIA-49685 */
+        WA_ERROR("Check(): %ld messages, %ld bytes left in the queues\n", pNow->depth, pNow->mqLeft);
+        status = -1;
+    }
+    return status;
+}
+
+/* The usage at rest: the queues are empty and the instance tasks are joined, threads -1 for any */
+static void Settle(long threads, WA_STEST_SOAK_usage_t *pUsage)
+{
+    int waited;
+
+    for(waited = 0; ; waited += SETTLE_STEP)
+    {
+        ReadUsage(pUsage);
+        if(((threads < 0) || (pUsage->threads <= threads)) && (pUsage->depth == 0) && (pUsage->mqLeft <= 0))
+        {
+            break;
+        }
+        if(waited >= SETTLE_TIMEOUT)
+        {
+            break;
+        }
+        WA_OSA_TaskSleep(SETTLE_STEP);
+    }
+}
+
+static void ReadUsage(WA_STEST_SOAK_usage_t *pUsage)
+{
+    WA_OSA_QStats_t stats[QUEUES_MAX];
+    char line[128], path[PATH_MAX];
+    struct dirent *pEntry;
+    FILE *f;
+    DIR *d;
+    long size;
+    size_t n, i;
+
+    memset(pUsage, 0, sizeof(*pUsage));
+
+    f = fopen("/proc/self/status", "r");
+    if(f != NULL)
+    {
+        while(fgets(line, sizeof(line), f))
+        {
+            sscanf(line, "VmRSS: %ld", &pUsage->rss);
+            sscanf(line, "Threads: %ld", &pUsage->threads);
+        }
+        fclose(f);
+    }
+
+    d = opendir("/proc/self/fd");
+    if(d != NULL)
+    {
+        while((pEntry = readdir(d)) != NULL)
+        {
+            pUsage->fds += (pEntry->d_name[0] != '.');
+        }
+        closedir(d);
+    }
+
+    n = WA_OSA_QGetStats(stats, QUEUES_MAX);
+    pUsage->queues = n;
+    for(i = 0; (i < n) && (i < QUEUES_MAX); ++i)
+    {
+        pUsage->depth += stats[i].depth;
+    }
+
+    /* the queues are named, what is left in them outlives the agent */
+    pUsage->mqLeft = -1;
+    d = opendir(MQUEUE_DIR);
+    if(d != NULL)
+    {
+        pUsage->mqLeft = 0;
+        while((pEntry = readdir(d)) != NULL)
+        {
+            if(strncmp(pEntry->d_name, MQUEUE_PREFIX, sizeof(MQUEUE_PREFIX) - 1))
+            {
+                continue;
+            }
+            snprintf(path, sizeof(path), MQUEUE_DIR "/%s", pEntry->d_name);
+            f = fopen(path, "r");
+            if(f != NULL)
+            {
+                if(fscanf(f, "QSIZE:%ld", &size) == 1)
+                {
+                    pUsage->mqLeft += size;
+                }
+                fclose(f);
+            }
+        }
+        closedir(d);
+    }
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
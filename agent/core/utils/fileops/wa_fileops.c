@@ -42,6 +42,7 @@
 #include "wa_fileops.h"
 #include "wa_debug.h"
 #include "wa_osa.h"
+#include "wa_sim.h"
 
 /*****************************************************************************
  * GLOBAL VARIABLE DEFINITIONS
@@ -161,7 +162,7 @@ int WA_UTILS_FILEOPS_OptionSupported(const char *file, const char *mode, const c
 
     (void)memset(buff, 0x00, sizeof(buff));
 
-    fd = fopen(file, mode);
+    fd = fopen(WA_UTILS_SIM_PATH(file), mode);
     if(fd == NULL)
     {
         return -1;
@@ -200,7 +201,7 @@ char *WA_UTILS_FILEOPS_OptionFind(const char *fname, const char *pattern)
     char result[LINE_LEN];
     char *line = NULL;
 
-    if ((fd = fopen(fname,"r")) == NULL)
+    if ((fd = fopen(WA_UTILS_SIM_PATH(fname),"r")) == NULL)
     {
         return NULL;
     }
@@ -241,7 +242,7 @@ char **WA_UTILS_FILEOPS_OptionFindMultiple(const char *fname, const char *patter
         return NULL;
     }
 
-    if ((fd = fopen(fname,"r")) == NULL)
+    if ((fd = fopen(WA_UTILS_SIM_PATH(fname),"r")) == NULL)
     {
         return NULL;
     }
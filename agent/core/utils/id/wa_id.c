@@ -21,6 +21,9 @@
  * @file wa_id.c
  *
  * @brief This file contains functions for generation of unique id.
+ *
+ * Taken ids are kept in a three level bitmap, so finding a free id takes
+ * a few find-first-set operations whatever the number of ids taken.
  */
 
 /** @addtogroup WA_UTILS_ID
@@ -32,6 +35,7 @@
 /*****************************************************************************
  * STANDARD INCLUDE FILES
  *****************************************************************************/
+#include <string.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
@@ -39,6 +43,7 @@
 #include "wa_debug.h"
 #include "wa_id.h"
 #include "wa_osa.h"
+#include "wa_slab.h"
 
 /*****************************************************************************
  * GLOBAL VARIABLE DEFINITIONS
@@ -47,9 +52,12 @@
 /*****************************************************************************
  * LOCAL DEFINITIONS
  *****************************************************************************/
-#define PREPROCESSOR_ASSERT(x) (void)(sizeof(char[-!(x)]))
+#define BIT(n) ((uint64_t)1 << (n))
+#define PAGE_SIZE (64 * sizeof(void *))
 
-#define NONULL 0x80000000
+/* valid bits of a level 1 word and of the level 2 word, the ranges may not fill them */
+#define L1_MASK(w1) ((WA_UTILS_ID_L0_WORDS - (w1) * 64 >= 64) ? ~(uint64_t)0 : (BIT(WA_UTILS_ID_L0_WORDS % 64) - 1))
+#define L2_MASK ((WA_UTILS_ID_L1_WORDS >= 64) ? ~(uint64_t)0 : (BIT(WA_UTILS_ID_L1_WORDS % 64) - 1))
 
 /*****************************************************************************
  * LOCAL TYPES
@@ -59,6 +67,7 @@ static WA_UTILS_ID_box_t idBox;
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
+static long FindFree(const WA_UTILS_ID_box_t *pBox, unsigned long from);
 
 /*****************************************************************************
  * LOCAL VARIABLE DECLARATIONS
@@ -83,7 +92,7 @@ int WA_UTILS_ID_Init()
     {
         WA_ERROR("WA_UTILS_ID_Init(): WA_OSA_MutexCreate(): error\n");
     }
-    WA_UTILS_LIST_ClearList(idBox.list);
+    WA_UTILS_ID_ClearUnsafe(&idBox);
 end:
     WA_RETURN("WA_UTILS_ID_Init(): %d\n", (idMutex == NULL));
     return (idMutex == NULL);
@@ -94,11 +103,14 @@ int WA_UTILS_ID_Exit()
     int status;
     WA_ENTER("WA_UTILS_ID_Exit()\n");
 
+    WA_UTILS_ID_ClearUnsafe(&idBox);
+
     status = WA_OSA_MutexDestroy(idMutex);
     if(status != 0)
     {
         WA_ERROR("WA_UTILS_ID_Exit(): WA_OSA_MutexDestroy(): %d\n", status);
     }
+    idMutex = NULL;
     WA_RETURN("WA_UTILS_ID_Exit(): %d\n", status);
     return status;
 }
@@ -159,100 +171,178 @@ end:
 int WA_UTILS_ID_GenerateUnsafe(WA_UTILS_ID_box_t *pBox, WA_UTILS_ID_t *pId)
 {
     int status = -1;
-    void *iterator;
-    WA_UTILS_LIST_t *pList = &(pBox->list);
-    WA_UTILS_ID_t eid;
-    int idPrev = -1;
-    void *iteratorAfterFree = WA_UTILS_LIST_NO_ELEM;
+    long id;
+    unsigned long w0, w1;
 
     WA_ENTER("WA_UTILS_ID_GenerateUnsafe(pBox=%p, pId=%p)\n", pBox, pId);
 
-    /* WARNING: Check against WA_UTILS_LIST_t that internally uses array of a fixed size */
-    PREPROCESSOR_ASSERT((WA_UTILS_ID_t)(-1) >= WA_UTILS_LIST_MAX_LIST_SIZE-1);
-
-    if(WA_UTILS_LIST_ElemCount(pList) > (WA_UTILS_ID_t)(-1))
+    /* go on after the last generated id, so a released id is not reused at once */
+    id = FindFree(pBox, ((unsigned long)pBox->id + 1) % WA_UTILS_ID_COUNT);
+    if(id < 0)
     {
         WA_ERROR("WA_UTILS_ID_GenerateUnsafe(): ID limit exceeded.\n");
         goto end;
     }
 
-    ++(pBox->id);
-    for(iterator = WA_UTILS_LIST_FrontIterator(pList);
-        iterator != WA_UTILS_LIST_NO_ELEM;
-        iterator = WA_UTILS_LIST_NextIterator(pList, iterator))
+    w0 = id / 64;
+    w1 = w0 / 64;
+    pBox->l0[w0] |= BIT(id % 64);
+    if(pBox->l0[w0] == ~(uint64_t)0)
     {
-        eid = (WA_UTILS_ID_t)((uintptr_t)WA_UTILS_LIST_DataAtIterator(pList, iterator) & ~NONULL);
-        if(iteratorAfterFree == WA_UTILS_LIST_NO_ELEM)
-        {
-            if(idPrev != eid-1)
-            {
-                iteratorAfterFree = iterator;
-            }
-            else
-            {
-                idPrev = eid;
-            }
-        }
-        if(pBox->id == eid)
-        {
-            ++(pBox->id);
-        }
-        else if(pBox->id < eid)
+        pBox->l1[w1] |= BIT(w0 % 64);
+        if(pBox->l1[w1] == L1_MASK(w1))
         {
-            iterator = WA_UTILS_LIST_InsertBefore(pList, iterator, (void *)(uintptr_t)(pBox->id | NONULL));
-            if(iterator == WA_UTILS_LIST_NO_ELEM)
-            {
-                WA_ERROR("WA_UTILS_ID_GenerateUnsafe(): WA_UTILS_LIST_InsertBefore() error\n");
-                goto end;
-            }
-            status = 0;
-            goto ok;
+            pBox->l2 |= BIT(w1);
         }
     }
-    if((pBox->id == 0) && (iteratorAfterFree != WA_UTILS_LIST_NO_ELEM))
+    pBox->count++;
+    pBox->id = (WA_UTILS_ID_t)id;
+
+    *pId = pBox->id;
+    WA_DBG("WA_UTILS_ID_GenerateUnsafe(): id=%d\n", pBox->id);
+    status = 0;
+end:
+    WA_RETURN("WA_UTILS_ID_GenerateUnsafe(): %d\n", status);
+    return status;
+}
+
+int WA_UTILS_ID_ReleaseUnsafe(WA_UTILS_ID_box_t *pBox, WA_UTILS_ID_t id)
+{
+    int status = -1;
+    unsigned long w0 = id / 64, w1 = w0 / 64;
+
+    WA_ENTER("WA_UTILS_ID_ReleaseUnsafe(pBox=%p, id=%d)\n", pBox, id);
+
+    if(!(pBox->l0[w0] & BIT(id % 64)))
     {
-        pBox->id = idPrev+1;
-        iterator = WA_UTILS_LIST_InsertBefore(pList, iteratorAfterFree, (void *)(uintptr_t)(pBox->id | NONULL));
-        if(iterator == WA_UTILS_LIST_NO_ELEM)
-        {
-            WA_ERROR("WA_UTILS_ID_GenerateUnsafe(): WA_UTILS_LIST_InsertBefore() error\n");
-            goto end;
-        }
+        WA_ERROR("WA_UTILS_ID_ReleaseUnsafe(): id %d not taken\n", id);
+        goto end;
     }
-    else
+
+    pBox->l0[w0] &= ~BIT(id % 64);
+    pBox->l1[w1] &= ~BIT(w0 % 64);
+    pBox->l2 &= ~BIT(w1);
+    pBox->count--;
+
+    if(pBox->owners[w0] != NULL)
     {
-        iterator = WA_UTILS_LIST_AddBack(pList, (void *)(uintptr_t)(pBox->id | NONULL));
-        if(iterator == WA_UTILS_LIST_NO_ELEM)
+        pBox->owners[w0][id % 64] = NULL;
+        if(pBox->l0[w0] == 0)
         {
-            WA_ERROR("WA_UTILS_ID_GenerateUnsafe(): WA_UTILS_LIST_AddBack() error\n");
-            goto end;
+            WA_UTILS_SLAB_Free(pBox->owners[w0], PAGE_SIZE);
+            pBox->owners[w0] = NULL;
         }
     }
-ok:
-    *pId = pBox->id;
-    WA_INFO("WA_UTILS_ID_GenerateUnsafe(): id=%d\n", pBox->id);
     status = 0;
 end:
-    WA_RETURN("WA_UTILS_ID_GenerateUnsafe(): %d\n", status);
+    WA_RETURN("WA_UTILS_ID_ReleaseUnsafe(): %d\n", status);
     return status;
 }
 
-int WA_UTILS_ID_ReleaseUnsafe(WA_UTILS_ID_box_t *pBox, WA_UTILS_ID_t id)
+int WA_UTILS_ID_SetOwnerUnsafe(WA_UTILS_ID_box_t *pBox, WA_UTILS_ID_t id, void *pOwner)
 {
-    WA_UTILS_LIST_t *pList = &(pBox->list);
+    unsigned long w0 = id / 64;
 
-    WA_ENTER("WA_UTILS_ID_ReleaseUnsafe(pBox=%p, id=%d)\n", pBox, id);
-
-    WA_UTILS_LIST_Remove(pList, (void *)(uintptr_t)(id | NONULL));
+    if(!(pBox->l0[w0] & BIT(id % 64)))
+    {
+        WA_ERROR("WA_UTILS_ID_SetOwnerUnsafe(): id %d not taken\n", id);
+        return -1;
+    }
 
-    WA_RETURN("WA_UTILS_ID_ReleaseUnsafe(): 0\n");
+    if(pBox->owners[w0] == NULL)
+    {
+        pBox->owners[w0] = WA_UTILS_SLAB_Alloc(PAGE_SIZE);
+        if(pBox->owners[w0] == NULL)
+        {
+            WA_ERROR("WA_UTILS_ID_SetOwnerUnsafe(): WA_UTILS_SLAB_Alloc() error\n");
+            return -1;
+        }
+        memset(pBox->owners[w0], 0, PAGE_SIZE);
+    }
+    pBox->owners[w0][id % 64] = pOwner;
     return 0;
 }
 
+void *WA_UTILS_ID_GetOwnerUnsafe(const WA_UTILS_ID_box_t *pBox, WA_UTILS_ID_t id)
+{
+    unsigned long w0 = id / 64;
+
+    if(!(pBox->l0[w0] & BIT(id % 64)) || (pBox->owners[w0] == NULL))
+    {
+        return NULL;
+    }
+    return pBox->owners[w0][id % 64];
+}
+
+void WA_UTILS_ID_ClearUnsafe(WA_UTILS_ID_box_t *pBox)
+{
+    unsigned long w0;
+
+    for(w0 = 0; w0 < WA_UTILS_ID_L0_WORDS; w0++)
+    {
+        if(pBox->owners[w0] != NULL)
+        {
+            WA_UTILS_SLAB_Free(pBox->owners[w0], PAGE_SIZE);
+        }
+    }
+    memset(pBox, 0, sizeof(*pBox));
+}
+
 /*****************************************************************************
  * LOCAL FUNCTIONS
  *****************************************************************************/
 
+/* Finds the first free id at or after \c from, wrapping around, -1 if all are taken. */
+static long FindFree(const WA_UTILS_ID_box_t *pBox, unsigned long from)
+{
+    unsigned long w0, w1;
+    uint64_t m;
+    int pass;
+
+    for(pass = 0; pass < 2; pass++, from = 0)
+    {
+        /* rest of the level 0 word */
+        w0 = from / 64;
+        m = ~pBox->l0[w0] & (~(uint64_t)0 << (from % 64));
+        if(m)
+        {
+            return w0 * 64 + __builtin_ctzll(m);
+        }
+
+        /* rest of the level 1 word */
+        w0++;
+        w1 = w0 / 64;
+        if(w0 % 64)
+        {
+            m = (w0 < WA_UTILS_ID_L0_WORDS) ? ~pBox->l1[w1] & L1_MASK(w1) & (~(uint64_t)0 << (w0 % 64)) : 0;
+            if(m)
+            {
+                w0 = w1 * 64 + __builtin_ctzll(m);
+                return w0 * 64 + __builtin_ctzll(~pBox->l0[w0]);
+            }
+            w1++;
+        }
+
+        /* rest of the level 2 word */
+        if(w1 < WA_UTILS_ID_L1_WORDS)
+        {
+            m = ~pBox->l2 & L2_MASK & (~(uint64_t)0 << w1);
+            if(m)
+            {
+                w1 = __builtin_ctzll(m);
+                w0 = w1 * 64 + __builtin_ctzll(~pBox->l1[w1] & L1_MASK(w1));
+                return w0 * 64 + __builtin_ctzll(~pBox->l0[w0]);
+            }
+        }
+
+        if(from == 0)
+        {
+            break;
+        }
+    }
+    return -1;
+}
+
 /* End of doxygen group */
 /*! @} */
 
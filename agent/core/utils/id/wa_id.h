@@ -36,7 +36,6 @@
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
  *****************************************************************************/
-#include "wa_list_api.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -46,7 +45,20 @@ extern "C"
 /*****************************************************************************
  * EXPORTED DEFINITIONS
  *****************************************************************************/
+#ifdef WA_STEST
+#define WA_UTILS_ID_BITS 8
+#else
+#define WA_UTILS_ID_BITS 16
+#endif
 
+/** Number of ids in a box */
+#define WA_UTILS_ID_COUNT (1UL << WA_UTILS_ID_BITS)
+
+/* Allocation bitmap levels: a bit of level 1 is set when the 64 ids of
+ * the level 0 word are all taken, a bit of level 2 when the level 1 word is full.
+ */
+#define WA_UTILS_ID_L0_WORDS (WA_UTILS_ID_COUNT / 64)
+#define WA_UTILS_ID_L1_WORDS ((WA_UTILS_ID_L0_WORDS + 63) / 64)
 
 /*****************************************************************************
  * EXPORTED TYPES
@@ -59,11 +71,17 @@ typedef uint8_t WA_UTILS_ID_t;
 typedef uint16_t WA_UTILS_ID_t;
 #endif
 
-/** Id container that might be used individually by \c WA_UTILS_ID_GenerateUnsafe() */
+/** Id container that might be used individually by \c WA_UTILS_ID_GenerateUnsafe().
+ * A zeroed box is empty.
+ */
 typedef struct
 {
-    WA_UTILS_ID_t id;
-    WA_UTILS_LIST_t list;
+    WA_UTILS_ID_t id; /**< the last generated id, the search for a free one starts after it */
+    unsigned long count; /**< ids taken */
+    uint64_t l2;
+    uint64_t l1[WA_UTILS_ID_L1_WORDS];
+    uint64_t l0[WA_UTILS_ID_L0_WORDS]; /**< a bit set for every id taken */
+    void **owners[WA_UTILS_ID_L0_WORDS]; /**< owners of the ids, 64 per page, pages allocated on demand */
 }WA_UTILS_ID_box_t;
 
 
@@ -133,6 +151,36 @@ extern int WA_UTILS_ID_GenerateUnsafe(WA_UTILS_ID_box_t *pBox, WA_UTILS_ID_t *pI
  */
 extern int WA_UTILS_ID_ReleaseUnsafe(WA_UTILS_ID_box_t *pBox, WA_UTILS_ID_t id);
 
+/**
+ * @brief Attach an owner to a generated id, thread-unsafe.
+ * The owner is detached when the id is released.
+ *
+ * @param pBox pointer to the id box
+ * @param id the id
+ * @param pOwner the owner, e.g. the context the id was generated for
+ *
+ * @retval 0  success
+ * @retval !=0 error, the id is not taken
+ */
+extern int WA_UTILS_ID_SetOwnerUnsafe(WA_UTILS_ID_box_t *pBox, WA_UTILS_ID_t id, void *pOwner);
+
+/**
+ * @brief Look up the owner of an id, thread-unsafe.
+ *
+ * @param pBox pointer to the id box
+ * @param id the id
+ *
+ * @return the owner, NULL if the id is not taken or has no owner
+ */
+extern void *WA_UTILS_ID_GetOwnerUnsafe(const WA_UTILS_ID_box_t *pBox, WA_UTILS_ID_t id);
+
+/**
+ * @brief Release all ids and owner pages of a box, thread-unsafe.
+ *
+ * @param pBox pointer to the id box
+ */
+extern void WA_UTILS_ID_ClearUnsafe(WA_UTILS_ID_box_t *pBox);
+
 #ifdef __cplusplus
 }
 #endif
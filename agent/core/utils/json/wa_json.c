@@ -56,6 +56,7 @@
  *****************************************************************************/
 
 static bool vNestedSet(json_t * object, json_t * value, const char * firstKey, va_list vl);
+static int RpcValidateBatch(json_t **pJson);
 
 /*****************************************************************************
  * LOCAL VARIABLE DECLARATIONS
@@ -86,6 +87,12 @@ int WA_UTILS_JSON_RpcValidate(json_t **pJson)
         goto end;
     }
 
+    if(json_is_array(*pJson))
+    {
+        status = RpcValidateBatch(pJson);
+        goto end;
+    }
+
     /* check for "id" */
     status = json_unpack(*pJson, "{s:o}", "id", &jId); //reference to jId is NOT modified
     if(status != 0)
@@ -213,6 +220,54 @@ extern bool WA_UTILS_JSON_NestedSetNew(json_t * object, json_t * value, const ch
  * LOCAL FUNCTIONS
  *****************************************************************************/
 
+static int RpcValidateBatch(json_t **pJson)
+{
+    int status, valid = 0;
+    size_t index;
+    json_t *jElem, *jout;
+
+    if(json_array_size(*pJson) == 0)
+    {
+        WA_ERROR("RpcValidateBatch(): empty batch\n");
+        jout = json_pack("{s:s,s:{s:i,s:s},s:n}", "jsonrpc", "2.0", "error", "code", -32600, "message", "Invalid Request", "id");
+        json_decref(*pJson);
+        *pJson = jout;
+        return jout ? 1 : -1;
+    }
+
+    json_array_foreach(*pJson, index, jElem)
+    {
+        json_incref(jElem);
+        if(json_is_array(jElem))
+        {
+            /* nested batches are not allowed */
+            json_decref(jElem);
+            jElem = json_pack("{s:s,s:{s:i,s:s},s:n}", "jsonrpc", "2.0", "error", "code", -32600, "message", "Invalid Request", "id");
+            status = jElem ? 1 : -1;
+        }
+        else
+        {
+            status = WA_UTILS_JSON_RpcValidate(&jElem);
+        }
+        if(status < 0)
+        {
+            WA_ERROR("RpcValidateBatch(): element %zu internal error\n", index);
+            json_decref(*pJson);
+            *pJson = NULL;
+            return -1;
+        }
+        if(status == 0)
+        {
+            ++valid;
+        }
+        /* the element reference is stolen back by the array */
+        json_array_set_new(*pJson, index, jElem);
+    }
+
+    WA_DBG("RpcValidateBatch(): %d of %zu requests valid\n", valid, json_array_size(*pJson));
+    return valid ? 0 : 1;
+}
+
 static bool vNestedSet(json_t * object, json_t * value, const char * firstKey, va_list vl)
 {
     const char * key = NULL;
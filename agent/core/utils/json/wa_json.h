@@ -65,6 +65,10 @@ extern "C"
 /**
  * @brief Validates json against json-rpc
  *
+ * A batch (array of requests) is validated element by element. Each invalid element
+ * is replaced in place by its error response, so the batch keeps its order. The batch
+ * is only rejected as a whole when it is empty or none of its elements is valid.
+ *
  * @param pJson pointer to there the newly created object is returned
  *
  * @retval 0 success (\c pJson is a \c json_t object, it must be applied to \n json_decref() by the caller)
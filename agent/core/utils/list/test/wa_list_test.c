@@ -16,40 +16,61 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
 */
+
+
+/* Unit test and benchmark of the list, build on the host with:
+ *   gcc -std=gnu99 -O2 -pthread -I.. -I../../slab wa_list_test.c ../wa_list_api.c ../../slab/wa_slab.c
+ */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include "wa_list_api.h"
+#include "wa_slab.h"
 
+#define CHECK(x) do { if(!(x)) { printf("HWST_DBG |FAILED %s:%d: %s\n", __FILE__, __LINE__, #x); return -1; } } while(0)
 
-int main(void)
+/* the fixed size list this one replaced: 128 elements of {int, 3 pointers} in every head */
+#define OLD_LIST_SIZE (128 * 4 * sizeof(void *) + 4 * sizeof(void *))
+
+#define BENCH_ELEMS 1000
+#define BENCH_ROUNDS 1000
+
+typedef struct
 {
-    LIST_t list;
-    int *p;
+    unsigned int id;
+    char payload[60];
+}Item_t;
+
+static long long NowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int TestOrder(void)
+{
+    WA_UTILS_LIST_t list;
+    int *p, expected[] = { 4, 5, 3 }, i = 0;
     void *listIterator = WA_UTILS_LIST_NO_ELEM;
 
-    LIST_Purge(&list);
+    WA_UTILS_LIST_Init(&list);
 
     p = WA_UTILS_LIST_AllocAddBack(&list, sizeof(int));
-    if(p == NULL)
-    {
-        goto end;
-    }
+    CHECK(p != NULL);
     *p = 3;
 
-    p = WA_UTILS_LIST_AllocInsertBefore(&list, listIterator, sizeof(int));
-    if(p == NULL)
-    {
-        goto end;
-    }
+    p = WA_UTILS_LIST_AllocInsertBefore(&list, WA_UTILS_LIST_FrontIterator(&list), sizeof(int));
+    CHECK(p != NULL);
     *p = 4;
 
     listIterator = WA_UTILS_LIST_FrontIterator(&list);
     listIterator = WA_UTILS_LIST_NextIterator(&list, listIterator);
 
     p = WA_UTILS_LIST_AllocInsertBefore(&list, listIterator, sizeof(int));
-    if(p == NULL)
-    {
-        goto end;
-    }
+    CHECK(p != NULL);
     *p = 5;
 
     for(listIterator = WA_UTILS_LIST_FrontIterator(&list);
@@ -57,12 +78,197 @@ int main(void)
             listIterator = WA_UTILS_LIST_NextIterator(&list, listIterator))
     {
         p = WA_UTILS_LIST_DataAtIterator(&list, listIterator);
-        printf("HWST_DBG |elem: %d\n", *p);
+        CHECK(*p == expected[i++]);
+    }
+    CHECK(WA_UTILS_LIST_ElemCount(&list) == 3);
+
+    /* back to front */
+    for(listIterator = WA_UTILS_LIST_FrontIterator(&list);
+            WA_UTILS_LIST_NextIterator(&list, listIterator) != WA_UTILS_LIST_NO_ELEM;
+            listIterator = WA_UTILS_LIST_NextIterator(&list, listIterator))
+        ;
+    for(i = 2; listIterator != WA_UTILS_LIST_NO_ELEM; listIterator = WA_UTILS_LIST_PrevIterator(&list, listIterator))
+    {
+        CHECK(*(int *)WA_UTILS_LIST_DataAtIterator(&list, listIterator) == expected[i--]);
+    }
+
+    WA_UTILS_LIST_AllocPurge(&list);
+    CHECK(WA_UTILS_LIST_ElemCount(&list) == 0);
+    CHECK(WA_UTILS_LIST_FrontIterator(&list) == WA_UTILS_LIST_NO_ELEM);
+    return 0;
+}
+
+static int TestRemove(void)
+{
+    WA_UTILS_LIST_t list, other;
+    Item_t *items[8];
+    int values[4] = { 1, 2, 3, 4 };
+    void *it;
+    int i;
+
+    WA_UTILS_LIST_Init(&list);
+    WA_UTILS_LIST_Init(&other);
+
+    for(i = 0; i < 8; i++)
+    {
+        items[i] = WA_UTILS_LIST_AllocAddBack(&list, sizeof(Item_t));
+        CHECK(items[i] != NULL);
+        items[i]->id = i;
+    }
+
+    /* front, back, middle */
+    WA_UTILS_LIST_AllocRemove(&list, items[0]);
+    WA_UTILS_LIST_AllocRemove(&list, items[7]);
+    WA_UTILS_LIST_AllocRemove(&list, items[4]);
+    CHECK(WA_UTILS_LIST_ElemCount(&list) == 5);
+
+    /* not owned by the other list */
+    WA_UTILS_LIST_AllocRemove(&other, items[1]);
+    CHECK(WA_UTILS_LIST_ElemCount(&list) == 5);
+
+    it = WA_UTILS_LIST_FrontIterator(&list);
+    CHECK(((Item_t *)WA_UTILS_LIST_DataAtIterator(&list, it))->id == 1);
+    it = WA_UTILS_LIST_RemoveAtIterator(&list, it);
+    CHECK(((Item_t *)WA_UTILS_LIST_DataAtIterator(&list, it))->id == 2);
+    CHECK(WA_UTILS_LIST_ElemCount(&list) == 4);
+    WA_UTILS_LIST_AllocPurge(&list);
+
+    /* entries not owned by the list */
+    for(i = 0; i < 4; i++)
+    {
+        CHECK(WA_UTILS_LIST_AddBack(&other, &values[i]) == &values[i]);
     }
-    printf("HWST_DBG |Num: %d\n", WA_UTILS_LIST_ElemCount(&list));
-    LIST_AllocPurge(&list);
-    printf("HWST_DBG |Num: %d\n", WA_UTILS_LIST_ElemCount(&list));
-    end:
-    LIST_AllocPurge(&list);
+    CHECK(WA_UTILS_LIST_AddBack(&other, NULL) == NULL);
+    WA_UTILS_LIST_Remove(&other, &values[2]);
+    WA_UTILS_LIST_Remove(&other, &values[2]);
+    CHECK(WA_UTILS_LIST_ElemCount(&other) == 3);
+    it = WA_UTILS_LIST_FrontIterator(&other);
+    WA_UTILS_LIST_ReplaceAtIterator(&other, it, &values[2]);
+    CHECK(WA_UTILS_LIST_DataAtIterator(&other, it) == &values[2]);
+    WA_UTILS_LIST_Purge(&other);
+    CHECK(WA_UTILS_LIST_ElemCount(&other) == 0);
+    return 0;
+}
+
+static int TestGrowth(void)
+{
+    WA_UTILS_LIST_t list;
+    WA_UTILS_SLAB_Stats_t stats;
+    Item_t *p;
+    void *it;
+    unsigned int i, slabs;
+
+    WA_UTILS_LIST_Init(&list);
+    WA_UTILS_SLAB_GetStats(&stats);
+    slabs = stats.slabs;
+
+    /* well over the old fixed capacity of 128 */
+    for(i = 0; i < 4 * BENCH_ELEMS; i++)
+    {
+        p = WA_UTILS_LIST_AllocAddBack(&list, sizeof(Item_t));
+        CHECK(p != NULL);
+        p->id = i;
+    }
+    CHECK(WA_UTILS_LIST_ElemCount(&list) == 4 * BENCH_ELEMS);
+    for(i = 0, it = WA_UTILS_LIST_FrontIterator(&list); it != WA_UTILS_LIST_NO_ELEM; it = WA_UTILS_LIST_NextIterator(&list, it), i++)
+    {
+        CHECK(((Item_t *)WA_UTILS_LIST_DataAtIterator(&list, it))->id == i);
+    }
+    WA_UTILS_LIST_AllocPurge(&list);
+
+    /* empty slabs are given back, except a spare one per size class */
+    WA_UTILS_SLAB_GetStats(&stats);
+    CHECK(stats.objects == 0);
+    CHECK(stats.slabs <= slabs + 1);
+    return 0;
+}
+
+static void Footprint(void)
+{
+    WA_UTILS_LIST_t lists[16];
+    WA_UTILS_SLAB_Stats_t stats;
+    unsigned int i, j, counts[] = { 0, 1, 4, 16, 128 };
+    size_t before;
+
+    for(i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        WA_UTILS_SLAB_GetStats(&stats);
+        before = stats.reserved;
+        for(j = 0; j < 16; j++)
+        {
+            WA_UTILS_LIST_Init(&lists[j]);
+            while(WA_UTILS_LIST_ElemCount(&lists[j]) < counts[i])
+            {
+                WA_UTILS_LIST_AllocAddBack(&lists[j], sizeof(Item_t));
+            }
+        }
+        WA_UTILS_SLAB_GetStats(&stats);
+        /* both with the entries, malloc() overhead of the fixed pool entries not counted */
+        printf("HWST_DBG |footprint: 16 lists x %3u elems: %7zu B (fixed pool: %7zu B)\n",
+                counts[i], 16 * sizeof(WA_UTILS_LIST_t) + stats.reserved - before,
+                16 * (OLD_LIST_SIZE + counts[i] * sizeof(Item_t)));
+        for(j = 0; j < 16; j++)
+        {
+            WA_UTILS_LIST_AllocPurge(&lists[j]);
+        }
+    }
+}
+
+static void Throughput(void)
+{
+    WA_UTILS_LIST_t list;
+    Item_t *items[BENCH_ELEMS];
+    unsigned long long sum = 0;
+    long long t;
+    void *it;
+    unsigned int r, i;
+
+    WA_UTILS_LIST_Init(&list);
+
+    t = NowNs();
+    for(r = 0; r < BENCH_ROUNDS; r++)
+    {
+        for(i = 0; i < BENCH_ELEMS; i++)
+        {
+            items[i] = WA_UTILS_LIST_AllocAddBack(&list, sizeof(Item_t));
+            items[i]->id = i;
+        }
+        /* remove in an order unrelated to insertion */
+        for(i = 0; i < BENCH_ELEMS; i++)
+        {
+            WA_UTILS_LIST_AllocRemove(&list, items[(i * 7919) % BENCH_ELEMS]);
+        }
+    }
+    t = NowNs() - t;
+    printf("HWST_DBG |add+remove: %.1f ns/op\n", (double)t / (2.0 * BENCH_ROUNDS * BENCH_ELEMS));
+
+    for(i = 0; i < BENCH_ELEMS; i++)
+    {
+        items[i] = WA_UTILS_LIST_AllocAddBack(&list, sizeof(Item_t));
+        items[i]->id = i;
+    }
+    t = NowNs();
+    for(r = 0; r < BENCH_ROUNDS; r++)
+    {
+        for(it = WA_UTILS_LIST_FrontIterator(&list); it != WA_UTILS_LIST_NO_ELEM; it = WA_UTILS_LIST_NextIterator(&list, it))
+        {
+            sum += ((Item_t *)WA_UTILS_LIST_DataAtIterator(&list, it))->id;
+        }
+    }
+    t = NowNs() - t;
+    printf("HWST_DBG |iterate: %.1f ns/elem (sum %llu)\n", (double)t / ((double)BENCH_ROUNDS * BENCH_ELEMS), sum);
+    WA_UTILS_LIST_AllocPurge(&list);
+}
+
+int main(void)
+{
+    if((TestOrder() != 0) || (TestRemove() != 0) || (TestGrowth() != 0))
+    {
+        return 1;
+    }
+    printf("HWST_DBG |tests passed\n");
+
+    Footprint();
+    Throughput();
     return 0;
 }
@@ -21,6 +21,10 @@
  * @file wa_list_api.c
  *
  * @brief This is the LIST api
+ *
+ * An embedded entry follows its node in the same slab object:
+ *
+ *     [ WA_UTILS_LIST_Node_t | padding | entry ]
  */
 
 /** @defgroup  WA_UTILS_LIST_API LIST public API
@@ -33,15 +37,21 @@
  *****************************************************************************/
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
  *****************************************************************************/
 #include "wa_list_api.h"
+#include "wa_slab.h"
 
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
+static WA_UTILS_LIST_Node_t *NewNode(WA_UTILS_LIST_t *pList, void *pElem, size_t elemSize);
+static void Link(WA_UTILS_LIST_t *pList, WA_UTILS_LIST_Node_t *pNode, WA_UTILS_LIST_Node_t *pBefore);
+static void Unlink(WA_UTILS_LIST_t *pList, WA_UTILS_LIST_Node_t *pNode);
+static void FreeNode(WA_UTILS_LIST_Node_t *pNode, int freeData);
 
 /*****************************************************************************
  * GLOBAL VARIABLE DEFINITIONS
@@ -50,7 +60,9 @@
 /*****************************************************************************
  * LOCAL DEFINITIONS
  *****************************************************************************/
-#define WA_UTILS_LIST_FROM_POINTER(p) (*(WA_UTILS_LIST(void) *)(p))
+#define DATA_OFFSET ((sizeof(WA_UTILS_LIST_Node_t) + 15) & ~(size_t)15)
+#define NODE_OF(p) ((WA_UTILS_LIST_Node_t *)((char *)(p) - DATA_OFFSET))
+
 /*****************************************************************************
  * LOCAL TYPES
  *****************************************************************************/
@@ -65,87 +77,72 @@
 
 /**
  */
-void WA_UTILS_LIST_Purge(void *pList)
+void WA_UTILS_LIST_Init(void *pList)
 {
-    WA_UTILS_LIST_ClearList(WA_UTILS_LIST_FROM_POINTER(pList));
+    memset(pList, 0, sizeof(WA_UTILS_LIST_t));
 }
 
 /**
  */
-void WA_UTILS_LIST_AllocPurge(void *pList)
+void WA_UTILS_LIST_Purge(void *pList)
 {
-    WA_UTILS_LIST_ELM(void) *pListIterator;
-    void *p;
+    WA_UTILS_LIST_t *pL = (WA_UTILS_LIST_t *)pList;
+    WA_UTILS_LIST_Node_t *pNode, *pNext;
 
-    for(pListIterator = WA_UTILS_LIST_FrontListIterator(WA_UTILS_LIST_FROM_POINTER(pList));
-            pListIterator != WA_UTILS_LIST_NO_ENTRY;
-            pListIterator = WA_UTILS_LIST_NextElem(pListIterator))
+    for(pNode = pL->pFront; pNode != NULL; pNode = pNext)
     {
-        p = WA_UTILS_LIST_Pdata(pListIterator);
-        if(p != NULL)
-        {
-            free(p);
-        }
+        pNext = pNode->pNext;
+        FreeNode(pNode, 0);
     }
-    WA_UTILS_LIST_ClearList(WA_UTILS_LIST_FROM_POINTER(pList));
+    WA_UTILS_LIST_Init(pList);
 }
 
 /**
  */
-void *WA_UTILS_LIST_AddBack(void *pList, void *pElem)
+void WA_UTILS_LIST_AllocPurge(void *pList)
 {
-    unsigned int i;
+    WA_UTILS_LIST_t *pL = (WA_UTILS_LIST_t *)pList;
+    WA_UTILS_LIST_Node_t *pNode, *pNext;
 
-    i = WA_UTILS_LIST_GetListCount(WA_UTILS_LIST_FROM_POINTER(pList));
-    WA_UTILS_LIST_AddListBack(WA_UTILS_LIST_FROM_POINTER(pList), pElem);
-    if(WA_UTILS_LIST_GetListCount(WA_UTILS_LIST_FROM_POINTER(pList)) == i)
+    for(pNode = pL->pFront; pNode != NULL; pNode = pNext)
     {
-        pElem = NULL;
+        pNext = pNode->pNext;
+        FreeNode(pNode, 1);
     }
-    return pElem;
+    WA_UTILS_LIST_Init(pList);
 }
 
 /**
  */
-void *WA_UTILS_LIST_AllocAddBack(void *pList, size_t elemSize)
+void *WA_UTILS_LIST_AddBack(void *pList, void *pElem)
 {
-    unsigned int i;
-    void *p;
+    return WA_UTILS_LIST_InsertBefore(pList, WA_UTILS_LIST_NO_ELEM, pElem);
+}
 
-    p = malloc(elemSize); /* Consideration: use memalign() if needed */
-    if(p != NULL)
-    {
-        i = WA_UTILS_LIST_GetListCount(WA_UTILS_LIST_FROM_POINTER(pList));
-        WA_UTILS_LIST_AddListBack(WA_UTILS_LIST_FROM_POINTER(pList), p);
-        if(WA_UTILS_LIST_GetListCount(WA_UTILS_LIST_FROM_POINTER(pList)) == i)
-        {
-            free(p);
-            p = NULL;
-        }
-    }
-    return p;
+/**
+ */
+void *WA_UTILS_LIST_AllocAddBack(void *pList, size_t elemSize)
+{
+    return WA_UTILS_LIST_AllocInsertBefore(pList, WA_UTILS_LIST_NO_ELEM, elemSize);
 }
 
 /**
  */
 void *WA_UTILS_LIST_InsertBefore(void *pList, void *iterator, void *pElem)
 {
-    unsigned int i;
+    WA_UTILS_LIST_Node_t *pNode;
 
-    i = WA_UTILS_LIST_GetListCount(WA_UTILS_LIST_FROM_POINTER(pList));
-    if(iterator != WA_UTILS_LIST_NO_ENTRY)
-    {
-        WA_UTILS_LIST_InsertListFront(WA_UTILS_LIST_FROM_POINTER(pList),
-                (WA_UTILS_LIST_ELM(void) *)iterator, pElem);
-    }
-    else
+    if(pElem == NULL)
     {
-        WA_UTILS_LIST_AddListBack(WA_UTILS_LIST_FROM_POINTER(pList), pElem);
+        return NULL;
     }
-    if(WA_UTILS_LIST_GetListCount(WA_UTILS_LIST_FROM_POINTER(pList)) == i)
+
+    pNode = NewNode((WA_UTILS_LIST_t *)pList, pElem, 0);
+    if(pNode == NULL)
     {
-        pElem = NULL;
+        return NULL;
     }
+    Link((WA_UTILS_LIST_t *)pList, pNode, (WA_UTILS_LIST_Node_t *)iterator);
     return pElem;
 }
 
@@ -153,67 +150,81 @@ void *WA_UTILS_LIST_InsertBefore(void *pList, void *iterator, void *pElem)
  */
 void *WA_UTILS_LIST_AllocInsertBefore(void *pList, void *iterator, size_t elemSize)
 {
-    unsigned int i;
-    void *p;
+    WA_UTILS_LIST_Node_t *pNode;
 
-    p = malloc(elemSize); /* Consideration: use memalign() if needed */
-    if(p != NULL)
+    pNode = NewNode((WA_UTILS_LIST_t *)pList, NULL, elemSize);
+    if(pNode == NULL)
     {
-        i = WA_UTILS_LIST_GetListCount(WA_UTILS_LIST_FROM_POINTER(pList));
-        if(iterator != WA_UTILS_LIST_NO_ENTRY)
-        {
-            WA_UTILS_LIST_InsertListFront(WA_UTILS_LIST_FROM_POINTER(pList),
-                    (WA_UTILS_LIST_ELM(void) *)iterator, p);
-        }
-        else
-        {
-            WA_UTILS_LIST_AddListBack(WA_UTILS_LIST_FROM_POINTER(pList), p);
-        }
-        if(WA_UTILS_LIST_GetListCount(WA_UTILS_LIST_FROM_POINTER(pList)) == i)
-        {
-            free(p);
-            p = NULL;
-        }
+        return NULL;
     }
-    return p;
+    Link((WA_UTILS_LIST_t *)pList, pNode, (WA_UTILS_LIST_Node_t *)iterator);
+    return pNode->pData;
 }
 
 /**
  */
 void WA_UTILS_LIST_Remove(void *pList, void *pElem)
 {
-    WA_UTILS_LIST_RemoveList(WA_UTILS_LIST_FROM_POINTER(pList), pElem);
+    WA_UTILS_LIST_Node_t *pNode;
+
+    if(pElem == NULL)
+    {
+        return;
+    }
+
+    for(pNode = ((WA_UTILS_LIST_t *)pList)->pFront; pNode != NULL; pNode = pNode->pNext)
+    {
+        if(pNode->pData == pElem)
+        {
+            Unlink((WA_UTILS_LIST_t *)pList, pNode);
+            FreeNode(pNode, 0);
+            break;
+        }
+    }
 }
 
 /**
  */
 void WA_UTILS_LIST_AllocRemove(void *pList, void *elem)
 {
-    WA_UTILS_LIST_ELM(void) *pListIterator;
-    void *p;
+    WA_UTILS_LIST_Node_t *pNode;
 
-    for(pListIterator = WA_UTILS_LIST_FrontListIterator(WA_UTILS_LIST_FROM_POINTER(pList));
-            pListIterator != WA_UTILS_LIST_NO_ENTRY;
-            pListIterator = WA_UTILS_LIST_NextElem(pListIterator))
+    if(elem == NULL)
     {
-        p = WA_UTILS_LIST_Pdata(pListIterator);
-        if(p == elem)
-        {
-            if(p != NULL)
-            {
-                free(p);
-            }
-            WA_UTILS_LIST_RemoveList(WA_UTILS_LIST_FROM_POINTER(pList), p);
-            break;
-        }
+        return;
+    }
+
+    pNode = NODE_OF(elem);
+    if((pNode->pList != pList) || (pNode->pData != elem) || (pNode->size == 0))
+    {
+        return;
     }
+    Unlink((WA_UTILS_LIST_t *)pList, pNode);
+    FreeNode(pNode, 1);
+}
+
+/**
+ */
+void *WA_UTILS_LIST_RemoveAtIterator(void *pList, void *iterator)
+{
+    WA_UTILS_LIST_Node_t *pNode = (WA_UTILS_LIST_Node_t *)iterator;
+    WA_UTILS_LIST_Node_t *pNext;
+
+    if(pNode == NULL)
+    {
+        return WA_UTILS_LIST_NO_ELEM;
+    }
+    pNext = pNode->pNext;
+    Unlink((WA_UTILS_LIST_t *)pList, pNode);
+    FreeNode(pNode, 0);
+    return pNext;
 }
 
 /**
  */
 void *WA_UTILS_LIST_FrontIterator(void *pList)
 {
-    return (void *)WA_UTILS_LIST_FrontListIterator(WA_UTILS_LIST_FROM_POINTER(pList));
+    return ((WA_UTILS_LIST_t *)pList)->pFront;
 }
 
 /**
@@ -221,7 +232,7 @@ void *WA_UTILS_LIST_FrontIterator(void *pList)
 void *WA_UTILS_LIST_NextIterator(void *pList, void *iterator)
 {
     (void)(pList); //unused
-    return (void *) WA_UTILS_LIST_NextElem((WA_UTILS_LIST_ELM(void) *)iterator);
+    return iterator ? ((WA_UTILS_LIST_Node_t *)iterator)->pNext : WA_UTILS_LIST_NO_ELEM;
 }
 
 /**
@@ -229,16 +240,20 @@ void *WA_UTILS_LIST_NextIterator(void *pList, void *iterator)
 void *WA_UTILS_LIST_PrevIterator(void *pList, void *iterator)
 {
     (void)(pList); //unused
-    return (void *) WA_UTILS_LIST_PrevElem((WA_UTILS_LIST_ELM(void) *)iterator);
+    return iterator ? ((WA_UTILS_LIST_Node_t *)iterator)->pPrev : WA_UTILS_LIST_NO_ELEM;
 }
 
 /**
  */
 void WA_UTILS_LIST_ReplaceAtIterator(void *pList, void *iterator, void *pElem)
 {
-    if(iterator)
+    WA_UTILS_LIST_Node_t *pNode = (WA_UTILS_LIST_Node_t *)iterator;
+
+    (void)(pList); //unused
+    /* an embedded entry cannot be replaced, it is the node itself */
+    if(pNode && (pNode->size == 0))
     {
-        ((WA_UTILS_LIST_ELM(void) *)iterator)->pData = pElem;
+        pNode->pData = pElem;
     }
 }
 
@@ -247,20 +262,95 @@ void WA_UTILS_LIST_ReplaceAtIterator(void *pList, void *iterator, void *pElem)
 void *WA_UTILS_LIST_DataAtIterator(void *pList, void *iterator)
 {
     (void)(pList); //unused
-    return (void *) WA_UTILS_LIST_Pdata((WA_UTILS_LIST_ELM(void) *)iterator);
+    return iterator ? ((WA_UTILS_LIST_Node_t *)iterator)->pData : WA_UTILS_LIST_NO_ELEM;
 }
 
 /**
  */
 unsigned int WA_UTILS_LIST_ElemCount(void *pList)
 {
-    return WA_UTILS_LIST_GetListCount(WA_UTILS_LIST_FROM_POINTER(pList));
+    return ((WA_UTILS_LIST_t *)pList)->numElements;
 }
 
 /*****************************************************************************
  * LOCAL FUNCTIONS
  *****************************************************************************/
 
+static WA_UTILS_LIST_Node_t *NewNode(WA_UTILS_LIST_t *pList, void *pElem, size_t elemSize)
+{
+    WA_UTILS_LIST_Node_t *pNode;
+    size_t size = elemSize ? DATA_OFFSET + elemSize : sizeof(WA_UTILS_LIST_Node_t);
+
+    pNode = (WA_UTILS_LIST_Node_t *)WA_UTILS_SLAB_Alloc(size);
+    if(pNode == NULL)
+    {
+        return NULL;
+    }
+    pNode->pList = pList;
+    pNode->size = elemSize ? size : 0;
+    pNode->pData = elemSize ? (char *)pNode + DATA_OFFSET : pElem;
+    return pNode;
+}
+
+static void Link(WA_UTILS_LIST_t *pList, WA_UTILS_LIST_Node_t *pNode, WA_UTILS_LIST_Node_t *pBefore)
+{
+    pNode->pNext = pBefore;
+    pNode->pPrev = pBefore ? pBefore->pPrev : pList->pBack;
+    if(pNode->pPrev != NULL)
+    {
+        pNode->pPrev->pNext = pNode;
+    }
+    else
+    {
+        pList->pFront = pNode;
+    }
+    if(pBefore != NULL)
+    {
+        pBefore->pPrev = pNode;
+    }
+    else
+    {
+        pList->pBack = pNode;
+    }
+    pList->numElements++;
+}
+
+static void Unlink(WA_UTILS_LIST_t *pList, WA_UTILS_LIST_Node_t *pNode)
+{
+    if(pNode->pPrev != NULL)
+    {
+        pNode->pPrev->pNext = pNode->pNext;
+    }
+    else
+    {
+        pList->pFront = pNode->pNext;
+    }
+    if(pNode->pNext != NULL)
+    {
+        pNode->pNext->pPrev = pNode->pPrev;
+    }
+    else
+    {
+        pList->pBack = pNode->pPrev;
+    }
+    pNode->pList = NULL;
+    pList->numElements--;
+}
+
+static void FreeNode(WA_UTILS_LIST_Node_t *pNode, int freeData)
+{
+    if(pNode->size != 0)
+    {
+        /* the entry goes with its node */
+        WA_UTILS_SLAB_Free(pNode, pNode->size);
+        return;
+    }
+    if(freeData && (pNode->pData != NULL))
+    {
+        free(pNode->pData);
+    }
+    WA_UTILS_SLAB_Free(pNode, sizeof(WA_UTILS_LIST_Node_t));
+}
+
 /* End of doxygen group */
 /*! @} */
-
@@ -19,6 +19,12 @@
 
 /**
  * @file wa_list_api.h
+ *
+ * @brief Doubly linked list of pointers, growing on demand.
+ *
+ * List nodes come from the shared slab allocator (\c WA_UTILS_SLAB_Alloc()).
+ * The Alloc* functions place the entry in the same slab object as its node,
+ * so such an entry is removed in O(1) and iterating walks adjacent memory.
  */
 
 #ifndef WA_UTILS_LIST_API_H
@@ -31,11 +37,11 @@
 /*****************************************************************************
  * STANDARD INCLUDE FILES
  *****************************************************************************/
+#include <stddef.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
  *****************************************************************************/
-#include "wa_list.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -46,18 +52,28 @@ extern "C"
  * EXPORTED DEFINITIONS
  *****************************************************************************/
 
-/** Value for iterator if points at non existing entry.
- * Consideration: Currently the maximum list capacity is hardcoded as an array in list.h.
- */
-#define WA_UTILS_LIST_NO_ELEM WA_UTILS_LIST_NO_ENTRY
+/** Value for iterator if points at non existing entry. */
+#define WA_UTILS_LIST_NO_ELEM ((void *)0)
 
 /*****************************************************************************
  * EXPORTED TYPES
  *****************************************************************************/
-WA_UTILS_LIST_DECLARE_LIST_TYPE(void);
+typedef struct WA_UTILS_LIST_Node_tag
+{
+    struct WA_UTILS_LIST_Node_tag *pNext;
+    struct WA_UTILS_LIST_Node_tag *pPrev;
+    void *pData;
+    void *pList; /**< owner, checked by \c WA_UTILS_LIST_AllocRemove() */
+    size_t size; /**< slab object size, 0 if the entry is not embedded */
+}WA_UTILS_LIST_Node_t;
 
-/* list head used if static declaration is needed */
-typedef WA_UTILS_LIST(void) WA_UTILS_LIST_t;
+/** List head, a zeroed head is an empty list */
+typedef struct
+{
+    WA_UTILS_LIST_Node_t *pFront;
+    WA_UTILS_LIST_Node_t *pBack;
+    unsigned int numElements;
+}WA_UTILS_LIST_t;
 
 /*****************************************************************************
  * EXPORTED VARIABLES
@@ -67,12 +83,20 @@ typedef WA_UTILS_LIST(void) WA_UTILS_LIST_t;
  * EXPORTED FUNCTIONS
  *****************************************************************************/
 
+/**
+ * @brief Initialize an empty list, whatever it contained is not released
+ *
+ * @param pList pointer to the list head
+ */
+void WA_UTILS_LIST_Init(void *pList);
+
 /**
  * @brief Purge list
  *
  * @param pList valid pointer to the existing list
  *
- * @note This API will not \c free() list entries
+ * @note This API will not \c free() list entries,
+ *       entries embedded by the Alloc* functions are released with their nodes
  */
 void WA_UTILS_LIST_Purge(void *pList);
 
@@ -81,7 +105,8 @@ void WA_UTILS_LIST_Purge(void *pList);
  *
  * @param pList valid pointer to the existing list
  *
- * @note This API will \c free() all list entries first
+ * @note This API will \c free() all list entries first,
+ *       entries added by other than the Alloc* functions are passed to \c free()
  */
 void WA_UTILS_LIST_AllocPurge(void *pList);
 
@@ -140,15 +165,28 @@ void *WA_UTILS_LIST_AllocInsertBefore(void *pList, void *iterator, size_t elemSi
 void WA_UTILS_LIST_Remove(void *pList, void *pElem);
 
 /**
- * @brief Find and remove and deallocate list element if exists.
+ * @brief Remove and deallocate list element, O(1).
  *
  * @param pList pointer to the existing list
- * @param elem element to find and remove
+ * @param elem element returned by \c WA_UTILS_LIST_AllocAddBack() or
+ *             \c WA_UTILS_LIST_AllocInsertBefore() for this list
  *
  * @note Only the \c elem is deallocated, any internal sub-allocations must be removed before
  */
 void WA_UTILS_LIST_AllocRemove(void *pList, void *elem);
 
+/**
+ * @brief Remove the element at iterator, O(1).
+ *
+ * @param pList pointer to the existing list
+ * @param interator an iterator, invalid after the call
+ *
+ * @return an iterator of the next element
+ *
+ * @note An entry added by the Alloc* functions is deallocated with its node
+ */
+void *WA_UTILS_LIST_RemoveAtIterator(void *pList, void *iterator);
+
 /**
  * @brief Returns list front iterator.
  *
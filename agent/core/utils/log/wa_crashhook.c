@@ -0,0 +1,207 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+/**
+ * @file wa_crashhook.c
+ *
+ * @brief This file contains the hook of the fatal signals.
+ *
+ * Shared by the agent and the TR-181 profile, so it depends on the C library only.
+ */
+
+/** @addtogroup WA_UTILS_CRASHHOOK
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <string.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_crashhook.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+static const int crashSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+#define CRASH_SIGNALS (sizeof(crashSignals) / sizeof(crashSignals[0]))
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static int Hook(void);
+static void Unhook(void);
+static void CrashHandler(int sig, siginfo_t *info, void *ctx);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static WA_UTILS_CRASHHOOK_Callback_t callbacks[WA_UTILS_CRASHHOOK_MAX];
+static unsigned int registered;
+static int crashed;
+static struct sigaction oldActions[CRASH_SIGNALS];
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+int WA_UTILS_CRASHHOOK_Register(WA_UTILS_CRASHHOOK_Callback_t cb)
+{
+    int status = -1;
+    int i;
+
+    pthread_mutex_lock(&mutex);
+    for(i = 0; i < WA_UTILS_CRASHHOOK_MAX; i++)
+    {
+        if(callbacks[i] == NULL)
+        {
+            break;
+        }
+    }
+    if((i == WA_UTILS_CRASHHOOK_MAX) || ((registered == 0) && (Hook() != 0)))
+    {
+        goto end;
+    }
+    /* the handler may read the slot any time */
+    __atomic_store_n(&callbacks[i], cb, __ATOMIC_RELEASE);
+    registered++;
+    status = 0;
+
+    end:
+    pthread_mutex_unlock(&mutex);
+    return status;
+}
+
+void WA_UTILS_CRASHHOOK_Unregister(WA_UTILS_CRASHHOOK_Callback_t cb)
+{
+    int i;
+
+    pthread_mutex_lock(&mutex);
+    for(i = 0; i < WA_UTILS_CRASHHOOK_MAX; i++)
+    {
+        if(callbacks[i] == cb)
+        {
+            __atomic_store_n(&callbacks[i], NULL, __ATOMIC_RELEASE);
+            if(--registered == 0)
+            {
+                Unhook();
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+static int Hook(void)
+{
+    struct sigaction sa;
+    unsigned int i;
+
+    /* runs before the breakpad handler, which is installed earlier */
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = CrashHandler;
+    sa.sa_flags = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    for(i = 0; i < CRASH_SIGNALS; i++)
+    {
+        if(sigaction(crashSignals[i], &sa, &oldActions[i]) != 0)
+        {
+            while(i--)
+            {
+                sigaction(crashSignals[i], &oldActions[i], NULL);
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void Unhook(void)
+{
+    unsigned int i;
+
+    for(i = 0; i < CRASH_SIGNALS; i++)
+    {
+        sigaction(crashSignals[i], &oldActions[i], NULL);
+    }
+}
+
+static void CrashHandler(int sig, siginfo_t *info, void *ctx)
+{
+    WA_UTILS_CRASHHOOK_Callback_t cb;
+    unsigned int i;
+
+    /* a callback that faults itself goes straight to the previous handler */
+    if(__atomic_exchange_n(&crashed, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        for(i = 0; i < WA_UTILS_CRASHHOOK_MAX; i++)
+        {
+            cb = __atomic_load_n(&callbacks[i], __ATOMIC_ACQUIRE);
+            if(cb != NULL)
+            {
+                cb(sig);
+            }
+        }
+    }
+
+    /* hand over to the previous (breakpad) handler */
+    for(i = 0; i < CRASH_SIGNALS; i++)
+    {
+        if(crashSignals[i] != sig)
+        {
+            continue;
+        }
+        sigaction(sig, &oldActions[i], NULL);
+        if(oldActions[i].sa_flags & SA_SIGINFO)
+        {
+            oldActions[i].sa_sigaction(sig, info, ctx);
+        }
+        else if((oldActions[i].sa_handler != SIG_DFL) && (oldActions[i].sa_handler != SIG_IGN))
+        {
+            oldActions[i].sa_handler(sig);
+        }
+        else if(sig == SIGABRT)
+        {
+            raise(sig);
+        }
+        /* a fault is raised again on return, now with the previous action */
+        break;
+    }
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
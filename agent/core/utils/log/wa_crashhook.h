@@ -0,0 +1,106 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+/**
+ * @file wa_crashhook.h
+ *
+ * @brief This file contains the hook of the fatal signals, shared by the modules
+ * that save their state on a crash.
+ */
+
+/** @addtogroup WA_UTILS_CRASHHOOK
+ *  @{
+ */
+
+#ifndef WA_UTILS_CRASHHOOK_H
+#define WA_UTILS_CRASHHOOK_H
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED DEFINITIONS
+ *****************************************************************************/
+
+/** Max number of the callbacks registered at a time */
+#define WA_UTILS_CRASHHOOK_MAX 4
+
+/*****************************************************************************
+ * EXPORTED TYPES
+ *****************************************************************************/
+
+/**
+ * Crash callback, runs in the signal handler of the crashed task, so it may only
+ * do what is async-signal-safe enough for a dying process.
+ *
+ * @param sig the signal
+ */
+typedef void (*WA_UTILS_CRASHHOOK_Callback_t)(int sig);
+
+/*****************************************************************************
+ * EXPORTED VARIABLES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * Registers a callback for SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT.
+ *
+ * The first registration installs the handler. On the first crash the handler
+ * calls the callbacks in the registration order, then restores the previous
+ * (breakpad) actions and hands the signal over to them.
+ *
+ * @param cb the callback
+ *
+ * @retval 0 success.
+ * @retval -1 no free slot, or the handler could not be installed
+ */
+extern int WA_UTILS_CRASHHOOK_Register(WA_UTILS_CRASHHOOK_Callback_t cb);
+
+/**
+ * Unregisters a callback. The last one restores the previous actions.
+ *
+ * @param cb the callback
+ */
+extern void WA_UTILS_CRASHHOOK_Unregister(WA_UTILS_CRASHHOOK_Callback_t cb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_UTILS_CRASHHOOK_H */
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
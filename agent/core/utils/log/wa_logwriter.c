@@ -0,0 +1,574 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_logwriter.c
+ *
+ * @brief This file contains the asynchronous writer of the hwselftest.log.
+ *
+ * Shared by the agent and the TR-181 profile, so it depends on the C library only.
+ *
+ * The ring is a bounded MPSC queue of fixed size slots with per-slot sequence
+ * numbers. A producer claims the consecutive slots of its record with one CAS
+ * on the tail and publishes each slot by advancing its sequence. Only the
+ * writer task consumes, so a free last slot means the whole claim is free.
+ *
+ * The file size is counted locally and synced with the file once per
+ * CHECK_INTERVAL, which also notices a rotation by the other process. The
+ * rotation itself is done under flock() of the file, so only one of the
+ * processes renames it.
+ */
+
+/** @addtogroup WA_UTILS_LOGWRITER
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_logwriter.h"
+#include "wa_crashhook.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define SLOTS 256 /* must be a power of 2 */
+#define SLOT_SIZE 1024
+#define BATCH 64
+#define FILE_NAME_MAX 128
+#define HEADER_MAX 64
+#define FULL_WAIT 1000 /* [us] */
+#define IDLE_WAIT 1 /* [s] */
+#define FLUSH_TIMEOUT 2000 /* [ms] */
+#define CHECK_INTERVAL 1 /* [s] */
+#define FILE_MODE (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH)
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+typedef struct
+{
+    unsigned long seq;
+    unsigned int len;
+    char data[SLOT_SIZE];
+}WA_UTILS_LOGWRITER_Slot_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static void *WriterTask(void *p);
+static unsigned long Drain(unsigned long from, bool release);
+static void Wake(void);
+static void OpenFile(void);
+static void CheckFile(void);
+static void RotateFile(void);
+static void CrashDrain(int sig);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+static WA_UTILS_LOGWRITER_Slot_t slots[SLOTS];
+static unsigned long tail; /* next position to claim, producers */
+static unsigned long head; /* next position to write, writer task */
+
+static bool running;
+static bool stopping;
+static int inflight;
+static int sleeping;
+static sem_t wakeSem;
+static pthread_t writerThread;
+
+static char file[FILE_NAME_MAX];
+static bool toFile;
+static size_t maxSize;
+static int fd = -1;
+static size_t fileSize; /* written by both processes, as far as known */
+static ino_t fileIno;
+static time_t checkTime; /* CLOCK_MONOTONIC [s] */
+
+static bool hooked;
+
+static __thread time_t stampTime = (time_t)-1;
+static __thread char stamp[32];
+static __thread size_t stampLen;
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+int WA_UTILS_LOGWRITER_Init(const char *fileName, size_t size, bool hookCrash)
+{
+    unsigned long i;
+
+    if(running)
+    {
+        return 0;
+    }
+
+    for(i = 0; i < SLOTS; i++)
+    {
+        slots[i].seq = i;
+    }
+    head = tail = 0;
+
+    toFile = (fileName != NULL);
+    if(toFile)
+    {
+        snprintf(file, sizeof(file), "%s", fileName);
+    }
+    maxSize = size;
+    OpenFile();
+
+    if(sem_init(&wakeSem, 0, 0) != 0)
+    {
+        goto err_sem;
+    }
+
+    stopping = false;
+    if(pthread_create(&writerThread, NULL, WriterTask, NULL) != 0)
+    {
+        goto err_thread;
+    }
+
+    /* best effort, a missing hook only loses the tail of the log on a crash */
+    hooked = hookCrash && (WA_UTILS_CRASHHOOK_Register(CrashDrain) == 0);
+
+    __atomic_store_n(&running, true, __ATOMIC_RELEASE);
+    return 0;
+
+err_thread:
+    sem_destroy(&wakeSem);
+err_sem:
+    if(toFile && (fd >= 0))
+    {
+        close(fd);
+    }
+    fd = -1;
+    return -1;
+}
+
+int WA_UTILS_LOGWRITER_Exit(void)
+{
+    if(!__atomic_exchange_n(&running, false, __ATOMIC_ACQ_REL))
+    {
+        return 0;
+    }
+
+    /* producers that saw the writer running still get their records out */
+    while(__atomic_load_n(&inflight, __ATOMIC_ACQUIRE))
+    {
+        sched_yield();
+    }
+
+    __atomic_store_n(&stopping, true, __ATOMIC_RELEASE);
+    sem_post(&wakeSem);
+    pthread_join(writerThread, NULL);
+    sem_destroy(&wakeSem);
+
+    if(hooked)
+    {
+        WA_UTILS_CRASHHOOK_Unregister(CrashDrain);
+    }
+    hooked = false;
+
+    if(toFile && (fd >= 0))
+    {
+        close(fd);
+    }
+    fd = -1;
+    return 0;
+}
+
+int WA_UTILS_LOGWRITER_Write(const char *mark, const char *msg, bool eol)
+{
+    char header[HEADER_MAX];
+    const char *piece[3];
+    size_t pieceLen[3];
+    size_t total, n, off, chunk;
+    unsigned long pos, last, seq;
+    unsigned int p;
+    WA_UTILS_LOGWRITER_Slot_t *pSlot;
+
+    __atomic_add_fetch(&inflight, 1, __ATOMIC_ACQ_REL);
+    if(!__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+    {
+        __atomic_sub_fetch(&inflight, 1, __ATOMIC_RELEASE);
+        return -1;
+    }
+
+    piece[0] = header;
+    pieceLen[0] = mark ? WA_UTILS_LOGWRITER_Header(mark, header, sizeof(header)) : 0;
+    piece[1] = msg;
+    pieceLen[1] = strlen(msg);
+    piece[2] = "\n";
+    pieceLen[2] = eol ? 1 : 0;
+
+    total = pieceLen[0] + pieceLen[1] + pieceLen[2];
+    if(total > WA_UTILS_LOGWRITER_RECORD_MAX)
+    {
+        pieceLen[1] -= total - WA_UTILS_LOGWRITER_RECORD_MAX;
+        total = WA_UTILS_LOGWRITER_RECORD_MAX;
+    }
+    n = total ? (total + SLOT_SIZE - 1) / SLOT_SIZE : 1;
+
+    /* claim n consecutive slots */
+    pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+    for(;;)
+    {
+        last = pos + n - 1;
+        seq = __atomic_load_n(&slots[last & (SLOTS - 1)].seq, __ATOMIC_ACQUIRE);
+        if(seq == last)
+        {
+            if(__atomic_compare_exchange_n(&tail, &pos, pos + n, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if((long)(seq - last) < 0)
+        {
+            /* full, let the writer catch up */
+            Wake();
+            usleep(FULL_WAIT);
+            pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            pos = __atomic_load_n(&tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    /* fill and publish the slots in order */
+    p = 0;
+    off = 0;
+    for(last = pos; last != pos + n; last++)
+    {
+        pSlot = &slots[last & (SLOTS - 1)];
+        pSlot->len = 0;
+        while((pSlot->len < SLOT_SIZE) && (p < 3))
+        {
+            chunk = pieceLen[p] - off;
+            if(chunk > SLOT_SIZE - pSlot->len)
+            {
+                chunk = SLOT_SIZE - pSlot->len;
+            }
+            memcpy(pSlot->data + pSlot->len, piece[p] + off, chunk);
+            pSlot->len += chunk;
+            off += chunk;
+            if(off == pieceLen[p])
+            {
+                p++;
+                off = 0;
+            }
+        }
+        __atomic_store_n(&pSlot->seq, last + 1, __ATOMIC_RELEASE);
+    }
+
+    __atomic_sub_fetch(&inflight, 1, __ATOMIC_RELEASE);
+    Wake();
+    return 0;
+}
+
+void WA_UTILS_LOGWRITER_Flush(void)
+{
+    unsigned long pos;
+    int waited = 0;
+
+    if(!__atomic_load_n(&running, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    pos = __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+    while(((long)(__atomic_load_n(&head, __ATOMIC_ACQUIRE) - pos) < 0) && (waited < FLUSH_TIMEOUT))
+    {
+        Wake();
+        usleep(1000);
+        waited++;
+    }
+}
+
+size_t WA_UTILS_LOGWRITER_Header(const char *mark, char *buffer, size_t size)
+{
+    struct tm bdTime;
+    time_t now = time(NULL);
+    size_t markLen = strlen(mark);
+
+    if(now != stampTime)
+    {
+        gmtime_r(&now, &bdTime);
+        stampLen = strftime(stamp, sizeof(stamp), "%F %T ", &bdTime);
+        stampTime = now;
+    }
+
+    if(markLen + stampLen >= size)
+    {
+        if(size)
+        {
+            buffer[0] = '\0';
+        }
+        return 0;
+    }
+    memcpy(buffer, mark, markLen);
+    memcpy(buffer + markLen, stamp, stampLen + 1);
+    return markLen + stampLen;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+static void *WriterTask(void *p)
+{
+    struct timespec ts;
+    unsigned long from;
+
+    (void)p;
+
+    for(;;)
+    {
+        from = head;
+        if(Drain(from, true) != from)
+        {
+            continue;
+        }
+
+        if(__atomic_load_n(&stopping, __ATOMIC_ACQUIRE))
+        {
+            break;
+        }
+
+        /* announce the sleep, then look again so a record published meanwhile is not missed */
+        __atomic_store_n(&sleeping, 1, __ATOMIC_SEQ_CST);
+        if(__atomic_load_n(&slots[head & (SLOTS - 1)].seq, __ATOMIC_SEQ_CST) == head + 1)
+        {
+            __atomic_store_n(&sleeping, 0, __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_sec += IDLE_WAIT;
+        while((sem_timedwait(&wakeSem, &ts) != 0) && (errno == EINTR))
+            ;
+        __atomic_store_n(&sleeping, 0, __ATOMIC_SEQ_CST);
+    }
+
+    return NULL;
+}
+
+/* Writes the published records from the given position in batches, returns the next position.
+ * Called by the writer task, or by the crash handler with release false.
+ */
+static unsigned long Drain(unsigned long from, bool release)
+{
+    struct iovec iov[BATCH];
+    unsigned long pos = from, end, i;
+    WA_UTILS_LOGWRITER_Slot_t *pSlot;
+    size_t len, done;
+    ssize_t written;
+    int cnt, k;
+
+    for(;;)
+    {
+        cnt = 0;
+        len = 0;
+        end = pos;
+        while(cnt < BATCH)
+        {
+            pSlot = &slots[end & (SLOTS - 1)];
+            if(__atomic_load_n(&pSlot->seq, __ATOMIC_ACQUIRE) != end + 1)
+            {
+                break;
+            }
+            iov[cnt].iov_base = pSlot->data;
+            iov[cnt].iov_len = pSlot->len;
+            len += pSlot->len;
+            cnt++;
+            end++;
+        }
+        if(cnt == 0)
+        {
+            break;
+        }
+
+        if(release && toFile)
+        {
+            CheckFile();
+        }
+
+        for(k = 0, done = 0; (fd >= 0) && (done < len); )
+        {
+            written = writev(fd, iov + k, cnt - k);
+            if(written < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+            done += written;
+            /* skip what was written, resume within a partially written slot */
+            while((k < cnt) && ((size_t)written >= iov[k].iov_len))
+            {
+                written -= iov[k].iov_len;
+                k++;
+            }
+            if(k < cnt)
+            {
+                iov[k].iov_base = (char *)iov[k].iov_base + written;
+                iov[k].iov_len -= written;
+            }
+        }
+        fileSize += done;
+
+        if(release)
+        {
+            for(i = pos; i != end; i++)
+            {
+                __atomic_store_n(&slots[i & (SLOTS - 1)].seq, i + SLOTS, __ATOMIC_RELEASE);
+            }
+            __atomic_store_n(&head, end, __ATOMIC_RELEASE);
+
+            if(toFile && maxSize && (fileSize >= maxSize))
+            {
+                RotateFile();
+            }
+        }
+        pos = end;
+    }
+
+    return pos;
+}
+
+static void Wake(void)
+{
+    if(__atomic_exchange_n(&sleeping, 0, __ATOMIC_SEQ_CST))
+    {
+        sem_post(&wakeSem);
+    }
+}
+
+static void OpenFile(void)
+{
+    struct stat st;
+
+    if(!toFile)
+    {
+        fd = STDOUT_FILENO;
+        return;
+    }
+
+    if(fd >= 0)
+    {
+        close(fd);
+    }
+    fd = open(file, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, FILE_MODE);
+    if((fd >= 0) && (fstat(fd, &st) == 0))
+    {
+        fileSize = st.st_size;
+        fileIno = st.st_ino;
+    }
+    else
+    {
+        fileSize = 0;
+        fileIno = 0;
+    }
+}
+
+/* Picks up what the other process did to the file, at most once per CHECK_INTERVAL */
+static void CheckFile(void)
+{
+    struct timespec now;
+    struct stat st;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if((fd >= 0) && (now.tv_sec - checkTime < CHECK_INTERVAL))
+    {
+        return;
+    }
+    checkTime = now.tv_sec;
+
+    if(stat(file, &st) != 0)
+    {
+        /* removed */
+        if((fd < 0) || (errno == ENOENT))
+        {
+            OpenFile();
+        }
+    }
+    else if((fd < 0) || (st.st_ino != fileIno))
+    {
+        /* rotated */
+        OpenFile();
+    }
+    else if(st.st_size > (off_t)fileSize)
+    {
+        fileSize = st.st_size;
+    }
+}
+
+static void RotateFile(void)
+{
+    char rotated[FILE_NAME_MAX + 2];
+    struct stat st;
+    bool locked;
+
+    /* whoever gets the lock first renames the file, the other one finds it renamed and reopens */
+    locked = (fd >= 0) && (flock(fd, LOCK_EX) == 0);
+    if((stat(file, &st) == 0) && (st.st_ino == fileIno) && ((size_t)st.st_size >= maxSize))
+    {
+        snprintf(rotated, sizeof(rotated), "%s.1", file);
+        (void)rename(file, rotated);
+    }
+    if(locked)
+    {
+        (void)flock(fd, LOCK_UN);
+    }
+    OpenFile();
+}
+
+static void CrashDrain(int sig)
+{
+    /* the writer task may be stopped mid batch, at worst that batch is written twice */
+    (void)Drain(__atomic_load_n(&head, __ATOMIC_ACQUIRE), false);
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,137 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_logwriter.h
+ *
+ * @brief This file contains the asynchronous writer of the hwselftest.log.
+ */
+
+/** @addtogroup WA_UTILS_LOGWRITER
+ *  @{
+ */
+
+#ifndef WA_UTILS_LOGWRITER_H
+#define WA_UTILS_LOGWRITER_H
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stddef.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED DEFINITIONS
+ *****************************************************************************/
+#define WA_UTILS_LOGWRITER_FILE "/opt/logs/hwselftest.log"
+
+/** Size at which the log file is rotated to "<file>.1", in [B] */
+#define WA_UTILS_LOGWRITER_MAX_SIZE (2 * 1024 * 1024)
+
+/** Longest record accepted by \c WA_UTILS_LOGWRITER_Write(), longer ones are truncated */
+#define WA_UTILS_LOGWRITER_RECORD_MAX (64 * 1024)
+
+/*****************************************************************************
+ * EXPORTED TYPES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * EXPORTED VARIABLES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * Starts the writer task of the process.
+ *
+ * Records are queued in a lock-free ring by any number of tasks and written
+ * in batches by the single writer task. Both the agent and the TR-181 profile
+ * append to the same file, each from its own process.
+ *
+ * @param file the log file, NULL to write to stdout (no rotation then)
+ * @param maxSize rotate the file once it grows over this size, 0 to never rotate
+ * @param hookCrash flush the queued records on a crash signal
+ *
+ * @retval 0 success.
+ * @retval -1 error
+ */
+extern int WA_UTILS_LOGWRITER_Init(const char *file, size_t maxSize, bool hookCrash);
+
+/**
+ * Writes out all queued records and stops the writer task.
+ *
+ * @retval 0 success.
+ * @retval -1 error
+ */
+extern int WA_UTILS_LOGWRITER_Exit(void);
+
+/**
+ * Queues a log record.
+ *
+ * The record is "<mark><timestamp> <msg>", or just "<msg>" when \c mark is NULL,
+ * followed by a new line when \c eol is set. Blocks only while the ring is full.
+ *
+ * @param mark the line header, e.g. "HWST_LOG |", NULL for a raw record
+ * @param msg the message
+ * @param eol append a new line
+ *
+ * @retval 0 success.
+ * @retval -1 the writer is not running, the caller has to write the record itself
+ */
+extern int WA_UTILS_LOGWRITER_Write(const char *mark, const char *msg, bool eol);
+
+/**
+ * Waits until all records queued so far are written.
+ */
+extern void WA_UTILS_LOGWRITER_Flush(void);
+
+/**
+ * Formats the line header "<mark><timestamp> ".
+ * The timestamp is UTC "%F %T", formatted at most once per second by every task.
+ *
+ * @param mark the line header mark
+ * @param buffer the output buffer
+ * @param size size of the \c buffer
+ *
+ * @returns the length of the header
+ */
+extern size_t WA_UTILS_LOGWRITER_Header(const char *mark, char *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_UTILS_LOGWRITER_H */
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,199 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_phash.c
+ *
+ * @brief This file contains the perfect hash of a fixed set of names.
+ *
+ * The slots are at least twice the names, seeds are tried until no two names
+ * share a slot. If no seed succeeds the slots are doubled.
+ */
+
+/** @addtogroup WA_UTILS_PHASH
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_phash.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define MIN_SLOTS 8
+#define MAX_GROWTH 8 /* times the slots may be doubled */
+#define SEEDS 256 /* seeds tried for one number of slots */
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static uint32_t Hash(const char *key, uint32_t seed);
+static int Place(WA_UTILS_PHASH_t *pHash);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+int WA_UTILS_PHASH_Init(WA_UTILS_PHASH_t *pHash, const char *const *keys, unsigned int count)
+{
+    int status = -1;
+    unsigned int i, j, slots, maxSlots;
+
+    memset(pHash, 0, sizeof(*pHash));
+    if(count == 0)
+    {
+        return 0;
+    }
+
+    for(i = 0; i < count; ++i)
+    {
+        if(keys[i] == NULL)
+        {
+            return -1;
+        }
+        for(j = 0; j < i; ++j)
+        {
+            if(!strcmp(keys[j], keys[i]))
+            {
+                return 1;
+            }
+        }
+    }
+
+    pHash->keys = malloc(count * sizeof(*pHash->keys));
+    if(pHash->keys == NULL)
+    {
+        goto err;
+    }
+    memcpy(pHash->keys, keys, count * sizeof(*pHash->keys));
+    pHash->count = count;
+
+    for(slots = MIN_SLOTS; slots < 2 * count; slots <<= 1);
+    for(maxSlots = slots * MAX_GROWTH; slots <= maxSlots; slots <<= 1)
+    {
+        free(pHash->slots);
+        pHash->slots = malloc(slots * sizeof(*pHash->slots));
+        if(pHash->slots == NULL)
+        {
+            goto err;
+        }
+        pHash->mask = slots - 1;
+
+        status = Place(pHash);
+        if(status == 0)
+        {
+            return 0;
+        }
+    }
+
+    err:
+    WA_UTILS_PHASH_Exit(pHash);
+    return -1;
+}
+
+int WA_UTILS_PHASH_Find(const WA_UTILS_PHASH_t *pHash, const char *key)
+{
+    int i;
+
+    if(pHash->count == 0)
+    {
+        return -1;
+    }
+
+    i = pHash->slots[Hash(key, pHash->seed) & pHash->mask];
+    return ((i >= 0) && !strcmp(pHash->keys[i], key)) ? i : -1;
+}
+
+void WA_UTILS_PHASH_Exit(WA_UTILS_PHASH_t *pHash)
+{
+    free(pHash->keys);
+    free(pHash->slots);
+    memset(pHash, 0, sizeof(*pHash));
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+/* FNV-1a, mixed at the end so that the low bits depend on every character */
+static uint32_t Hash(const char *key, uint32_t seed)
+{
+    uint32_t h = 2166136261u ^ seed;
+
+    while(*key)
+    {
+        h ^= (unsigned char)*key++;
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/* 0 when a seed is found, -1 when every seed collides */
+static int Place(WA_UTILS_PHASH_t *pHash)
+{
+    uint32_t seed, slot;
+    unsigned int i;
+
+    for(seed = 1; seed <= SEEDS; ++seed)
+    {
+        memset(pHash->slots, 0xff, (pHash->mask + 1) * sizeof(*pHash->slots));
+        for(i = 0; i < pHash->count; ++i)
+        {
+            slot = Hash(pHash->keys[i], seed) & pHash->mask;
+            if(pHash->slots[slot] >= 0)
+            {
+                break;
+            }
+            pHash->slots[slot] = (int)i;
+        }
+        if(i == pHash->count)
+        {
+            pHash->seed = seed;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,118 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_phash.h
+ *
+ * @brief This file contains the perfect hash of a fixed set of names.
+ */
+
+/** @addtogroup WA_UTILS_PHASH
+ *  @{
+ */
+
+#ifndef WA_UTILS_PHASH_H
+#define WA_UTILS_PHASH_H
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdint.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED DEFINITIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * EXPORTED TYPES
+ *****************************************************************************/
+
+/** Collision-free table of names, read-only once built so it can be used without locking.
+ * A zeroed table is empty.
+ */
+typedef struct
+{
+    uint32_t seed; /**< hash seed that spreads the names over distinct slots */
+    uint32_t mask; /**< number of slots - 1 */
+    unsigned int count; /**< names in the table */
+    const char **keys; /**< the names, by index */
+    int *slots; /**< index of the name hashed to the slot, -1 if none */
+}WA_UTILS_PHASH_t;
+
+/*****************************************************************************
+ * EXPORTED VARIABLES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @brief Builds the table for the given names.
+ *
+ * Searches for a seed under which every name has its own slot, so a lookup
+ * costs one hash and one string compare.
+ *
+ * @param pHash the table
+ * @param keys the names, must stay valid until \c WA_UTILS_PHASH_Exit()
+ * @param count number of the names
+ *
+ * @retval 0 success
+ * @retval 1 a name is given twice
+ * @retval -1 error
+ */
+int WA_UTILS_PHASH_Init(WA_UTILS_PHASH_t *pHash, const char *const *keys, unsigned int count);
+
+/**
+ * @brief Looks up a name.
+ *
+ * @param pHash the table
+ * @param key the name
+ *
+ * @return index of the name in the \c keys given to \c WA_UTILS_PHASH_Init(), -1 if not found
+ */
+int WA_UTILS_PHASH_Find(const WA_UTILS_PHASH_t *pHash, const char *key);
+
+/**
+ * @brief Releases the table, it becomes empty.
+ *
+ * @param pHash the table
+ */
+void WA_UTILS_PHASH_Exit(WA_UTILS_PHASH_t *pHash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_UTILS_PHASH_H */
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -42,6 +42,7 @@
  *****************************************************************************/
 #include "wa_debug.h"
 #include "wa_osa.h"
+#include "wa_metrics.h"
 
 /*****************************************************************************
  * RDK-SPECIFIC INCLUDE FILES
@@ -292,6 +293,20 @@ int WA_UTILS_IARM_Disconnect(void)
     return status;
 }
 
+int WA_UTILS_IARM_Call(const char *ownerName, const char *methodName, void *arg, size_t argLen)
+{
+    uint64_t start = WA_METRICS_Now();
+
+    IARM_Result_t ret = IARM_Bus_Call(ownerName, methodName, arg, argLen);
+
+    WA_METRICS_Since(WA_METRICS_IARM_CALL, start);
+    if(ret != IARM_RESULT_SUCCESS)
+    {
+        WA_METRICS_Inc(WA_METRICS_IARM_ERRORS);
+    }
+    return ret;
+}
+
 /* End of doxygen group */
 /*! @} */
 
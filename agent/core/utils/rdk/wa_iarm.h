@@ -34,6 +34,7 @@
 /*****************************************************************************
  * STANDARD INCLUDE FILES
  *****************************************************************************/
+#include <stddef.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
@@ -92,6 +93,18 @@ extern int WA_UTILS_IARM_Connect(void);
 
 extern int WA_UTILS_IARM_Disconnect(void);
 
+/**
+ * Calls an IARM Bus RPC method, as \c IARM_Bus_Call(), and records the call in the agent metrics.
+ *
+ * @param ownerName name of the IARM member that provides the method
+ * @param methodName the method name
+ * @param arg the method argument
+ * @param argLen size of the \c arg
+ *
+ * @returns the \c IARM_Result_t of the call
+ */
+extern int WA_UTILS_IARM_Call(const char *ownerName, const char *methodName, void *arg, size_t argLen);
+
 /*****************************************************************************
  * LOCAL FUNCTIONS
  *****************************************************************************/
@@ -41,6 +41,7 @@
 #include "wa_debug.h"
 #include "wa_osa.h"
 #include "wa_fileops.h"
+#include "wa_sim.h"
 
 /*****************************************************************************
  * RDK-SPECIFIC INCLUDE FILES
@@ -153,7 +154,7 @@ int WA_UTILS_SICACHE_TuningRead(int numEntries, WA_UTILS_SICACHE_Entries_t **ppE
 
     snprintf(line, MAX_LINE, PARSER_COMMAND, sicache, snscache);
 
-    f = popen(line, "r");
+    f = popen(WA_UTILS_SIM_COMMAND(line), "r");
     if(f == NULL)
     {
         WA_ERROR("WA_UTILS_SICACHE_TuningRead() popen() error\n");
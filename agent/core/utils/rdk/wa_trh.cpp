@@ -36,6 +36,7 @@
 #include <string>
 #include <sys/time.h>
 #include <typeinfo>
+#include <unistd.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
@@ -106,28 +107,16 @@ class TestException: public std::exception
 };
 
 /*****************************************************************************
- * EXPORTED FUNCTIONS
+ * LOCAL FUNCTIONS
  *****************************************************************************/
 
-int WA_UTILS_TRH_Init()
-{
-    int status = 0;
-
-
-    return status;
-}
-
-int WA_UTILS_TRH_Exit()
-{
-    int status = 0;
-
-
-    return status;
-}
-
-int WA_UTILS_TRH_ReserveTuner(const char *url, uint64_t when, uint64_t duration, int timeout_ms, int tuner_count, void **out_handle)
+/* Counts the tuners in the "Free" state.
+ *
+ * @returns number of free tuners, -1 on failure
+ */
+static int countFreeTuners(TunerReservationHelper *helper)
 {
-    int status = 1;
+    int status;
     int num_tuner = 0;
     int freeTuners = 0;
     char output[OUTPUT_LEN] = {'\0'};
@@ -137,86 +126,127 @@ int WA_UTILS_TRH_ReserveTuner(const char *url, uint64_t when, uint64_t duration,
     json_t *allStates = NULL;
     json_t *trmResp = NULL;
     json_t *value;
-    std::string tunerId;
     std::string tunerStates;
 
-    WA_ENTER("WA_UTILS_TRH_ReserveTuner(): url='%s', when=%llu, duration=%llu, timeout_ms=%i, out_handle=%p\n",
-                url, when, duration, timeout_ms, out_handle);
+    if (helper->getAllTunerStates(tunerStates) == false)
+    {
+        WA_ERROR("countFreeTuners(): Failed to get tuner states\n");
+        return -1;
+    }
 
-    try
+    WA_DBG("countFreeTuners(): Tuner states from TRM (success): '%s'\n", tunerStates.c_str());
+
+    // To check if at-least one tuner is in Free state by checking all the tuners
+    if (tunerStates.compare("") != 0)
     {
-        WA_DBG("WA_UTILS_TRH_ReserveTuner(): requesting tuner reservation for '%s' from TRM...\n", url);
-        TrhHandler *handler = new TrhHandler(url);
+        snprintf(output, sizeof(output),"%s", tunerStates.c_str());
+        json = json_loads((char*)output, JSON_DISABLE_EOF_CHECK, NULL);
+        if (!json)
+        {
+            WA_ERROR("countFreeTuners(): TRM output json_loads() error\n");
+            return -1;
+        }
 
-        // Get all tuner states before tuning to ensure there are free tuners
-        if (handler->helper->getAllTunerStates(tunerStates) == false)
+        status = json_unpack(json, "{so}", "getAllTunerStatesResponse", &trmResp);
+        if (status || !trmResp)
         {
-            WA_ERROR("WA_UTILS_TRH_ReserveTuner(): Failed to get tuner states\n");
-            delete handler;
-            return TRH_STATUS_RESERVATION_FAIL;
+            WA_ERROR("countFreeTuners(): json_unpack(\"getAllTunerStatesResponse\") error\n");
+            json_decref(json);
+            return -1;
         }
 
-        WA_DBG("WA_UTILS_TRH_ReserveTuner(): Tuner states from TRM (success): '%s'\n", tunerStates.c_str());
+        status = json_unpack(trmResp, "{so}", "allStates", &allStates);
+        if (status || !allStates)
+        {
+            WA_ERROR("countFreeTuners(): json_unpack(\"allStates\") error\n");
+            json_decref(json);
+            return -1;
+        }
 
-        // To check if at-least one tuner is in Free state by checking all the tuners
-        if (tunerStates.compare("") != 0)
+        void *iter = json_object_iter(allStates);
+        while(iter && num_tuner < MAX_TUNER_RESERVATION_HELPERS)
         {
-            snprintf(output, sizeof(output),"%s", tunerStates.c_str());
-            json = json_loads((char*)output, JSON_DISABLE_EOF_CHECK, NULL);
-            if (!json)
-            {
-                WA_ERROR("WA_UTILS_TRH_ReserveTuner(): TRM output json_loads() error\n");
-                return TRH_STATUS_RESERVATION_FAIL;
-            }
+            key = json_object_iter_key(iter);
+            value = json_object_iter_value(iter);
+            tunerState = json_string_value(value);
 
-            status = json_unpack(json, "{so}", "getAllTunerStatesResponse", &trmResp);
-            if (status || !trmResp)
+            if (strstr(key, "TunerId-") && !strcmp(tunerState, "Free"))
             {
-                WA_ERROR("WA_UTILS_TRH_ReserveTuner(): json_unpack(\"getAllTunerStatesResponse\") error\n");
-                return TRH_STATUS_RESERVATION_FAIL;
+                freeTuners++;
             }
 
-            status = json_unpack(trmResp, "{so}", "allStates", &allStates);
-            if (status || !allStates)
-            {
-                WA_ERROR("WA_UTILS_TRH_ReserveTuner(): json_unpack(\"allStates\") error\n");
-                return TRH_STATUS_RESERVATION_FAIL;
-            }
+            num_tuner++;
 
-            void *iter = json_object_iter(allStates);
-            while(iter && num_tuner < MAX_TUNER_RESERVATION_HELPERS)
-            {
-                key = json_object_iter_key(iter);
-                value = json_object_iter_value(iter);
-                tunerState = json_string_value(value);
+            iter = json_object_iter_next(allStates, iter);
+        }
+        json_decref(json);
+    }
 
-                if (strstr(key, "TunerId-") && !strcmp(tunerState, "Free"))
-                {
-                    freeTuners++;
-                }
+    return freeTuners;
+}
 
-                num_tuner++;
+/* Checks with TRM that at least one tuner is free and issues an asynchronous
+ * live reservation request. Completion is reported through the handler listener.
+ *
+ * @retval 0 request issued
+ * @retval 1 no free tuners or request failure
+ */
+static int requestReservation(TrhHandler *handler, uint64_t when, uint64_t duration)
+{
+    // Get all tuner states before tuning to ensure there are free tuners
+    int freeTuners = countFreeTuners(handler->helper);
 
-                iter = json_object_iter_next(allStates, iter);
-            }
-        }
+    if (freeTuners <= 0)
+    {
+        WA_ERROR("requestReservation(): Could not get Free tuners\n");
+        return 1;
+    }
 
-        if (freeTuners == 0)
-        {
-            WA_ERROR("WA_UTILS_TRH_ReserveTuner(): Could not get Free tuners\n");
-            return TRH_STATUS_RESERVATION_FAIL;
-        }
+    WA_DBG("requestReservation(): Free tuners available: %i\n", freeTuners);
 
-        WA_DBG("WA_UTILS_TRH_ReserveTuner(): Free tuners available: %i\n", freeTuners);
+    if (!when)
+    {
+        struct timeval timeNow;
+        gettimeofday(&timeNow, NULL);
+        when = (uint64_t)timeNow.tv_sec * 1000LL; /* reserve now */
+    }
 
-        if (!when)
-        {
-            struct timeval timeNow;
-            gettimeofday(&timeNow, NULL);
-            when = (uint64_t)timeNow.tv_sec * 1000LL; /* reserve now */
-        }
+    return handler->helper->reserveTunerForLive(handler->locator.c_str(), when, duration, false /* async call */) ? 0 : 1;
+}
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+int WA_UTILS_TRH_Init()
+{
+    int status = 0;
+
+
+    return status;
+}
+
+int WA_UTILS_TRH_Exit()
+{
+    int status = 0;
+
+
+    return status;
+}
+
+int WA_UTILS_TRH_ReserveTuner(const char *url, uint64_t when, uint64_t duration, int timeout_ms, int tuner_count, void **out_handle)
+{
+    int status = 1;
+
+    WA_ENTER("WA_UTILS_TRH_ReserveTuner(): url='%s', when=%llu, duration=%llu, timeout_ms=%i, out_handle=%p\n",
+                url, when, duration, timeout_ms, out_handle);
+
+    try
+    {
+        WA_DBG("WA_UTILS_TRH_ReserveTuner(): requesting tuner reservation for '%s' from TRM...\n", url);
+        TrhHandler *handler = new TrhHandler(url);
 
-        if (handler->helper->reserveTunerForLive(url, when, duration, false /* async call */))
+        if (!requestReservation(handler, when, duration))
         {
             WA_DBG("WA_UTILS_TRH_ReserveTuner(): waiting for tuner reservation for '%s'...\n", url);
 
@@ -247,8 +277,8 @@ int WA_UTILS_TRH_ReserveTuner(const char *url, uint64_t when, uint64_t duration,
         else
         {
             WA_ERROR("WA_UTILS_TRH_ReserveTuner(): failed to request tuner reservation\n");
-            throw TestException(TRH_STATUS_RESERVATION_FAIL, "Unable to Reserve Tuner");
             delete handler;
+            return TRH_STATUS_RESERVATION_FAIL;
         }
 
     }
@@ -263,6 +293,105 @@ int WA_UTILS_TRH_ReserveTuner(const char *url, uint64_t when, uint64_t duration,
     return status;
 }
 
+int WA_UTILS_TRH_RequestTuner(const char *url, uint64_t when, uint64_t duration, void **out_handle)
+{
+    int status = 1;
+
+    WA_ENTER("WA_UTILS_TRH_RequestTuner(): url='%s', when=%llu, duration=%llu, out_handle=%p\n",
+                url, when, duration, out_handle);
+
+    if (!out_handle)
+    {
+        WA_ERROR("WA_UTILS_TRH_RequestTuner(): invalid parameters\n");
+        goto end;
+    }
+
+    try
+    {
+        TrhHandler *handler = new TrhHandler(url);
+
+        if (!requestReservation(handler, when, duration))
+        {
+            WA_DBG("WA_UTILS_TRH_RequestTuner(): reservation for '%s' requested\n", url);
+            *out_handle = handler;
+            status = 0;
+        }
+        else
+        {
+            WA_ERROR("WA_UTILS_TRH_RequestTuner(): failed to request tuner reservation\n");
+            delete handler;
+        }
+    }
+    catch (std::exception &e)
+    {
+        WA_ERROR("WA_UTILS_TRH_RequestTuner(): failed to alloc reservation helper (%s)\n", e.what());
+    }
+
+end:
+    WA_RETURN("WA_UTILS_TRH_RequestTuner(): status=%i\n", status);
+
+    return status;
+}
+
+int WA_UTILS_TRH_GetFreeTuners()
+{
+    int freeTuners = -1;
+
+    WA_ENTER("WA_UTILS_TRH_GetFreeTuners()\n");
+
+    try
+    {
+        TrhHandler handler("");
+
+        freeTuners = countFreeTuners(handler.helper);
+    }
+    catch (std::exception &e)
+    {
+        WA_ERROR("WA_UTILS_TRH_GetFreeTuners(): failed to alloc reservation helper (%s)\n", e.what());
+    }
+
+    WA_RETURN("WA_UTILS_TRH_GetFreeTuners(): %i\n", freeTuners);
+
+    return freeTuners;
+}
+
+int WA_UTILS_TRH_GetEventFd(void *handle)
+{
+    if (!handle)
+        return -1;
+
+    return reinterpret_cast<TrhHandler *>(handle)->listener->get_event_fd();
+}
+
+WA_UTILS_TRH_State_t WA_UTILS_TRH_GetState(void *handle)
+{
+    uint64_t events;
+
+    if (!handle)
+        return WA_UTILS_TRH_STATE_FAILED;
+
+    TrhHandler *handler = reinterpret_cast<TrhHandler *>(handle);
+
+    /* consume pending notifications, the status is the single source of truth */
+    while (read(handler->listener->get_event_fd(), &events, sizeof(events)) == sizeof(events))
+        ;
+
+    switch (handler->listener->get_status())
+    {
+    case TRH_STATUS_RESERVATION_SUCCESS:
+        return WA_UTILS_TRH_STATE_RESERVED;
+    case TRH_STATUS_RESERVATION_FAIL:
+        return WA_UTILS_TRH_STATE_FAILED;
+    case TRH_STATUS_RESERVATION_RELEASE_SUCCESS:
+    case TRH_STATUS_RESERVATION_RELEASE_FAIL:
+    case TRH_STATUS_RELEASED:
+        return WA_UTILS_TRH_STATE_RELEASED;
+    case TRH_STATUS_UNRESERVED:
+    default:
+        return WA_UTILS_TRH_STATE_PENDING;
+    }
+}
+
 int WA_UTILS_TRH_ReleaseTuner(void *handle, int timeout_ms)
 {
     int status = 1;
@@ -52,6 +52,15 @@ extern "C"
  * EXPORTED TYPES
  *****************************************************************************/
 
+/** State of an asynchronous reservation, see \c WA_UTILS_TRH_RequestTuner(). */
+typedef enum
+{
+    WA_UTILS_TRH_STATE_PENDING = 0, /**< no response from TRM yet */
+    WA_UTILS_TRH_STATE_RESERVED,    /**< tuner reserved */
+    WA_UTILS_TRH_STATE_FAILED,      /**< reservation failed */
+    WA_UTILS_TRH_STATE_RELEASED     /**< reservation or tuner released */
+} WA_UTILS_TRH_State_t;
+
 /*****************************************************************************
  * EXPORTED VARIABLES
  *****************************************************************************/
@@ -92,6 +101,48 @@ int WA_UTILS_TRH_Exit();
  */
 int WA_UTILS_TRH_ReserveTuner(const char *url, uint64_t when, uint64_t duration, int timeout_ms, int tuner_count, void **out_handle);
 
+/**
+ * @brief Issues a tuner reservation request via TRM without waiting for the response.
+ *
+ * The progress of the reservation can be awaited with poll() on the descriptor
+ * returned by \c WA_UTILS_TRH_GetEventFd() and checked with \c WA_UTILS_TRH_GetState().
+ * The handle must be released with \c WA_UTILS_TRH_ReleaseTuner().
+ *
+ * param url         OCAP URL to tune to.
+ * param when        Timestamp when to reserve the tuner (epoch, 0: now).
+ * param duration    Duration for how long to reserve the tuner (ms).
+ * param out_handle  Output: reservation handle.
+ *
+ * @retval 0 on success.
+ * @retval 1 on failure.
+ */
+int WA_UTILS_TRH_RequestTuner(const char *url, uint64_t when, uint64_t duration, void **out_handle);
+
+/**
+ * @brief Asks TRM how many tuners are free at the moment.
+ *
+ * @returns number of free tuners, -1 on failure.
+ */
+int WA_UTILS_TRH_GetFreeTuners();
+
+/**
+ * @brief Returns a descriptor that becomes readable on every reservation event.
+ *
+ * @param handle Handle of reservation.
+ *
+ * @returns file descriptor, -1 on invalid handle
+ */
+int WA_UTILS_TRH_GetEventFd(void *handle);
+
+/**
+ * @brief Returns the current state of a reservation and clears pending events.
+ *
+ * @param handle Handle of reservation.
+ *
+ * @returns reservation state
+ */
+WA_UTILS_TRH_State_t WA_UTILS_TRH_GetState(void *handle);
+
 /**
  * @brief Attempts to release a tuner via TRM.
  *
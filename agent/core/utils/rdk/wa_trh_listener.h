@@ -36,6 +36,9 @@
 #include <exception>
 #include <stdexcept>
 #include <string>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
@@ -72,6 +75,7 @@ public:
     void wait_reserve_release(int timeout_ms = 0) const;
     void wait_release(int timeout_ms = 0) const;
     TRH_Status_t get_status() const { return _status; };
+    int get_event_fd() const { return _event_fd; };
 
     void reserveSuccess() /* override */;
     void reserveFailed() /* override */;
@@ -81,8 +85,10 @@ public:
 
 private:
     void _deinit();
+    void _notify();
 
     TRH_Status_t _status;
+    int _event_fd; /**< signalled on every reservation event, for poll() based waiters */
     std::string _locator;
     mutable void *_reserve_sem;
     mutable void *_reserve_release_sem;
@@ -101,8 +107,9 @@ reservation_listener_impl::reservation_listener_impl(const std::string& url)
     _reserve_sem = WA_OSA_SemCreate(0);
     _reserve_release_sem = WA_OSA_SemCreate(0);
     _tuner_release_sem = WA_OSA_SemCreate(0);
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
 
-    if (!_reserve_sem || !_reserve_release_sem || !_tuner_release_sem)
+    if (!_reserve_sem || !_reserve_release_sem || !_tuner_release_sem || (_event_fd < 0))
     {
         _deinit();
         throw std::runtime_error("semaphore creation error");
@@ -133,6 +140,20 @@ void reservation_listener_impl::_deinit()
         if (WA_OSA_SemDestroy(_tuner_release_sem))
             WA_ERROR("reservation_listener::_deinit(): WA_OSA_SemDestroy() failed\n");
     }
+
+    if (_event_fd >= 0)
+    {
+        close(_event_fd);
+        _event_fd = -1;
+    }
+}
+
+void reservation_listener_impl::_notify()
+{
+    uint64_t one = 1;
+
+    if (write(_event_fd, &one, sizeof(one)) != sizeof(one))
+        WA_ERROR("reservation_listener::_notify(): write() failed\n");
 }
 
 void reservation_listener_impl::wait_reserve(int timeout_ms) const
@@ -155,6 +176,7 @@ void reservation_listener_impl::reserveSuccess()
     WA_DBG("TRHListenerImpl::reserveSuccess(): reservation success for '%s'\n", _locator.c_str());
     _status = TRH_STATUS_RESERVATION_SUCCESS;
     WA_OSA_SemSignal(_reserve_sem);
+    _notify();
 }
 
 void reservation_listener_impl::reserveFailed()
@@ -162,6 +184,7 @@ void reservation_listener_impl::reserveFailed()
     WA_DBG("TRHListenerImpl::reserveFailed(): reservation failed for '%s'\n", _locator.c_str());
     _status = TRH_STATUS_RESERVATION_FAIL;
     WA_OSA_SemSignal(_reserve_sem);
+    _notify();
 }
 
 void reservation_listener_impl::releaseReservationSuccess()
@@ -169,6 +192,7 @@ void reservation_listener_impl::releaseReservationSuccess()
     WA_DBG("TRHListenerImpl::releaseReservationSuccess(): reservation release success for '%s'\n", _locator.c_str());
     _status = TRH_STATUS_RESERVATION_RELEASE_SUCCESS;
     WA_OSA_SemSignal(_reserve_release_sem);
+    _notify();
 }
 
 void reservation_listener_impl::releaseReservationFailed()
@@ -176,6 +200,7 @@ void reservation_listener_impl::releaseReservationFailed()
     WA_DBG("TRHListenerImpl::releaseReservationFailed(): reservation release failed for '%s'\n", _locator.c_str());
     _status = TRH_STATUS_RESERVATION_RELEASE_FAIL;
     WA_OSA_SemSignal(_reserve_release_sem);
+    _notify();
 }
 
 void reservation_listener_impl::tunerReleased()
@@ -184,6 +209,7 @@ void reservation_listener_impl::tunerReleased()
     _status = TRH_STATUS_RELEASED;
     WA_OSA_SemSignal(_tuner_release_sem);
     WA_OSA_SemSignal(_reserve_release_sem);
+    _notify();
 }
 
 #endif /* WA_UTILS_TRH_LISTENER_H */
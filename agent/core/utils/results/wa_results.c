@@ -0,0 +1,234 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file wa_results.c
+ *
+ * @brief This file contains functions for storing and reading the aggregated results file.
+ *
+ * Shared by the agent and the TR-181 profile, so it depends on the C library only.
+ */
+
+/** @addtogroup WA_UTILS_RESULTS
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_results.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define TRAILER_TAG "#hwst-results v"
+#define TRAILER_MAX_LEN 64
+#define MAX_FILE_SIZE (1024 * 1024)
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static uint32_t Fnv1a(const char *data, size_t len);
+static void FillStamp(const struct stat *st, WA_UTILS_RESULTS_Stamp_t *stamp);
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+int WA_UTILS_RESULTS_Write(const char *file, const char *payload)
+{
+    char tmpFile[256];
+    char trailer[TRAILER_MAX_LEN];
+    size_t len;
+    FILE *f;
+    int status = -1;
+
+    if(!file || !payload || strchr(payload, '\n'))
+        return -1;
+
+    if(snprintf(tmpFile, sizeof(tmpFile), "%s.tmp", file) >= (int)sizeof(tmpFile))
+        return -1;
+
+    len = strlen(payload);
+    snprintf(trailer, sizeof(trailer), TRAILER_TAG "%d %zu %08x\n",
+            WA_UTILS_RESULTS_FORMAT_VERSION, len, Fnv1a(payload, len));
+
+    f = fopen(tmpFile, "wb");
+    if(!f)
+        return -1;
+
+    if((fwrite(payload, 1, len, f) == len) &&
+       (fputc('\n', f) != EOF) &&
+       (fputs(trailer, f) != EOF) &&
+       (fflush(f) == 0) &&
+       (fsync(fileno(f)) == 0))
+    {
+        status = 0;
+    }
+
+    if(fclose(f) != 0)
+        status = -1;
+
+    /* the snapshot swap */
+    if((status == 0) && (rename(tmpFile, file) != 0))
+        status = -1;
+
+    if(status != 0)
+        unlink(tmpFile);
+
+    return status;
+}
+
+int WA_UTILS_RESULTS_GetStamp(const char *file, WA_UTILS_RESULTS_Stamp_t *stamp)
+{
+    struct stat st;
+
+    if(!file || !stamp)
+        return -1;
+
+    if(stat(file, &st) != 0)
+        return 1;
+
+    FillStamp(&st, stamp);
+    return 0;
+}
+
+bool WA_UTILS_RESULTS_StampEqual(const WA_UTILS_RESULTS_Stamp_t *a, const WA_UTILS_RESULTS_Stamp_t *b)
+{
+    return (a->ino == b->ino) && (a->mtime == b->mtime) && (a->size == b->size);
+}
+
+int WA_UTILS_RESULTS_Read(const char *file, char **payload, WA_UTILS_RESULTS_Stamp_t *stamp)
+{
+    struct stat st;
+    char *buf = NULL, *eol, *trailer;
+    ssize_t rd;
+    size_t got = 0, len;
+    unsigned int version, sum;
+    int fd, status = -1;
+
+    if(!file || !payload)
+        return -1;
+
+    *payload = NULL;
+
+    fd = open(file, O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+        return 1;
+
+    /* the stamp of the opened file, the name may already point to a newer snapshot */
+    if((fstat(fd, &st) != 0) || (st.st_size > MAX_FILE_SIZE))
+        goto end;
+
+    if(st.st_size == 0)
+    {
+        status = 1;
+        goto end;
+    }
+
+    buf = (char *)malloc(st.st_size + 1);
+    if(!buf)
+        goto end;
+
+    while(got < (size_t)st.st_size)
+    {
+        rd = read(fd, buf + got, st.st_size - got);
+        if(rd <= 0)
+            break;
+        got += rd;
+    }
+    if(got != (size_t)st.st_size)
+        goto end;
+    buf[got] = '\0';
+
+    eol = strchr(buf, '\n');
+    if(eol)
+        *eol = '\0';
+    len = strlen(buf);
+
+    trailer = eol ? eol + 1 : NULL;
+    if(trailer && !strncmp(trailer, TRAILER_TAG, strlen(TRAILER_TAG)))
+    {
+        size_t expLen;
+
+        if((sscanf(trailer + strlen(TRAILER_TAG), "%u %zu %x", &version, &expLen, &sum) != 3) ||
+           (version > WA_UTILS_RESULTS_FORMAT_VERSION) ||
+           (expLen != len) ||
+           (sum != Fnv1a(buf, len)))
+        {
+            goto end;
+        }
+    }
+    /* else: version 0, plain json line */
+
+    if(len == 0)
+    {
+        status = 1;
+        goto end;
+    }
+
+    if(stamp)
+        FillStamp(&st, stamp);
+
+    *payload = buf;
+    buf = NULL;
+    status = 0;
+
+end:
+    free(buf);
+    close(fd);
+    return status;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+static uint32_t Fnv1a(const char *data, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    while(len--)
+    {
+        hash ^= (unsigned char)*data++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void FillStamp(const struct stat *st, WA_UTILS_RESULTS_Stamp_t *stamp)
+{
+    stamp->ino = st->st_ino;
+    stamp->mtime = (long long)st->st_mtim.tv_sec * 1000000000LL + st->st_mtim.tv_nsec;
+    stamp->size = st->st_size;
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
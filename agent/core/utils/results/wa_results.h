@@ -0,0 +1,139 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file wa_results.h
+ *
+ * @brief This file contains functions for storing and reading the aggregated results file.
+ */
+
+/** @addtogroup WA_UTILS_RESULTS
+ *  @{
+ */
+
+#ifndef WA_UTILS_RESULTS_H
+#define WA_UTILS_RESULTS_H
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdbool.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED DEFINITIONS
+ *****************************************************************************/
+#define WA_UTILS_RESULTS_FILE "/tmp/hwselftest.results"
+
+/** Version of the on-disk format written by \c WA_UTILS_RESULTS_Write().
+ *
+ * The file keeps the results json on the first line, so it stays readable
+ * by tools that take the first line. The second line is a trailer:
+ *
+ *     #hwst-results v<version> <payload length> <payload fnv1a32 hex>
+ *
+ * Files without the trailer (written before versioning) are read as version 0.
+ */
+#define WA_UTILS_RESULTS_FORMAT_VERSION 1
+
+/*****************************************************************************
+ * EXPORTED TYPES
+ *****************************************************************************/
+
+/** Identifies one snapshot of the results file.
+ * A new snapshot is always a new file (renamed into place), so an unchanged
+ * stamp means unchanged content.
+ */
+typedef struct
+{
+    unsigned long long ino;
+    long long mtime; /**< in [ns] */
+    long long size;
+}WA_UTILS_RESULTS_Stamp_t;
+
+/*****************************************************************************
+ * EXPORTED VARIABLES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @brief Atomically replaces the results file.
+ *
+ * The new content is written to a temporary file, synced and renamed over \c file,
+ * so readers never see a partially written snapshot and need no locking.
+ *
+ * @param file the results file
+ * @param payload the results json, in a single line
+ *
+ * @retval 0 success
+ * @retval -1 error
+ */
+int WA_UTILS_RESULTS_Write(const char *file, const char *payload);
+
+/**
+ * @brief Returns the stamp of the current results file snapshot.
+ *
+ * @param file the results file
+ * @param stamp the stamp to fill
+ *
+ * @retval 0 success
+ * @retval 1 no results file
+ * @retval -1 error
+ */
+int WA_UTILS_RESULTS_GetStamp(const char *file, WA_UTILS_RESULTS_Stamp_t *stamp);
+
+/**
+ * @brief Compares two snapshot stamps.
+ */
+bool WA_UTILS_RESULTS_StampEqual(const WA_UTILS_RESULTS_Stamp_t *a, const WA_UTILS_RESULTS_Stamp_t *b);
+
+/**
+ * @brief Reads and validates the results file.
+ *
+ * @param file the results file
+ * @param payload returns the results json, must be released with free() by the caller
+ * @param stamp if not NULL filled with the stamp of the snapshot read
+ *
+ * @retval 0 success
+ * @retval 1 no results available
+ * @retval -1 error, unsupported version or corrupted file
+ */
+int WA_UTILS_RESULTS_Read(const char *file, char **payload, WA_UTILS_RESULTS_Stamp_t *stamp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_UTILS_RESULTS_H */
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,345 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_sim.c
+ *
+ * @brief This file contains the fixture tree and the injector of the hardware simulation.
+ *
+ * The environment is read on first use. Every injection point draws from its own
+ * seeded sequence, so a point fails the same calls in every run regardless of
+ * how the other points are used.
+ */
+
+/** @addtogroup WA_UTILS_SIM
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_sim.h"
+#include "wa_debug.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define ENV_ROOT "HWST_SIM_ROOT"
+#define ENV_SEED "HWST_SIM_SEED"
+#define ENV_INJECT "HWST_SIM_INJECT"
+
+#define FIXTURE_DIR "sim"
+#define PATH_BUFFERS 3 /* paths of one call may be in use together, e.g. rename() */
+#define COMMAND_LEN 1024
+#define FAILED_COMMAND "false"
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+
+typedef struct
+{
+    unsigned int latencyMs;
+    unsigned int failPercent;
+    unsigned int seed; /**< rand_r() state, under the injectMutex */
+} WA_UTILS_SIM_inject_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static void Init(void);
+static void ParseInject(const char *spec);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+
+static const char *const pointNames[WA_UTILS_SIM_POINTS] = {"iarm", "snmp", "trm", "streamer", "exec"};
+
+static pthread_once_t initOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t injectMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *root;
+static WA_UTILS_SIM_inject_t inject[WA_UTILS_SIM_POINTS];
+
+static __thread char paths[PATH_BUFFERS][PATH_MAX];
+static __thread unsigned int nextPath;
+static __thread char command[COMMAND_LEN];
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+const char *WA_UTILS_SIM_Root(void)
+{
+    pthread_once(&initOnce, Init);
+    return root;
+}
+
+const char *WA_UTILS_SIM_Path(const char *path)
+{
+    char *buffer;
+
+    pthread_once(&initOnce, Init);
+
+    if(!path || (path[0] != '/'))
+    {
+        return path;
+    }
+
+    buffer = paths[nextPath++ % PATH_BUFFERS];
+    if(snprintf(buffer, PATH_MAX, "%s%s", root, path) >= PATH_MAX)
+    {
+        WA_ERROR("WA_UTILS_SIM_Path(): '%s' too long\n", path);
+        return path;
+    }
+    return buffer;
+}
+
+const char *WA_UTILS_SIM_Command(const char *cmd)
+{
+    const char *name, *args;
+    size_t nameLen;
+
+    pthread_once(&initOnce, Init);
+
+    if(WA_UTILS_SIM_Inject(WA_UTILS_SIM_EXEC) != 0)
+    {
+        return FAILED_COMMAND;
+    }
+
+    /* the basename of the first word names the fixture */
+    name = cmd + strspn(cmd, " \t");
+    args = name + strcspn(name, " \t;|&<>");
+    for(nameLen = args - name; nameLen && (name[nameLen - 1] != '/'); --nameLen)
+        ;
+    name += nameLen;
+    nameLen = args - name;
+
+    if((nameLen == 0) ||
+       (snprintf(command, sizeof(command), "%s/" FIXTURE_DIR "/cmd/%.*s", root, (int)nameLen, name) >= (int)sizeof(command)) ||
+       (access(command, X_OK) != 0))
+    {
+        return cmd;
+    }
+
+    if(snprintf(command + strlen(command), sizeof(command) - strlen(command), "%s", args) >= (int)(sizeof(command) - strlen(command)))
+    {
+        WA_ERROR("WA_UTILS_SIM_Command(): '%s' too long\n", cmd);
+        return cmd;
+    }
+    WA_DBG("WA_UTILS_SIM_Command(): '%s'\n", command);
+    return command;
+}
+
+int WA_UTILS_SIM_Inject(WA_UTILS_SIM_point_t point)
+{
+    struct timespec delay;
+    unsigned int roll = 100;
+
+    pthread_once(&initOnce, Init);
+
+    if(point >= WA_UTILS_SIM_POINTS)
+    {
+        return 0;
+    }
+
+    if(inject[point].failPercent)
+    {
+        pthread_mutex_lock(&injectMutex);
+        roll = rand_r(&inject[point].seed) % 100;
+        pthread_mutex_unlock(&injectMutex);
+    }
+
+    if(inject[point].latencyMs)
+    {
+        delay.tv_sec = inject[point].latencyMs / 1000;
+        delay.tv_nsec = (inject[point].latencyMs % 1000) * 1000000L;
+        while((nanosleep(&delay, &delay) != 0) && (errno == EINTR))
+            ;
+    }
+
+    if(roll < inject[point].failPercent)
+    {
+        WA_DBG("WA_UTILS_SIM_Inject(): %s failure\n", pointNames[point]);
+        return -1;
+    }
+    return 0;
+}
+
+char *WA_UTILS_SIM_Fixture(const char *name, size_t *pSize)
+{
+    char path[PATH_MAX];
+    char *data = NULL;
+    FILE *f;
+    long size;
+
+    pthread_once(&initOnce, Init);
+
+    if(snprintf(path, sizeof(path), "%s/" FIXTURE_DIR "/%s", root, name) >= (int)sizeof(path))
+    {
+        WA_ERROR("WA_UTILS_SIM_Fixture(): '%s' too long\n", name);
+        return NULL;
+    }
+
+    f = fopen(path, "rb");
+    if(!f)
+    {
+        WA_DBG("WA_UTILS_SIM_Fixture(): no '%s'\n", path);
+        return NULL;
+    }
+
+    if((fseek(f, 0, SEEK_END) != 0) || ((size = ftell(f)) < 0) || (fseek(f, 0, SEEK_SET) != 0))
+    {
+        WA_ERROR("WA_UTILS_SIM_Fixture(): '%s' not seekable\n", path);
+        goto end;
+    }
+
+    data = malloc(size + 1);
+    if(!data)
+    {
+        WA_ERROR("WA_UTILS_SIM_Fixture(): malloc() error\n");
+        goto end;
+    }
+
+    if(fread(data, 1, size, f) != (size_t)size)
+    {
+        WA_ERROR("WA_UTILS_SIM_Fixture(): '%s' read error\n", path);
+        free(data);
+        data = NULL;
+        goto end;
+    }
+    data[size] = '\0';
+
+    if(pSize)
+    {
+        *pSize = size;
+    }
+
+end:
+    fclose(f);
+    return data;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+static void Init(void)
+{
+    const char *s;
+    unsigned int seed = 1;
+    int i;
+
+    root = getenv(ENV_ROOT);
+    if(!root || !*root)
+    {
+        root = WA_UTILS_SIM_DEFAULT_ROOT;
+    }
+
+    s = getenv(ENV_SEED);
+    if(s)
+    {
+        seed = strtoul(s, NULL, 0);
+    }
+    for(i = 0; i < WA_UTILS_SIM_POINTS; ++i)
+    {
+        inject[i].seed = seed + i;
+    }
+
+    s = getenv(ENV_INJECT);
+    if(s)
+    {
+        ParseInject(s);
+    }
+
+    WA_INFO("hardware simulation: fixtures '%s', seed %u\n", root, seed);
+    for(i = 0; i < WA_UTILS_SIM_POINTS; ++i)
+    {
+        if(inject[i].latencyMs || inject[i].failPercent)
+        {
+            WA_INFO("hardware simulation: %s latency %u ms, failures %u%%\n",
+                    pointNames[i], inject[i].latencyMs, inject[i].failPercent);
+        }
+    }
+}
+
+static void ParseInject(const char *spec)
+{
+    char *specs, *entry, *save = NULL;
+    char name[16];
+    unsigned int latencyMs, failPercent;
+    int i, n;
+
+    specs = strdup(spec);
+    if(!specs)
+    {
+        WA_ERROR("ParseInject(): strdup() error\n");
+        return;
+    }
+
+    for(entry = strtok_r(specs, ",", &save); entry; entry = strtok_r(NULL, ",", &save))
+    {
+        failPercent = 0;
+        n = sscanf(entry, " %15[^=]=%u/%u", name, &latencyMs, &failPercent);
+        if((n < 2) || (failPercent > 100))
+        {
+            WA_WARN("ParseInject(): invalid " ENV_INJECT " entry '%s'\n", entry);
+            continue;
+        }
+
+        for(i = 0; i < WA_UTILS_SIM_POINTS; ++i)
+        {
+            if(!strcmp(name, "*") || !strcmp(name, pointNames[i]))
+            {
+                inject[i].latencyMs = latencyMs;
+                inject[i].failPercent = failPercent;
+                if(strcmp(name, "*"))
+                {
+                    break;
+                }
+            }
+        }
+        if(strcmp(name, "*") && (i == WA_UTILS_SIM_POINTS))
+        {
+            WA_WARN("ParseInject(): unknown injection point '%s'\n", name);
+        }
+    }
+
+    free(specs);
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,181 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_sim.h
+ *
+ * @brief This file contains the hardware simulation backend (--enable-hw-sim).
+ *
+ * A simulation build replaces the IARM bus, the SNMP client, TRM and the dsMgr
+ * video ports with fakes answering from a fixture tree, and serves the rmfstreamer
+ * tune requests from a fake streamer on the loopback. It is configured from the
+ * environment, so the agent, tr69profile and the CLI see the same simulated box:
+ *
+ * - HWST_SIM_ROOT   the fixture tree (default \c WA_UTILS_SIM_DEFAULT_ROOT)
+ * - HWST_SIM_SEED   seed of the failure injection (default 1), runs with the same seed
+ *                   fail the same calls
+ * - HWST_SIM_INJECT comma separated "<point>=<latency ms>[/<failure %>]", the points
+ *                   are "iarm", "snmp", "trm", "streamer", "exec" and "*" for all
+ *
+ * The fixture tree mirrors the box rootfs for the platform files the diags read
+ * (proc/brcm/frontend, etc/device.properties, version.txt, ...) and holds the
+ * fake services data under sim/:
+ *
+ * - sim/iarm/<owner>/<method> the raw argument returned by the call (the leading bytes
+ *                             when shorter), the call fails if missing; the owner
+ *                             directory makes the member connected
+ * - sim/snmp                  lines "<server|*> <oid> <value>", in walk order; counter64
+ *                             values are given as "<high>:<low>"
+ * - sim/vport                 "hdmi_port=", "display_connected=", "hdcp_enabled=" options
+ * - sim/cmd/<name>            run instead of the command <name> given to WA_DIAG_Popen()
+ *                             or WA_DIAG_System(), with the same arguments
+ */
+
+/** @addtogroup WA_UTILS_SIM
+ *  @{
+ */
+
+#ifndef WA_UTILS_SIM_H
+#define WA_UTILS_SIM_H
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stddef.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED DEFINITIONS
+ *****************************************************************************/
+
+#define WA_UTILS_SIM_DEFAULT_ROOT "/opt/hwselftest/sim"
+
+/* Platform file and command lookups go through these, they are no-ops outside of the simulation. */
+#ifdef WA_HW_SIM
+#define WA_UTILS_SIM_PATH(path) WA_UTILS_SIM_Path(path)
+#define WA_UTILS_SIM_COMMAND(command) WA_UTILS_SIM_Command(command)
+#else
+#define WA_UTILS_SIM_PATH(path) (path)
+#define WA_UTILS_SIM_COMMAND(command) (command)
+#endif
+
+/*****************************************************************************
+ * EXPORTED TYPES
+ *****************************************************************************/
+
+/** Points where latency and failures are injected. */
+typedef enum
+{
+    WA_UTILS_SIM_IARM = 0,
+    WA_UTILS_SIM_SNMP,
+    WA_UTILS_SIM_TRM,
+    WA_UTILS_SIM_STREAMER,
+    WA_UTILS_SIM_EXEC,
+    WA_UTILS_SIM_POINTS
+} WA_UTILS_SIM_point_t;
+
+/*****************************************************************************
+ * EXPORTED VARIABLES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @brief Returns the fixture tree.
+ */
+const char *WA_UTILS_SIM_Root(void);
+
+/**
+ * @brief Maps a platform file to the fixture tree.
+ *
+ * @param path absolute path on the box
+ *
+ * @return the path under the fixture tree, valid until the next 3 calls from the same task
+ */
+const char *WA_UTILS_SIM_Path(const char *path);
+
+/**
+ * @brief Maps a shell command to its fixture, if there is one.
+ *
+ * Injects the "exec" latency. An injected failure turns the command into \c false.
+ *
+ * @param command the command line
+ *
+ * @return the command line to run, valid until the next call from the same task
+ */
+const char *WA_UTILS_SIM_Command(const char *command);
+
+/**
+ * @brief Waits the latency of the point and decides if the call fails.
+ *
+ * @param point the injection point
+ *
+ * @retval 0 the call goes on
+ * @retval -1 the call has to fail
+ */
+int WA_UTILS_SIM_Inject(WA_UTILS_SIM_point_t point);
+
+/**
+ * @brief Reads a fake service data file.
+ *
+ * @param name path under the sim/ directory of the fixture tree
+ * @param[out] pSize size of the data (might be null)
+ *
+ * @return the data, nul terminated, to be released with free(); null if not found
+ */
+char *WA_UTILS_SIM_Fixture(const char *name, size_t *pSize);
+
+/**
+ * @brief Starts the fake rmfstreamer.
+ *
+ * Answers every request on the loopback port with an endless stream of null TS packets.
+ *
+ * @param port the streamer port
+ *
+ * @retval 0 success
+ * @retval -1 error
+ */
+int WA_UTILS_SIM_StreamerStart(int port);
+
+/**
+ * @brief Stops the fake rmfstreamer and closes its connections.
+ */
+void WA_UTILS_SIM_StreamerStop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_UTILS_SIM_H */
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
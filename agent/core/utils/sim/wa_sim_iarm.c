@@ -0,0 +1,178 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_sim_iarm.c
+ *
+ * @brief This file contains the simulated IARM bus, it takes the place of libIARMBus.
+ *
+ * Calls are answered from the sim/iarm/<owner>/<method> fixtures. Event handlers
+ * are never called, there is nobody to broadcast.
+ */
+
+/** @addtogroup WA_UTILS_SIM
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_sim.h"
+#include "wa_debug.h"
+
+/*****************************************************************************
+ * RDK-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "libIBus.h"
+#include "libIARMCore.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+IARM_Result_t IARM_Bus_Init(const char *name)
+{
+    WA_INFO("IARM_Bus_Init(%s): simulated bus, fixtures in '%s'\n", name, WA_UTILS_SIM_Root());
+    return IARM_RESULT_SUCCESS;
+}
+
+IARM_Result_t IARM_Bus_Term(void)
+{
+    return IARM_RESULT_SUCCESS;
+}
+
+IARM_Result_t IARM_Bus_Connect(void)
+{
+    return (WA_UTILS_SIM_Inject(WA_UTILS_SIM_IARM) == 0) ? IARM_RESULT_SUCCESS : IARM_RESULT_IPCCORE_FAIL;
+}
+
+IARM_Result_t IARM_Bus_Disconnect(void)
+{
+    return IARM_RESULT_SUCCESS;
+}
+
+IARM_Result_t IARM_Bus_IsConnected(const char *memberName, int *isRegistered)
+{
+    char path[PATH_MAX];
+    struct stat st;
+
+    if(!memberName || !isRegistered)
+    {
+        return IARM_RESULT_INVALID_PARAM;
+    }
+
+    if(WA_UTILS_SIM_Inject(WA_UTILS_SIM_IARM) != 0)
+    {
+        return IARM_RESULT_IPCCORE_FAIL;
+    }
+
+    /* a member is up if it has fixtures */
+    snprintf(path, sizeof(path), "%s/sim/iarm/%s", WA_UTILS_SIM_Root(), memberName);
+    *isRegistered = (stat(path, &st) == 0) && S_ISDIR(st.st_mode);
+    return IARM_RESULT_SUCCESS;
+}
+
+IARM_Result_t IARM_Bus_Call(const char *ownerName, const char *methodName, void *arg, size_t argLen)
+{
+    char name[PATH_MAX];
+    char *data;
+    size_t size;
+
+    if(!ownerName || !methodName)
+    {
+        return IARM_RESULT_INVALID_PARAM;
+    }
+
+    if(WA_UTILS_SIM_Inject(WA_UTILS_SIM_IARM) != 0)
+    {
+        return IARM_RESULT_IPCCORE_FAIL;
+    }
+
+    snprintf(name, sizeof(name), "iarm/%s/%s", ownerName, methodName);
+    data = WA_UTILS_SIM_Fixture(name, &size);
+    if(!data)
+    {
+        WA_DBG("IARM_Bus_Call(%s, %s): no fixture\n", ownerName, methodName);
+        return IARM_RESULT_INVALID_STATE;
+    }
+
+    if(arg)
+    {
+        memcpy(arg, data, (size < argLen) ? size : argLen);
+    }
+    free(data);
+
+    return IARM_RESULT_SUCCESS;
+}
+
+IARM_Result_t IARM_Malloc(IARM_MemType_t type, size_t size, void **ptr)
+{
+    (void)type;
+
+    if(!ptr)
+    {
+        return IARM_RESULT_INVALID_PARAM;
+    }
+
+    *ptr = malloc(size);
+    return *ptr ? IARM_RESULT_SUCCESS : IARM_RESULT_OOM;
+}
+
+IARM_Result_t IARM_Free(IARM_MemType_t type, void *alloc)
+{
+    (void)type;
+
+    free(alloc);
+    return IARM_RESULT_SUCCESS;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,292 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_sim_snmp.c
+ *
+ * @brief This file contains the simulated SNMP client, it takes the place of wa_snmp_client.c.
+ *
+ * The sim/snmp fixture is loaded by WA_UTILS_SNMP_Init() and is read-only afterwards.
+ * A get matches the OID exactly, a walk returns the first entry under the OID, like
+ * the getnext of the real client.
+ */
+
+/** @addtogroup WA_UTILS_SIM
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_snmp_client.h"
+#include "wa_sim.h"
+#include "wa_debug.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define FIXTURE "snmp"
+#define FIELD_LEN 256
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+
+typedef struct
+{
+    const char *server; /**< "*" matches any */
+    const char *oid;
+    const char *value;
+} WA_UTILS_SIM_snmpEntry_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static const WA_UTILS_SIM_snmpEntry_t *Find(const char *server, const char *reqoid, WA_UTILS_SNMP_ReqType_t reqType);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+
+static char *fixture;
+static WA_UTILS_SIM_snmpEntry_t *entries;
+static unsigned int entriesCount;
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+int WA_UTILS_SNMP_Init()
+{
+    char *line, *next, *p;
+    unsigned int lines = 0;
+
+    fixture = WA_UTILS_SIM_Fixture(FIXTURE, NULL);
+    if(!fixture)
+    {
+        WA_WARN("WA_UTILS_SNMP_Init(): no SNMP fixture, every request fails\n");
+        return 0;
+    }
+
+    for(p = fixture; *p; ++p)
+    {
+        lines += (*p == '\n');
+    }
+
+    entries = malloc((lines + 1) * sizeof(*entries));
+    if(!entries)
+    {
+        WA_ERROR("WA_UTILS_SNMP_Init(): malloc() error\n");
+        free(fixture);
+        fixture = NULL;
+        return -1;
+    }
+
+    /* split "<server> <oid> <value>" in place */
+    entriesCount = 0;
+    for(line = fixture; line && *line; line = next)
+    {
+        WA_UTILS_SIM_snmpEntry_t *e = &entries[entriesCount];
+
+        next = strchr(line, '\n');
+        if(next)
+        {
+            *next++ = '\0';
+        }
+
+        e->server = line + strspn(line, " \t");
+        if((*e->server == '\0') || (*e->server == '#'))
+        {
+            continue;
+        }
+
+        p = (char *)e->server + strcspn(e->server, " \t");
+        if(*p == '\0')
+        {
+            WA_WARN("WA_UTILS_SNMP_Init(): invalid entry '%s'\n", line);
+            continue;
+        }
+        *p++ = '\0';
+        e->oid = p + strspn(p, " \t");
+        p = (char *)e->oid + strcspn(e->oid, " \t");
+        if(*p != '\0')
+        {
+            *p++ = '\0';
+        }
+        e->value = p + strspn(p, " \t");
+        ++entriesCount;
+    }
+
+    WA_DBG("WA_UTILS_SNMP_Init(): %u simulated OIDs\n", entriesCount);
+    return 0;
+}
+
+int WA_UTILS_SNMP_Exit()
+{
+    free(entries);
+    entries = NULL;
+    entriesCount = 0;
+    free(fixture);
+    fixture = NULL;
+    return 0;
+}
+
+bool WA_UTILS_SNMP_GetString(const char *server, const char * reqoid, char * buffer, size_t bufSize, WA_UTILS_SNMP_ReqType_t reqType)
+{
+    const WA_UTILS_SIM_snmpEntry_t *e;
+
+    if (!server || !reqoid || !buffer || !bufSize)
+    {
+        WA_ERROR("WA_UTILS_SNMP_GetString(): Invalid parameters\n");
+        return false;
+    }
+
+    e = Find(server, reqoid, reqType);
+    if(!e)
+    {
+        return false;
+    }
+
+    snprintf(buffer, bufSize, "%s", e->value);
+    WA_INFO("WA_UTILS_SNMP_GetString(%s, %s, %i): returned '%s'\n", server, reqoid, reqType, buffer);
+    return true;
+}
+
+bool WA_UTILS_SNMP_GetNumber(const char *server, const char *reqoid, WA_UTILS_SNMP_Resp_t *buffer, WA_UTILS_SNMP_ReqType_t reqType)
+{
+    const WA_UTILS_SIM_snmpEntry_t *e;
+    unsigned long long value;
+    unsigned long high, low;
+
+    if (!server || !reqoid || !buffer)
+    {
+        WA_ERROR("WA_UTILS_SNMP_GetNumber(): Invalid parameters\n");
+        return false;
+    }
+
+    e = Find(server, reqoid, reqType);
+    if(!e)
+    {
+        return false;
+    }
+
+    switch(buffer->type)
+    {
+        case WA_UTILS_SNMP_RESP_TYPE_LONG:
+            buffer->data.l = strtol(e->value, NULL, 0);
+            break;
+
+        case WA_UTILS_SNMP_RESP_TYPE_COUNTER64:
+            if(sscanf(e->value, "%lu:%lu", &high, &low) != 2)
+            {
+                value = strtoull(e->value, NULL, 0);
+                high = value >> 32;
+                low = value & 0xffffffffUL;
+            }
+            buffer->data.c64.high = high;
+            buffer->data.c64.low = low;
+            break;
+
+        default:
+            WA_ERROR("WA_UTILS_SNMP_GetNumber(): Invalid response type specified\n");
+            return false;
+    }
+
+    WA_INFO("WA_UTILS_SNMP_GetNumber(server: %s, oid: %s, reqType: %i): returned %s\n", server, reqoid, reqType, e->value);
+    return true;
+}
+
+bool WA_UTILS_SNMP_FindIfIndex(const char *server, const char *reqoid, int *ifIndex)
+{
+    const WA_UTILS_SIM_snmpEntry_t *e;
+    char buff[FIELD_LEN];
+    int idx;
+
+    if (!server || !reqoid || !ifIndex)
+    {
+        WA_ERROR("WA_UTILS_SNMP_FindIfIndex(): Invalid parameters\n");
+        return false;
+    }
+
+    e = Find(server, reqoid, WA_UTILS_SNMP_REQ_TYPE_WALK);
+    if(!e)
+    {
+        WA_ERROR("WA_UTILS_SNMP_FindIfIndex(): no such object\n");
+        return false;
+    }
+
+    if(sscanf(e->oid, "%255[^.].%d", buff, &idx) != 2)
+    {
+        WA_ERROR("WA_UTILS_SNMP_FindIfIndex(): index not found\n");
+        return false;
+    }
+
+    WA_DBG("WA_UTILS_SNMP_FindIfIndex(): index: %d\n", idx);
+    *ifIndex = idx;
+    return true;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+static const WA_UTILS_SIM_snmpEntry_t *Find(const char *server, const char *reqoid, WA_UTILS_SNMP_ReqType_t reqType)
+{
+    size_t len = strlen(reqoid);
+    unsigned int i;
+
+    if(WA_UTILS_SIM_Inject(WA_UTILS_SIM_SNMP) != 0)
+    {
+        WA_DBG("Find(%s, %s): timeout\n", server, reqoid);
+        return NULL;
+    }
+
+    for(i = 0; i < entriesCount; ++i)
+    {
+        const WA_UTILS_SIM_snmpEntry_t *e = &entries[i];
+
+        if(strcmp(e->server, "*") && strcmp(e->server, server))
+        {
+            continue;
+        }
+
+        if(!strcmp(e->oid, reqoid) ||
+           ((reqType == WA_UTILS_SNMP_REQ_TYPE_WALK) && !strncmp(e->oid, reqoid, len) && (e->oid[len] == '.')))
+        {
+            return e;
+        }
+    }
+
+    WA_DBG("Find(%s, %s): no such object\n", server, reqoid);
+    return NULL;
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,295 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_sim_streamer.c
+ *
+ * @brief This file contains the simulated rmfstreamer.
+ *
+ * One task serves all the tune sessions: the first data on a connection is taken
+ * as the request, it is answered after the "streamer" latency and then a chunk of
+ * null TS packets is sent every tick until the client closes. An injected failure
+ * drops the connection, like a tune that does not start.
+ */
+
+/** @addtogroup WA_UTILS_SIM
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_sim.h"
+#include "wa_osa.h"
+#include "wa_debug.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define MAX_CLIENTS 16
+#define TICK_MS 20
+#define TS_PACKET_SIZE 188
+#define CHUNK_PACKETS 7 /* one chunk per connection every tick, about 0.5 Mbps */
+#define REQUEST_LEN 1024
+#define RESPONSE "HTTP/1.1 200 OK\r\nContent-Type: video/mp2t\r\n\r\n"
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+
+typedef struct
+{
+    int fd;
+    bool streaming;
+} WA_UTILS_SIM_client_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static void *StreamerTask(void *p);
+static bool Serve(WA_UTILS_SIM_client_t *pClient, short revents, const unsigned char *chunk);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+
+static int listenFd = -1;
+static int wakeFds[2] = {-1, -1};
+static void *streamerTaskHandle;
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+int WA_UTILS_SIM_StreamerStart(int port)
+{
+    struct sockaddr_in address;
+    int on = 1;
+
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(listenFd < 0)
+    {
+        WA_ERROR("WA_UTILS_SIM_StreamerStart(): socket() error: %i (%s)\n", errno, strerror(errno));
+        goto err_socket;
+    }
+
+    if(setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0)
+    {
+        WA_ERROR("WA_UTILS_SIM_StreamerStart(): setsockopt() error: %i (%s)\n", errno, strerror(errno));
+        goto err_listen;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if((bind(listenFd, (struct sockaddr *)&address, sizeof(address)) < 0) || (listen(listenFd, MAX_CLIENTS) < 0))
+    {
+        WA_ERROR("WA_UTILS_SIM_StreamerStart(): port %i: %i (%s)\n", port, errno, strerror(errno));
+        goto err_listen;
+    }
+
+    if(pipe2(wakeFds, O_CLOEXEC) < 0)
+    {
+        WA_ERROR("WA_UTILS_SIM_StreamerStart(): pipe2() error: %i (%s)\n", errno, strerror(errno));
+        goto err_listen;
+    }
+
+    streamerTaskHandle = WA_OSA_TaskCreate("simstreamer", 0, StreamerTask, NULL, WA_OSA_SCHED_POLICY_NORMAL, 0);
+    if(streamerTaskHandle == NULL)
+    {
+        WA_ERROR("WA_UTILS_SIM_StreamerStart(): WA_OSA_TaskCreate(StreamerTask): error\n");
+        goto err_task;
+    }
+
+    WA_INFO("WA_UTILS_SIM_StreamerStart(): streaming on port %i\n", port);
+    return 0;
+
+err_task:
+    close(wakeFds[0]);
+    close(wakeFds[1]);
+    wakeFds[0] = wakeFds[1] = -1;
+err_listen:
+    close(listenFd);
+    listenFd = -1;
+err_socket:
+    return -1;
+}
+
+void WA_UTILS_SIM_StreamerStop(void)
+{
+    if(streamerTaskHandle == NULL)
+    {
+        return;
+    }
+
+    if(write(wakeFds[1], "q", 1) != 1)
+    {
+        WA_ERROR("WA_UTILS_SIM_StreamerStop(): write() error: %i (%s)\n", errno, strerror(errno));
+    }
+    WA_OSA_TaskJoin(streamerTaskHandle, NULL);
+    WA_OSA_TaskDestroy(streamerTaskHandle);
+    streamerTaskHandle = NULL;
+
+    close(wakeFds[0]);
+    close(wakeFds[1]);
+    wakeFds[0] = wakeFds[1] = -1;
+    close(listenFd);
+    listenFd = -1;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+static void *StreamerTask(void *p)
+{
+    WA_UTILS_SIM_client_t clients[MAX_CLIENTS];
+    struct pollfd pfds[MAX_CLIENTS + 2];
+    unsigned char chunk[CHUNK_PACKETS * TS_PACKET_SIZE];
+    unsigned int count = 0, polled, i;
+    int fd;
+
+    (void)p;
+
+    /* null packets: sync byte, PID 0x1fff, payload only */
+    memset(chunk, 0xff, sizeof(chunk));
+    for(i = 0; i < CHUNK_PACKETS; ++i)
+    {
+        chunk[i * TS_PACKET_SIZE] = 0x47;
+        chunk[i * TS_PACKET_SIZE + 1] = 0x1f;
+        chunk[i * TS_PACKET_SIZE + 3] = 0x10;
+    }
+
+    for(;;)
+    {
+        pfds[0].fd = wakeFds[0];
+        pfds[0].events = POLLIN;
+        pfds[1].fd = listenFd;
+        pfds[1].events = (count < MAX_CLIENTS) ? POLLIN : 0;
+        for(i = 0; i < count; ++i)
+        {
+            pfds[i + 2].fd = clients[i].fd;
+            pfds[i + 2].events = POLLIN;
+        }
+        polled = count;
+
+        if(poll(pfds, polled + 2, TICK_MS) < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            WA_ERROR("StreamerTask(): poll() error: %i (%s)\n", errno, strerror(errno));
+            break;
+        }
+
+        if(pfds[0].revents)
+        {
+            break;
+        }
+
+        if(pfds[1].revents & POLLIN)
+        {
+            fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if(fd >= 0)
+            {
+                clients[count].fd = fd;
+                clients[count].streaming = false;
+                ++count;
+            }
+        }
+
+        /* backwards, a dropped client is replaced by one already served or just accepted */
+        for(i = polled; i-- > 0;)
+        {
+            if(!Serve(&clients[i], pfds[i + 2].revents, chunk))
+            {
+                close(clients[i].fd);
+                clients[i] = clients[--count];
+            }
+        }
+    }
+
+    for(i = 0; i < count; ++i)
+    {
+        close(clients[i].fd);
+    }
+
+    return NULL;
+}
+
+/* Returns false when the connection is to be dropped. */
+static bool Serve(WA_UTILS_SIM_client_t *pClient, short revents, const unsigned char *chunk)
+{
+    char request[REQUEST_LEN];
+    ssize_t n;
+
+    if(revents & (POLLIN | POLLHUP | POLLERR))
+    {
+        n = recv(pClient->fd, request, sizeof(request), 0);
+        if((n == 0) || ((n < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)))
+        {
+            return false;
+        }
+
+        if((n > 0) && !pClient->streaming)
+        {
+            if(WA_UTILS_SIM_Inject(WA_UTILS_SIM_STREAMER) != 0)
+            {
+                return false;
+            }
+
+            if(send(pClient->fd, RESPONSE, strlen(RESPONSE), MSG_NOSIGNAL) < 0)
+            {
+                return false;
+            }
+            pClient->streaming = true;
+        }
+    }
+
+    if(pClient->streaming &&
+       (send(pClient->fd, chunk, CHUNK_PACKETS * TS_PACKET_SIZE, MSG_NOSIGNAL) < 0) &&
+       (errno != EAGAIN) && (errno != EWOULDBLOCK))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
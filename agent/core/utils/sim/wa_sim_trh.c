@@ -0,0 +1,226 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_sim_trh.c
+ *
+ * @brief This file contains the simulated TRM, it takes the place of wa_trh.cpp.
+ *
+ * Every reservation is granted after the "trm" latency, unless a failure is
+ * injected. Nothing else competes for the tuners, so they are never taken away.
+ */
+
+/** @addtogroup WA_UTILS_SIM
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_trh.h"
+#include "wa_sim.h"
+#include "wa_osa.h"
+#include "wa_debug.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+
+typedef struct
+{
+    int eventFd;
+    WA_UTILS_TRH_State_t state;
+} WA_UTILS_SIM_reservation_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+int WA_UTILS_TRH_Init()
+{
+    return 0;
+}
+
+int WA_UTILS_TRH_Exit()
+{
+    return 0;
+}
+
+int WA_UTILS_TRH_ReserveTuner(const char *url, uint64_t when, uint64_t duration, int timeout_ms, int tuner_count, void **out_handle)
+{
+    void *handle;
+
+    (void)timeout_ms;
+    (void)tuner_count;
+
+    if (WA_UTILS_TRH_RequestTuner(url, when, duration, &handle))
+        return 1;
+
+    if (out_handle)
+        *out_handle = handle;
+    else
+        WA_UTILS_TRH_ReleaseTuner(handle, 0);
+
+    return 0;
+}
+
+int WA_UTILS_TRH_RequestTuner(const char *url, uint64_t when, uint64_t duration, void **out_handle)
+{
+    WA_UTILS_SIM_reservation_t *reservation;
+    uint64_t event = 1;
+
+    WA_ENTER("WA_UTILS_TRH_RequestTuner(): url='%s', when=%llu, duration=%llu, out_handle=%p\n",
+                url, (unsigned long long)when, (unsigned long long)duration, out_handle);
+
+    if (!out_handle)
+    {
+        WA_ERROR("WA_UTILS_TRH_RequestTuner(): invalid parameters\n");
+        return 1;
+    }
+
+    if (WA_UTILS_SIM_Inject(WA_UTILS_SIM_TRM) != 0)
+    {
+        WA_ERROR("WA_UTILS_TRH_RequestTuner(): failed to request tuner reservation\n");
+        return 1;
+    }
+
+    reservation = malloc(sizeof(*reservation));
+    if (!reservation)
+    {
+        WA_ERROR("WA_UTILS_TRH_RequestTuner(): malloc() error\n");
+        return 1;
+    }
+
+    reservation->eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (reservation->eventFd < 0)
+    {
+        WA_ERROR("WA_UTILS_TRH_RequestTuner(): eventfd() error\n");
+        free(reservation);
+        return 1;
+    }
+
+    reservation->state = WA_UTILS_TRH_STATE_RESERVED;
+    if (write(reservation->eventFd, &event, sizeof(event)) != sizeof(event))
+        WA_WARN("WA_UTILS_TRH_RequestTuner(): event not signalled\n");
+
+    *out_handle = reservation;
+
+    WA_RETURN("WA_UTILS_TRH_RequestTuner(): status=0\n");
+
+    return 0;
+}
+
+int WA_UTILS_TRH_GetFreeTuners()
+{
+    /* nothing else takes the tuners, all of them are free */
+    return (WA_UTILS_SIM_Inject(WA_UTILS_SIM_TRM) != 0) ? -1 : INT_MAX;
+}
+
+int WA_UTILS_TRH_GetEventFd(void *handle)
+{
+    if (!handle)
+        return -1;
+
+    return ((WA_UTILS_SIM_reservation_t *)handle)->eventFd;
+}
+
+WA_UTILS_TRH_State_t WA_UTILS_TRH_GetState(void *handle)
+{
+    WA_UTILS_SIM_reservation_t *reservation = handle;
+    uint64_t events;
+
+    if (!reservation)
+        return WA_UTILS_TRH_STATE_FAILED;
+
+    while (read(reservation->eventFd, &events, sizeof(events)) == sizeof(events))
+        ;
+
+    return reservation->state;
+}
+
+int WA_UTILS_TRH_ReleaseTuner(void *handle, int timeout_ms)
+{
+    WA_UTILS_SIM_reservation_t *reservation = handle;
+    int status;
+
+    (void)timeout_ms;
+
+    if (!reservation)
+    {
+        WA_ERROR("WA_UTILS_TRH_ReleaseTuner(): invalid reservation handle %p\n", handle);
+        return 1;
+    }
+
+    status = (WA_UTILS_SIM_Inject(WA_UTILS_SIM_TRM) != 0);
+    if (status)
+        WA_ERROR("WA_UTILS_TRH_ReleaseTuner(): reservation release failure\n");
+
+    close(reservation->eventFd);
+    free(reservation);
+
+    return status;
+}
+
+int WA_UTILS_TRH_WaitForTunerRelease(void *handle, int timeout_ms)
+{
+    if (!handle)
+    {
+        WA_ERROR("WA_UTILS_TRH_WaitForTunerRelease(): invalid reservation handle %p\n", handle);
+        return 1;
+    }
+
+    /* the tuner is never taken away, wait out the timeout; "forever" would hang */
+    if (timeout_ms > 0)
+        WA_OSA_TaskSleep(timeout_ms);
+
+    WA_ERROR("WA_UTILS_TRH_WaitForTunerRelease(): tuner release time out\n");
+
+    return 2;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,170 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_sim_vport.c
+ *
+ * @brief This file contains the simulated dsMgr video ports, it takes the place of
+ *        wa_mgr.cpp and wa_vport.cpp.
+ *
+ * The ports are described by the sim/vport fixture, dsMgr is reached over IARM
+ * so the "iarm" injection applies.
+ */
+
+/** @addtogroup WA_UTILS_SIM
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_mgr.h"
+#include "wa_vport.h"
+#include "wa_sim.h"
+#include "wa_osa.h"
+#include "wa_debug.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define FIXTURE "vport"
+#define OPTION_HDMI_PORT "hdmi_port="
+#define OPTION_DISPLAY_CONNECTED "display_connected="
+#define OPTION_HDCP_ENABLED "hdcp_enabled="
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static int Option(const char *option, int defaultValue);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+void WA_UTILS_MGR_Init(void)
+{
+}
+
+void WA_UTILS_MGR_Term(void)
+{
+}
+
+int WA_UTILS_VPORT_GetHdmiPortId(void)
+{
+    int id;
+
+    if(WA_OSA_TaskCheckQuit())
+    {
+        return WA_UTILS_VPORT_ID_CHECK_CANCELLED;
+    }
+
+    if(WA_UTILS_SIM_Inject(WA_UTILS_SIM_IARM) != 0)
+    {
+        return WA_UTILS_VPORT_ID_UNKNOWN;
+    }
+
+    id = Option(OPTION_HDMI_PORT, WA_UTILS_VPORT_ID_UNKNOWN);
+    return (id < 0) ? WA_UTILS_VPORT_ID_UNKNOWN : id;
+}
+
+int WA_UTILS_VPORT_IsDisplayConnected(int id)
+{
+    (void)id;
+
+    if(WA_UTILS_SIM_Inject(WA_UTILS_SIM_IARM) != 0)
+    {
+        return 0;
+    }
+
+    return Option(OPTION_DISPLAY_CONNECTED, 0) != 0;
+}
+
+int WA_UTILS_VPORT_IsHdcpEnabled(int id)
+{
+    int enabled;
+
+    (void)id;
+
+    if(WA_OSA_TaskCheckQuit())
+    {
+        return WA_UTILS_VPORT_HDCP_CHECK_CANCELLED;
+    }
+
+    if(WA_UTILS_SIM_Inject(WA_UTILS_SIM_IARM) != 0)
+    {
+        return WA_UTILS_VPORT_HDCP_UNKNOWN;
+    }
+
+    enabled = Option(OPTION_HDCP_ENABLED, -1);
+    if(enabled < 0)
+    {
+        return WA_UTILS_VPORT_HDCP_UNKNOWN;
+    }
+    return enabled ? WA_UTILS_VPORT_HDCP_ENABLED : WA_UTILS_VPORT_HDCP_DISABLED;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+static int Option(const char *option, int defaultValue)
+{
+    char *data, *line;
+    int value = defaultValue;
+    size_t len = strlen(option);
+
+    data = WA_UTILS_SIM_Fixture(FIXTURE, NULL);
+    if(!data)
+    {
+        return defaultValue;
+    }
+
+    for(line = data; line; line = strchr(line, '\n'))
+    {
+        line += (*line == '\n');
+        if(!strncmp(line, option, len))
+        {
+            value = atoi(line + len);
+            break;
+        }
+    }
+
+    free(data);
+    return value;
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,279 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_slab.c
+ *
+ * @brief This file contains the shared slab allocator for small objects.
+ *
+ * Every slab is aligned to its size, so the slab header of an object is found
+ * by masking the object address. A size class keeps the slabs with free objects
+ * on a list, each slab keeps its free objects on its own list.
+ */
+
+/** @addtogroup WA_UTILS_SLAB
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_slab.h"
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define ALIGNMENT 16
+#define ALIGN(x) (((x) + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1))
+#define CLASSES (sizeof(classSizes) / sizeof(classSizes[0]))
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+typedef struct WA_UTILS_SLAB_Slab_tag
+{
+    struct WA_UTILS_SLAB_Slab_tag *pNext; /**< on the partial list of the class */
+    struct WA_UTILS_SLAB_Slab_tag *pPrev;
+    void *pFree; /**< free objects of this slab */
+    unsigned short used;
+    unsigned short cls;
+}WA_UTILS_SLAB_Slab_t;
+
+typedef struct
+{
+    WA_UTILS_SLAB_Slab_t *pPartial; /**< slabs with at least one free object */
+    unsigned int slabs;
+    unsigned int objects;
+}WA_UTILS_SLAB_Class_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static int ClassOf(size_t size);
+static WA_UTILS_SLAB_Slab_t *NewSlab(unsigned int cls);
+static void Unlink(WA_UTILS_SLAB_Class_t *pClass, WA_UTILS_SLAB_Slab_t *pSlab);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+static const unsigned short classSizes[] = { 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024 };
+
+static pthread_mutex_t slabMutex = PTHREAD_MUTEX_INITIALIZER;
+static WA_UTILS_SLAB_Class_t classes[CLASSES];
+static size_t largeBytes;
+static unsigned int largeObjects;
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+void *WA_UTILS_SLAB_Alloc(size_t size)
+{
+    WA_UTILS_SLAB_Class_t *pClass;
+    WA_UTILS_SLAB_Slab_t *pSlab;
+    void *p = NULL;
+    int cls;
+
+    cls = ClassOf(size);
+
+    pthread_mutex_lock(&slabMutex);
+    if(cls < 0)
+    {
+        p = malloc(size);
+        if(p != NULL)
+        {
+            largeBytes += size;
+            largeObjects++;
+        }
+        goto end;
+    }
+
+    pClass = &classes[cls];
+    pSlab = pClass->pPartial;
+    if(pSlab == NULL)
+    {
+        pSlab = NewSlab(cls);
+        if(pSlab == NULL)
+        {
+            goto end;
+        }
+        pClass->pPartial = pSlab;
+        pClass->slabs++;
+    }
+
+    p = pSlab->pFree;
+    pSlab->pFree = *(void **)p;
+    pSlab->used++;
+    pClass->objects++;
+    if(pSlab->pFree == NULL)
+    {
+        Unlink(pClass, pSlab);
+    }
+
+end:
+    pthread_mutex_unlock(&slabMutex);
+    return p;
+}
+
+void WA_UTILS_SLAB_Free(void *p, size_t size)
+{
+    WA_UTILS_SLAB_Class_t *pClass;
+    WA_UTILS_SLAB_Slab_t *pSlab;
+
+    if(p == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&slabMutex);
+    if(ClassOf(size) < 0)
+    {
+        free(p);
+        largeBytes -= size;
+        largeObjects--;
+        goto end;
+    }
+
+    pSlab = (WA_UTILS_SLAB_Slab_t *)((uintptr_t)p & ~(uintptr_t)(WA_UTILS_SLAB_SIZE - 1));
+    pClass = &classes[pSlab->cls];
+
+    if(pSlab->pFree == NULL)
+    {
+        /* was full, back on the partial list */
+        pSlab->pPrev = NULL;
+        pSlab->pNext = pClass->pPartial;
+        if(pClass->pPartial != NULL)
+        {
+            pClass->pPartial->pPrev = pSlab;
+        }
+        pClass->pPartial = pSlab;
+    }
+    *(void **)p = pSlab->pFree;
+    pSlab->pFree = p;
+    pSlab->used--;
+    pClass->objects--;
+
+    /* give an empty slab back, unless it is the only one with free room */
+    if((pSlab->used == 0) && ((pSlab->pPrev != NULL) || (pSlab->pNext != NULL)))
+    {
+        Unlink(pClass, pSlab);
+        pClass->slabs--;
+        free(pSlab);
+    }
+
+end:
+    pthread_mutex_unlock(&slabMutex);
+}
+
+void WA_UTILS_SLAB_GetStats(WA_UTILS_SLAB_Stats_t *pStats)
+{
+    unsigned int i;
+
+    pthread_mutex_lock(&slabMutex);
+    pStats->reserved = largeBytes;
+    pStats->used = largeBytes;
+    pStats->slabs = 0;
+    pStats->objects = largeObjects;
+    for(i = 0; i < CLASSES; i++)
+    {
+        pStats->reserved += (size_t)classes[i].slabs * WA_UTILS_SLAB_SIZE;
+        pStats->used += (size_t)classes[i].objects * classSizes[i];
+        pStats->slabs += classes[i].slabs;
+        pStats->objects += classes[i].objects;
+    }
+    pthread_mutex_unlock(&slabMutex);
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+
+static int ClassOf(size_t size)
+{
+    unsigned int i;
+
+    for(i = 0; i < CLASSES; i++)
+    {
+        if(size <= classSizes[i])
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static WA_UTILS_SLAB_Slab_t *NewSlab(unsigned int cls)
+{
+    WA_UTILS_SLAB_Slab_t *pSlab;
+    char *p, *end;
+    void **ppLast;
+
+    if(posix_memalign((void **)&pSlab, WA_UTILS_SLAB_SIZE, WA_UTILS_SLAB_SIZE) != 0)
+    {
+        return NULL;
+    }
+
+    pSlab->pNext = NULL;
+    pSlab->pPrev = NULL;
+    pSlab->used = 0;
+    pSlab->cls = cls;
+
+    /* thread the objects in address order, so a fresh slab hands them out sequentially */
+    ppLast = &pSlab->pFree;
+    end = (char *)pSlab + WA_UTILS_SLAB_SIZE - classSizes[cls];
+    for(p = (char *)pSlab + ALIGN(sizeof(WA_UTILS_SLAB_Slab_t)); p <= end; p += classSizes[cls])
+    {
+        *ppLast = p;
+        ppLast = (void **)p;
+    }
+    *ppLast = NULL;
+
+    return pSlab;
+}
+
+static void Unlink(WA_UTILS_SLAB_Class_t *pClass, WA_UTILS_SLAB_Slab_t *pSlab)
+{
+    if(pSlab->pPrev != NULL)
+    {
+        pSlab->pPrev->pNext = pSlab->pNext;
+    }
+    else
+    {
+        pClass->pPartial = pSlab->pNext;
+    }
+    if(pSlab->pNext != NULL)
+    {
+        pSlab->pNext->pPrev = pSlab->pPrev;
+    }
+    pSlab->pNext = NULL;
+    pSlab->pPrev = NULL;
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,115 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_slab.h
+ *
+ * @brief This file contains the shared slab allocator for small objects.
+ */
+
+/** @addtogroup WA_UTILS_SLAB
+ *  @{
+ */
+
+#ifndef WA_UTILS_SLAB_H
+#define WA_UTILS_SLAB_H
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stddef.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED DEFINITIONS
+ *****************************************************************************/
+
+/** Size of one slab, objects of one size class are carved from slabs of this size */
+#define WA_UTILS_SLAB_SIZE 4096
+
+/** Largest object served from the slabs, bigger ones go to \c malloc() */
+#define WA_UTILS_SLAB_MAX_OBJECT 1024
+
+/*****************************************************************************
+ * EXPORTED TYPES
+ *****************************************************************************/
+
+/** Allocator footprint */
+typedef struct
+{
+    size_t reserved; /**< bytes taken from the system, slabs and large objects */
+    size_t used; /**< bytes handed out, rounded up to the size class */
+    unsigned int slabs; /**< slabs currently held */
+    unsigned int objects; /**< objects currently allocated */
+}WA_UTILS_SLAB_Stats_t;
+
+/*****************************************************************************
+ * EXPORTED VARIABLES
+ *****************************************************************************/
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @brief Allocates an object, thread-safe.
+ *
+ * Slabs are taken from the system on demand and given back once empty,
+ * except one spare slab per size class.
+ *
+ * @param size size of the object
+ *
+ * @return pointer to the object, aligned for any type, or NULL on error
+ */
+void *WA_UTILS_SLAB_Alloc(size_t size);
+
+/**
+ * @brief Releases an object, thread-safe.
+ *
+ * @param p the object, NULL is ignored
+ * @param size the size given to \c WA_UTILS_SLAB_Alloc()
+ */
+void WA_UTILS_SLAB_Free(void *p, size_t size);
+
+/**
+ * @brief Reads the allocator footprint.
+ *
+ * @param pStats where to store the footprint
+ */
+void WA_UTILS_SLAB_GetStats(WA_UTILS_SLAB_Stats_t *pStats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_UTILS_SLAB_H */
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
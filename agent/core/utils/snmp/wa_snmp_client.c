@@ -53,6 +53,7 @@
 #include "wa_osa.h"
 #include "wa_snmp_client.h"
 #include "wa_debug.h"
+#include "wa_metrics.h"
 
 /*****************************************************************************
  * GLOBAL VARIABLE DEFINITIONS
@@ -392,10 +393,13 @@ static WaSnmpSingleResult waSnmpGetSingle(const char *server, const char * reqOi
 
         snmp_add_null_var(pdu, reqOid, reqOidLength);
 
+        uint64_t callStart = WA_METRICS_Now();
         int rc = snmp_synch_response(sd.session, pdu, &sd.response);
+        WA_METRICS_Since(WA_METRICS_SNMP_CALL, callStart);
 
         if ((rc != STAT_SUCCESS) || (sd.response->errstat != SNMP_ERR_NOERROR) || !sd.response->variables)
         {
+            WA_METRICS_Inc(WA_METRICS_SNMP_ERRORS);
             WA_ERROR("waSnmpGetSingle(): snmp_synch_response() returned %i, errstat: %li, vars: %s\n",
                 rc, sd.response ? sd.response->errstat : -1, sd.response ? (sd.response->variables ? "ok" : "nok") : "");
 
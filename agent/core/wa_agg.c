@@ -46,7 +46,9 @@
 #include "wa_log.h"
 #include "wa_debug.h"
 #include "wa_osa.h"
+#include "wa_phash.h"
 #include "wa_diag_errcodes.h"
+#include "wa_results.h"
 
 /*****************************************************************************
  * GLOBAL VARIABLE DEFINITIONS
@@ -55,7 +57,7 @@
 /*****************************************************************************
  * LOCAL DEFINITIONS
  *****************************************************************************/
-#define AGG_RESULTS_FILE "/tmp/hwselftest.results"
+#define AGG_RESULTS_FILE WA_UTILS_RESULTS_FILE
 #define DEFAULT_RESULT_VALUE -200
 
  /*****************************************************************************
@@ -67,6 +69,8 @@
  *****************************************************************************/
 static int load_results(const char *file, WA_AGG_AggregateResults_t *bank);
 static int save_results(const char *file, const WA_AGG_AggregateResults_t *bank);
+static json_t *pack_usage(const WA_DIAG_Usage_t *usage);
+static int unpack_usage(json_t *json, WA_DIAG_Usage_t *usage);
 
 /*****************************************************************************
  * LOCAL VARIABLE DECLARATIONS
@@ -75,6 +79,7 @@ static void *api_mutex = NULL;
 static int current_bank = -1;
 static WA_AGG_AggregateResults_t agg_results[2];
 static bool writeTestResult = true;
+static WA_UTILS_PHASH_t diag_names; /* index of a diag in the diag_results of either bank */
 
 /*****************************************************************************
  * FUNCTION DEFINITIONS
@@ -124,6 +129,7 @@ int WA_AGG_Init(const WA_DIAG_proceduresConfig_t *diags)
                 agg_results[i].diag_results[count].timestamp = 0;
                 agg_results[i].diag_results[count].result = DEFAULT_RESULT_VALUE;
                 agg_results[i].diag_results[count].diagResultsName = pDiag->nameInResults;
+                agg_results[i].diag_results[count].hasUsage = false;
 
                 count++;
             }
@@ -133,6 +139,28 @@ int WA_AGG_Init(const WA_DIAG_proceduresConfig_t *diags)
         status = 0;
     }
 
+    if (!status)
+    {
+        const char **names = malloc((agg_results[0].diag_count + 1) * sizeof(*names));
+        if (names)
+        {
+            for (int i = 0; i < agg_results[0].diag_count; i++)
+                names[i] = agg_results[0].diag_results[i].diag;
+
+            if (WA_UTILS_PHASH_Init(&diag_names, names, agg_results[0].diag_count))
+            {
+                WA_ERROR("WA_AGG_Init(): WA_UTILS_PHASH_Init() failed\n");
+                status = 1;
+            }
+            free(names);
+        }
+        else
+        {
+            WA_ERROR("WA_AGG_Init(): out of memory\n");
+            status = 1;
+        }
+    }
+
 err:
     if (!status)
     {
@@ -165,6 +193,7 @@ int WA_AGG_Exit()
     /* release results memory */
     free(agg_results[0].diag_results);
     free(agg_results[1].diag_results);
+    WA_UTILS_PHASH_Exit(&diag_names);
 
     current_bank = -1;
 
@@ -200,6 +229,10 @@ int WA_AGG_StartTestRun(const char *client, bool results_filter, time_t timestam
     strncpy(agg_results[current_bank].client, client, sizeof(agg_results[current_bank].client) - 1);
     status = 0;
 
+    /* diags of this run share the hardware probes */
+    if (WA_DIAG_ProbeCacheStart())
+        WA_ERROR("WA_AGG_StartTestRun(): WA_DIAG_ProbeCacheStart() failed\n");
+
     if (WA_OSA_MutexUnlock(api_mutex))
         WA_ERROR("WA_AGG_StartTestRun(): WA_OSA_MutexUnlock() failed\n");
 
@@ -233,6 +266,8 @@ int WA_AGG_FinishTestRun(time_t timestamp)
                 WA_ERROR("WA_AGG_FinishTestRun(): failed to save results file\n");
         }
 
+        WA_DIAG_ProbeCacheClear();
+
         /* mark the bank as valid, force the other bank as dirty */
         agg_results[current_bank].dirty = false;
         agg_results[!current_bank].dirty = true;
@@ -251,7 +286,7 @@ err:
     return status;
 }
 
-int WA_AGG_SetTestResult(const char *diag_name, int result, time_t timestamp)
+int WA_AGG_SetTestResult(const char *diag_name, int result, time_t timestamp, const WA_DIAG_Usage_t *usage)
 {
     int status = 1;
 
@@ -267,184 +302,184 @@ int WA_AGG_SetTestResult(const char *diag_name, int result, time_t timestamp)
     if (current_bank != -1)
     {
         /* find the diag and store its result and timestamp */
-        for (int i = 0; i < agg_results[current_bank].diag_count; i++)
+        int i = WA_UTILS_PHASH_Find(&diag_names, diag_name);
+        if (i >= 0)
         {
-            if (!strcmp(agg_results[current_bank].diag_results[i].diag, diag_name))
+            agg_results[current_bank].diag_results[i].result = result;
+            agg_results[current_bank].diag_results[i].timestamp = timestamp;
+            agg_results[current_bank].diag_results[i].hasUsage = (usage != NULL);
+            if (usage)
+                agg_results[current_bank].diag_results[i].usage = *usage;
+
+            char info[512] = {'\0'};
+            if (result != 0)
             {
-                agg_results[current_bank].diag_results[i].result = result;
-                agg_results[current_bank].diag_results[i].timestamp = timestamp;
-
-                char info[512] = {'\0'};
-                if (result != 0)
+                switch(result)
                 {
-                    switch(result)
-                    {
-                        case WA_DIAG_ERRCODE_FAILURE:
-                            if (!strcmp("hdd_status", diag_name)) {
-                                strcpy(info, "FAILED_Disk_Health_Status_Error");
-                            }
-                            else if (!strcmp("mcard_status", diag_name)) {
-                                strcpy(info, "FAILED_Invalid_Card_Certification");
-                            }
-                            else if (!strcmp("rf4ce_status", diag_name)) {
-                                strcpy(info, "FAILED_Paired_RCU_Count_Exceeded_Max_Value");
-                            }
-                            else if (!strcmp("avdecoder_qam_status", diag_name)) {
-                                strcpy(info, "FAILED_Play_Status_Error");
-                            }
-                            else if (!strcmp("tuner_status", diag_name)) {
-                                strcpy(info, "FAILED_Read_Status_File_Error");
-                            }
-                            else if (!strcmp("modem_status", diag_name)) {
-                                strcpy(info, "FAILED_Gateway_IP_Not_Reachable");
-                            }
-                            else if (!strcmp("bluetooth_status", diag_name)) {
-                                strcpy(info, "FAILED_Bluetooth_Not_Operational");
-                            }
-                            else if ((!strcmp("sdcard_status", diag_name)) || (!strcmp("sdcard_status", diag_name)) || (!strcmp("sdcard_status", diag_name))) {
-                                strcpy(info, "FAILED_Memory_Verify_Error");
-                            }
-                            break;
-                        case WA_DIAG_ERRCODE_NOT_APPLICABLE:
-                            strcpy(info, "WARNING_Test_Not_Applicable");
-                            break;
-                        case WA_DIAG_ERRCODE_HDD_STATUS_MISSING:
-                            strcpy(info, "WARNING_HDD_Test_Not_Run");
-                            break;
-                        case WA_DIAG_ERRCODE_HDMI_NO_DISPLAY:
-                            strcpy(info, "WARNING_No_HDMI_detected._Verify_HDMI_cable_is_connected_on_both_ends_or_if_TV_is_compatible");
-                            break;
-                        case WA_DIAG_ERRCODE_HDMI_NO_HDCP:
-                            strcpy(info, "WARNING_HDMI_authentication_failed._Try_another_HDMI_cable_or_check_TV_compatibility");
-                            break;
-                        case WA_DIAG_ERRCODE_MOCA_NO_CLIENTS:
-                            strcpy(info, "WARNING_No_MoCA_Network_Found");
-                            break;
-                        case WA_DIAG_ERRCODE_MOCA_DISABLED:
-                            strcpy(info, "WARNING_MoCA_OFF");
-                            break;
-                        case WA_DIAG_ERRCODE_SI_CACHE_MISSING:
-                            strcpy(info, "WARNING_Missing_Channel_Map");
-                            break;
-                        case WA_DIAG_ERRCODE_TUNER_NO_LOCK:
-                            strcpy(info, "WARNING_Lock_Failed_-_Check_Cable");
-                            break;
-                        case WA_DIAG_ERRCODE_TUNER_BUSY:
-                            strcpy(info, "WARNING_One_or_more_tuners_are_busy._All_tuners_were_not_tested");
-                            break;
-                        case WA_DIAG_ERRCODE_AV_NO_SIGNAL:
-                            strcpy(info, "WARNING_No_stream_data._Check_cable_and_verify_STB_is_provisioned_correctly");
-                            break;
-                        case WA_DIAG_ERRCODE_IR_NOT_DETECTED:
-                            strcpy(info, "WARNING_IR_Not_Detected");
-                            break;
-                        case WA_DIAG_ERRCODE_CM_NO_SIGNAL:
-                            strcpy(info, "WARNING_Lock_Failed_-_Check_Cable");
-                            break;
-                        case WA_DIAG_ERRCODE_RF4CE_NO_RESPONSE:
-                            strcpy(info, "WARNING_RF_Input_Not_Detected_In_Last_10_Minutes");
-                            break;
-                        case WA_DIAG_ERRCODE_WIFI_NO_CONNECTION:
-                            strcpy(info, "WARNING_No_Connection");
-                            break;
-                        case WA_DIAG_ERRCODE_AV_URL_NOT_REACHABLE:
-                            strcpy(info, "WARNING_No_AV._URL_Not_Reachable_Or_Check_Cable");
-                            break;
-                        case WA_DIAG_ERRCODE_NON_RF4CE_INPUT:
-                            strcpy(info, "WARNING_RF_Paired_But_No_RF_Input");
-                            break;
-                        case WA_DIAG_ERRCODE_RF4CE_CTRLM_NO_RESPONSE:
-                            strcpy(info, "WARNING_RF_Controller_Issue");
-                            break;
-                        case WA_DIAG_ERRCODE_HDD_MARGINAL_ATTRIBUTES_FOUND:
-                            strcpy(info, "WARNING_Marginal_HDD_Values");
-                            break;
-                        case WA_DIAG_ERRCODE_RF4CE_CHIP_DISCONNECTED:
-                            strcpy(info, "FAILED_RF4CE_Chip_Fail");
-                            break;
-                        case WA_DIAG_ERRCODE_HDD_DEVICE_NODE_NOT_FOUND:
-                            strcpy(info, "WARNING_HDD_Device_Node_Not_Found");
-                            break;
-                        case WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR:
-                            strcpy(info, "WARNING_Test_Not_Run");
-                            break;
-                        case WA_DIAG_ERRCODE_CANCELLED:
-                            strcpy(info, "WARNING_Test_Cancelled");
-                            break;
-                        case WA_DIAG_ERRCODE_CANCELLED_NOT_STANDBY:
-                            strcpy(info, "WARNING_Test_Cancelled._Device_not_in_standby");
-                            break;
-                        case WA_DIAG_ERRCODE_NO_GATEWAY_CONNECTION:
-                            strcpy(info, "WARNING_No_Local_Gateway_Connection");
-                            break;
-                        case WA_DIAG_ERRCODE_NO_COMCAST_WAN_CONNECTION:
-                            strcpy(info, "WARNING_No_Comcast_WAN_Connection");
-                            break;
-                        case WA_DIAG_ERRCODE_NO_PUBLIC_WAN_CONNECTION:
-                            strcpy(info, "WARNING_No_Public_WAN_Connection");
-                            break;
-                        case WA_DIAG_ERRCODE_NO_WAN_CONNECTION:
-                            strcpy(info, "WARNING_No_WAN_Connection._Check_Connection");
-                            break;
-                        case WA_DIAG_ERRCODE_NO_ETH_GATEWAY_FOUND:
-                            strcpy(info, "WARNING_No_Gateway_Discovered_via_Ethernet");
-                            break;
-                        case WA_DIAG_ERRCODE_NO_MW_GATEWAY_FOUND:
-                            strcpy(info, "WARNING_No_Local_Gateway_Discovered");
-                            break;
-                        case WA_DIAG_ERRCODE_NO_ETH_GATEWAY_CONNECTION:
-                            strcpy(info, "WARNING_No_Gateway_Response_via_Ethernet");
-                            break;
-                        case WA_DIAG_ERRCODE_NO_MW_GATEWAY_CONNECTION:
-                            strcpy(info, "WARNING_No_Local_Gateway_Response");
-                            break;
-                        case WA_DIAG_ERRCODE_AV_DECODERS_NOT_ACTIVE:
-                            strcpy(info, "WARNING_AV_Decoders_Not_Active");
-                            break;
-                        case WA_DIAG_ERRCODE_BLUETOOTH_INTERFACE_FAILURE:
-                            strcpy(info, "FAILED_Bluetooth_Interfaces_Not_Found");
-                            break;
-                        case WA_DIAG_ERRCODE_FILE_WRITE_OPERATION_FAILURE:
-                            strcpy(info, "FAILED_File_Write_Operation_Error");
-                            break;
-                        case WA_DIAG_ERRCODE_FILE_READ_OPERATION_FAILURE:
-                            strcpy(info, "FAILED_File_Read_Operation_Error");
-                            break;
-                        case WA_DIAG_ERRCODE_EMMC_TYPEA_MAX_LIFE_EXCEED_FAILURE:
-                            strcpy(info, "FAILED_Device_TypeA_Exceeded_Max_Life");
-                            break;
-                        case WA_DIAG_ERRCODE_EMMC_TYPEB_MAX_LIFE_EXCEED_FAILURE:
-                            strcpy(info, "FAILED_Device_TypeB_Exceeded_Max_Life");
-                            break;
-                        case WA_DIAG_ERRCODE_EMMC_TYPEA_ZERO_LIFETIME_FAILURE:
-                            strcpy(info, "FAILED_Device_TypeA_Returned_Invalid_Response");
-                            break;
-                        case WA_DIAG_ERRCODE_EMMC_TYPEB_ZERO_LIFETIME_FAILURE:
-                            strcpy(info, "FAILED_Device_TypeB_Returned_Invalid_Response");
-                            break;
-                        case WA_DIAG_ERRCODE_MCARD_AUTH_KEY_REQUEST_FAILURE:
-                            strcpy(info, "FAILED_Card_Auth_Key_Not_Ready");
-                            break;
-                        case WA_DIAG_ERRCODE_MCARD_HOSTID_RETRIEVE_FAILURE:
-                            strcpy(info, "FAILED_Unable_To_Retrieve_Card_ID");
-                            break;
-                        case WA_DIAG_ERRCODE_MCARD_CERT_AVAILABILITY_FAILURE:
-                            strcpy(info, "FAILED_Card_Certification_Not_Available");
-                            break;
-                        case WA_DIAG_ERRCODE_DEFAULT_RESULT_VALUE:
-                        default:
-                            if(result < 0) {
-                                strcpy(info, "WARNING_Test_Not_Executed");
-                            } else {
-                                strcpy(info, "");
-                            }
-                            break;
-                    }
-                    strcpy (agg_results[current_bank].diag_results[i].diagResultMessage, info);
+                    case WA_DIAG_ERRCODE_FAILURE:
+                        if (!strcmp("hdd_status", diag_name)) {
+                            strcpy(info, "FAILED_Disk_Health_Status_Error");
+                        }
+                        else if (!strcmp("mcard_status", diag_name)) {
+                            strcpy(info, "FAILED_Invalid_Card_Certification");
+                        }
+                        else if (!strcmp("rf4ce_status", diag_name)) {
+                            strcpy(info, "FAILED_Paired_RCU_Count_Exceeded_Max_Value");
+                        }
+                        else if (!strcmp("avdecoder_qam_status", diag_name)) {
+                            strcpy(info, "FAILED_Play_Status_Error");
+                        }
+                        else if (!strcmp("tuner_status", diag_name)) {
+                            strcpy(info, "FAILED_Read_Status_File_Error");
+                        }
+                        else if (!strcmp("modem_status", diag_name)) {
+                            strcpy(info, "FAILED_Gateway_IP_Not_Reachable");
+                        }
+                        else if (!strcmp("bluetooth_status", diag_name)) {
+                            strcpy(info, "FAILED_Bluetooth_Not_Operational");
+                        }
+                        else if ((!strcmp("sdcard_status", diag_name)) || (!strcmp("sdcard_status", diag_name)) || (!strcmp("sdcard_status", diag_name))) {
+                            strcpy(info, "FAILED_Memory_Verify_Error");
+                        }
+                        break;
+                    case WA_DIAG_ERRCODE_NOT_APPLICABLE:
+                        strcpy(info, "WARNING_Test_Not_Applicable");
+                        break;
+                    case WA_DIAG_ERRCODE_HDD_STATUS_MISSING:
+                        strcpy(info, "WARNING_HDD_Test_Not_Run");
+                        break;
+                    case WA_DIAG_ERRCODE_HDMI_NO_DISPLAY:
+                        strcpy(info, "WARNING_No_HDMI_detected._Verify_HDMI_cable_is_connected_on_both_ends_or_if_TV_is_compatible");
+                        break;
+                    case WA_DIAG_ERRCODE_HDMI_NO_HDCP:
+                        strcpy(info, "WARNING_HDMI_authentication_failed._Try_another_HDMI_cable_or_check_TV_compatibility");
+                        break;
+                    case WA_DIAG_ERRCODE_MOCA_NO_CLIENTS:
+                        strcpy(info, "WARNING_No_MoCA_Network_Found");
+                        break;
+                    case WA_DIAG_ERRCODE_MOCA_DISABLED:
+                        strcpy(info, "WARNING_MoCA_OFF");
+                        break;
+                    case WA_DIAG_ERRCODE_SI_CACHE_MISSING:
+                        strcpy(info, "WARNING_Missing_Channel_Map");
+                        break;
+                    case WA_DIAG_ERRCODE_TUNER_NO_LOCK:
+                        strcpy(info, "WARNING_Lock_Failed_-_Check_Cable");
+                        break;
+                    case WA_DIAG_ERRCODE_TUNER_BUSY:
+                        strcpy(info, "WARNING_One_or_more_tuners_are_busy._All_tuners_were_not_tested");
+                        break;
+                    case WA_DIAG_ERRCODE_AV_NO_SIGNAL:
+                        strcpy(info, "WARNING_No_stream_data._Check_cable_and_verify_STB_is_provisioned_correctly");
+                        break;
+                    case WA_DIAG_ERRCODE_IR_NOT_DETECTED:
+                        strcpy(info, "WARNING_IR_Not_Detected");
+                        break;
+                    case WA_DIAG_ERRCODE_CM_NO_SIGNAL:
+                        strcpy(info, "WARNING_Lock_Failed_-_Check_Cable");
+                        break;
+                    case WA_DIAG_ERRCODE_RF4CE_NO_RESPONSE:
+                        strcpy(info, "WARNING_RF_Input_Not_Detected_In_Last_10_Minutes");
+                        break;
+                    case WA_DIAG_ERRCODE_WIFI_NO_CONNECTION:
+                        strcpy(info, "WARNING_No_Connection");
+                        break;
+                    case WA_DIAG_ERRCODE_AV_URL_NOT_REACHABLE:
+                        strcpy(info, "WARNING_No_AV._URL_Not_Reachable_Or_Check_Cable");
+                        break;
+                    case WA_DIAG_ERRCODE_NON_RF4CE_INPUT:
+                        strcpy(info, "WARNING_RF_Paired_But_No_RF_Input");
+                        break;
+                    case WA_DIAG_ERRCODE_RF4CE_CTRLM_NO_RESPONSE:
+                        strcpy(info, "WARNING_RF_Controller_Issue");
+                        break;
+                    case WA_DIAG_ERRCODE_HDD_MARGINAL_ATTRIBUTES_FOUND:
+                        strcpy(info, "WARNING_Marginal_HDD_Values");
+                        break;
+                    case WA_DIAG_ERRCODE_RF4CE_CHIP_DISCONNECTED:
+                        strcpy(info, "FAILED_RF4CE_Chip_Fail");
+                        break;
+                    case WA_DIAG_ERRCODE_HDD_DEVICE_NODE_NOT_FOUND:
+                        strcpy(info, "WARNING_HDD_Device_Node_Not_Found");
+                        break;
+                    case WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR:
+                        strcpy(info, "WARNING_Test_Not_Run");
+                        break;
+                    case WA_DIAG_ERRCODE_CANCELLED:
+                        strcpy(info, "WARNING_Test_Cancelled");
+                        break;
+                    case WA_DIAG_ERRCODE_CANCELLED_NOT_STANDBY:
+                        strcpy(info, "WARNING_Test_Cancelled._Device_not_in_standby");
+                        break;
+                    case WA_DIAG_ERRCODE_NO_GATEWAY_CONNECTION:
+                        strcpy(info, "WARNING_No_Local_Gateway_Connection");
+                        break;
+                    case WA_DIAG_ERRCODE_NO_COMCAST_WAN_CONNECTION:
+                        strcpy(info, "WARNING_No_Comcast_WAN_Connection");
+                        break;
+                    case WA_DIAG_ERRCODE_NO_PUBLIC_WAN_CONNECTION:
+                        strcpy(info, "WARNING_No_Public_WAN_Connection");
+                        break;
+                    case WA_DIAG_ERRCODE_NO_WAN_CONNECTION:
+                        strcpy(info, "WARNING_No_WAN_Connection._Check_Connection");
+                        break;
+                    case WA_DIAG_ERRCODE_NO_ETH_GATEWAY_FOUND:
+                        strcpy(info, "WARNING_No_Gateway_Discovered_via_Ethernet");
+                        break;
+                    case WA_DIAG_ERRCODE_NO_MW_GATEWAY_FOUND:
+                        strcpy(info, "WARNING_No_Local_Gateway_Discovered");
+                        break;
+                    case WA_DIAG_ERRCODE_NO_ETH_GATEWAY_CONNECTION:
+                        strcpy(info, "WARNING_No_Gateway_Response_via_Ethernet");
+                        break;
+                    case WA_DIAG_ERRCODE_NO_MW_GATEWAY_CONNECTION:
+                        strcpy(info, "WARNING_No_Local_Gateway_Response");
+                        break;
+                    case WA_DIAG_ERRCODE_AV_DECODERS_NOT_ACTIVE:
+                        strcpy(info, "WARNING_AV_Decoders_Not_Active");
+                        break;
+                    case WA_DIAG_ERRCODE_BLUETOOTH_INTERFACE_FAILURE:
+                        strcpy(info, "FAILED_Bluetooth_Interfaces_Not_Found");
+                        break;
+                    case WA_DIAG_ERRCODE_FILE_WRITE_OPERATION_FAILURE:
+                        strcpy(info, "FAILED_File_Write_Operation_Error");
+                        break;
+                    case WA_DIAG_ERRCODE_FILE_READ_OPERATION_FAILURE:
+                        strcpy(info, "FAILED_File_Read_Operation_Error");
+                        break;
+                    case WA_DIAG_ERRCODE_EMMC_TYPEA_MAX_LIFE_EXCEED_FAILURE:
+                        strcpy(info, "FAILED_Device_TypeA_Exceeded_Max_Life");
+                        break;
+                    case WA_DIAG_ERRCODE_EMMC_TYPEB_MAX_LIFE_EXCEED_FAILURE:
+                        strcpy(info, "FAILED_Device_TypeB_Exceeded_Max_Life");
+                        break;
+                    case WA_DIAG_ERRCODE_EMMC_TYPEA_ZERO_LIFETIME_FAILURE:
+                        strcpy(info, "FAILED_Device_TypeA_Returned_Invalid_Response");
+                        break;
+                    case WA_DIAG_ERRCODE_EMMC_TYPEB_ZERO_LIFETIME_FAILURE:
+                        strcpy(info, "FAILED_Device_TypeB_Returned_Invalid_Response");
+                        break;
+                    case WA_DIAG_ERRCODE_MCARD_AUTH_KEY_REQUEST_FAILURE:
+                        strcpy(info, "FAILED_Card_Auth_Key_Not_Ready");
+                        break;
+                    case WA_DIAG_ERRCODE_MCARD_HOSTID_RETRIEVE_FAILURE:
+                        strcpy(info, "FAILED_Unable_To_Retrieve_Card_ID");
+                        break;
+                    case WA_DIAG_ERRCODE_MCARD_CERT_AVAILABILITY_FAILURE:
+                        strcpy(info, "FAILED_Card_Certification_Not_Available");
+                        break;
+                    case WA_DIAG_ERRCODE_DEFAULT_RESULT_VALUE:
+                    default:
+                        if(result < 0) {
+                            strcpy(info, "WARNING_Test_Not_Executed");
+                        } else {
+                            strcpy(info, "");
+                        }
+                        break;
                 }
-                status = 0;
-                break;
+                strcpy (agg_results[current_bank].diag_results[i].diagResultMessage, info);
             }
+            status = 0;
         }
 
         if (status)
@@ -536,6 +571,9 @@ int WA_AGG_Serialise(const WA_AGG_AggregateResults_t *results, json_t **out_json
                                                    "m", results->diag_results[i].diagResultMessage);
             }
 
+            if (jdiagresult && results->diag_results[i].hasUsage)
+                json_object_set_new(jdiagresult, "u", pack_usage(&results->diag_results[i].usage));
+
             json_object_set_new(jresults, results->diag_results[i].diagResultsName, jdiagresult);
         }
 
@@ -627,6 +665,10 @@ int WA_AGG_Deserialise(json_t *json, WA_AGG_AggregateResults_t *out_results)
                 out_results->diag_results[i].result = result;
                 if (message != NULL)
                     strcpy (out_results->diag_results[i].diagResultMessage, message);
+
+                /* "u" is optional, results files of older agents do not have it */
+                out_results->diag_results[i].hasUsage =
+                    !unpack_usage(json_object_get(diag_result_json, "u"), &out_results->diag_results[i].usage);
             }
         }
 
@@ -666,7 +708,17 @@ static int load_results(const char *file, WA_AGG_AggregateResults_t *bank)
 
     WA_ENTER("load_results(%s, %p)\n", file, bank);
 
-    json_t *json = json_load_file(file, 0, NULL);
+    char *payload = NULL;
+    json_t *json = NULL;
+
+    if (!WA_UTILS_RESULTS_Read(file, &payload, NULL))
+    {
+        json = json_loads(payload, 0, NULL);
+        free(payload);
+    }
+    else
+        WA_DBG("load_results(): WA_UTILS_RESULTS_Read() failed\n");
+
     if (json)
     {
         if (!WA_AGG_Deserialise(json, bank))
@@ -680,7 +732,7 @@ static int load_results(const char *file, WA_AGG_AggregateResults_t *bank)
         json_decref(json);
     }
     else
-        WA_DBG("load_results(): json_load_file() failed\n");
+        WA_DBG("load_results(): json_loads() failed\n");
 
     WA_RETURN("load_results(): %d\n", status);
 
@@ -697,22 +749,22 @@ static int save_results(const char *file, const WA_AGG_AggregateResults_t *bank)
 
     if (!WA_AGG_Serialise(bank, &json) && json)
     {
-        FILE *f = fopen(file, "wb+");
-        if (f)
+        char *payload = json_dumps(json, 0);
+        if (payload)
         {
-            if (!json_dumpf(json, f, 0))
+            /* readers (e.g. the TR-181 profile) pick up the new snapshot without locking */
+            if (!WA_UTILS_RESULTS_Write(file, payload))
             {
-                fsync(fileno(f));
                 WA_DBG("save_results(): json saved successfully\n");
                 status = 0;
             }
             else
-                WA_ERROR("save_results(): json_dump_file() failed\n");
+                WA_ERROR("save_results(): WA_UTILS_RESULTS_Write() failed\n");
 
-            fclose(f);
+            free(payload);
         }
         else
-            WA_ERROR("save_results(): failed to create file\n");
+            WA_ERROR("save_results(): json_dumps() failed\n");
 
         json_decref(json);
     }
@@ -724,6 +776,36 @@ static int save_results(const char *file, const WA_AGG_AggregateResults_t *bank)
     return status;
 }
 
+static json_t *pack_usage(const WA_DIAG_Usage_t *usage)
+{
+    /* wall and cpu in [ms], rss in [kB], rd/wr in [B] */
+    return json_pack("{s:i,s:i,s:I,s:I,s:I,s:i}",
+            "wall", usage->wall,
+            "cpu", usage->cpu,
+            "rss", (json_int_t)usage->rss,
+            "rd", (json_int_t)usage->read,
+            "wr", (json_int_t)usage->written,
+            "sp", usage->subprocesses);
+}
+
+static int unpack_usage(json_t *json, WA_DIAG_Usage_t *usage)
+{
+    int wall, cpu, subprocesses;
+    json_int_t rss, rd, wr;
+
+    if (!json || json_unpack(json, "{s:i,s:i,s:I,s:I,s:I,s:i}",
+            "wall", &wall, "cpu", &cpu, "rss", &rss, "rd", &rd, "wr", &wr, "sp", &subprocesses))
+        return 1;
+
+    usage->wall = wall;
+    usage->cpu = cpu;
+    usage->rss = rss;
+    usage->read = rd;
+    usage->written = wr;
+    usage->subprocesses = subprocesses;
+    return 0;
+}
+
 /* End of doxygen group */
 /*! @} */
 
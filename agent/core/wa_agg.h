@@ -58,6 +58,8 @@ typedef struct
     int result;
     const char *diagResultsName;
     char diagResultMessage[512];
+    bool hasUsage;
+    WA_DIAG_Usage_t usage;
 }
 WA_AGG_DiagResult_t;
 
@@ -121,11 +123,12 @@ int WA_AGG_FinishTestRun(time_t timestamp);
  * @param diag_name Name of the test.
  * @param result    Result of the test.
  * @param timestamp Test finish time (epoch).
+ * @param usage     Resources used by the test, NULL if not measured.
  *
  * @returns Operation status.
  * @retval 0 for success, non-zero otherwise
  */
-int WA_AGG_SetTestResult(const char *diag_name, int result, time_t timestamp);
+int WA_AGG_SetTestResult(const char *diag_name, int result, time_t timestamp, const WA_DIAG_Usage_t *usage);
 
 /**
  * @brief Sets the bool value whether to write the results or not.
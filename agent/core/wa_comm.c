@@ -31,8 +31,10 @@
  * STANDARD INCLUDE FILES
  *****************************************************************************/
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
@@ -40,6 +42,8 @@
 #include "wa_comm.h"
 #include "wa_id.h"
 #include "wa_init.h"
+#include "wa_list_api.h"
+#include "wa_metrics.h"
 #include "wa_osa.h"
 #include "wa_debug.h"
 
@@ -55,6 +59,22 @@ void *WA_COMM_IncomingQ = NULL;
 
 #define WA_COMM_INCOME_Q_EXIT_MSG "exit"
 
+#define WA_COMM_PROGRESS_SLOTS 32
+
+#define WA_COMM_RECORD_FILE_DEFAULT "/tmp/hwselftest.cap"
+#define WA_COMM_RECORD_MAX_SIZE_DEFAULT 1024 /* [kB] */
+
+/*
+ * Capture file layout, all fields little endian:
+ *   header: magic[8], uint32 version, uint32 reserved, uint64 realtime [us] at the start
+ *   frames: uint64 ts [us] since the start, uint32 connection id, uint32 length,
+ *           uint8 direction, payload (not terminated)
+ * Directions: '>' a request to the agent, '<' a message from it, '+' and '-' a connection
+ * registered and unregistered, with the adapter name as the payload.
+ */
+#define WA_COMM_RECORD_HEADER_SIZE (8 + 4 + 4 + 8)
+#define WA_COMM_RECORD_FRAME_SIZE (8 + 4 + 4 + 1)
+
 /*****************************************************************************
  * LOCAL TYPES
  *****************************************************************************/
@@ -64,25 +84,61 @@ typedef struct
     void *cookie;
     const WA_COMM_adaptersConfig_t *pConfig;
 }WA_COMM_adapterConnectionContext_t;
-WA_UTILS_LIST_DECLARE_LIST_TYPE(WA_COMM_adapterConnectionContext_t);
 
 typedef struct
 {
     void *mutex;
     WA_UTILS_ID_box_t idBox;
-    WA_UTILS_LIST(WA_COMM_adapterConnectionContext_t) adaptersList;
+    WA_UTILS_LIST_t adaptersList;
 }WA_COMM_adapterConnections_t;
 
+/** The latest progress of a diag instance, waiting for delivery */
+typedef struct
+{
+    uint32_t from; /**< diag instance id, 0 for a free slot */
+    uint32_t to;
+    int progress;
+    bool pending; /**< progress not delivered yet */
+    struct timespec lastSent;
+}WA_COMM_progressSlot_t;
+
+typedef struct
+{
+    void *mutex;
+    unsigned int period; /**< min time between two notifications of one instance in [ms] */
+    unsigned int merged;
+    unsigned int dropped;
+    WA_COMM_progressSlot_t slots[WA_COMM_PROGRESS_SLOTS];
+}WA_COMM_progress_t;
+
+typedef struct
+{
+    void *mutex;
+    FILE *file; /**< NULL once the capture is full */
+    uint64_t start; /**< [us] */
+    size_t size;
+    size_t maxSize;
+}WA_COMM_record_t;
+
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
 static void *CommTask(void *p);
+static void Deliver(WA_OSA_Qjmsg_t *pQjmsg);
+static int FlushProgress(void);
+static void ReleaseProgress(uint32_t from);
+static unsigned long long ElapsedMs(const struct timespec *pSince, const struct timespec *pNow);
+static void PutLe(unsigned char *p, uint64_t value, size_t size);
+static void Record(uint32_t id, char direction, const char *msg, size_t len);
+static void RecordJson(uint32_t id, char direction, json_t *json);
 
 /*****************************************************************************
  * LOCAL VARIABLE DECLARATIONS
  *****************************************************************************/
 static void *commTaskHandle;
 static WA_COMM_adapterConnections_t commAdapterConnections = {mutex:NULL};
+static WA_COMM_progress_t commProgress = {mutex:NULL, period:1000 / WA_COMM_PROGRESS_RATE_DEFAULT};
+static WA_COMM_record_t commRecord = {mutex:NULL};
 
 static const WA_COMM_adaptersConfig_t *pAdaptersConfig;
 static WA_UTILS_LIST_t adaptersHandles;
@@ -108,8 +164,8 @@ int WA_COMM_Init(const WA_COMM_adaptersConfig_t *adapters)
     }
 
     pAdaptersConfig = adapters;
-    WA_UTILS_LIST_ClearList(commAdapterConnections.adaptersList);
-    WA_UTILS_LIST_ClearList(adaptersHandles);
+    WA_UTILS_LIST_Init(&(commAdapterConnections.adaptersList));
+    WA_UTILS_LIST_Init(&(adaptersHandles));
 
     commAdapterConnections.mutex = WA_OSA_MutexCreate();
     if(commAdapterConnections.mutex == NULL)
@@ -118,12 +174,23 @@ int WA_COMM_Init(const WA_COMM_adaptersConfig_t *adapters)
         goto err_mutex;
     }
 
+    memset(commProgress.slots, 0, sizeof(commProgress.slots));
+    commProgress.merged = 0;
+    commProgress.dropped = 0;
+    commProgress.mutex = WA_OSA_MutexCreate();
+    if(commProgress.mutex == NULL)
+    {
+        WA_ERROR("WA_COMM_Init(): WA_OSA_MutexCreate(progress): error\n");
+        goto err_progress_mutex;
+    }
+
     WA_COMM_IncomingQ = WA_OSA_QCreate(WA_COMM_INCOME_Q_DEEP, sizeof(WA_OSA_Qjmsg_t));
     if(WA_COMM_IncomingQ == NULL)
     {
         WA_ERROR("WA_COMM_Init(): WA_OSA_QCreate(WA_COMM_IncomingQ) error\n");
         goto income_q_err;
     }
+    (void)WA_OSA_QSetMetrics(WA_COMM_IncomingQ, "comm", WA_METRICS_HOP_COMM);
 
     commTaskHandle = WA_OSA_TaskCreate(NULL, 0, CommTask, NULL, WA_OSA_SCHED_POLICY_RT, WA_OSA_TASK_PRIORITY_MAX);
     if(commTaskHandle == NULL)
@@ -182,6 +249,14 @@ int WA_COMM_Init(const WA_COMM_adaptersConfig_t *adapters)
     }
 
     income_q_err:
+    s1 = WA_OSA_MutexDestroy(commProgress.mutex);
+    if(s1 != 0)
+    {
+        WA_ERROR("WA_COMM_Init(): WA_OSA_MutexDestroy(progress): %d\n", s1);
+    }
+    commProgress.mutex = NULL;
+
+    err_progress_mutex:
     s1 = WA_OSA_MutexDestroy(commAdapterConnections.mutex);
     if(s1 != 0)
     {
@@ -254,6 +329,14 @@ int WA_COMM_Exit(void)
         WA_ERROR("WA_COMM_Exit():  WA_OSA_QDestroy(WA_COMM_IncomingQ): %d\n", status);
     }
 
+    WA_INFO("WA_COMM_Exit(): progress updates merged: %u, dropped: %u\n", commProgress.merged, commProgress.dropped);
+    status = WA_OSA_MutexDestroy(commProgress.mutex);
+    if(status != 0)
+    {
+        WA_ERROR("WA_COMM_Exit(): WA_OSA_MutexDestroy(progress): %d\n", status);
+    }
+    commProgress.mutex = NULL;
+
     status = WA_OSA_MutexDestroy(commAdapterConnections.mutex);
     if(status != 0)
     {
@@ -310,6 +393,16 @@ void *WA_COMM_Register(const WA_COMM_adaptersConfig_t *config, void *cookie)
     pContext->pConfig = config;
     pContext->cookie = cookie;
     pContext->id = WA_COMM_MSG_ID_PREFIX | id;
+
+    status = WA_UTILS_ID_SetOwnerUnsafe(&(commAdapterConnections.idBox), id, pContext);
+    if(status != 0)
+    {
+        WA_ERROR("WA_COMM_Register(): WA_UTILS_ID_SetOwnerUnsafe(): %d\n", status);
+        WA_UTILS_LIST_AllocRemove(&(commAdapterConnections.adaptersList), pContext);
+        pContext = NULL;
+        goto err_addlist;
+    }
+    Record(pContext->id, '+', config->name, config->name ? strlen(config->name) : 0);
     goto unlock;
 
     err_addlist:
@@ -374,6 +467,7 @@ int WA_COMM_Unregister(void *handle)
         WA_ERROR("WA_COMM_Unregister(): WA_UTILS_ID_ReleaseUnsafe(): %d\n", status);
     }
 
+    Record(pContext->id, '-', pContext->pConfig->name, pContext->pConfig->name ? strlen(pContext->pConfig->name) : 0);
     WA_UTILS_LIST_AllocRemove(&(commAdapterConnections.adaptersList), handle);
 
     s1 = WA_OSA_MutexUnlock(commAdapterConnections.mutex);
@@ -403,6 +497,8 @@ int WA_COMM_Send(void *handle, json_t *json)
         goto end;
     }
 
+    RecordJson(pContext->id, '>', json);
+
     status = WA_UTILS_JSON_RpcValidate(&json);
     if(status == -1)
     {
@@ -455,6 +551,9 @@ int WA_COMM_SendTxt(void *handle, char *msg, size_t len)
         goto end;
     }
 
+    /* as received, the invalid requests too */
+    Record(pContext->id, '>', msg, len);
+
     /* general parsing check */
     status = WA_UTILS_JSON_RpcValidateTxt(msg, len, &(qjmsg.json));
     if(status < 0)
@@ -481,6 +580,198 @@ int WA_COMM_SendTxt(void *handle, char *msg, size_t len)
     return status;
 }
 
+int WA_COMM_SendProgress(uint32_t from, uint32_t to, int progress)
+{
+    int status = -1, s1;
+    WA_COMM_progressSlot_t *pSlot = NULL;
+    bool wakeup = false;
+    struct timespec now;
+    int i;
+
+    WA_ENTER("WA_COMM_SendProgress(from=0x%08x to=0x%08x progress=%d)\n", from, to, progress);
+
+    if(commProgress.mutex == NULL)
+    {
+        WA_ERROR("WA_COMM_SendProgress(): COMM not initialized\n");
+        goto end;
+    }
+
+    status = WA_OSA_MutexLock(commProgress.mutex);
+    if(status != 0)
+    {
+        WA_ERROR("WA_COMM_SendProgress(): WA_OSA_MutexLock(): %d\n", status);
+        status = -1;
+        goto end;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    for(i = 0; i < WA_COMM_PROGRESS_SLOTS; ++i)
+    {
+        if(commProgress.slots[i].from == from)
+        {
+            pSlot = &commProgress.slots[i];
+            break;
+        }
+        /* a free slot, or one whose rate limit does not matter any more */
+        if((pSlot == NULL) &&
+           ((commProgress.slots[i].from == 0) ||
+            (!commProgress.slots[i].pending && (ElapsedMs(&commProgress.slots[i].lastSent, &now) >= commProgress.period))))
+        {
+            pSlot = &commProgress.slots[i];
+        }
+    }
+
+    if(pSlot == NULL)
+    {
+        WA_WARN("WA_COMM_SendProgress(): no free progress slot\n");
+        status = 1;
+    }
+    else
+    {
+        if(pSlot->from != from)
+        {
+            pSlot->from = from;
+            pSlot->pending = false;
+            pSlot->lastSent.tv_sec = 0;
+            pSlot->lastSent.tv_nsec = 0;
+        }
+
+        if(pSlot->pending)
+        {
+            ++commProgress.merged;
+        }
+        else
+        {
+            /* the COMM task might be waiting without a timeout */
+            wakeup = true;
+        }
+        pSlot->to = to;
+        pSlot->progress = progress;
+        pSlot->pending = true;
+        status = 0;
+    }
+
+    s1 = WA_OSA_MutexUnlock(commProgress.mutex);
+    if(s1 != 0)
+    {
+        WA_ERROR("WA_COMM_SendProgress(): WA_OSA_MutexUnlock(): %d\n", s1);
+    }
+
+    if(wakeup)
+    {
+        WA_OSA_Qjmsg_t qjmsg = {.from = 0, .to = 0, .json = NULL};
+
+        s1 = WA_OSA_QTimedRetrySend(WA_COMM_IncomingQ,
+                (const char * const)&qjmsg,
+                sizeof(WA_OSA_Qjmsg_t),
+                WA_OSA_Q_PRIORITY_MAX,
+                WA_OSA_Q_SEND_TIMEOUT_DEFAULT,
+                WA_OSA_Q_SEND_RETRY_DEFAULT);
+        if(s1 != 0)
+        {
+            WA_ERROR("WA_COMM_SendProgress(): WA_OSA_QTimedRetrySend(): %d\n", s1);
+        }
+    }
+
+    end:
+    WA_RETURN("WA_COMM_SendProgress(): %d\n", status);
+    return status;
+}
+
+void WA_COMM_SetProgressRate(unsigned int rate)
+{
+    WA_INFO("WA_COMM_SetProgressRate(): %u/s\n", rate);
+    commProgress.period = rate ? 1000 / rate : 0;
+}
+
+void WA_COMM_GetProgressStats(unsigned int *merged, unsigned int *dropped)
+{
+    *merged = commProgress.merged;
+    *dropped = commProgress.dropped;
+}
+
+int WA_COMM_RecordStart(json_t *config)
+{
+    int status = -1;
+    const char *file = WA_COMM_RECORD_FILE_DEFAULT;
+    int maxSize = WA_COMM_RECORD_MAX_SIZE_DEFAULT;
+    unsigned char header[WA_COMM_RECORD_HEADER_SIZE];
+    struct timespec now;
+
+    WA_ENTER("WA_COMM_RecordStart(config=%p)\n", config);
+
+    if(commRecord.mutex != NULL)
+    {
+        WA_WARN("WA_COMM_RecordStart(): already recording\n");
+        status = 0;
+        goto end;
+    }
+
+    if(config && json_unpack(config, "{s?s,s?i}", "file", &file, "max_size", &maxSize))
+    {
+        WA_ERROR("WA_COMM_RecordStart(): invalid configuration\n");
+        goto end;
+    }
+
+    commRecord.file = fopen(file, "wb");
+    if(commRecord.file == NULL)
+    {
+        WA_ERROR("WA_COMM_RecordStart(): fopen(%s): error\n", file);
+        goto end;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    memcpy(header, WA_COMM_RECORD_MAGIC, 8);
+    PutLe(header + 8, WA_COMM_RECORD_VERSION, 4);
+    PutLe(header + 12, 0, 4);
+    PutLe(header + 16, (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000, 8);
+    if(fwrite(header, sizeof(header), 1, commRecord.file) != 1)
+    {
+        WA_ERROR("WA_COMM_RecordStart(): fwrite(%s): error\n", file);
+        goto err_file;
+    }
+
+    commRecord.mutex = WA_OSA_MutexCreate();
+    if(commRecord.mutex == NULL)
+    {
+        WA_ERROR("WA_COMM_RecordStart(): WA_OSA_MutexCreate(): error\n");
+        goto err_file;
+    }
+
+    commRecord.start = WA_METRICS_Now();
+    commRecord.size = sizeof(header);
+    commRecord.maxSize = (size_t)(maxSize > 0 ? maxSize : WA_COMM_RECORD_MAX_SIZE_DEFAULT) * 1024;
+    WA_INFO("WA_COMM_RecordStart(): recording to %s, up to %zu kB\n", file, commRecord.maxSize / 1024);
+    status = 0;
+    goto end;
+
+    err_file:
+    fclose(commRecord.file);
+    commRecord.file = NULL;
+    end:
+    WA_RETURN("WA_COMM_RecordStart(): %d\n", status);
+    return status;
+}
+
+void WA_COMM_RecordStop(void)
+{
+    if(commRecord.mutex == NULL)
+    {
+        return;
+    }
+
+    if(commRecord.file != NULL)
+    {
+        fclose(commRecord.file);
+        commRecord.file = NULL;
+    }
+    WA_INFO("WA_COMM_RecordStop(): %zu bytes recorded\n", commRecord.size);
+
+    WA_OSA_MutexDestroy(commRecord.mutex);
+    commRecord.mutex = NULL;
+}
+
 /*****************************************************************************
  * LOCAL FUNCTIONS
  *****************************************************************************/
@@ -489,6 +780,8 @@ static void *CommTask(void *p)
     int status;
     WA_OSA_Qjmsg_t qjmsg;
     unsigned int qprio;
+    int timeout;
+    const char *method;
 
     WA_ENTER("CommTask(p=%p)\n", p);
 
@@ -501,7 +794,19 @@ static void *CommTask(void *p)
 
     while(1)
     {
-        status = WA_OSA_QReceive(WA_COMM_IncomingQ, (char * const)&qjmsg, sizeof(WA_OSA_Qjmsg_t), &qprio);
+        timeout = FlushProgress();
+        if(timeout < 0)
+        {
+            status = WA_OSA_QReceive(WA_COMM_IncomingQ, (char * const)&qjmsg, sizeof(WA_OSA_Qjmsg_t), &qprio);
+        }
+        else
+        {
+            status = WA_OSA_QTimedReceive(WA_COMM_IncomingQ, (char * const)&qjmsg, sizeof(WA_OSA_Qjmsg_t), &qprio, timeout);
+            if(status == -2)
+            {
+                continue;
+            }
+        }
         if(status == 0)
         {
             WA_INFO("CommTask(): WA_OSA_QReceive(): empty\n");
@@ -513,6 +818,12 @@ static void *CommTask(void *p)
             goto end;
         }
 
+        if(qjmsg.json == NULL)
+        {
+            /* progress wakeup */
+            continue;
+        }
+
 #if WA_DEBUG
         {
             char *msg;
@@ -531,55 +842,243 @@ static void *CommTask(void *p)
         WA_INFO("CommTask(): WA_OSA_QReceive(): %p\n", qjmsg.json);
 #endif
 
+        /* the final result is never held back by a progress of the same instance */
+        if((json_unpack(qjmsg.json, "{ss}", "method", &method) == 0) && !strcmp(method, "eod"))
         {
-            WA_COMM_adapterConnectionContext_t *pContext;
-            void *iterator;
-
-            status = WA_OSA_MutexLock(commAdapterConnections.mutex);
-            if(status != 0)
-            {
-                WA_ERROR("CommTask(): WA_OSA_MutexLock(): %d\n", status);
-            }
-            else
-            {
-                status = -1;
-                for(iterator = WA_UTILS_LIST_FrontIterator(&commAdapterConnections.adaptersList);
-                    iterator != WA_UTILS_LIST_NO_ELEM;
-                    iterator = WA_UTILS_LIST_NextIterator(&commAdapterConnections.adaptersList, iterator))
-                {
-                    pContext = (WA_COMM_adapterConnectionContext_t *)(WA_UTILS_LIST_DataAtIterator(&commAdapterConnections.adaptersList, iterator));
-                    if((pContext != NULL) && (pContext->id == qjmsg.to))
-                    {
-                        if(pContext->pConfig->callback != NULL)
-                        {
-                            status = pContext->pConfig->callback(pContext->cookie, qjmsg.json);
-                            if(status != 0)
-                            {
-                                WA_ERROR("CommTask(): callback(): %d\n", status);
-                            }
-                        }
-                        break;
-                    }
-                }
-
-                if(status != 0)
-                {
-                    json_decref(qjmsg.json);//discard
-                }
-
-                status = WA_OSA_MutexUnlock(commAdapterConnections.mutex);
-                if(status != 0)
-                {
-                    WA_ERROR("CommTask(): WA_OSA_MutexUnlock(): %d\n", status);
-                }
-            }
+            ReleaseProgress(qjmsg.from);
         }
+
+        Deliver(&qjmsg);
     }
     end:
     WA_RETURN("CommTask(): %p\n", p);
     return p;
 }
 
+static void Deliver(WA_OSA_Qjmsg_t *pQjmsg)
+{
+    int status;
+    WA_COMM_adapterConnectionContext_t *pContext;
+
+    status = WA_OSA_MutexLock(commAdapterConnections.mutex);
+    if(status != 0)
+    {
+        WA_ERROR("Deliver(): WA_OSA_MutexLock(): %d\n", status);
+        return;
+    }
+
+    status = -1;
+    pContext = NULL;
+    if((pQjmsg->to & ~(uint32_t)(WA_UTILS_ID_COUNT - 1)) == WA_COMM_MSG_ID_PREFIX)
+    {
+        pContext = (WA_COMM_adapterConnectionContext_t *)WA_UTILS_ID_GetOwnerUnsafe(&(commAdapterConnections.idBox),
+                (WA_UTILS_ID_t)(pQjmsg->to & (WA_UTILS_ID_COUNT - 1)));
+    }
+    if((pContext != NULL) && (pContext->pConfig->callback != NULL))
+    {
+        /* before the callback, it takes the message over */
+        RecordJson(pContext->id, '<', pQjmsg->json);
+        status = pContext->pConfig->callback(pContext->cookie, pQjmsg->json);
+        if(status != 0)
+        {
+            WA_ERROR("Deliver(): callback(): %d\n", status);
+        }
+    }
+
+    if(status != 0)
+    {
+        json_decref(pQjmsg->json);//discard
+    }
+
+    status = WA_OSA_MutexUnlock(commAdapterConnections.mutex);
+    if(status != 0)
+    {
+        WA_ERROR("Deliver(): WA_OSA_MutexUnlock(): %d\n", status);
+    }
+}
+
+/**
+ * Delivers the progress updates that are due.
+ *
+ * @returns time to the next due update in [ms]
+ * @retval -1 nothing pending
+ */
+static int FlushProgress(void)
+{
+    WA_OSA_Qjmsg_t due[WA_COMM_PROGRESS_SLOTS];
+    int progress[WA_COMM_PROGRESS_SLOTS];
+    int count = 0, next = -1, i;
+    unsigned long long elapsed;
+    struct timespec now;
+    char method[10];
+
+    if(WA_OSA_MutexLock(commProgress.mutex) != 0)
+    {
+        WA_ERROR("FlushProgress(): WA_OSA_MutexLock() failed\n");
+        return -1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for(i = 0; i < WA_COMM_PROGRESS_SLOTS; ++i)
+    {
+        WA_COMM_progressSlot_t *pSlot = &commProgress.slots[i];
+
+        if(!pSlot->pending)
+        {
+            continue;
+        }
+
+        elapsed = ElapsedMs(&pSlot->lastSent, &now);
+        if(elapsed >= commProgress.period)
+        {
+            due[count].from = pSlot->from;
+            due[count].to = pSlot->to;
+            progress[count] = pSlot->progress;
+            ++count;
+            pSlot->pending = false;
+            pSlot->lastSent = now;
+        }
+        else if((next < 0) || ((int)(commProgress.period - elapsed) < next))
+        {
+            next = (int)(commProgress.period - elapsed);
+        }
+    }
+
+    if(WA_OSA_MutexUnlock(commProgress.mutex) != 0)
+    {
+        WA_ERROR("FlushProgress(): WA_OSA_MutexUnlock() failed\n");
+    }
+
+    for(i = 0; i < count; ++i)
+    {
+        snprintf(method, sizeof(method), "#%08x", due[i].from);
+        due[i].json = json_pack("{s:s,s:s,s:{s:i},s:n}", "jsonrpc", "2.0", "method", method, "params", "progress", progress[i], "id");
+        if(due[i].json == NULL)
+        {
+            WA_ERROR("FlushProgress(): json_pack() error\n");
+            continue;
+        }
+        Deliver(&due[i]);
+    }
+
+    return next;
+}
+
+static void ReleaseProgress(uint32_t from)
+{
+    int i;
+
+    if(WA_OSA_MutexLock(commProgress.mutex) != 0)
+    {
+        WA_ERROR("ReleaseProgress(): WA_OSA_MutexLock() failed\n");
+        return;
+    }
+
+    for(i = 0; i < WA_COMM_PROGRESS_SLOTS; ++i)
+    {
+        if(commProgress.slots[i].from == from)
+        {
+            if(commProgress.slots[i].pending)
+            {
+                ++commProgress.dropped;
+            }
+            commProgress.slots[i].from = 0;
+            commProgress.slots[i].pending = false;
+            break;
+        }
+    }
+
+    if(WA_OSA_MutexUnlock(commProgress.mutex) != 0)
+    {
+        WA_ERROR("ReleaseProgress(): WA_OSA_MutexUnlock() failed\n");
+    }
+}
+
+static unsigned long long ElapsedMs(const struct timespec *pSince, const struct timespec *pNow)
+{
+    return (unsigned long long)(pNow->tv_sec - pSince->tv_sec) * 1000 + (pNow->tv_nsec - pSince->tv_nsec) / 1000000;
+}
+
+
+/**
+ * Appends a frame to the capture, if recording. The frames are few, each one is
+ * flushed so that the capture of an agent that hangs or crashes is complete.
+ */
+/* the capture is the same on any host */
+static void PutLe(unsigned char *p, uint64_t value, size_t size)
+{
+    size_t i;
+
+    for(i = 0; i < size; i++)
+    {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static void Record(uint32_t id, char direction, const char *msg, size_t len)
+{
+    unsigned char header[WA_COMM_RECORD_FRAME_SIZE];
+
+    if(commRecord.mutex == NULL)
+    {
+        return;
+    }
+
+    if(WA_OSA_MutexLock(commRecord.mutex) != 0)
+    {
+        return;
+    }
+
+    if(commRecord.file == NULL)
+    {
+        goto end;
+    }
+
+    if(commRecord.size + sizeof(header) + len > commRecord.maxSize)
+    {
+        WA_WARN("Record(): the capture is full, recording stopped\n");
+        fclose(commRecord.file);
+        commRecord.file = NULL;
+        goto end;
+    }
+
+    PutLe(header, WA_METRICS_Now() - commRecord.start, 8);
+    PutLe(header + 8, id, 4);
+    PutLe(header + 12, len, 4);
+    header[16] = direction;
+    if((fwrite(header, sizeof(header), 1, commRecord.file) != 1) ||
+       (len && (fwrite(msg, len, 1, commRecord.file) != 1)) ||
+       (fflush(commRecord.file) != 0))
+    {
+        WA_ERROR("Record(): write error, recording stopped\n");
+        fclose(commRecord.file);
+        commRecord.file = NULL;
+        goto end;
+    }
+    commRecord.size += sizeof(header) + len;
+
+end:
+    WA_OSA_MutexUnlock(commRecord.mutex);
+}
+
+static void RecordJson(uint32_t id, char direction, json_t *json)
+{
+    char *msg;
+
+    if((commRecord.mutex == NULL) || (commRecord.file == NULL) || (json == NULL))
+    {
+        return;
+    }
+
+    msg = json_dumps(json, JSON_COMPACT | JSON_PRESERVE_ORDER);
+    if(msg == NULL)
+    {
+        WA_ERROR("RecordJson(): json_dumps(): error\n");
+        return;
+    }
+    Record(id, direction, msg, strlen(msg));
+    free(msg);
+}
 
 /* End of doxygen group */
 /*! @} */
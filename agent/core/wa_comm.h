@@ -35,6 +35,7 @@
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
  *****************************************************************************/
+#include <stdint.h>
 #include "wa_json.h"
 
 #ifdef __cplusplus
@@ -47,6 +48,13 @@ extern "C"
  *****************************************************************************/
 #define WA_COMM_MSG_ID_PREFIX 0x00010000
 
+/** Default max number of progress notifications per second for one diag instance */
+#define WA_COMM_PROGRESS_RATE_DEFAULT 4
+
+/** Capture file format, see hwst_replay */
+#define WA_COMM_RECORD_MAGIC "HWSTCAP"
+#define WA_COMM_RECORD_VERSION 1
+
 /*****************************************************************************
  * EXPORTED TYPES
  *****************************************************************************/
@@ -150,6 +158,48 @@ extern int WA_COMM_Send(void *handle, json_t *json);
  */
 extern int WA_COMM_SendTxt(void *handle, char *msg, size_t len);
 
+/** Posts a progress update of a diag instance.
+ * The update replaces any not yet delivered progress of the same instance and is
+ * delivered by the COMM task at the rate set with \c WA_COMM_SetProgressRate().
+ * Pending progress is dropped once the final result of the instance passes.
+ * @param from id of the diag instance
+ * @param to id of the comm adapter connection the progress is for
+ * @param progress the progress value
+ * @retval 0 success.
+ * @retval 1 no free progress slot, the caller must send the progress itself
+ * @retval -1 error
+ */
+extern int WA_COMM_SendProgress(uint32_t from, uint32_t to, int progress);
+
+/** Sets the max progress notification rate.
+ * @param rate notifications per second for one diag instance, 0 disables the limit
+ */
+extern void WA_COMM_SetProgressRate(unsigned int rate);
+
+/** Returns progress coalescing statistics.
+ * @param[out] merged updates replaced by a newer value before delivery
+ * @param[out] dropped updates discarded because the final result was already sent
+ */
+extern void WA_COMM_GetProgressStats(unsigned int *merged, unsigned int *dropped);
+
+/**
+ * Starts recording the JSON-RPC frames of all the adapter connections to a capture.
+ * The inbound requests are recorded as received, the outbound messages as delivered,
+ * with the monotonic time since the start, for hwst_replay to play them back.
+ *
+ * @param config the "comm"."record" configuration section: "file" the capture
+ *        ("/tmp/hwselftest.cap"), "max_size" [kB] (1024) after which recording stops.
+ *
+ * @retval 0 success.
+ * @retval -1 error
+ */
+extern int WA_COMM_RecordStart(json_t *config);
+
+/**
+ * Stops recording and closes the capture, nothing is done if not recording.
+ */
+extern void WA_COMM_RecordStop(void);
+
 /**
  * Initialize the comm module.
  *
@@ -31,6 +31,8 @@
  * STANDARD INCLUDE FILES
  *****************************************************************************/
 #include <stdbool.h>
+#include <limits.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -99,6 +101,10 @@
 #ifdef HAVE_DIAG_WAN
 #include "wa_diag_wan.h"
 #endif
+#ifdef WA_BENCH
+#include "wa_comm_bench.h"
+#include "wa_diag_bench.h"
+#endif
 
 /*****************************************************************************
  * GLOBAL VARIABLE DEFINITIONS
@@ -117,11 +123,33 @@
 #define SYSCONFDIR "/etc/hwselftest"
 #endif
 
+#define DIAGS_COUNT (sizeof(diags)/sizeof(diags[0]))
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+typedef enum
+{
+    SETTING_BOOL,
+    SETTING_INT,
+    SETTING_STRING
+}WA_CONFIG_settingType_t;
+
+/** A key of the diag config and where it goes in the \c WA_DIAG_settings_t */
+typedef struct
+{
+    const char *key;
+    WA_CONFIG_settingType_t type;
+    size_t offset;
+    int invalid; /**< taken by an int that is not a non-negative integer */
+}WA_CONFIG_setting_t;
+
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
 static json_t *loadConfigFile(const char * filename);
 static json_t *loadConfig(const char * commandLineFilename);
+static void loadSettings(const char *name, json_t *config, WA_DIAG_settings_t *pSettings);
 
 /*****************************************************************************
  * LOCAL VARIABLE DECLARATIONS
@@ -131,62 +159,91 @@ static json_t *configs = NULL;
 static WA_COMM_adaptersConfig_t adapters[] =
 {
     {"comm_ws", WA_COMM_WS_Init, WA_COMM_WS_Exit, WA_COMM_WS_Callback, NULL, NULL},
+#ifdef WA_BENCH
+    {"comm_bench", WA_COMM_BENCH_Init, WA_COMM_BENCH_Exit, WA_COMM_BENCH_Callback, NULL, NULL},
+#endif
     /* END OF LIST */
     {NULL, NULL, NULL, NULL, NULL, NULL}
 };
 
+/* With plugins the diag functions are taken from the plugin when it is loaded */
+#ifdef WA_DIAG_PLUGINS
+#define DIAG_ENTRY(name, init, fnc, nameInResults, plugin, needs) {name, NULL, NULL, WA_DIAG_PluginProcedure, NULL, NULL, NULL, nameInResults, plugin, needs}
+#else
+#define DIAG_ENTRY(name, init, fnc, nameInResults, plugin, needs) {name, init, NULL, fnc, NULL, NULL, NULL, nameInResults, NULL, needs}
+#endif
+
 static WA_DIAG_proceduresConfig_t diags[] =
 {
-    {"sysinfo_info", NULL, NULL, WA_DIAG_SYSINFO_Info, NULL, NULL, NULL, NULL },
+    {"sysinfo_info", NULL, NULL, WA_DIAG_SYSINFO_Info, NULL, NULL, NULL, NULL, NULL, WA_DIAG_NEEDS_IARM | WA_DIAG_NEEDS_SNMP },
     {"capabilities_info", NULL, NULL, WA_DIAG_CAPABILITIES_Info, NULL, NULL, NULL, NULL },
 
 #ifdef HAVE_DIAG_HDD
-    {"hdd_status", NULL, NULL, WA_DIAG_HDD_status, NULL, NULL, NULL, "HDD"},
+    DIAG_ENTRY("hdd_status", NULL, WA_DIAG_HDD_status, "HDD", "wa_diag_hdd.so", 0),
 #endif
 #ifdef HAVE_DIAG_SDCARD
-    {"sdcard_status", NULL, NULL, WA_DIAG_SDCARD_status, NULL, NULL, NULL, "SDCard" },
+    DIAG_ENTRY("sdcard_status", NULL, WA_DIAG_SDCARD_status, "SDCard", "wa_diag_sdcard.so", WA_DIAG_NEEDS_IARM),
 #endif
 #ifdef HAVE_DIAG_FLASH
-    {"flash_status", NULL, NULL, WA_DIAG_FLASH_status, NULL, NULL, NULL, "FLASH" },
+    DIAG_ENTRY("flash_status", NULL, WA_DIAG_FLASH_status, "FLASH", "wa_diag_flash.so", WA_DIAG_NEEDS_IARM),
 #endif
 #ifdef HAVE_DIAG_FLASH_XI6
-    {"flash_status", NULL, NULL, WA_DIAG_FLASH_status, NULL, NULL, NULL, "FLASH" },
+    DIAG_ENTRY("flash_status", NULL, WA_DIAG_FLASH_status, "FLASH", "wa_diag_flash.so", WA_DIAG_NEEDS_IARM),
 #endif
 #ifdef HAVE_DIAG_DRAM
-    {"dram_status", NULL, NULL, WA_DIAG_DRAM_status, NULL, NULL, NULL, "DRAM" },
+    DIAG_ENTRY("dram_status", NULL, WA_DIAG_DRAM_status, "DRAM", "wa_diag_dram.so", 0),
 #endif
 #ifdef HAVE_DIAG_HDMIOUT
-    {"hdmiout_status", NULL, NULL, WA_DIAG_HDMIOUT_status, NULL, NULL, NULL, "HDMI" },
+    DIAG_ENTRY("hdmiout_status", NULL, WA_DIAG_HDMIOUT_status, "HDMI", "wa_diag_hdmiout.so", WA_DIAG_NEEDS_IARM),
 #endif
 #ifdef HAVE_DIAG_MCARD
-    {"mcard_status", NULL, NULL, WA_DIAG_MCARD_status, NULL, NULL, NULL, "CableCard" },
+    DIAG_ENTRY("mcard_status", NULL, WA_DIAG_MCARD_status, "CableCard", "wa_diag_mcard.so", WA_DIAG_NEEDS_SNMP),
 #endif
 #ifdef HAVE_DIAG_IR
-    {"ir_status", NULL, NULL, WA_DIAG_IR_status, NULL, NULL, NULL, "IRR"},
+    DIAG_ENTRY("ir_status", NULL, WA_DIAG_IR_status, "IRR", "wa_diag_ir.so", 0),
 #endif
 #ifdef HAVE_DIAG_RF4CE
-    {"rf4ce_status", NULL, NULL, WA_DIAG_RF4CE_status, NULL, NULL, NULL, "RFR" },
+    DIAG_ENTRY("rf4ce_status", NULL, WA_DIAG_RF4CE_status, "RFR", "wa_diag_rf4ce.so", WA_DIAG_NEEDS_IARM),
 #endif
 #ifdef HAVE_DIAG_MOCA
-    {"moca_status", NULL, NULL, WA_DIAG_MOCA_status, NULL, NULL, NULL, "MOCA" },
+    DIAG_ENTRY("moca_status", NULL, WA_DIAG_MOCA_status, "MOCA", "wa_diag_moca.so", WA_DIAG_NEEDS_IARM | WA_DIAG_NEEDS_SNMP),
 #endif
 #ifdef HAVE_DIAG_AVDECODER_QAM
-    {"avdecoder_qam_status", WA_DIAG_AVDECODER_init, NULL, WA_DIAG_AVDECODER_status, NULL, NULL, NULL, "AVDecoder" },
+    DIAG_ENTRY("avdecoder_qam_status", WA_DIAG_AVDECODER_init, WA_DIAG_AVDECODER_status, "AVDecoder", "wa_diag_avdecoder.so", WA_DIAG_NEEDS_IARM),
 #endif
 #ifdef HAVE_DIAG_TUNER
-    {"tuner_status", NULL, NULL, WA_DIAG_TUNER_status, NULL, NULL, NULL, "QAM" },
+    DIAG_ENTRY("tuner_status", NULL, WA_DIAG_TUNER_status, "QAM", "wa_diag_tuner.so", WA_DIAG_NEEDS_IARM | WA_DIAG_NEEDS_SNMP),
 #endif
 #ifdef HAVE_DIAG_MODEM
-    {"modem_status", NULL, NULL, WA_DIAG_MODEM_status, NULL, NULL, NULL, "DOCSIS" },
+    DIAG_ENTRY("modem_status", NULL, WA_DIAG_MODEM_status, "DOCSIS", "wa_diag_modem.so", WA_DIAG_NEEDS_SNMP),
 #endif
 #ifdef HAVE_DIAG_BLUETOOTH
-    {"bluetooth_status", NULL, NULL, WA_DIAG_BLUETOOTH_status, NULL, NULL, NULL, "BTLE" },
+    DIAG_ENTRY("bluetooth_status", NULL, WA_DIAG_BLUETOOTH_status, "BTLE", "wa_diag_bluetooth.so", 0),
 #endif
 #ifdef HAVE_DIAG_WIFI
-    {"wifi_status", NULL, NULL, WA_DIAG_WIFI_status, NULL, NULL, NULL, "WiFi" },
+    DIAG_ENTRY("wifi_status", NULL, WA_DIAG_WIFI_status, "WiFi", "wa_diag_wifi.so", WA_DIAG_NEEDS_IARM),
 #endif
 #ifdef HAVE_DIAG_WAN
-    {"wan_status", NULL, NULL, WA_DIAG_WAN_status, NULL, NULL, NULL, "WAN" },
+    DIAG_ENTRY("wan_status", NULL, WA_DIAG_WAN_status, "WAN", "wa_diag_wan.so", WA_DIAG_NEEDS_IARM),
+#endif
+#ifdef WA_BENCH
+    /* one per client of the comm_bench, WA_DIAG_BENCH_COUNT */
+    {"bench_0", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_1", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_2", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_3", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_4", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_5", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_6", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_7", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_8", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_9", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_10", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_11", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_12", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_13", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_14", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
+    {"bench_15", NULL, NULL, WA_DIAG_BENCH_Noop, NULL, NULL, NULL, NULL, NULL, 0},
 #endif
 
     {"previous_results", NULL, NULL, WA_DIAG_PREV_RESULTS_Info, NULL, NULL, NULL, NULL },
@@ -194,6 +251,25 @@ static WA_DIAG_proceduresConfig_t diags[] =
     {NULL, NULL, NULL, NULL, NULL, NULL}
 };
 
+/* by the index of the diag */
+static WA_DIAG_settings_t settings[DIAGS_COUNT];
+
+static const WA_CONFIG_setting_t settingKeys[] =
+{
+    {"applicable", SETTING_BOOL, offsetof(WA_DIAG_settings_t, applicable), 0},
+    {"max_age", SETTING_INT, offsetof(WA_DIAG_settings_t, maxAge), 0},
+    {"filesize", SETTING_INT, offsetof(WA_DIAG_settings_t, fileSize), 0},
+    {"filename", SETTING_STRING, offsetof(WA_DIAG_settings_t, fileName), 0},
+    {"logfile", SETTING_STRING, offsetof(WA_DIAG_settings_t, logFile), 0},
+    {"logpattern", SETTING_STRING, offsetof(WA_DIAG_settings_t, logPattern), 0},
+    {"interface", SETTING_STRING, offsetof(WA_DIAG_settings_t, interface), 0},
+    {"url", SETTING_STRING, offsetof(WA_DIAG_settings_t, url), 0},
+    {"tuners_count", SETTING_INT, offsetof(WA_DIAG_settings_t, tunersCount), 0}, /* no tuners tested */
+    {"expiry_time", SETTING_INT, offsetof(WA_DIAG_settings_t, expiryTime), -1},
+    {"sweep_sessions", SETTING_INT, offsetof(WA_DIAG_settings_t, sweepSessions), 0},
+    {"sweep_stop_on_lock", SETTING_BOOL, offsetof(WA_DIAG_settings_t, sweepStopOnLock), 0}
+};
+
 char * configCheckDirectories[] =
 {
     ".",
@@ -230,18 +306,18 @@ int WA_CONFIG_Init(const char* filename)
                 }
             }
 
-            /* Fill in config fields in diag definition table with json taken from configuration */
+            /* Fill in config fields in diag definition table with json taken from configuration,
+             * the typed settings are read from it once here */
             json_t * diagsConfig = json_object_get(configs, "diags");
-            if (diagsConfig && json_is_object(diagsConfig))
+            for (WA_DIAG_proceduresConfig_t * diag = &diags[0]; diag->name; diag++)
             {
-                for (WA_DIAG_proceduresConfig_t * diag = &diags[0]; diag->name; diag++)
+                json_t * diagConfig = json_is_object(diagsConfig) ? json_object_get(diagsConfig, diag->name) : NULL;
+                if (diagConfig && json_is_object(diagConfig))
                 {
-                    json_t * diagConfig = json_object_get(diagsConfig, diag->name);
-                    if (diagConfig && json_is_object(diagConfig))
-                    {
-                        diag->config = diagConfig;
-                    }
+                    diag->config = diagConfig;
                 }
+                loadSettings(diag->name, diag->config, &settings[diag - diags]);
+                diag->settings = &settings[diag - diags];
             }
 
             status = 0;
@@ -265,6 +341,13 @@ int WA_CONFIG_Exit()
 
     if (configs)
     {
+        /* the settings point into the configs */
+        for (WA_DIAG_proceduresConfig_t * diag = &diags[0]; diag->name; diag++)
+        {
+            diag->config = NULL;
+            diag->settings = NULL;
+        }
+
         json_decref(configs);
         configs = NULL;
     }
@@ -284,6 +367,13 @@ const WA_COMM_adaptersConfig_t *WA_CONFIG_GetAdapters()
     return adapters;
 }
 
+json_t *WA_CONFIG_GetSection(const char *name)
+{
+    json_t *section = configs ? json_object_get(configs, name) : NULL;
+
+    return json_is_object(section) ? section : NULL;
+}
+
 /*****************************************************************************
  * LOCAL FUNCTION DEFINITIONS
  *****************************************************************************/
@@ -367,6 +457,52 @@ static json_t *loadConfig(const char *filename)
     return result;
 }
 
+static void loadSettings(const char *name, json_t *config, WA_DIAG_settings_t *pSettings)
+{
+    static const WA_DIAG_settings_t defaults = WA_DIAG_SETTINGS_DEFAULT;
+
+    *pSettings = defaults;
+    if (!config)
+        return;
+
+    for (int i = 0; i < sizeof(settingKeys) / sizeof(settingKeys[0]); ++i)
+    {
+        const WA_CONFIG_setting_t *key = &settingKeys[i];
+        char *field = (char *)pSettings + key->offset;
+        json_t *value = json_object_get(config, key->key);
+
+        if (!value)
+            continue;
+
+        switch (key->type)
+        {
+        case SETTING_BOOL:
+            if (json_is_boolean(value))
+                *(bool *)field = json_is_true(value);
+            else
+                WA_ERROR("loadSettings(): %s: \"%s\" boolean expected\n", name, key->key);
+            break;
+
+        case SETTING_INT:
+            if (json_is_integer(value) && (json_integer_value(value) >= 0) && (json_integer_value(value) <= INT_MAX))
+                *(int *)field = (int)json_integer_value(value);
+            else
+            {
+                WA_ERROR("loadSettings(): %s: \"%s\" non-negative integer expected\n", name, key->key);
+                *(int *)field = key->invalid;
+            }
+            break;
+
+        case SETTING_STRING:
+            if (json_is_string(value))
+                *(const char **)field = json_string_value(value);
+            else
+                WA_ERROR("loadSettings(): %s: \"%s\" string expected\n", name, key->key);
+            break;
+        }
+    }
+}
+
 /* End of doxygen group */
 /*! @} */
 
@@ -86,6 +86,15 @@ const WA_DIAG_proceduresConfig_t *WA_CONFIG_GetDiags();
  */
 const WA_COMM_adaptersConfig_t *WA_CONFIG_GetAdapters();
 
+/**
+ * @brief Retrieve a top level configuration section.
+ *
+ * @param name Section name, e.g. "comm".
+ *
+ * @returns Section object (borrowed reference), NULL if not configured.
+ */
+json_t *WA_CONFIG_GetSection(const char *name);
+
 #ifdef __cplusplus
 }
 #endif
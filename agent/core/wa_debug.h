@@ -40,18 +40,29 @@
 #include "rdk_debug.h"
 #include "stdlib.h"
 #include "string.h"
+#include "wa_trace.h"
 
 /*****************************************************************************
  * EXPORTED DEFINITIONS
  *****************************************************************************/
 
-/* Debug definitions. This will be enabled/disabled via debug.ini using 'LOG.RDK.HWST = ' */
-#define WA_ENTER(fmt...)  RDK_LOG(RDK_LOG_TRACE1,  "LOG.RDK.HWST", "HWST_LOG |" fmt)
-#define WA_RETURN(fmt...) RDK_LOG(RDK_LOG_TRACE1,  "LOG.RDK.HWST", "HWST_LOG |" fmt)
-#define WA_ERROR(fmt...)  RDK_LOG(RDK_LOG_ERROR,   "LOG.RDK.HWST", "HWST_LOG |" fmt)
-#define WA_WARN(fmt...)   RDK_LOG(RDK_LOG_WARN,    "LOG.RDK.HWST", "HWST_LOG |" fmt)
-#define WA_INFO(fmt...)   RDK_LOG(RDK_LOG_INFO,    "LOG.RDK.HWST", "HWST_LOG |" fmt)
-#define WA_DBG(fmt...)    RDK_LOG(RDK_LOG_DEBUG,   "LOG.RDK.HWST", "HWST_LOG |" fmt)
+/* Debug definitions. This will be enabled/disabled via debug.ini using 'LOG.RDK.HWST = '
+ * Every message is also recorded in the binary trace (see wa_trace.h). Function enter/return
+ * tracing goes only there, unless built with WA_DEBUG.
+ */
+#define WA_LOG_(level, trace, fmt...) WA_TRACE_Log(level, trace, WA_TRACE_LOG_PREFIX fmt)
+
+#if WA_DEBUG
+#define WA_ENTER(fmt...)  WA_LOG_(RDK_LOG_TRACE1, '>', fmt)
+#define WA_RETURN(fmt...) WA_LOG_(RDK_LOG_TRACE1, '<', fmt)
+#else
+#define WA_ENTER(fmt...)  WA_TRACE('>', fmt)
+#define WA_RETURN(fmt...) WA_TRACE('<', fmt)
+#endif
+#define WA_ERROR(fmt...)  WA_LOG_(RDK_LOG_ERROR, 'E', fmt)
+#define WA_WARN(fmt...)   WA_LOG_(RDK_LOG_WARN,  'W', fmt)
+#define WA_INFO(fmt...)   WA_LOG_(RDK_LOG_INFO,  'I', fmt)
+#define WA_DBG(fmt...)    WA_LOG_(RDK_LOG_DEBUG, 'D', fmt)
 
 /*****************************************************************************
  * EXPORTED TYPES
@@ -30,8 +30,18 @@
 /*****************************************************************************
  * STANDARD INCLUDE FILES
  *****************************************************************************/
+#define _GNU_SOURCE /* dl_iterate_phdr() */
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#ifdef WA_DIAG_PLUGINS
+#include <dlfcn.h>
+#include <limits.h>
+#include <link.h>
+#endif
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
@@ -40,11 +50,20 @@
 #include "wa_diag.h"
 #include "wa_id.h"
 #include "wa_init.h"
+#include "wa_list_api.h"
+#include "wa_metrics.h"
 #include "wa_osa.h"
+#include "wa_phash.h"
+#include "wa_sim.h"
 #include "wa_debug.h"
 #include "wa_log.h"
 #include "wa_agg.h"
+#include "wa_comm.h"
 #include "wa_diag_filter.h"
+#include "wa_iarm.h"
+#include "wa_snmp_client.h"
+#include "wa_throttle.h"
+#include "wa_trace.h"
 
 /*****************************************************************************
  * GLOBAL VARIABLE DEFINITIONS
@@ -59,6 +78,18 @@ void *WA_DIAG_IncomingQ = NULL;
 
 #define WA_DIAG_INCOME_Q_EXIT_MSG "exit"
 
+#define PROC_SELF_STATUS "/proc/self/status"
+#define PROC_TASK_IO "/proc/self/task/%ld/io"
+
+#define LOCAL_PROCEDURES (sizeof(localProcedures)/sizeof(WA_DIAG_localProcedures_t))
+
+#ifndef WA_DIAG_PLUGIN_DIR
+#define WA_DIAG_PLUGIN_DIR "/usr/lib/hwselftest"
+#endif
+
+#define PLUGIN_IDLE_TIME 60 /* [s] a plugin stays loaded after its last instance */
+#define PLUGIN_IDLE_CHECK 5000 /* [ms] */
+
 /*****************************************************************************
  * LOCAL TYPES
  *****************************************************************************/
@@ -71,23 +102,79 @@ typedef struct
     void *taskHandle;
     struct WA_DIAG_procedureContext_tag *pContext;
     json_t *json; /**< startup json (a msg received) */
+    uint64_t created; /**< \c WA_METRICS_Now() when the instance task was requested */
 }WA_DIAG_procedureInstance_t;
-WA_UTILS_LIST_DECLARE_LIST_TYPE(WA_DIAG_procedureInstance_t);
+
+/** The last verdict of a diag, served again while fresh enough */
+typedef struct
+{
+    bool valid;
+    int status;
+    time_t timestamp; /**< time of the original run, reported */
+    time_t stored; /**< monotonic time [s] of the original run, for the age, immune to the clock steps */
+    json_t *data;
+}WA_DIAG_lastResult_t;
 
 typedef struct WA_DIAG_procedureContext_tag
 {
     const WA_DIAG_proceduresConfig_t *pConfig;
     void *handle;
-    WA_UTILS_LIST(WA_DIAG_procedureInstance_t) instancesList;
+    WA_DIAG_ProcedureFnc_t fnc; /**< the procedure, for a plugin set once it is loaded */
+    void *plugin; /**< the loaded plugin, set and cleared only while no instance exists or by the instance */
+    const WA_DIAG_proceduresConfig_t *pPlugin; /**< registration descriptor of the loaded plugin */
+    time_t idleSince; /**< monotonic time [s] the last instance of the loaded plugin ended */
+    WA_UTILS_LIST_t instancesList;
+    WA_DIAG_lastResult_t lastResult; /**< accessed only by the (single) instance of the procedure */
 }WA_DIAG_procedureContext_t;
-WA_UTILS_LIST_DECLARE_LIST_TYPE(WA_DIAG_procedureContext_t);
+
+typedef struct WA_DIAG_probeEntry_tag
+{
+    struct WA_DIAG_probeEntry_tag *next;
+    char *key; /**< "<probe>:<args>" */
+    struct timespec timestamp; /**< monotonic time of publishing */
+    unsigned int maxAge; /**< in [ms] */
+    size_t size;
+    unsigned char data[];
+}WA_DIAG_probeEntry_t;
+
+typedef struct
+{
+    void *mutex;
+    bool active;
+    unsigned int hits;
+    unsigned int misses;
+    WA_DIAG_probeEntry_t *entries;
+}WA_DIAG_probeCache_t;
+
+/** Resource counters of the instance task at one moment */
+typedef struct
+{
+    struct timespec wall;
+    struct timespec cpu;
+    unsigned long hwm; /**< VmHWM [kB] */
+    unsigned long long read;
+    unsigned long long written;
+    unsigned int subprocesses;
+}WA_DIAG_usageSample_t;
+
+#ifdef WA_DIAG_PLUGINS
+/** Mapping of a loaded plugin, found by an address inside it */
+typedef struct
+{
+    uintptr_t addr;
+    uintptr_t start;
+    uintptr_t end;
+}WA_DIAG_PluginRange_t;
+#endif
 
 typedef struct
 {
     void *mutex;
     void *semCollector;
     WA_UTILS_ID_box_t idBox;
-    WA_UTILS_LIST(WA_DIAG_procedureContext_t) proceduresList;
+    WA_UTILS_LIST_t proceduresList;
+    WA_UTILS_PHASH_t names; /**< procedure names, by their index in the config */
+    WA_DIAG_procedureContext_t **contexts; /**< by the index of the name */
 }WA_DIAG_procedures_t;
 
 
@@ -101,13 +188,25 @@ typedef struct
 {
     const char *name;
     WA_DIAG_LocalProcedure_t fnc;
+    bool response; /**< also called as a method, with the json it returns sent back as the result */
 }WA_DIAG_localProcedures_t;
 
+typedef struct
+{
+    unsigned int need; /**< the WA_DIAG_NEEDS_* bit */
+    const char *name;
+    int (*init)(void);
+    int (*exit)(void);
+}WA_DIAG_service_t;
+
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
 static void *DiagTask(void *p);
+static void Dispatch(json_t *json, uint32_t from);
 static WA_DIAG_procedureContext_t *FindContextByName(const char *name);
+static int IndexNames(void);
+static void ReleaseNames(void);
 static int CreateProcedureInstance(char *name, json_t *json, uint32_t callerId);
 static int DestroyProcedureInstance(WA_DIAG_procedureInstance_t *pInstance);
 static int CleanupInstance(WA_DIAG_procedureInstance_t *pInstance);
@@ -116,6 +215,22 @@ static void *InstancesCollectorTask(void *p);
 static WA_DIAG_procedureInstance_t *FindInstanceById(uint32_t id);
 static int DiagControl(json_t **json);
 static int TestRunControl(json_t **json);
+static int MetricsControl(json_t **json);
+static int TraceControl(json_t **json);
+static char *ProbeKey(const char *probe, const char *args);
+static int ResultMaxAge(WA_DIAG_procedureContext_t *pContext, json_t *jparams);
+static void StoreResult(WA_DIAG_procedureContext_t *pContext, int status, time_t timestamp, json_t *data);
+static WA_DIAG_probeEntry_t **FindProbeEntry(const char *key);
+static void UsageSample(WA_DIAG_usageSample_t *pSample);
+static void UsageDelta(const WA_DIAG_usageSample_t *pStart, const WA_DIAG_usageSample_t *pEnd, WA_DIAG_Usage_t *pUsage);
+static int LoadPlugin(WA_DIAG_procedureContext_t *pContext);
+static void UnloadPlugin(WA_DIAG_procedureContext_t *pContext);
+#ifdef WA_DIAG_PLUGINS
+static void UnloadIdlePlugins(void);
+static int PluginRange(struct dl_phdr_info *info, size_t size, void *data);
+#endif
+static time_t MonotonicSec(void);
+static void StopServices(void);
 
 /*****************************************************************************
  * LOCAL VARIABLE DECLARATIONS
@@ -129,13 +244,35 @@ static const WA_DIAG_proceduresConfig_t *pProceduresConfig;
 
 static WA_DIAG_procedures_t diagProcedures = {mutex:NULL};
 
+static WA_DIAG_probeCache_t probeCache = {mutex:NULL};
+
+/* processes spawned by the task, see WA_DIAG_Popen() */
+static __thread unsigned int taskSubprocesses;
+
 static const WA_DIAG_localProcedures_t localProcedures[] =
 {
-        {"LOG", WA_LOG_Log},
-        {"DIAG", DiagControl},
-        {"TESTRUN", TestRunControl}
+        {"LOG", WA_LOG_Log, false},
+        {"DIAG", DiagControl, false},
+        {"TESTRUN", TestRunControl, false},
+        {"METRICS", MetricsControl, true},
+        {"TRACE", TraceControl, true}
+};
+
+/* names of the above, by their index */
+static WA_UTILS_PHASH_t localNames;
+
+static const WA_DIAG_settings_t defaultSettings = WA_DIAG_SETTINGS_DEFAULT;
+
+/* platform services brought up on demand, see WA_DIAG_Need() */
+static const WA_DIAG_service_t services[] =
+{
+        {WA_DIAG_NEEDS_IARM, "IARM", WA_UTILS_IARM_Init, WA_UTILS_IARM_Term},
+        {WA_DIAG_NEEDS_SNMP, "SNMP", WA_UTILS_SNMP_Init, WA_UTILS_SNMP_Exit}
 };
 
+static void *servicesMutex;
+static unsigned int servicesUp; /**< WA_DIAG_NEEDS_* services up, under the servicesMutex */
+
 /*****************************************************************************
  * FUNCTION DEFINITIONS
  *****************************************************************************/
@@ -159,7 +296,15 @@ int WA_DIAG_Init(const WA_DIAG_proceduresConfig_t *diags)
     }
 
     pProceduresConfig = diags;
-    WA_UTILS_LIST_ClearList(diagProcedures.proceduresList);
+    WA_UTILS_LIST_Init(&(diagProcedures.proceduresList));
+
+    status = IndexNames();
+    if(status != 0)
+    {
+        WA_ERROR("WA_DIAG_Init(): IndexNames(): %d\n", status);
+        status = -1;
+        goto err_names;
+    }
     /*
     status = WA_UTILS_ID_GenerateUnsafe(&(diagProcedures.idBox), &id);
     if(status != 0)
@@ -175,12 +320,27 @@ int WA_DIAG_Init(const WA_DIAG_proceduresConfig_t *diags)
         goto err_mutex;
     }
 
+    probeCache.mutex = WA_OSA_MutexCreate();
+    if(probeCache.mutex == NULL)
+    {
+        WA_ERROR("WA_DIAG_Init(): WA_OSA_MutexCreate(probeCache): error\n");
+        goto err_probe_mutex;
+    }
+
+    servicesMutex = WA_OSA_MutexCreate();
+    if(servicesMutex == NULL)
+    {
+        WA_ERROR("WA_DIAG_Init(): WA_OSA_MutexCreate(services): error\n");
+        goto err_services_mutex;
+    }
+
     collectorQ = WA_OSA_QCreate(COLLECTOR_Q_DEEP, sizeof(WA_DIAG_procedureInstance_t *));
     if(collectorQ == NULL)
     {
         WA_ERROR("WA_DIAG_Init(): WA_OSA_QCreate(collectorQ) error\n");
         goto err_collector_q;
     }
+    (void)WA_OSA_QSetMetrics(collectorQ, "collector", WA_METRICS_HOP_COLLECTOR);
 
     collectorTaskHandle = WA_OSA_TaskCreate(NULL, 0, InstancesCollectorTask, NULL, WA_OSA_SCHED_POLICY_RT, WA_OSA_TASK_PRIORITY_MAX);
     if(collectorTaskHandle == NULL)
@@ -196,6 +356,7 @@ int WA_DIAG_Init(const WA_DIAG_proceduresConfig_t *diags)
         WA_ERROR("WA_DIAG_Init(): WA_OSA_QCreate(WA_DIAG_IncomingQ) error\n");
         goto income_q_err;
     }
+    (void)WA_OSA_QSetMetrics(WA_DIAG_IncomingQ, "diag", WA_METRICS_HOP_DIAG);
 
     diagTaskHandle = WA_OSA_TaskCreate(NULL, 0, DiagTask, NULL, WA_OSA_SCHED_POLICY_RT, WA_OSA_TASK_PRIORITY_MAX);
     if(diagTaskHandle == NULL)
@@ -216,16 +377,15 @@ int WA_DIAG_Init(const WA_DIAG_proceduresConfig_t *diags)
             goto err_adapters;
         }
 
-        pContext = FindContextByName(pConfig->name);
-        if(pContext != NULL)
-        {
-            WA_ERROR("WA_DIAG_Init(): name \"%s\" already registered\n", pConfig->name);
-            goto err_adapters;
-        }
-
         procedureHandle = (void *)pConfig;
         if(pConfig->initFnc != NULL)
         {
+            /* the init may already talk to the platform */
+            if(WA_DIAG_Need(pConfig->needs) != 0)
+            {
+                WA_ERROR("WA_DIAG_Init(): WA_DIAG_Need(): error\n");
+                goto err_adapters;
+            }
             procedureHandle = pConfig->initFnc(pConfig);
             if(procedureHandle == NULL)
             {
@@ -252,7 +412,13 @@ int WA_DIAG_Init(const WA_DIAG_proceduresConfig_t *diags)
 
         pContext->handle = procedureHandle;
         pContext->pConfig = pConfig;
-        WA_UTILS_LIST_ClearList(pContext->instancesList);
+        /* a plugin brings its procedure when loaded */
+        pContext->fnc = (pConfig->plugin == NULL) ? pConfig->fnc : NULL;
+        pContext->plugin = NULL;
+        pContext->lastResult.valid = false;
+        pContext->lastResult.data = NULL;
+        WA_UTILS_LIST_Init(&(pContext->instancesList));
+        diagProcedures.contexts[pConfig - pProceduresConfig] = pContext;
     }
     status = 0;
     goto end;
@@ -273,6 +439,7 @@ int WA_DIAG_Init(const WA_DIAG_proceduresConfig_t *diags)
         }
     }
     WA_UTILS_LIST_AllocPurge(&(diagProcedures.proceduresList));
+    StopServices();
 
     s1 = WA_OSA_QSend(WA_DIAG_IncomingQ,
             NULL,
@@ -334,12 +501,28 @@ int WA_DIAG_Init(const WA_DIAG_proceduresConfig_t *diags)
         WA_ERROR("WA_DIAG_Init():  WA_OSA_QDestroy(collectorQ): %d\n", s1);
     }
     err_collector_q:
+    s1 = WA_OSA_MutexDestroy(servicesMutex);
+    if(s1 != 0)
+    {
+        WA_ERROR("WA_DIAG_Init(): WA_OSA_MutexDestroy(services): %d\n", s1);
+    }
+    servicesMutex = NULL;
+    err_services_mutex:
+    s1 = WA_OSA_MutexDestroy(probeCache.mutex);
+    if(s1 != 0)
+    {
+        WA_ERROR("WA_DIAG_Init(): WA_OSA_MutexDestroy(probeCache): %d\n", s1);
+    }
+    probeCache.mutex = NULL;
+    err_probe_mutex:
     s1 = WA_OSA_MutexDestroy(diagProcedures.mutex);
     if(s1 != 0)
     {
         WA_ERROR("WA_DIAG_Init(): WA_OSA_MutexDestroy(): %d\n", s1);
     }
     err_mutex:
+    ReleaseNames();
+    err_names:
     end:
     WA_RETURN("WA_DIAG_Init(): %d\n", status);
     return status;
@@ -389,11 +572,12 @@ int WA_DIAG_Exit(void)
     {
         pContext = (WA_DIAG_procedureContext_t *)WA_UTILS_LIST_DataAtIterator(&(diagProcedures.proceduresList), iterator);
 
-        for(instanceIterator = WA_UTILS_LIST_FrontIterator(&(pContext->instancesList));
-                instanceIterator != WA_UTILS_LIST_NO_ELEM;
-                instanceIterator = WA_UTILS_LIST_NextIterator(&(pContext->instancesList), instanceIterator))
+        /* the instance leaves the list when destroyed, step over it first */
+        instanceIterator = WA_UTILS_LIST_FrontIterator(&(pContext->instancesList));
+        while(instanceIterator != WA_UTILS_LIST_NO_ELEM)
         {
             pInstance = (WA_DIAG_procedureInstance_t *)WA_UTILS_LIST_DataAtIterator(&(pContext->instancesList), instanceIterator);
+            instanceIterator = WA_UTILS_LIST_NextIterator(&(pContext->instancesList), instanceIterator);
             s1 = DestroyProcedureInstance(pInstance);
             if(s1 != 0)
             {
@@ -403,6 +587,8 @@ int WA_DIAG_Exit(void)
 
         }
 
+        StoreResult(pContext, 0, 0, NULL);
+
         if(pContext->pConfig->exitFnc != NULL)
         {
             s1 = pContext->pConfig->exitFnc(pContext->handle);
@@ -412,9 +598,11 @@ int WA_DIAG_Exit(void)
                 status = -1;
             }
         }
+        UnloadPlugin(pContext);
     }
 
     WA_UTILS_LIST_AllocPurge(&(diagProcedures.proceduresList));
+    StopServices();
 
     s1 = WA_OSA_QSend(WA_DIAG_IncomingQ,
             NULL,
@@ -460,12 +648,31 @@ int WA_DIAG_Exit(void)
         status = -1;
     }
 
+    WA_DIAG_ProbeCacheClear();
+    s1 = WA_OSA_MutexDestroy(probeCache.mutex);
+    if(s1 != 0)
+    {
+        WA_ERROR("WA_DIAG_Exit(): WA_OSA_MutexDestroy(probeCache): %d\n", s1);
+        status = -1;
+    }
+    probeCache.mutex = NULL;
+
+    s1 = WA_OSA_MutexDestroy(servicesMutex);
+    if(s1 != 0)
+    {
+        WA_ERROR("WA_DIAG_Exit(): WA_OSA_MutexDestroy(services): %d\n", s1);
+        status = -1;
+    }
+    servicesMutex = NULL;
+
     s1 = WA_OSA_MutexDestroy(diagProcedures.mutex);
     if(s1 != 0)
     {
         WA_ERROR("WA_DIAG_Exit(): WA_OSA_MutexDestroy(): %d\n", s1);
         status = -1;
     }
+
+    ReleaseNames();
     end:
     WA_RETURN("WA_DIAG_Exit(): %d\n", status);
     return status;
@@ -589,6 +796,17 @@ void WA_DIAG_SendProgress(void* instanceHandle, int progress)
     WA_ENTER("WA_DIAG_SendProgress(instanceHandle=%p, progress=%d)\n",
             instanceHandle, progress);
 
+    /* coalesced and rate limited by the COMM task */
+    if(instanceHandle != NULL)
+    {
+        WA_DIAG_procedureInstance_t *pInstance = (WA_DIAG_procedureInstance_t *)instanceHandle;
+
+        if(WA_COMM_SendProgress(pInstance->id, pInstance->callerId, progress) == 0)
+        {
+            return;
+        }
+    }
+
     jout = json_pack("{s:i}", "progress", progress);
     if(jout == NULL)
     {
@@ -610,17 +828,284 @@ void WA_DIAG_SetWriteTestResult(bool writeResult)
     WA_AGG_SetWriteTestResult(writeResult);
 }
 
+int WA_DIAG_ProbeCacheStart(void)
+{
+    int status = -1;
+
+    WA_ENTER("WA_DIAG_ProbeCacheStart()\n");
+
+    if(WA_OSA_MutexLock(probeCache.mutex))
+    {
+        WA_ERROR("WA_DIAG_ProbeCacheStart(): WA_OSA_MutexLock() failed\n");
+        goto end;
+    }
+
+    /* entries left by an unfinished run are not trusted */
+    while(probeCache.entries)
+    {
+        WA_DIAG_probeEntry_t *pEntry = probeCache.entries;
+        probeCache.entries = pEntry->next;
+        free(pEntry->key);
+        free(pEntry);
+    }
+    probeCache.hits = 0;
+    probeCache.misses = 0;
+    probeCache.active = true;
+    status = 0;
+
+    if(WA_OSA_MutexUnlock(probeCache.mutex))
+    {
+        WA_ERROR("WA_DIAG_ProbeCacheStart(): WA_OSA_MutexUnlock() failed\n");
+    }
+
+    end:
+    WA_RETURN("WA_DIAG_ProbeCacheStart(): %d\n", status);
+    return status;
+}
+
+void WA_DIAG_ProbeCacheClear(void)
+{
+    WA_ENTER("WA_DIAG_ProbeCacheClear()\n");
+
+    if(WA_OSA_MutexLock(probeCache.mutex))
+    {
+        WA_ERROR("WA_DIAG_ProbeCacheClear(): WA_OSA_MutexLock() failed\n");
+        goto end;
+    }
+
+    if(probeCache.active)
+    {
+        WA_INFO("WA_DIAG_ProbeCacheClear(): probe cache hits: %u, misses: %u\n", probeCache.hits, probeCache.misses);
+    }
+
+    while(probeCache.entries)
+    {
+        WA_DIAG_probeEntry_t *pEntry = probeCache.entries;
+        probeCache.entries = pEntry->next;
+        free(pEntry->key);
+        free(pEntry);
+    }
+    probeCache.active = false;
+
+    if(WA_OSA_MutexUnlock(probeCache.mutex))
+    {
+        WA_ERROR("WA_DIAG_ProbeCacheClear(): WA_OSA_MutexUnlock() failed\n");
+    }
+
+    end:
+    WA_RETURN("WA_DIAG_ProbeCacheClear()\n");
+}
+
+int WA_DIAG_ProbeCachePut(const char *probe, const char *args, const void *data, size_t size, unsigned int maxAge)
+{
+    int status = -1;
+    char *key;
+    WA_DIAG_probeEntry_t **ppEntry;
+    WA_DIAG_probeEntry_t *pEntry;
+
+    WA_ENTER("WA_DIAG_ProbeCachePut(probe=%s, args=%s, size=%zu, maxAge=%u)\n", probe, args, size, maxAge);
+
+    key = ProbeKey(probe, args);
+    if(key == NULL)
+    {
+        WA_ERROR("WA_DIAG_ProbeCachePut(): ProbeKey(): error\n");
+        goto end;
+    }
+
+    pEntry = malloc(sizeof(WA_DIAG_probeEntry_t) + size);
+    if(pEntry == NULL)
+    {
+        WA_ERROR("WA_DIAG_ProbeCachePut(): malloc(): error\n");
+        goto err_entry;
+    }
+    pEntry->key = key;
+    pEntry->maxAge = maxAge;
+    pEntry->size = size;
+    memcpy(pEntry->data, data, size);
+    clock_gettime(CLOCK_MONOTONIC, &pEntry->timestamp);
+
+    if(WA_OSA_MutexLock(probeCache.mutex))
+    {
+        WA_ERROR("WA_DIAG_ProbeCachePut(): WA_OSA_MutexLock() failed\n");
+        goto err_lock;
+    }
+
+    if(!probeCache.active)
+    {
+        status = 1;
+        WA_OSA_MutexUnlock(probeCache.mutex);
+        goto err_lock;
+    }
+
+    /* replace the older result of the same probe */
+    ppEntry = FindProbeEntry(key);
+    if(*ppEntry != NULL)
+    {
+        WA_DIAG_probeEntry_t *pOld = *ppEntry;
+        *ppEntry = pOld->next;
+        free(pOld->key);
+        free(pOld);
+    }
+    pEntry->next = probeCache.entries;
+    probeCache.entries = pEntry;
+    status = 0;
+
+    if(WA_OSA_MutexUnlock(probeCache.mutex))
+    {
+        WA_ERROR("WA_DIAG_ProbeCachePut(): WA_OSA_MutexUnlock() failed\n");
+    }
+    goto end;
+
+    err_lock:
+    free(pEntry);
+    err_entry:
+    free(key);
+    end:
+    WA_RETURN("WA_DIAG_ProbeCachePut(): %d\n", status);
+    return status;
+}
+
+int WA_DIAG_ProbeCacheGet(const char *probe, const char *args, void *data, size_t size)
+{
+    int status = 1;
+    char *key;
+    WA_DIAG_probeEntry_t *pEntry;
+    struct timespec now;
+
+    WA_ENTER("WA_DIAG_ProbeCacheGet(probe=%s, args=%s, size=%zu)\n", probe, args, size);
+
+    key = ProbeKey(probe, args);
+    if(key == NULL)
+    {
+        WA_ERROR("WA_DIAG_ProbeCacheGet(): ProbeKey(): error\n");
+        goto end;
+    }
+
+    if(WA_OSA_MutexLock(probeCache.mutex))
+    {
+        WA_ERROR("WA_DIAG_ProbeCacheGet(): WA_OSA_MutexLock() failed\n");
+        goto err_lock;
+    }
+
+    if(probeCache.active)
+    {
+        pEntry = *FindProbeEntry(key);
+        if((pEntry != NULL) && (pEntry->size == size))
+        {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if((now.tv_sec - pEntry->timestamp.tv_sec) * 1000 +
+               (now.tv_nsec - pEntry->timestamp.tv_nsec) / 1000000 <= pEntry->maxAge)
+            {
+                memcpy(data, pEntry->data, size);
+                status = 0;
+            }
+        }
+
+        if(status == 0)
+        {
+            ++probeCache.hits;
+        }
+        else
+        {
+            ++probeCache.misses;
+        }
+    }
+
+    if(WA_OSA_MutexUnlock(probeCache.mutex))
+    {
+        WA_ERROR("WA_DIAG_ProbeCacheGet(): WA_OSA_MutexUnlock() failed\n");
+    }
+
+    err_lock:
+    free(key);
+    end:
+    WA_RETURN("WA_DIAG_ProbeCacheGet(): %d\n", status);
+    return status;
+}
+
+FILE *WA_DIAG_Popen(const char *command, const char *type)
+{
+    ++taskSubprocesses;
+    return popen(WA_UTILS_SIM_COMMAND(command), type);
+}
+
+int WA_DIAG_System(const char *command)
+{
+    ++taskSubprocesses;
+    return system(WA_UTILS_SIM_COMMAND(command));
+}
+
+const WA_DIAG_settings_t *WA_DIAG_GetSettings(const WA_DIAG_proceduresConfig_t *pConfig)
+{
+    return ((pConfig != NULL) && (pConfig->settings != NULL)) ? pConfig->settings : &defaultSettings;
+}
+
+int WA_DIAG_Need(unsigned int needs)
+{
+    int status = 0, s1;
+    unsigned int i;
+    struct timespec start, end;
+
+    if(needs == 0)
+    {
+        return 0;
+    }
+
+    s1 = WA_OSA_MutexLock(servicesMutex);
+    if(s1 != 0)
+    {
+        WA_ERROR("WA_DIAG_Need(): WA_OSA_MutexLock(): %d\n", s1);
+        return -1;
+    }
+
+    for(i = 0; i < sizeof(services)/sizeof(services[0]); ++i)
+    {
+        if(!(needs & services[i].need) || (servicesUp & services[i].need))
+        {
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        s1 = services[i].init();
+        if(s1 != 0)
+        {
+            WA_ERROR("WA_DIAG_Need(): %s init: %d\n", services[i].name, s1);
+            status = -1;
+            break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        servicesUp |= services[i].need;
+
+        WA_INFO("WA_DIAG_Need(): %s up in %ld ms\n", services[i].name,
+                (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000);
+    }
+
+    s1 = WA_OSA_MutexUnlock(servicesMutex);
+    if(s1 != 0)
+    {
+        WA_ERROR("WA_DIAG_Need(): WA_OSA_MutexUnlock(): %d\n", s1);
+    }
+
+    return status;
+}
+
+int WA_DIAG_PluginProcedure(void *instanceHandle, void *initHandle, json_t **json)
+{
+    WA_ERROR("WA_DIAG_PluginProcedure(): plugin not loaded\n");
+    json_decref(*json);
+    *json = NULL;
+    return WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
+}
+
 /*****************************************************************************
  * LOCAL FUNCTIONS
  *****************************************************************************/
+
 static void *DiagTask(void *p)
 {
-    int status, i;
-    WA_OSA_Qjmsg_t qjmsg, qjmsgOut;
+    int status;
+    WA_OSA_Qjmsg_t qjmsg;
     unsigned int qprio;
-    json_t *jId;
-    char *method;
-    WA_DIAG_procedureContext_t *pContext;
 
     WA_ENTER("DiagTask(p=%p)\n", p);
 
@@ -633,7 +1118,6 @@ static void *DiagTask(void *p)
 
     while(1)
     {
-        next:
         status = WA_OSA_QReceive(WA_DIAG_IncomingQ, (char * const)&qjmsg, sizeof(WA_OSA_Qjmsg_t), &qprio);
         if(status == 0)
         {
@@ -664,125 +1148,186 @@ static void *DiagTask(void *p)
         WA_INFO("DiagTask(): WA_OSA_QReceive(): %p\n", qjmsg.json);
 #endif
 
-        status = json_unpack(qjmsg.json, "{s:s}", "method", &method);
-        if(status != 0)
+        if(json_is_array(qjmsg.json))
         {
-            WA_ERROR("DiagTask(): json_unpack() \"method\" missing\n");
-            json_decref(qjmsg.json);
-            continue;
-        }
+            size_t index;
+            json_t *jElem;
 
-        status = json_unpack(qjmsg.json, "{s:o}", "id", &jId); //reference to jId is NOT modified
-        if(status != 0)
-        {
-            WA_ERROR("DiagTask(): json_unpack() \"id\" missing\n");
+            /* batch: dispatch all requests in one pass, responses are streamed per element */
+            WA_INFO("DiagTask(): batch of %zu requests\n", json_array_size(qjmsg.json));
+            json_array_foreach(qjmsg.json, index, jElem)
+            {
+                Dispatch(json_incref(jElem), qjmsg.from);
+            }
             json_decref(qjmsg.json);
-            continue;
         }
-
-        if(json_typeof(jId) == JSON_NULL)
+        else
         {
-            /* First use local handlers */
-            for(i = 0; i < sizeof(localProcedures)/sizeof(WA_DIAG_localProcedures_t); ++i)
-            {
-                if(!strcmp(localProcedures[i].name, method))
-                {
-                    /* qjmsg.json is released inside the function called. */
-                    localProcedures[i].fnc(&(qjmsg.json));
-                    json_decref(qjmsg.json);
-                    goto next;
-                }
-            }
-
-            //if(method[0] != '#')
-            {
-                WA_ERROR("DiagTask(): id null for procedure call\n");
-                /* according to the spec no response is allowed */
-                json_decref(qjmsg.json);
-                continue;
-            }
-            /* Consideration: Currently there is no need to send any information from
-             *                client to a diag instance.
-             *                If needed it should be handled here.
-             */
+            Dispatch(qjmsg.json, qjmsg.from);
         }
+    }
+    end:
+    WA_RETURN("DiagTask(): %p\n", p);
+    return p;
+}
 
-        /* Consideration: Currently the local handlers (grouped in localProcedures) are
-         *                executed in response to notifications from client (so no reponse
-         *                is returned).
-         *                If there is a need to run them as methods (e.g to get a status of
-         *                their execution) is should be handled here.
-         */
+/**
+ * Handles a single request from a client.
+ *
+ * @param json the request, consumed by the function
+ * @param from id of the client connection
+ */
+static void Dispatch(json_t *json, uint32_t from)
+{
+    int status, local;
+    WA_OSA_Qjmsg_t qjmsgOut;
+    json_t *jId, *jError;
+    char *method;
+    WA_DIAG_procedureContext_t *pContext;
 
-        /* Consideration: Currently accept any message that it is known as coming from a clinet
-         *                directed to a diag (as no more players are in the system).
-         *                If there is a new player added (that can send/receive messages in system)
-         *                or any filtering is needed it must be implemented here to make use of
-         *                an ID that is carried by the messages.
-         */
-        /* Consideration: Currently there is no communication to particular instance (to its
-         *                id in form as "#<instance>"). If this is needed it must be handled here.
-         */
+    status = -1;
+    qjmsgOut.json = NULL;
 
-        WA_INFO("DiagTask(): method: %s\n", method);
+    /* invalid element of a batch, already turned into its error response by the validation */
+    if(json_unpack(json, "{s:o}", "error", &jError) == 0)
+    {
+        WA_INFO("Dispatch(): invalid batch element\n");
+        qjmsgOut.json = json_incref(json);
+        goto respond;
+    }
 
+    status = json_unpack(json, "{s:s}", "method", &method);
+    if(status != 0)
+    {
+        WA_ERROR("Dispatch(): json_unpack() \"method\" missing\n");
+        json_decref(json);
+        return;
+    }
+
+    status = json_unpack(json, "{s:o}", "id", &jId); //reference to jId is NOT modified
+    if(status != 0)
+    {
+        WA_ERROR("Dispatch(): json_unpack() \"id\" missing\n");
+        json_decref(json);
+        return;
+    }
+
+    local = WA_UTILS_PHASH_Find(&localNames, method);
+
+    if(json_typeof(jId) == JSON_NULL)
+    {
+        /* First use local handlers */
+        if(local >= 0)
+        {
+            /* json is released inside the function called. */
+            localProcedures[local].fnc(&json);
+            json_decref(json);
+            return;
+        }
+
+        //if(method[0] != '#')
+        {
+            WA_ERROR("Dispatch(): id null for procedure call\n");
+            /* according to the spec no response is allowed */
+            json_decref(json);
+            return;
+        }
+        /* Consideration: Currently there is no need to send any information from
+         *                client to a diag instance.
+         *                If needed it should be handled here.
+         */
+    }
+
+    /* Consideration: Currently the local handlers (grouped in localProcedures) are
+     *                executed in response to notifications from client (so no reponse
+     *                is returned).
+     *                If there is a need to run them as methods (e.g to get a status of
+     *                their execution) is should be handled here.
+     */
+
+    /* Consideration: Currently accept any message that it is known as coming from a clinet
+     *                directed to a diag (as no more players are in the system).
+     *                If there is a new player added (that can send/receive messages in system)
+     *                or any filtering is needed it must be implemented here to make use of
+     *                an ID that is carried by the messages.
+     */
+    /* Consideration: Currently there is no communication to particular instance (to its
+     *                id in form as "#<instance>"). If this is needed it must be handled here.
+     */
+
+    if((local >= 0) && localProcedures[local].response)
+    {
+        jId = json_incref(jId);
+        /* json is released inside the function called, the result is returned in its place. */
+        if((localProcedures[local].fnc(&json) == 0) && (json != NULL))
+        {
+            qjmsgOut.json = json_pack("{s:s,s:o,s:o}", "jsonrpc", "2.0", "result", json, "id", jId);
+        }
+        else
+        {
+            json_decref(json);
+            qjmsgOut.json = json_pack("{s:s,s:{s:i,s:s},s:o}", "jsonrpc", "2.0", "error", "code", -32603, "message", "Internal error", "id", jId);
+        }
+        json = NULL;
         status = -1;
-        qjmsgOut.json = NULL;
+        goto respond;
+    }
+
+    WA_INFO("Dispatch(): method: %s\n", method);
 
-        //if(msg.h.to == WA_DIAG_MSG_ID_PREFIX)
-        pContext = FindContextByName(method);
-        if(pContext)
+    status = -1;
+
+    //if(msg.h.to == WA_DIAG_MSG_ID_PREFIX)
+    pContext = FindContextByName(method);
+    if(pContext)
+    {
+        if(WA_UTILS_LIST_ElemCount(&(pContext->instancesList)) == 0)
         {
-            if(WA_UTILS_LIST_ElemCount(&(pContext->instancesList)) == 0)
-            {
-                status = CreateProcedureInstance(method, qjmsg.json, qjmsg.from);
-                if(status != 0)
-                {
-                    WA_ERROR("DiagTask(): \"%s\" run error\n", method);
-                    qjmsgOut.json = json_pack("{s:s,s:{s:n,s:s},s:O}", "jsonrpc", "2.0", "result", "diag", "message", "Cannot create instance", "id", jId);
-                }
-            }
-            else
+            status = CreateProcedureInstance(method, json, from);
+            if(status != 0)
             {
-                WA_INFO("DiagTask(): \"%s\" already in progress\n", method);
-                qjmsgOut.json = json_pack("{s:s,s:{s:n,s:s},s:O}", "jsonrpc", "2.0", "result", "diag", "message", "Already in progress", "id", jId);
+                WA_ERROR("Dispatch(): \"%s\" run error\n", method);
+                qjmsgOut.json = json_pack("{s:s,s:{s:n,s:s},s:O}", "jsonrpc", "2.0", "result", "diag", "message", "Cannot create instance", "id", jId);
             }
         }
         else
         {
-            WA_INFO("DiagTask(): \"%s\" diag unknown\n", method);
-            qjmsgOut.json = json_pack("{s:s,s:{s:n,s:s},s:O}", "jsonrpc", "2.0", "result", "diag", "message", "Unknown method", "id", jId);
+            WA_INFO("Dispatch(): \"%s\" already in progress\n", method);
+            qjmsgOut.json = json_pack("{s:s,s:{s:n,s:s},s:O}", "jsonrpc", "2.0", "result", "diag", "message", "Already in progress", "id", jId);
         }
+    }
+    else
+    {
+        WA_INFO("Dispatch(): \"%s\" diag unknown\n", method);
+        qjmsgOut.json = json_pack("{s:s,s:{s:n,s:s},s:O}", "jsonrpc", "2.0", "result", "diag", "message", "Unknown method", "id", jId);
+    }
 
-        if(status != 0)
-        {
-            json_decref(qjmsg.json);
+    respond:
+    if(status != 0)
+    {
+        json_decref(json);
 
-            if(qjmsgOut.json == NULL)
-            {
-                WA_ERROR("DiagTask(): json_object() error\n");
-            }
-            else
+        if(qjmsgOut.json == NULL)
+        {
+            WA_ERROR("Dispatch(): json_object() error\n");
+        }
+        else
+        {
+            qjmsgOut.from = WA_DIAG_MSG_ID_PREFIX;
+            qjmsgOut.to = from;
+            status = WA_OSA_QTimedRetrySend(WA_INIT_IncomingQ,
+                    (const char * const)&qjmsgOut,
+                    sizeof(qjmsgOut),
+                    WA_OSA_Q_PRIORITY_MAX,
+                    WA_OSA_Q_SEND_TIMEOUT_DEFAULT,
+                    WA_OSA_Q_SEND_RETRY_DEFAULT);
+            if(status != 0)
             {
-                qjmsgOut.from = WA_DIAG_MSG_ID_PREFIX;
-                qjmsgOut.to = qjmsg.from;
-                status = WA_OSA_QTimedRetrySend(WA_INIT_IncomingQ,
-                        (const char * const)&qjmsgOut,
-                        sizeof(qjmsgOut),
-                        WA_OSA_Q_PRIORITY_MAX,
-                        WA_OSA_Q_SEND_TIMEOUT_DEFAULT,
-                        WA_OSA_Q_SEND_RETRY_DEFAULT);
-                if(status != 0)
-                {
-                    WA_ERROR("DiagTask(): WA_OSA_QSend(): %d\n", status);
-                }
+                WA_ERROR("Dispatch(): WA_OSA_QSend(): %d\n", status);
             }
         }
-
     }
-    end:
-    WA_RETURN("DiagTask(): %p\n", p);
-    return p;
+
 }
 
 static void *InstancesCollectorTask(void *p)
@@ -802,7 +1347,16 @@ static void *InstancesCollectorTask(void *p)
 
     while(1)
     {
+#ifdef WA_DIAG_PLUGINS
+        status = WA_OSA_QTimedReceive(collectorQ, (char * const)&pInstance, sizeof(pInstance), &qprio, PLUGIN_IDLE_CHECK);
+        if(status == -2)
+        {
+            UnloadIdlePlugins();
+            continue;
+        }
+#else
         status = WA_OSA_QReceive(collectorQ, (char * const)&pInstance, sizeof(pInstance), &qprio);
+#endif
         if(status < 0)
         {
             WA_ERROR("InstancesCollectorTask(): WA_OSA_QReceive(): %d\n", status);
@@ -872,24 +1426,104 @@ static void *InstancesCollectorTask(void *p)
 static WA_DIAG_procedureContext_t *FindContextByName(const char *name)
 {
     WA_DIAG_procedureContext_t *pContext = NULL;
-    void *iterator;
+    int i;
 
     WA_ENTER("FindContextByName(name=%s)\n", name);
 
-    for(iterator = WA_UTILS_LIST_FrontIterator(&(diagProcedures.proceduresList));
-            iterator != WA_UTILS_LIST_NO_ELEM;
-            iterator = WA_UTILS_LIST_NextIterator(&(diagProcedures.proceduresList), iterator))
+    /* the names are fixed at init, no lock needed */
+    i = WA_UTILS_PHASH_Find(&(diagProcedures.names), name);
+    if(i >= 0)
+    {
+        pContext = diagProcedures.contexts[i];
+    }
+
+    WA_RETURN("FindContextByName(): %p\n", pContext);
+    return pContext;
+}
+
+/* Hashes the names of the local and configured procedures, a name may be given only once. */
+static int IndexNames(void)
+{
+    int status = -1;
+    unsigned int count;
+    const WA_DIAG_proceduresConfig_t *pConfig;
+    const char **names;
+
+    count = LOCAL_PROCEDURES;
+    for(pConfig = pProceduresConfig; pConfig && pConfig->fnc; ++pConfig)
+    {
+        ++count;
+    }
+
+    names = malloc(count * sizeof(*names));
+    if(names == NULL)
     {
-        pContext = (WA_DIAG_procedureContext_t *)(WA_UTILS_LIST_DataAtIterator(&(diagProcedures.proceduresList), iterator));
-        if(strcmp(name, pContext->pConfig->name) == 0)
+        WA_ERROR("IndexNames(): malloc() error\n");
+        goto end;
+    }
+
+    for(count = 0; count < LOCAL_PROCEDURES; ++count)
+    {
+        names[count] = localProcedures[count].name;
+    }
+    for(pConfig = pProceduresConfig; pConfig && pConfig->fnc; ++pConfig, ++count)
+    {
+        if((pConfig->name == NULL) || (strlen(pConfig->name) == 0))
         {
-            goto end;
+            WA_ERROR("IndexNames(): invalid config params\n");
+            goto free_names;
         }
+        names[count] = pConfig->name;
+    }
+
+    /* all names at once first, a diag must not hide a local procedure either */
+    status = WA_UTILS_PHASH_Init(&localNames, names, count);
+    if(status != 0)
+    {
+        WA_ERROR("IndexNames(): WA_UTILS_PHASH_Init(): %d, name given twice?\n", status);
+        goto free_names;
+    }
+    WA_UTILS_PHASH_Exit(&localNames);
+
+    status = WA_UTILS_PHASH_Init(&localNames, names, LOCAL_PROCEDURES);
+    if(status != 0)
+    {
+        WA_ERROR("IndexNames(): WA_UTILS_PHASH_Init(local): %d\n", status);
+        goto free_names;
+    }
+
+    status = WA_UTILS_PHASH_Init(&(diagProcedures.names), names + LOCAL_PROCEDURES, count - LOCAL_PROCEDURES);
+    if(status != 0)
+    {
+        WA_ERROR("IndexNames(): WA_UTILS_PHASH_Init(procedures): %d\n", status);
+        goto err_procedures;
+    }
+
+    diagProcedures.contexts = calloc(count - LOCAL_PROCEDURES + 1, sizeof(*diagProcedures.contexts));
+    if(diagProcedures.contexts == NULL)
+    {
+        WA_ERROR("IndexNames(): calloc() error\n");
+        status = -1;
+        goto err_contexts;
     }
-    pContext = NULL;
+    goto free_names;
+
+    err_contexts:
+    WA_UTILS_PHASH_Exit(&(diagProcedures.names));
+    err_procedures:
+    WA_UTILS_PHASH_Exit(&localNames);
+    free_names:
+    free(names);
     end:
-    WA_ENTER("FindContextByName(): %p\n", pContext);
-    return pContext;
+    return status;
+}
+
+static void ReleaseNames(void)
+{
+    free(diagProcedures.contexts);
+    diagProcedures.contexts = NULL;
+    WA_UTILS_PHASH_Exit(&(diagProcedures.names));
+    WA_UTILS_PHASH_Exit(&localNames);
 }
 
 static int CreateProcedureInstance(char *name, json_t *json, uint32_t callerId)
@@ -956,6 +1590,15 @@ static int CreateProcedureInstance(char *name, json_t *json, uint32_t callerId)
     pInstance->json = json;
     pInstance->callerId = callerId;
     pInstance->id = WA_DIAG_MSG_ID_PREFIX | id;
+    pInstance->created = WA_METRICS_Now();
+
+    status = WA_UTILS_ID_SetOwnerUnsafe(&(diagProcedures.idBox), id, pInstance);
+    if(status != 0)
+    {
+        WA_ERROR("CreateProcedureInstance(): WA_UTILS_ID_SetOwnerUnsafe(): %d\n", status);
+        goto err_task;
+    }
+
     pInstance->taskHandle = WA_OSA_TaskCreate(NULL, 0, InstanceTask, pInstance, WA_OSA_SCHED_POLICY_RT, WA_OSA_TASK_PRIORITY_MAX);
     if(pInstance->taskHandle == NULL)
     {
@@ -1075,6 +1718,7 @@ static int CleanupInstance(WA_DIAG_procedureInstance_t *pInstance)
     pContext = (WA_DIAG_procedureContext_t *)pInstance->pContext;
 
     WA_UTILS_LIST_AllocRemove(&(pContext->instancesList), pInstance);
+    pContext->idleSince = MonotonicSec();
 
     s1 = WA_OSA_MutexUnlock(diagProcedures.mutex);
     if(s1 != 0)
@@ -1100,9 +1744,18 @@ static void *InstanceTask(void *p)
     int final_status = -1;
     bool filter_enabled = false;
     bool results_filter = false;
+    bool cached = false;
+    int maxAge;
+    time_t age;
+    unsigned int throttled = 0;
+    WA_DIAG_usageSample_t usageStart, usageEnd;
+    WA_DIAG_Usage_t usage;
+    bool measured = false;
 
     WA_ENTER("InstanceTask(p=%p)\n", p);
 
+    WA_METRICS_Since(WA_METRICS_HOP_INSTANCE, pInstance->created);
+
     snprintf(tmp, WA_OSA_TASK_NAME_MAX_LEN, "WAdiag#%d", pInstance->id);
     status = WA_OSA_TaskSetName(tmp);
     if(status != 0)
@@ -1165,20 +1818,57 @@ static void *InstanceTask(void *p)
         WA_ERROR("InstanceTask(): WA_OSA_QSend(): %d\n", status);
     }
 
-    status = pContext->pConfig->fnc(pInstance, pContext->handle, &jparams);
-    if(status != 0)
+    maxAge = ResultMaxAge(pContext, jparams);
+    age = MonotonicSec() - pContext->lastResult.stored;
+    if((maxAge > 0) && pContext->lastResult.valid && (age >= 0) && (age <= maxAge))
+    {
+        WA_INFO("InstanceTask(): %s: result from %ld s ago reused\n",
+                pContext->pConfig->name, (long)age);
+        cached = true;
+        json_decref(jparams);
+        jparams = pContext->lastResult.data ? json_deep_copy(pContext->lastResult.data) : NULL;
+        status = pContext->lastResult.status;
+        timestamp = pContext->lastResult.timestamp;
+    }
+    else if((WA_DIAG_Need(pContext->pConfig->needs) != 0) || (LoadPlugin(pContext) != 0))
     {
-        WA_DBG("InstanceTask(): fnc(): %d\n", status);
+        json_decref(jparams);
+        jparams = NULL;
+        status = WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR;
+        timestamp = time(0);
+    }
+    else
+    {
+        UsageSample(&usageStart);
+        WA_THROTTLE_Begin();
+        status = pContext->fnc(pInstance, pContext->handle, &jparams);
+        throttled = WA_THROTTLE_End();
+        UsageSample(&usageEnd);
+        UsageDelta(&usageStart, &usageEnd, &usage);
+        measured = true;
+        WA_METRICS_Observe(WA_METRICS_DIAG_DURATION, (uint64_t)usage.wall * 1000);
+        if(status != 0)
+        {
+            WA_DBG("InstanceTask(): fnc(): %d\n", status);
+        }
+        timestamp = time(0);
+
+        /* cancelled or broken runs are no verdicts to reuse */
+        if((status != WA_DIAG_ERRCODE_CANCELLED) &&
+           (status != WA_DIAG_ERRCODE_CANCELLED_NOT_STANDBY) &&
+           (status != WA_DIAG_ERRCODE_INTERNAL_TEST_ERROR) &&
+           !WA_OSA_TaskCheckQuit())
+        {
+            StoreResult(pContext, status, timestamp, jparams);
+        }
     }
 
     filter_status = WA_FILTER_GetFilteredResult(pContext->pConfig->name, status); // both status and filter_status is used for telemetry
     filter_enabled = strstr(pContext->pConfig->name, "_status") ? WA_FILTER_IsFilterEnabled() : false; // filter_enabled is used to decide whether or not to print the telemetry of filtered results
     results_filter = WA_FILTER_IsResultsFiltered(); // results_filter is used to decide whether status or filter_status must be written into results file and shown on UI
 
-    timestamp = time(0);
-
     final_status = results_filter ? filter_status : status; // deciding which result must be written into hwselftest.results file
-    if (WA_AGG_SetTestResult(pContext->pConfig->name, final_status, timestamp))
+    if (WA_AGG_SetTestResult(pContext->pConfig->name, final_status, timestamp, measured ? &usage : NULL))
         WA_WARN("InstanceTask(): WA_AGG_SetTestResult(): failed\n");
 
     WA_LOG_GetTimestampStr(timestamp, strtimestamp, sizeof(strtimestamp));
@@ -1188,6 +1878,33 @@ static void *InstanceTask(void *p)
     else
         qjmsg.json = json_pack("{s:s,s:s,s:{s:s,s:i,s:i,s:i,s:i,s:s},s:n}", "jsonrpc", "2.0", "method", "eod", "params", "diag", tmp, "status", status, "filterstatus", filter_status, "resultsfilter", results_filter, "filterenabled", filter_enabled, "timestamp", strtimestamp, "id");
 
+    if(cached && qjmsg.json)
+    {
+        /* "timestamp" is the one of the original run */
+        json_object_set_new(json_object_get(qjmsg.json, "params"), "cached", json_true());
+    }
+
+    if(measured && qjmsg.json)
+    {
+        WA_INFO("InstanceTask(): %s: wall %u ms, cpu %u ms, rss +%lu kB, read %llu B, written %llu B, subprocesses %u\n",
+                pContext->pConfig->name, usage.wall, usage.cpu, usage.rss, usage.read, usage.written, usage.subprocesses);
+        json_object_set_new(json_object_get(qjmsg.json, "params"), "usage",
+                json_pack("{s:i,s:i,s:I,s:I,s:I,s:i}",
+                        "wall", usage.wall,
+                        "cpu", usage.cpu,
+                        "rss", (json_int_t)usage.rss,
+                        "read", (json_int_t)usage.read,
+                        "written", (json_int_t)usage.written,
+                        "subprocesses", usage.subprocesses));
+    }
+
+    if(throttled && qjmsg.json)
+    {
+        /* time the diag spent slowed down or paused for the foreground load, [ms] */
+        WA_INFO("InstanceTask(): %s: throttled for %u ms\n", pContext->pConfig->name, throttled);
+        json_object_set_new(json_object_get(qjmsg.json, "params"), "throttled", json_integer(throttled));
+    }
+
     status = WA_OSA_QTimedRetrySend(WA_INIT_IncomingQ,
             (const char * const)&qjmsg,
             sizeof(qjmsg),
@@ -1212,32 +1929,17 @@ static void *InstanceTask(void *p)
 
 static WA_DIAG_procedureInstance_t *FindInstanceById(uint32_t id)
 {
-    WA_DIAG_procedureContext_t *pContext;
-    WA_DIAG_procedureInstance_t *pInstance;
-    void *iterator;
-    void *instanceIterator;
+    WA_DIAG_procedureInstance_t *pInstance = NULL;
 
     WA_ENTER("FindInstanceById(id=0x%x)\n", id);
 
-    for(iterator = WA_UTILS_LIST_FrontIterator(&(diagProcedures.proceduresList));
-            iterator != WA_UTILS_LIST_NO_ELEM;
-            iterator = WA_UTILS_LIST_NextIterator(&(diagProcedures.proceduresList), iterator))
+    /* the instance owns its id in the box, no need to walk the procedures */
+    if((id & ~(uint32_t)(WA_UTILS_ID_COUNT - 1)) == WA_DIAG_MSG_ID_PREFIX)
     {
-        pContext = (WA_DIAG_procedureContext_t *)WA_UTILS_LIST_DataAtIterator(&(diagProcedures.proceduresList), iterator);
-
-        for(instanceIterator = WA_UTILS_LIST_FrontIterator(&(pContext->instancesList));
-                instanceIterator != WA_UTILS_LIST_NO_ELEM;
-                instanceIterator = WA_UTILS_LIST_NextIterator(&(pContext->instancesList), instanceIterator))
-        {
-            pInstance = (WA_DIAG_procedureInstance_t *)WA_UTILS_LIST_DataAtIterator(&(pContext->instancesList), instanceIterator);
-            if(pInstance->id == id)
-            {
-                goto end;
-            }
-        }
+        pInstance = (WA_DIAG_procedureInstance_t *)WA_UTILS_ID_GetOwnerUnsafe(&(diagProcedures.idBox),
+                (WA_UTILS_ID_t)(id & (WA_UTILS_ID_COUNT - 1)));
     }
-    pInstance = NULL;
-    end:
+
     WA_RETURN("FindInstanceById(): %p\n", pInstance);
     return pInstance;
 }
@@ -1358,6 +2060,8 @@ static int TestRunControl(json_t **json)
             goto end;
         }
 
+        /* the filter settings come over IARM, the filter copes without them */
+        (void)WA_DIAG_Need(WA_DIAG_NEEDS_IARM);
         status = WA_FILTER_SetFilterBuffer();
         if(status != 0)
         {
@@ -1394,6 +2098,382 @@ static int TestRunControl(json_t **json)
     return status;
 }
 
+static int MetricsControl(json_t **json)
+{
+    int status = 0;
+
+    WA_ENTER("MetricsControl(json=%p)\n", json);
+
+    json_decref(*json);
+    *json = WA_METRICS_Get();
+    if(*json == NULL)
+    {
+        WA_ERROR("MetricsControl(): WA_METRICS_Get() failed\n");
+        status = -1;
+    }
+
+    WA_RETURN("MetricsControl(): %d\n", status);
+    return status;
+}
+
+/**
+ * Dumps the binary trace to the configured file, see \c WA_TRACE_Init().
+ */
+static int TraceControl(json_t **json)
+{
+    int status;
+    unsigned int records = 0;
+
+    WA_ENTER("TraceControl(json=%p)\n", json);
+
+    json_decref(*json);
+    *json = NULL;
+
+    status = WA_TRACE_Dump(NULL, &records);
+    if(status != 0)
+    {
+        WA_ERROR("TraceControl(): WA_TRACE_Dump(%s) failed\n", WA_TRACE_File());
+        goto end;
+    }
+    WA_INFO("TraceControl(): %u events written to %s\n", records, WA_TRACE_File());
+
+    *json = json_pack("{s:s,s:i}", "file", WA_TRACE_File(), "records", records);
+
+    end:
+    WA_RETURN("TraceControl(): %d\n", status);
+    return status;
+}
+
+/**
+ * Returns how old [s] a previous result of the diag may be to be served again.
+ * Consumes the request option from \c jparams, so the diag does not see it.
+ */
+static int ResultMaxAge(WA_DIAG_procedureContext_t *pContext, json_t *jparams)
+{
+    int maxAge = 0;
+
+    if(json_unpack(jparams, "{s:i}", WA_DIAG_PARAM_MAX_AGE, &maxAge) == 0)
+    {
+        json_object_del(jparams, WA_DIAG_PARAM_MAX_AGE);
+    }
+    else
+    {
+        maxAge = WA_DIAG_GetSettings(pContext->pConfig)->maxAge;
+    }
+
+    return maxAge;
+}
+
+static void StoreResult(WA_DIAG_procedureContext_t *pContext, int status, time_t timestamp, json_t *data)
+{
+    json_decref(pContext->lastResult.data);
+    pContext->lastResult.data = data ? json_deep_copy(data) : NULL;
+    pContext->lastResult.status = status;
+    pContext->lastResult.timestamp = timestamp;
+    pContext->lastResult.stored = MonotonicSec();
+    pContext->lastResult.valid = (timestamp != 0) && (!data || pContext->lastResult.data);
+}
+
+static char *ProbeKey(const char *probe, const char *args)
+{
+    size_t len = strlen(probe) + 1 + strlen(args) + 1;
+    char *key = malloc(len);
+
+    if(key != NULL)
+    {
+        snprintf(key, len, "%s:%s", probe, args);
+    }
+    return key;
+}
+
+/**
+ * @note Must be called with the probeCache.mutex locked.
+ * @returns the link pointing to the entry, the link holds NULL if not found
+ */
+static WA_DIAG_probeEntry_t **FindProbeEntry(const char *key)
+{
+    WA_DIAG_probeEntry_t **ppEntry;
+
+    for(ppEntry = &probeCache.entries; *ppEntry != NULL; ppEntry = &(*ppEntry)->next)
+    {
+        if(!strcmp((*ppEntry)->key, key))
+        {
+            break;
+        }
+    }
+    return ppEntry;
+}
+
+static void UsageSample(WA_DIAG_usageSample_t *pSample)
+{
+    char path[64];
+    char line[128];
+    FILE *f;
+
+    memset(pSample, 0, sizeof(*pSample));
+    clock_gettime(CLOCK_MONOTONIC, &pSample->wall);
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &pSample->cpu);
+    pSample->subprocesses = taskSubprocesses;
+
+    f = fopen(PROC_SELF_STATUS, "r");
+    if(f != NULL)
+    {
+        while(fgets(line, sizeof(line), f) != NULL)
+        {
+            if(sscanf(line, "VmHWM: %lu kB", &pSample->hwm) == 1)
+            {
+                break;
+            }
+        }
+        fclose(f);
+    }
+
+    /* the I/O of the instance task only, not of the whole agent */
+    snprintf(path, sizeof(path), PROC_TASK_IO, (long)syscall(SYS_gettid));
+    f = fopen(path, "r");
+    if(f != NULL)
+    {
+        while(fgets(line, sizeof(line), f) != NULL)
+        {
+            if(sscanf(line, "read_bytes: %llu", &pSample->read) != 1)
+            {
+                sscanf(line, "write_bytes: %llu", &pSample->written);
+            }
+        }
+        fclose(f);
+    }
+}
+
+static void UsageDelta(const WA_DIAG_usageSample_t *pStart, const WA_DIAG_usageSample_t *pEnd, WA_DIAG_Usage_t *pUsage)
+{
+    pUsage->wall = (pEnd->wall.tv_sec - pStart->wall.tv_sec) * 1000 +
+                   (pEnd->wall.tv_nsec - pStart->wall.tv_nsec) / 1000000;
+    pUsage->cpu = (pEnd->cpu.tv_sec - pStart->cpu.tv_sec) * 1000 +
+                  (pEnd->cpu.tv_nsec - pStart->cpu.tv_nsec) / 1000000;
+    pUsage->rss = (pEnd->hwm > pStart->hwm) ? pEnd->hwm - pStart->hwm : 0;
+    pUsage->read = pEnd->read - pStart->read;
+    pUsage->written = pEnd->written - pStart->written;
+    pUsage->subprocesses = pEnd->subprocesses - pStart->subprocesses;
+}
+
+/* Loads the plugin of the procedure unless it is linked in or already loaded.
+ * Called by the (single) instance of the procedure, while no one else touches the plugin.
+ */
+static int LoadPlugin(WA_DIAG_procedureContext_t *pContext)
+{
+    int status = -1;
+#ifdef WA_DIAG_PLUGINS
+    char path[PATH_MAX];
+    void *plugin, *handle;
+    const WA_DIAG_proceduresConfig_t *pPlugin;
+    struct timespec start, loaded, ready;
+#endif
+
+    if((pContext->pConfig->plugin == NULL) || (pContext->plugin != NULL))
+    {
+        return 0;
+    }
+
+    WA_ENTER("LoadPlugin(plugin=%s)\n", pContext->pConfig->plugin);
+
+#ifdef WA_DIAG_PLUGINS
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    snprintf(path, sizeof(path), "%s/%s", WA_DIAG_PLUGIN_DIR, pContext->pConfig->plugin);
+    plugin = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if(plugin == NULL)
+    {
+        WA_ERROR("LoadPlugin(): dlopen(): %s\n", dlerror());
+        goto end;
+    }
+
+    pPlugin = (const WA_DIAG_proceduresConfig_t *)dlsym(plugin, WA_DIAG_PLUGIN_SYMBOL);
+    if((pPlugin == NULL) || (pPlugin->name == NULL) || (pPlugin->fnc == NULL) ||
+            strcmp(pPlugin->name, pContext->pConfig->name))
+    {
+        WA_ERROR("LoadPlugin(): %s does not provide \"%s\"\n", path, pContext->pConfig->name);
+        goto err_descriptor;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &loaded);
+
+    /* the init works on the agent's entry, that is where the config is */
+    handle = (void *)pContext->pConfig;
+    if(pPlugin->initFnc != NULL)
+    {
+        handle = pPlugin->initFnc((WA_DIAG_proceduresConfig_t *)pContext->pConfig);
+        if(handle == NULL)
+        {
+            WA_ERROR("LoadPlugin(): initFnc(): error\n");
+            goto err_descriptor;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ready);
+
+    pContext->handle = handle;
+    pContext->fnc = pPlugin->fnc;
+    pContext->pPlugin = pPlugin;
+    pContext->plugin = plugin;
+
+    WA_METRICS_Observe(WA_METRICS_PLUGIN_LOAD, (uint64_t)(ready.tv_sec - start.tv_sec) * 1000000 +
+            (ready.tv_nsec - start.tv_nsec) / 1000);
+    WA_INFO("LoadPlugin(): %s: load %ld ms, init %ld ms\n", pContext->pConfig->plugin,
+            (loaded.tv_sec - start.tv_sec) * 1000 + (loaded.tv_nsec - start.tv_nsec) / 1000000,
+            (ready.tv_sec - loaded.tv_sec) * 1000 + (ready.tv_nsec - loaded.tv_nsec) / 1000000);
+    status = 0;
+    goto end;
+
+    err_descriptor:
+    dlclose(plugin);
+    end:
+#else
+    WA_ERROR("LoadPlugin(): plugins not supported\n");
+#endif
+    WA_RETURN("LoadPlugin(): %d\n", status);
+    return status;
+}
+
+/* Unloads the plugin of the procedure if it is loaded, no instance of the procedure may exist. */
+static void UnloadPlugin(WA_DIAG_procedureContext_t *pContext)
+{
+#ifdef WA_DIAG_PLUGINS
+    WA_DIAG_PluginRange_t range;
+    int status;
+
+    if(pContext->plugin == NULL)
+    {
+        return;
+    }
+
+    WA_ENTER("UnloadPlugin(plugin=%s)\n", pContext->pConfig->plugin);
+
+    if(pContext->pPlugin->exitFnc != NULL)
+    {
+        status = pContext->pPlugin->exitFnc(pContext->handle);
+        if(status != 0)
+        {
+            WA_ERROR("UnloadPlugin(): exitFnc(): %d\n", status);
+        }
+    }
+
+    /* the results keep nothing from the plugin, the json data is on the heap,
+     * the trace keeps pointers to its format strings */
+    range.addr = (uintptr_t)pContext->pPlugin;
+    range.start = range.end = 0;
+    if(dl_iterate_phdr(PluginRange, &range) != 0)
+    {
+        WA_TRACE_Forget((const void *)range.start, range.end - range.start);
+    }
+    dlclose(pContext->plugin);
+    pContext->plugin = NULL;
+    pContext->pPlugin = NULL;
+    pContext->fnc = NULL;
+    pContext->handle = (void *)pContext->pConfig;
+
+    WA_RETURN("UnloadPlugin()\n");
+#endif
+}
+
+#ifdef WA_DIAG_PLUGINS
+/* Unloads the plugins not used for PLUGIN_IDLE_TIME.
+ * A plugin with an init stays, the init may set up process wide state that cannot be set up twice.
+ */
+static void UnloadIdlePlugins(void)
+{
+    int status;
+    unsigned int i;
+    time_t now;
+    WA_DIAG_procedureContext_t *pContext;
+
+    status = WA_OSA_MutexLock(diagProcedures.mutex);
+    if(status != 0)
+    {
+        WA_ERROR("UnloadIdlePlugins(): WA_OSA_MutexLock(): %d\n", status);
+        return;
+    }
+
+    now = MonotonicSec();
+    for(i = 0; i < diagProcedures.names.count; ++i)
+    {
+        pContext = diagProcedures.contexts[i];
+        /* an instance owns the plugin state, check it first */
+        if((pContext == NULL) || (WA_UTILS_LIST_ElemCount(&(pContext->instancesList)) != 0))
+        {
+            continue;
+        }
+        if((pContext->plugin != NULL) && (pContext->pPlugin->initFnc == NULL) &&
+                (now - pContext->idleSince >= PLUGIN_IDLE_TIME))
+        {
+            WA_INFO("UnloadIdlePlugins(): %s idle\n", pContext->pConfig->plugin);
+            UnloadPlugin(pContext);
+        }
+    }
+
+    status = WA_OSA_MutexUnlock(diagProcedures.mutex);
+    if(status != 0)
+    {
+        WA_ERROR("UnloadIdlePlugins(): WA_OSA_MutexUnlock(): %d\n", status);
+    }
+}
+
+/* dl_iterate_phdr() callback, takes the loaded segments of the object holding the address */
+static int PluginRange(struct dl_phdr_info *info, size_t size, void *data)
+{
+    WA_DIAG_PluginRange_t *pRange = (WA_DIAG_PluginRange_t *)data;
+    uintptr_t start = UINTPTR_MAX, end = 0, segStart, segEnd;
+    bool found = false;
+    int i;
+
+    for(i = 0; i < info->dlpi_phnum; i++)
+    {
+        if(info->dlpi_phdr[i].p_type != PT_LOAD)
+        {
+            continue;
+        }
+        segStart = info->dlpi_addr + info->dlpi_phdr[i].p_vaddr;
+        segEnd = segStart + info->dlpi_phdr[i].p_memsz;
+        found |= (pRange->addr >= segStart) && (pRange->addr < segEnd);
+        start = (segStart < start) ? segStart : start;
+        end = (segEnd > end) ? segEnd : end;
+    }
+    if(found)
+    {
+        pRange->start = start;
+        pRange->end = end;
+    }
+    return found;
+}
+#endif
+
+static time_t MonotonicSec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
+
+/* Stops the services brought up by WA_DIAG_Need(), in reverse order, no procedure may run. */
+static void StopServices(void)
+{
+    int status;
+    unsigned int i;
+
+    for(i = sizeof(services)/sizeof(services[0]); i-- > 0; )
+    {
+        if(!(servicesUp & services[i].need))
+        {
+            continue;
+        }
+
+        status = services[i].exit();
+        if(status != 0)
+        {
+            WA_ERROR("StopServices(): %s exit: %d\n", services[i].name, status);
+        }
+        servicesUp &= ~services[i].need;
+    }
+}
+
 /* End of doxygen group */
 /*! @} */
 
@@ -31,6 +31,8 @@
 /*****************************************************************************
  * STANDARD INCLUDE FILES
  *****************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
@@ -49,6 +51,38 @@ extern "C"
  *****************************************************************************/
 #define WA_DIAG_MSG_ID_PREFIX 0x00020000
 
+/** Probe types shared through the run-scoped probe cache */
+#define WA_DIAG_PROBE_SNMP(walk) ((walk) ? "snmp_walk" : "snmp_get") /**< numeric SNMP response, args: "<server> <oid>" */
+#define WA_DIAG_PROBE_TR69 "tr69" /**< raw TR-69 hostif parameter value, args: the parameter name */
+
+/** Default freshness of a probe cache entry, in [ms] */
+#define WA_DIAG_PROBE_CACHE_MAX_AGE 10000
+
+/** Request parameter with the max age [s] of a previous result of the diag that may be
+ * returned instead of running the diag again. Defaults to the "max_age" of the diag config.
+ */
+#define WA_DIAG_PARAM_MAX_AGE "maxAge"
+
+/** Platform services brought up when the first diag that needs them runs, see \c WA_DIAG_Need() */
+#define WA_DIAG_NEEDS_IARM 0x01 /**< IARM bus, also used by the mfr and device settings wrappers */
+#define WA_DIAG_NEEDS_SNMP 0x02 /**< SNMP client */
+
+/** Name of the registration descriptor exported by a diag plugin, see \c WA_DIAG_PLUGIN() */
+#define WA_DIAG_PLUGIN_SYMBOL "WA_DIAG_Plugin"
+
+#ifdef __cplusplus
+#define WA_DIAG_PLUGIN_EXPORT extern "C"
+#else
+#define WA_DIAG_PLUGIN_EXPORT
+#endif
+
+/** Defines the registration descriptor of a diag built as a plugin.
+ * Only the \c name and the functions are taken from it, the rest of the config
+ * comes from the agent's table where the diag is listed with its \c plugin file.
+ */
+#define WA_DIAG_PLUGIN(name, initFnc, exitFnc, fnc) \
+    WA_DIAG_PLUGIN_EXPORT const WA_DIAG_proceduresConfig_t WA_DIAG_Plugin = {(name), (initFnc), (exitFnc), (fnc), NULL, NULL, NULL, NULL, NULL, 0}
+
 /*****************************************************************************
  * EXPORTED TYPES
  *****************************************************************************/
@@ -91,19 +125,56 @@ typedef int (*WA_DIAG_Callback_t)(void *initHandle, json_t *json, void *response
  */
 typedef int (*WA_DIAG_ProcedureFnc_t)(void *instanceHandle, void *initHandle, json_t **json);
 
+/** Resources used by a diag procedure instance, recorded with its result */
+typedef struct
+{
+    unsigned int wall; /**< wall time, in [ms] */
+    unsigned int cpu; /**< CPU time of the instance task, in [ms] */
+    unsigned long rss; /**< growth of the agent peak RSS while the instance ran, in [kB] */
+    unsigned long long read; /**< bytes the instance task read from storage */
+    unsigned long long written; /**< bytes the instance task wrote to storage */
+    unsigned int subprocesses; /**< processes spawned with \c WA_DIAG_Popen() and \c WA_DIAG_System() */
+}WA_DIAG_Usage_t;
+
+/** Settings of a diag, the typed view of its entry in the "diags" section of the config.
+ * Validated once when the config is loaded, see \c WA_DIAG_GetSettings().
+ * The strings stay valid as long as the config.
+ */
+typedef struct
+{
+    bool applicable; /**< "applicable", false if the device does not have the component */
+    int maxAge; /**< "max_age" [s], a previous result may be returned instead, 0 if not set */
+    int fileSize; /**< "filesize" [B], 0 if not set */
+    const char *fileName; /**< "filename", NULL if not set */
+    const char *logFile; /**< "logfile", NULL if not set */
+    const char *logPattern; /**< "logpattern", NULL if not set */
+    const char *interface; /**< "interface", NULL if not set */
+    const char *url; /**< "url", NULL if not set */
+    int tunersCount; /**< "tuners_count", -1 if not set */
+    int expiryTime; /**< "expiry_time" [min], -1 if not set */
+    int sweepSessions; /**< "sweep_sessions", 0 if not set */
+    bool sweepStopOnLock; /**< "sweep_stop_on_lock" */
+}WA_DIAG_settings_t;
+
+/** Settings of a diag that is not configured */
+#define WA_DIAG_SETTINGS_DEFAULT {true, 0, 0, NULL, NULL, NULL, NULL, NULL, -1, -1, 0, false}
+
 /** Content for registration of the diag procedures.
  * Provided in a form of array closed by NULLs in last entry.
  */
 typedef struct WA_DIAG_proceduresConfig_t
 {
     const char *name;
-    void * (*initFnc)(struct WA_DIAG_proceduresConfig_t *); /**< the initialization function that will be called at the system startup */
-    WA_DIAG_ProcedureExit_t exitFnc; /**< the de-initialization function that will be called at the system exit */
+    void * (*initFnc)(struct WA_DIAG_proceduresConfig_t *); /**< the initialization function that will be called at the system startup, or when the plugin is loaded */
+    WA_DIAG_ProcedureExit_t exitFnc; /**< the de-initialization function that will be called at the system exit, or when the plugin is unloaded */
     WA_DIAG_ProcedureFnc_t fnc; /**< the procedure function that executes the diagnose */
     WA_DIAG_Callback_t callback; /** a callback function */
     json_t *config; /**< configuration given back to the above functions */
     const char *caps; /**< fnc capabilities */
     const char *nameInResults; /**< component name represented in results file */
+    const char *plugin; /**< shared object with the procedure, loaded on first use, NULL if linked in */
+    unsigned int needs; /**< \c WA_DIAG_NEEDS_* services the procedure uses */
+    const WA_DIAG_settings_t *settings; /**< typed \c config, NULL if not configured */
 }WA_DIAG_proceduresConfig_t;
 
 /** Adapter implementation side initialization for the diag procedure.
@@ -127,6 +198,11 @@ extern void *WA_DIAG_IncomingQ;
  * EXPORTED FUNCTIONS
  *****************************************************************************/
 
+/** Placeholder \c fnc of a diag provided by a plugin, never called.
+ * The procedure is taken from the plugin when it is loaded.
+ */
+extern int WA_DIAG_PluginProcedure(void *instanceHandle, void *initHandle, json_t **json);
+
 /** Communication function from diag module to the system.
  * Carries test status, progress, etc.
  *
@@ -166,6 +242,90 @@ extern void WA_DIAG_SendProgress(void* instanceHandle, int progress);
  */
 extern void WA_DIAG_SetWriteTestResult(bool writeResult);
 
+/**
+ * Starts the run-scoped probe cache.
+ * Until \c WA_DIAG_ProbeCacheClear() diags can share the results of hardware probes
+ * (SNMP queries, status reads) through \c WA_DIAG_ProbeCachePut() and \c WA_DIAG_ProbeCacheGet().
+ * Outside of a test run the cache is inactive and every probe hits the hardware.
+ *
+ * @retval 0 success.
+ * @retval -1 error
+ */
+extern int WA_DIAG_ProbeCacheStart(void);
+
+/**
+ * Drops all entries and deactivates the run-scoped probe cache.
+ */
+extern void WA_DIAG_ProbeCacheClear(void);
+
+/**
+ * Publishes a probe result in the run-scoped probe cache.
+ *
+ * @param probe the probe type, e.g. \c WA_DIAG_PROBE_SNMP
+ * @param args the probe arguments, together with \c probe identify the entry
+ * @param data the probe result, copied into the cache
+ * @param size size of the \c data
+ * @param maxAge how long the result stays valid, in [ms]
+ *
+ * @retval 0 success.
+ * @retval 1 cache not active, result not stored
+ * @retval -1 error
+ */
+extern int WA_DIAG_ProbeCachePut(const char *probe, const char *args, const void *data, size_t size, unsigned int maxAge);
+
+/**
+ * Looks up a probe result in the run-scoped probe cache.
+ *
+ * @param probe the probe type, e.g. \c WA_DIAG_PROBE_SNMP
+ * @param args the probe arguments
+ * @param data the buffer for the cached result
+ * @param size size of the \c data, must match the size of the published result
+ *
+ * @retval 0 fresh entry found and copied to \c data
+ * @retval 1 no such entry, or the entry is stale
+ */
+extern int WA_DIAG_ProbeCacheGet(const char *probe, const char *args, void *data, size_t size);
+
+/**
+ * Gives the typed settings of a diag.
+ *
+ * @param pConfig the diag, as given to the procedure in its \c initHandle when it has no \c initFnc
+ *
+ * @returns the settings, the defaults if the diag is not configured
+ */
+extern const WA_DIAG_settings_t *WA_DIAG_GetSettings(const WA_DIAG_proceduresConfig_t *pConfig);
+
+/**
+ * Brings up the platform services used by a diag, the first call for a service initializes it.
+ * Called by the agent before a procedure runs, according to its \c needs.
+ *
+ * @param needs the \c WA_DIAG_NEEDS_* services
+ *
+ * @retval 0 success.
+ * @retval -1 error
+ */
+extern int WA_DIAG_Need(unsigned int needs);
+
+/**
+ * \c popen() for diag procedures, the spawned process is accounted to the calling instance.
+ *
+ * @param command the shell command
+ * @param type "r" or "w"
+ *
+ * @returns the stream to close with \c pclose()
+ * @retval NULL error
+ */
+extern FILE *WA_DIAG_Popen(const char *command, const char *type);
+
+/**
+ * \c system() for diag procedures, the spawned process is accounted to the calling instance.
+ *
+ * @param command the shell command
+ *
+ * @returns as \c system()
+ */
+extern int WA_DIAG_System(const char *command);
+
 /**
  * Initialize the diag module.
  *
@@ -31,6 +31,8 @@
  * STANDARD INCLUDE FILES
  *****************************************************************************/
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
 
 /*****************************************************************************
  * PROJECT-SPECIFIC INCLUDE FILES
@@ -39,6 +41,7 @@
 #include "wa_diag.h"
 #include "wa_id.h"
 #include "wa_init.h"
+#include "wa_metrics.h"
 #include "wa_osa.h"
 #include "wa_debug.h"
 #include "wa_agg.h"
@@ -59,20 +62,87 @@ void *WA_INIT_IncomingQ = NULL;
 
 #define WA_MSG_ID_SUFFIX_MASK 0x0000ffff
 
+#define PHASE(i) (1u << (i))
+
 /*****************************************************************************
  * LOCAL TYPES
  *****************************************************************************/
+typedef enum
+{
+    PHASE_JSON = 0,
+    PHASE_ID,
+    PHASE_QUEUE,
+    PHASE_FILTER,
+    PHASE_DIAG,
+    PHASE_AGG,
+    PHASE_AGENT,
+    PHASE_COMM,
+    PHASE_COUNT
+}WA_INIT_phaseId_t;
+
+/** A startup phase, run once all the phases it comes after are up */
+typedef struct
+{
+    const char *name;
+    int (*init)(void);
+    int (*exit)(void); /**< NULL if there is nothing to undo */
+    unsigned int after; /**< PHASE() mask of the phases that must be up first */
+}WA_INIT_phase_t;
+
+typedef struct
+{
+    void *cond;
+    unsigned int started; /**< PHASE() masks, under the cond */
+    unsigned int done;
+    unsigned int failed;
+    struct timespec origin;
+    unsigned int begin[PHASE_COUNT]; /**< [ms] since the origin */
+    unsigned int end[PHASE_COUNT];
+    void *tasks[PHASE_COUNT];
+}WA_INIT_graph_t;
 
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
 static void *AgentTask(void *p);
+static int RunPhases(void);
+static void RunPhase(unsigned int i);
+static void *PhaseTask(void *p);
+static unsigned int ElapsedMs(void);
+static int IdInit(void);
+static int QueueInit(void);
+static int QueueExit(void);
+static int DiagInit(void);
+static int AggInit(void);
+static int AgentInit(void);
+static int AgentExit(void);
+static int CommInit(void);
 
 /*****************************************************************************
  * LOCAL VARIABLE DECLARATIONS
  *****************************************************************************/
 static void *agentTaskHandle;
 
+static const WA_COMM_adaptersConfig_t *pAdapters;
+static const WA_DIAG_proceduresConfig_t *pDiags;
+
+/* Startup dependency graph, independent phases come up concurrently.
+ * The COMM opens the listener, it goes last. Exits run in reverse order.
+ */
+static const WA_INIT_phase_t phases[PHASE_COUNT] =
+{
+        [PHASE_JSON] = {"json", WA_UTILS_JSON_Init, NULL, 0},
+        [PHASE_ID] = {"id", IdInit, WA_UTILS_ID_Exit, 0},
+        [PHASE_QUEUE] = {"queue", QueueInit, QueueExit, 0},
+        [PHASE_FILTER] = {"filter", WA_FILTER_FilterInit, WA_FILTER_FilterExit, PHASE(PHASE_JSON)},
+        [PHASE_DIAG] = {"diag", DiagInit, WA_DIAG_Exit, PHASE(PHASE_JSON) | PHASE(PHASE_ID) | PHASE(PHASE_QUEUE)},
+        [PHASE_AGG] = {"agg", AggInit, WA_AGG_Exit, PHASE(PHASE_JSON)},
+        [PHASE_AGENT] = {"agent", AgentInit, AgentExit, PHASE(PHASE_QUEUE)},
+        [PHASE_COMM] = {"comm", CommInit, WA_COMM_Exit, PHASE(PHASE_COMM) - 1}
+};
+
+static WA_INIT_graph_t graph;
+
 /*****************************************************************************
  * FUNCTION DEFINITIONS
  *****************************************************************************/
@@ -80,181 +150,40 @@ static void *agentTaskHandle;
 int WA_INIT_Init(const WA_COMM_adaptersConfig_t *adapters,
         const WA_DIAG_proceduresConfig_t *diags)
 {
-    int status = -1, s1;
+    int status = -1;
     WA_ENTER("WA_INIT_Init(adapters=%p)\n", adapters);
 
-    status = WA_UTILS_JSON_Init();
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_UTILS_JSON_Init():%d\n", status);
-        goto end;
-    }
-
-    status = WA_UTILS_ID_Init();
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_UTILS_ID_Init():%d\n", status);
-        goto end;
-    }
-
-    {
-        WA_UTILS_ID_t id;
-        WA_UTILS_ID_Generate(&id);
-    }
-
-    status = WA_FILTER_FilterInit();
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_FILTER_FilterInit():%d\n", status);
-        goto filter_err;
-    }
-
-    WA_INIT_IncomingQ = WA_OSA_QCreate(WA_INIT_INCOME_Q_DEEP, sizeof(WA_OSA_Qjmsg_t));
-    if(WA_INIT_IncomingQ == NULL)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_OSA_QCreate(WA_INIT_IncomingQ) error\n");
-        goto income_q_err;
-    }
-
-    status = WA_DIAG_Init(diags);
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_DIAG_Init():%d\n", status);
-        goto diag_err;
-    }
-
-    status = WA_AGG_Init(diags);
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_AGG_Init():%d\n", status);
-        goto agg_err;
-    }
-
-    agentTaskHandle = WA_OSA_TaskCreate(NULL, 0, AgentTask, NULL, WA_OSA_SCHED_POLICY_RT, WA_OSA_TASK_PRIORITY_MAX);
-    if(agentTaskHandle == NULL)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_OSA_TaskCreate(AgentTask): error\n");
-        goto agent_task_err;
-    }
+    pAdapters = adapters;
+    pDiags = diags;
 
-    status = WA_COMM_Init(adapters);
+    status = RunPhases();
     if(status != 0)
     {
-        WA_ERROR("WA_INIT_Init(): WA_COMM_Init():%d\n", status);
-        goto comm_err;
-    }
-
-    goto end;
-
-comm_err:
-    s1 = WA_OSA_TaskDestroy(agentTaskHandle);
-    if(s1 != 0)
-    {
-        WA_ERROR("WA_INIT_Exit(): WA_OSA_TaskDestroy(AgentTask): error %d\n", s1);
-    }
-
-agent_task_err:
-    s1 = WA_AGG_Exit();
-    if(s1 != 0)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_AGG_Exit():%d\n", s1);
-    }
-
-agg_err:
-    s1 = WA_DIAG_Exit();
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_DIAG_Exit():%d\n", s1);
-    }
-
-diag_err:
-    s1 = WA_OSA_QDestroy(WA_INIT_IncomingQ);
-    if(s1 != 0)
-    {
-        WA_ERROR("WA_INIT_Init():  WA_OSA_QDestroy(WA_INIT_IncomingQ): %d\n", s1);
-    }
-
-income_q_err:
-    s1 = WA_FILTER_FilterExit();
-    if(s1 != 0)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_FILTER_FilterExit():%d\n", s1);
-    }
-
-filter_err:
-    s1 = WA_UTILS_ID_Exit();
-    if(s1 != 0)
-    {
-        WA_ERROR("WA_INIT_Init(): WA_UTILS_ID_Exit():%d\n", s1);
+        WA_ERROR("WA_INIT_Init(): RunPhases():%d\n", status);
     }
 
-    /* no JSON exit */
-
-end:
     WA_RETURN("%d\n", status);
     return status;
 }
 
 int WA_INIT_Exit(void)
 {
-    int status = -1;
+    int status;
+    unsigned int i;
     WA_ENTER("WA_INIT_Exit()\n");
 
-    status = WA_COMM_Exit();
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Exit(): WA_COMM_Exit():%d\n", status);
-    }
-
-    status = WA_OSA_QSend(WA_INIT_IncomingQ,
-            NULL,
-            0,
-            WA_OSA_Q_PRIORITY_MAX);
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Exit(): WA_OSA_QSend(): %d\n", status);
-    }
-
-    status = WA_OSA_TaskJoin(agentTaskHandle, NULL);
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Exit(): WA_OSA_TaskJoin(AgentTask): error\n");
-    }
-
-    status = WA_OSA_TaskDestroy(agentTaskHandle);
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Exit(): WA_OSA_TaskDestroy(AgentTask): error\n");
-    }
-
-    status = WA_AGG_Exit();
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Exit(): WA_AGG_Exit():%d\n", status);
-    }
-
-    status = WA_DIAG_Exit();
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Exit(): WA_DIAG_Exit():%d\n", status);
-    }
-
-    status = WA_OSA_QDestroy(WA_INIT_IncomingQ);
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Exit():  WA_OSA_QDestroy(WA_INIT_IncomingQ): %d\n", status);
-    }
-
-    status = WA_FILTER_FilterExit();
-    if(status != 0)
+    for(i = PHASE_COUNT; i-- > 0; )
     {
-        WA_ERROR("WA_INIT_Exit(): WA_FILTER_FilterExit():%d\n", status);
-    }
+        if(phases[i].exit == NULL)
+        {
+            continue;
+        }
 
-    status = WA_UTILS_ID_Exit();
-    if(status != 0)
-    {
-        WA_ERROR("WA_INIT_Exit(): WA_UTILS_ID_Exit():%d\n", status);
+        status = phases[i].exit();
+        if(status != 0)
+        {
+            WA_ERROR("WA_INIT_Exit(): %s:%d\n", phases[i].name, status);
+        }
     }
 
     WA_RETURN("%d\n", 0);
@@ -375,6 +304,241 @@ end:
     return p;
 }
 
+/* Runs the phases of the startup graph, each one in its own task once the phases
+ * it comes after are up. On a failure no new phase starts and the phases that came up are undone.
+ */
+static int RunPhases(void)
+{
+    int status = 0, s1;
+    unsigned int i, total;
+
+    graph.cond = WA_OSA_CondCreate();
+    if(graph.cond == NULL)
+    {
+        WA_ERROR("RunPhases(): WA_OSA_CondCreate(): error\n");
+        return -1;
+    }
+    graph.started = graph.done = graph.failed = 0;
+    clock_gettime(CLOCK_MONOTONIC, &graph.origin);
+
+    WA_OSA_CondLock(graph.cond);
+    while(1)
+    {
+        for(i = 0; (i < PHASE_COUNT) && !graph.failed; ++i)
+        {
+            if((graph.started & PHASE(i)) || (phases[i].after & ~graph.done))
+            {
+                continue;
+            }
+
+            graph.started |= PHASE(i);
+            graph.tasks[i] = WA_OSA_TaskCreate("init", 0, PhaseTask, (void *)(uintptr_t)i, WA_OSA_SCHED_POLICY_NORMAL, 0);
+            if(graph.tasks[i] == NULL)
+            {
+                WA_ERROR("RunPhases(): WA_OSA_TaskCreate(%s): error\n", phases[i].name);
+                graph.failed |= PHASE(i);
+            }
+        }
+
+        /* nothing running, all done or given up */
+        if((graph.started & ~(graph.done | graph.failed)) == 0)
+        {
+            break;
+        }
+        WA_OSA_CondWait(graph.cond);
+    }
+    WA_OSA_CondUnlock(graph.cond);
+    total = ElapsedMs();
+
+    for(i = 0; i < PHASE_COUNT; ++i)
+    {
+        if(graph.tasks[i] == NULL)
+        {
+            continue;
+        }
+
+        s1 = WA_OSA_TaskJoin(graph.tasks[i], NULL);
+        if(s1 != 0)
+        {
+            WA_ERROR("RunPhases(): WA_OSA_TaskJoin(%s): error\n", phases[i].name);
+        }
+        s1 = WA_OSA_TaskDestroy(graph.tasks[i]);
+        if(s1 != 0)
+        {
+            WA_ERROR("RunPhases(): WA_OSA_TaskDestroy(%s): error\n", phases[i].name);
+        }
+        graph.tasks[i] = NULL;
+    }
+
+    for(i = 0; i < PHASE_COUNT; ++i)
+    {
+        if(graph.done & PHASE(i))
+        {
+            WA_INFO("RunPhases(): %s: %u ms (at %u ms)\n", phases[i].name,
+                    graph.end[i] - graph.begin[i], graph.begin[i]);
+        }
+    }
+
+    if(graph.failed)
+    {
+        status = -1;
+        for(i = PHASE_COUNT; i-- > 0; )
+        {
+            if((graph.done & PHASE(i)) && (phases[i].exit != NULL))
+            {
+                s1 = phases[i].exit();
+                if(s1 != 0)
+                {
+                    WA_ERROR("RunPhases(): %s exit:%d\n", phases[i].name, s1);
+                }
+            }
+        }
+    }
+    else
+    {
+        WA_INFO("RunPhases(): up in %u ms\n", total);
+    }
+
+    s1 = WA_OSA_CondDestroy(graph.cond);
+    if(s1 != 0)
+    {
+        WA_ERROR("RunPhases(): WA_OSA_CondDestroy(): %d\n", s1);
+    }
+    graph.cond = NULL;
+
+    return status;
+}
+
+static void RunPhase(unsigned int i)
+{
+    int status;
+    unsigned int begin, end;
+
+    begin = ElapsedMs();
+    status = phases[i].init();
+    end = ElapsedMs();
+    if(status != 0)
+    {
+        WA_ERROR("RunPhase(): %s:%d\n", phases[i].name, status);
+    }
+
+    WA_OSA_CondLock(graph.cond);
+    graph.begin[i] = begin;
+    graph.end[i] = end;
+    if(status == 0)
+    {
+        graph.done |= PHASE(i);
+    }
+    else
+    {
+        graph.failed |= PHASE(i);
+    }
+    WA_OSA_CondSignal(graph.cond);
+    WA_OSA_CondUnlock(graph.cond);
+}
+
+static void *PhaseTask(void *p)
+{
+    RunPhase((unsigned int)(uintptr_t)p);
+    return NULL;
+}
+
+/* [ms] since the start of the graph */
+static unsigned int ElapsedMs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - graph.origin.tv_sec) * 1000 + (now.tv_nsec - graph.origin.tv_nsec) / 1000000;
+}
+
+static int IdInit(void)
+{
+    int status;
+    WA_UTILS_ID_t id;
+
+    status = WA_UTILS_ID_Init();
+    if(status == 0)
+    {
+        WA_UTILS_ID_Generate(&id);
+    }
+    return status;
+}
+
+static int QueueInit(void)
+{
+    WA_INIT_IncomingQ = WA_OSA_QCreate(WA_INIT_INCOME_Q_DEEP, sizeof(WA_OSA_Qjmsg_t));
+    if(WA_INIT_IncomingQ == NULL)
+    {
+        WA_ERROR("QueueInit(): WA_OSA_QCreate(WA_INIT_IncomingQ) error\n");
+        return -1;
+    }
+    (void)WA_OSA_QSetMetrics(WA_INIT_IncomingQ, "init", WA_METRICS_HOP_INIT);
+    return 0;
+}
+
+static int QueueExit(void)
+{
+    return WA_OSA_QDestroy(WA_INIT_IncomingQ);
+}
+
+static int DiagInit(void)
+{
+    return WA_DIAG_Init(pDiags);
+}
+
+static int AggInit(void)
+{
+    return WA_AGG_Init(pDiags);
+}
+
+static int AgentInit(void)
+{
+    agentTaskHandle = WA_OSA_TaskCreate(NULL, 0, AgentTask, NULL, WA_OSA_SCHED_POLICY_RT, WA_OSA_TASK_PRIORITY_MAX);
+    if(agentTaskHandle == NULL)
+    {
+        WA_ERROR("AgentInit(): WA_OSA_TaskCreate(AgentTask): error\n");
+        return -1;
+    }
+    return 0;
+}
+
+static int AgentExit(void)
+{
+    int status = 0, s1;
+
+    s1 = WA_OSA_QSend(WA_INIT_IncomingQ,
+            NULL,
+            0,
+            WA_OSA_Q_PRIORITY_MAX);
+    if(s1 != 0)
+    {
+        WA_ERROR("AgentExit(): WA_OSA_QSend(): %d\n", s1);
+        status = -1;
+    }
+
+    s1 = WA_OSA_TaskJoin(agentTaskHandle, NULL);
+    if(s1 != 0)
+    {
+        WA_ERROR("AgentExit(): WA_OSA_TaskJoin(AgentTask): error\n");
+        status = -1;
+    }
+
+    s1 = WA_OSA_TaskDestroy(agentTaskHandle);
+    if(s1 != 0)
+    {
+        WA_ERROR("AgentExit(): WA_OSA_TaskDestroy(AgentTask): error\n");
+        status = -1;
+    }
+
+    return status;
+}
+
+static int CommInit(void)
+{
+    return WA_COMM_Init(pAdapters);
+}
+
 /* End of doxygen group */
 /*! @} */
 
@@ -48,11 +48,13 @@
  *****************************************************************************/
 #include "wa_log.h"
 #include "wa_debug.h"
+#include "wa_logwriter.h"
 
 /*****************************************************************************
  * LOCAL DEFINITIONS
  *****************************************************************************/
-#define LOG_FILE_PATH "/opt/logs/hwselftest.log"
+#define LOG_FILE_PATH WA_UTILS_LOGWRITER_FILE
+#define LOG_MARK "HWST_LOG |"
 
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
@@ -61,7 +63,6 @@ static void saveLog(const char * msg);
 static void saveRawLog(const char * msg);
 static void saveTelemetryLog(const char * msg); /* RDK-31352 To report events for Telemetry2.0 */
 static void writeLineToLog(const char * line);
-static void prepareLogHeader(char * buffer, const char * mark, size_t bufferSize);
 
 /*****************************************************************************
  * FUNCTION DEFINITIONS
@@ -77,9 +78,24 @@ bool WA_LOG_Init()
         WA_ERROR("rdk_logger_init returned %i\n", (int)re);
         return false;
     }
+
+    /* until the writer runs, and if it fails to start, lines are written synchronously */
+#ifdef HWST_LOG_TO_FILE
+    if (WA_UTILS_LOGWRITER_Init(LOG_FILE_PATH, WA_UTILS_LOGWRITER_MAX_SIZE, true) != 0)
+#else
+    if (WA_UTILS_LOGWRITER_Init(NULL, 0, true) != 0)
+#endif
+    {
+        WA_ERROR("WA_UTILS_LOGWRITER_Init() failed\n");
+    }
     return true;
 }
 
+void WA_LOG_Exit()
+{
+    WA_UTILS_LOGWRITER_Exit();
+}
+
 void WA_LOG_Client(int level, const char * format, ...)
 {
     char * logmsg = NULL;
@@ -185,18 +201,20 @@ static void saveLog(const char * msg)
     char * buffer = NULL;
     static const int HEADER_MAX_LENGTH = 128;
     size_t msgLen = strlen(msg);
+    size_t hdrLen;
 
-    char mark[] = "HWST_LOG |";
-    size_t markLen = strlen(mark);
+    if (WA_UTILS_LOGWRITER_Write(LOG_MARK, msg, true) == 0)
+    {
+        return;
+    }
 
-    buffer = (char*) malloc (markLen + msgLen + HEADER_MAX_LENGTH + 1 + 1);
+    buffer = (char*) malloc (msgLen + HEADER_MAX_LENGTH + 1 + 1);
     if (!buffer)
     {
         return;
     }
 
-    prepareLogHeader(buffer, mark, HEADER_MAX_LENGTH);
-    size_t hdrLen = strlen(buffer);
+    hdrLen = WA_UTILS_LOGWRITER_Header(LOG_MARK, buffer, HEADER_MAX_LENGTH);
     memcpy(buffer + hdrLen, msg, msgLen);
     buffer[hdrLen + msgLen] = '\n';
     buffer[hdrLen + msgLen + 1] = 0;
@@ -211,6 +229,11 @@ static void saveRawLog(const char * msg)
     char * buffer = NULL;
     size_t msgLen = strlen(msg);
 
+    if (WA_UTILS_LOGWRITER_Write(NULL, msg, true) == 0)
+    {
+        return;
+    }
+
     buffer = (char*) malloc(msgLen + 1 + 1);
     if (!buffer)
     {
@@ -273,27 +296,11 @@ static void writeLineToLog(const char * line)
     write(file, line, strlen(line));
     close(file);
 #else
-    printf("%s\n", line);
+    printf("%s", line);
     fflush(stdout); /* Fix for COLBO-110, DELIA-40567 */
 #endif
 }
 
-static void prepareLogHeader(char * buffer, const char * mark, size_t bufferSize)
-{
-    time_t curTime;
-    struct tm bdTime;
-    size_t curSize = 0;
-
-    size_t markLen = strlen(mark);
-
-    memcpy(buffer, mark, markLen);
-
-    curTime = time(0);
-    gmtime_r(&curTime, &bdTime);
-    curSize = strftime(buffer + markLen, bufferSize - markLen, "%F %T ", &bdTime);
-    buffer[curSize + markLen] = 0;
-}
-
 /* End of doxygen group */
 /*! @} */
 
@@ -58,6 +58,9 @@ extern "C"
  *****************************************************************************/
 bool WA_LOG_Init();
 
+/* Writes out the queued log lines, call after the last CLIENT_LOG() */
+void WA_LOG_Exit();
+
 void WA_LOG_Client(int level, const char * format, ...);
 
 int WA_LOG_Log(json_t **pJson);
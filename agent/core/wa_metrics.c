@@ -0,0 +1,671 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_metrics.c
+ *
+ * @brief Implementation of the agent self metrics.
+ *
+ * A task gets its counter block on the first record and is its only writer, the
+ * block goes back to the pool when the task exits and keeps its totals for the next
+ * owner. Readers sum all the blocks with atomic loads, so neither side takes a lock.
+ */
+
+/** @addtogroup WA_METRICS
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_metrics.h"
+#include "wa_debug.h"
+#include "wa_osa.h"
+
+/*****************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define PROC_SELF_STATUS "/proc/self/status"
+
+#define DEFAULT_PERIOD 60
+
+/* the exporter checks for quit that often, [ms] */
+#define EXPORT_STEP 1000
+
+/* queues reported, the agent runs far fewer */
+#define QUEUES_MAX 64
+
+#ifdef WA_BENCH
+/* fine histogram: values below FINE_SUB have their own buckets, above that FINE_SUB buckets per power of two */
+#define FINE_SUB_BITS 3
+#define FINE_SUB (1 << FINE_SUB_BITS)
+#endif
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+typedef struct
+{
+    uint64_t count;
+    uint64_t sum; /* [us] */
+    uint64_t max; /* [us] */
+    uint64_t buckets[WA_METRICS_BUCKETS];
+} WA_METRICS_Series_t;
+
+typedef struct WA_METRICS_Block_tag
+{
+    struct WA_METRICS_Block_tag *next;
+    int used;
+    WA_METRICS_Series_t series[WA_METRICS_MAX];
+#ifdef WA_BENCH
+    uint64_t fine[WA_METRICS_MAX][WA_METRICS_FINE_BUCKETS];
+#endif
+} WA_METRICS_Block_t;
+
+typedef struct
+{
+    const char *key;    /* in the METRICS procedure result */
+    const char *name;   /* in the exported file */
+    const char *label;
+    bool histogram;
+    const char *help;
+} WA_METRICS_Info_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static void CreateKey(void);
+static void ReleaseBlock(void *p);
+static WA_METRICS_Block_t *TaskBlock(void);
+static void Snapshot(WA_METRICS_Series_t *pSeries);
+static void ReadRss(unsigned long *pRss, unsigned long *pHwm);
+static size_t GetQueues(WA_OSA_QStats_t *pStats);
+static int Export(const char *file);
+static void *ExportTask(void *p);
+#ifdef WA_BENCH
+static int FineBucket(uint64_t us);
+#endif
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+static const WA_METRICS_Info_t info[WA_METRICS_MAX] =
+{
+    [WA_METRICS_HOP_INIT] = {"hop_init", "hwst_hop_latency_seconds", "hop=\"init\"", true,
+            "Time the messages spend between the agent tasks."},
+    [WA_METRICS_HOP_DIAG] = {"hop_diag", "hwst_hop_latency_seconds", "hop=\"diag\"", true, NULL},
+    [WA_METRICS_HOP_INSTANCE] = {"hop_instance", "hwst_hop_latency_seconds", "hop=\"instance\"", true, NULL},
+    [WA_METRICS_HOP_COLLECTOR] = {"hop_collector", "hwst_hop_latency_seconds", "hop=\"collector\"", true, NULL},
+    [WA_METRICS_HOP_COMM] = {"hop_comm", "hwst_hop_latency_seconds", "hop=\"comm\"", true, NULL},
+    [WA_METRICS_DIAG_DURATION] = {"diag_duration", "hwst_diag_duration_seconds", NULL, true,
+            "Run time of the diag instances."},
+    [WA_METRICS_WS_TX_STALL] = {"ws_tx_stall", "hwst_ws_tx_stall_seconds", NULL, true,
+            "Waits for the WebSocket tx slot."},
+    [WA_METRICS_WS_TX_DROPS] = {"ws_tx_drops", "hwst_ws_tx_drops_total", NULL, false,
+            "Messages dropped on the WebSocket tx timeout."},
+    [WA_METRICS_SNMP_CALL] = {"snmp_call", "hwst_snmp_call_seconds", NULL, true,
+            "SNMP request round trips."},
+    [WA_METRICS_SNMP_ERRORS] = {"snmp_errors", "hwst_snmp_errors_total", NULL, false,
+            "Failed SNMP requests."},
+    [WA_METRICS_IARM_CALL] = {"iarm_call", "hwst_iarm_call_seconds", NULL, true,
+            "IARM bus calls."},
+    [WA_METRICS_IARM_ERRORS] = {"iarm_errors", "hwst_iarm_errors_total", NULL, false,
+            "Failed IARM bus calls."},
+    [WA_METRICS_PLUGIN_LOAD] = {"plugin_load", "hwst_plugin_load_seconds", NULL, true,
+            "Loads of the diag plugins, with their init."},
+#ifdef WA_BENCH
+    [WA_METRICS_ALLOCS] = {"allocs", "hwst_allocs_total", NULL, false,
+            "Allocations of the agent and jansson through the OSA."},
+#endif
+};
+
+/* bucket upper bounds, the last bucket is +Inf */
+static const uint64_t bucketLe[WA_METRICS_BUCKETS - 1] =
+{
+    100, 1000, 10000, 100000, 1000000, 10000000, 100000000
+};
+
+static WA_METRICS_Block_t *blocks;
+static pthread_once_t keyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t blockKey;
+static __thread WA_METRICS_Block_t *pTaskBlock;
+
+static struct
+{
+    char *file;
+    unsigned int period; /* [s] */
+    void *task;
+} exporter;
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+int WA_METRICS_Init(json_t *config)
+{
+    int status = -1;
+    const char *file = NULL;
+    int period = DEFAULT_PERIOD;
+
+    WA_ENTER("WA_METRICS_Init(config=%p)\n", config);
+
+    memset(&exporter, 0, sizeof(exporter));
+
+    if(config && json_unpack(config, "{s?s,s?i}", "file", &file, "period", &period))
+    {
+        WA_ERROR("WA_METRICS_Init(): invalid config\n");
+        goto end;
+    }
+
+    if(file != NULL)
+    {
+        exporter.file = strdup(file);
+        exporter.period = period > 0 ? period : DEFAULT_PERIOD;
+        if(exporter.file == NULL)
+        {
+            WA_ERROR("WA_METRICS_Init(): strdup() failed\n");
+            goto end;
+        }
+
+        exporter.task = WA_OSA_TaskCreate("metrics", 0, ExportTask, NULL, WA_OSA_SCHED_POLICY_NORMAL, 0);
+        if(exporter.task == NULL)
+        {
+            WA_ERROR("WA_METRICS_Init(): WA_OSA_TaskCreate(ExportTask): error\n");
+            free(exporter.file);
+            exporter.file = NULL;
+            goto end;
+        }
+    }
+
+    WA_INFO("WA_METRICS_Init(): export %s, period %us\n", exporter.file ? exporter.file : "disabled", exporter.period);
+    status = 0;
+
+    end:
+    WA_RETURN("WA_METRICS_Init(): %d\n", status);
+    return status;
+}
+
+int WA_METRICS_Exit(void)
+{
+    int status = 0;
+
+    WA_ENTER("WA_METRICS_Exit()\n");
+
+    if(exporter.task != NULL)
+    {
+        status = WA_OSA_TaskSignalQuit(exporter.task);
+        if(status != 0)
+        {
+            WA_ERROR("WA_METRICS_Exit(): WA_OSA_TaskSignalQuit(): %d\n", status);
+        }
+        status = WA_OSA_TaskJoin(exporter.task, NULL);
+        if(status != 0)
+        {
+            WA_ERROR("WA_METRICS_Exit(): WA_OSA_TaskJoin(): %d\n", status);
+        }
+        else
+        {
+            status = WA_OSA_TaskDestroy(exporter.task);
+        }
+        exporter.task = NULL;
+    }
+    free(exporter.file);
+    exporter.file = NULL;
+
+    WA_RETURN("WA_METRICS_Exit(): %d\n", status);
+    return status;
+}
+
+uint64_t WA_METRICS_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void WA_METRICS_Inc(WA_METRICS_Id_t id)
+{
+    WA_METRICS_Block_t *pBlock = TaskBlock();
+    WA_METRICS_Series_t *pS;
+
+    if(pBlock == NULL)
+    {
+        return;
+    }
+    pS = &pBlock->series[id];
+    /* the task is the only writer, the atomic store only keeps the readers from tearing */
+    __atomic_store_n(&pS->count, pS->count + 1, __ATOMIC_RELAXED);
+}
+
+void WA_METRICS_Observe(WA_METRICS_Id_t id, uint64_t us)
+{
+    WA_METRICS_Block_t *pBlock = TaskBlock();
+    WA_METRICS_Series_t *pS;
+    int b;
+
+    if(pBlock == NULL)
+    {
+        return;
+    }
+    pS = &pBlock->series[id];
+
+    for(b = 0; (b < WA_METRICS_BUCKETS - 1) && (us > bucketLe[b]); b++)
+        ;
+    __atomic_store_n(&pS->buckets[b], pS->buckets[b] + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&pS->sum, pS->sum + us, __ATOMIC_RELAXED);
+    if(us > pS->max)
+    {
+        __atomic_store_n(&pS->max, us, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&pS->count, pS->count + 1, __ATOMIC_RELAXED);
+#ifdef WA_BENCH
+    b = FineBucket(us);
+    __atomic_store_n(&pBlock->fine[id][b], pBlock->fine[id][b] + 1, __ATOMIC_RELAXED);
+#endif
+}
+
+void WA_METRICS_Since(WA_METRICS_Id_t id, uint64_t start)
+{
+    uint64_t now = WA_METRICS_Now();
+
+    WA_METRICS_Observe(id, now > start ? now - start : 0);
+}
+
+uint64_t WA_METRICS_Count(WA_METRICS_Id_t id)
+{
+    WA_METRICS_Block_t *pBlock;
+    uint64_t count = 0;
+
+    for(pBlock = __atomic_load_n(&blocks, __ATOMIC_ACQUIRE); pBlock != NULL; pBlock = pBlock->next)
+    {
+        count += __atomic_load_n(&pBlock->series[id].count, __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+#ifdef WA_BENCH
+void WA_METRICS_GetFine(WA_METRICS_Id_t id, uint64_t *pCounts)
+{
+    WA_METRICS_Block_t *pBlock;
+    int b;
+
+    memset(pCounts, 0, WA_METRICS_FINE_BUCKETS * sizeof(uint64_t));
+    for(pBlock = __atomic_load_n(&blocks, __ATOMIC_ACQUIRE); pBlock != NULL; pBlock = pBlock->next)
+    {
+        for(b = 0; b < WA_METRICS_FINE_BUCKETS; b++)
+        {
+            pCounts[b] += __atomic_load_n(&pBlock->fine[id][b], __ATOMIC_RELAXED);
+        }
+    }
+}
+
+uint64_t WA_METRICS_FineBound(int b)
+{
+    int shift;
+
+    if(b < FINE_SUB)
+    {
+        return (uint64_t)b;
+    }
+    shift = b / FINE_SUB - 1;
+    return ((uint64_t)(FINE_SUB + b % FINE_SUB + 1) << shift) - 1;
+}
+#endif
+
+json_t *WA_METRICS_Get(void)
+{
+    WA_METRICS_Series_t series[WA_METRICS_MAX];
+    WA_OSA_QStats_t queues[QUEUES_MAX];
+    json_t *json, *jSeries, *jBuckets, *jQueues;
+    unsigned long rss, hwm;
+    size_t n, i;
+    int id, b;
+
+    WA_ENTER("WA_METRICS_Get()\n");
+
+    json = json_object();
+    jQueues = json_array();
+    if((json == NULL) || (jQueues == NULL))
+    {
+        WA_ERROR("WA_METRICS_Get(): out of memory\n");
+        json_decref(json);
+        json_decref(jQueues);
+        json = NULL;
+        goto end;
+    }
+
+    Snapshot(series);
+    for(id = 0; id < WA_METRICS_MAX; id++)
+    {
+        if(!info[id].histogram)
+        {
+            json_object_set_new(json, info[id].key, json_integer(series[id].count));
+            continue;
+        }
+        jBuckets = json_array();
+        for(b = 0; b < WA_METRICS_BUCKETS; b++)
+        {
+            json_array_append_new(jBuckets, json_integer(series[id].buckets[b]));
+        }
+        jSeries = json_pack("{s:I,s:I,s:I,s:o}",
+                "count", (json_int_t)series[id].count,
+                "sum", (json_int_t)series[id].sum,
+                "max", (json_int_t)series[id].max,
+                "buckets", jBuckets);
+        json_object_set_new(json, info[id].key, jSeries);
+    }
+
+    n = GetQueues(queues);
+    for(i = 0; i < n; i++)
+    {
+        json_array_append_new(jQueues, json_pack("{s:s,s:i,s:i,s:i,s:I}",
+                "name", queues[i].name ? queues[i].name : "",
+                "depth", (int)queues[i].depth,
+                "hwm", (int)queues[i].hwm,
+                "capacity", (int)queues[i].capacity,
+                "timeouts", (json_int_t)queues[i].timeouts));
+    }
+    json_object_set_new(json, "queues", jQueues);
+
+    ReadRss(&rss, &hwm);
+    json_object_set_new(json, "rss", json_integer(rss));
+    json_object_set_new(json, "rss_max", json_integer(hwm));
+
+    end:
+    WA_RETURN("WA_METRICS_Get(): %p\n", json);
+    return json;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+static void CreateKey(void)
+{
+    if(pthread_key_create(&blockKey, ReleaseBlock) != 0)
+    {
+        WA_ERROR("CreateKey(): pthread_key_create() failed\n");
+    }
+}
+
+static void ReleaseBlock(void *p)
+{
+    /* runs in the exiting task, a later metric there (from another key destructor) takes a block again */
+    pTaskBlock = NULL;
+    __atomic_store_n(&((WA_METRICS_Block_t *)p)->used, 0, __ATOMIC_RELEASE);
+}
+
+static WA_METRICS_Block_t *TaskBlock(void)
+{
+    WA_METRICS_Block_t *pBlock;
+    int unused;
+
+    if(pTaskBlock != NULL)
+    {
+        return pTaskBlock;
+    }
+
+    pthread_once(&keyOnce, CreateKey);
+
+    /* reuse a block left by an exited task, its totals stay in */
+    for(pBlock = __atomic_load_n(&blocks, __ATOMIC_ACQUIRE); pBlock != NULL; pBlock = pBlock->next)
+    {
+        unused = 0;
+        if(__atomic_compare_exchange_n(&pBlock->used, &unused, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+
+    if(pBlock == NULL)
+    {
+        pBlock = calloc(1, sizeof(WA_METRICS_Block_t));
+        if(pBlock == NULL)
+        {
+            return NULL;
+        }
+        pBlock->used = 1;
+        pBlock->next = __atomic_load_n(&blocks, __ATOMIC_RELAXED);
+        while(!__atomic_compare_exchange_n(&blocks, &pBlock->next, pBlock, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+    }
+
+    /* the blocks are never freed, so the key destructor only returns the block to the pool */
+    pthread_setspecific(blockKey, pBlock);
+    pTaskBlock = pBlock;
+    return pBlock;
+}
+
+static void Snapshot(WA_METRICS_Series_t *pSeries)
+{
+    WA_METRICS_Block_t *pBlock;
+    uint64_t max;
+    int id, b;
+
+    memset(pSeries, 0, sizeof(WA_METRICS_Series_t) * WA_METRICS_MAX);
+
+    for(pBlock = __atomic_load_n(&blocks, __ATOMIC_ACQUIRE); pBlock != NULL; pBlock = pBlock->next)
+    {
+        for(id = 0; id < WA_METRICS_MAX; id++)
+        {
+            pSeries[id].count += __atomic_load_n(&pBlock->series[id].count, __ATOMIC_RELAXED);
+            pSeries[id].sum += __atomic_load_n(&pBlock->series[id].sum, __ATOMIC_RELAXED);
+            max = __atomic_load_n(&pBlock->series[id].max, __ATOMIC_RELAXED);
+            if(max > pSeries[id].max)
+            {
+                pSeries[id].max = max;
+            }
+            for(b = 0; b < WA_METRICS_BUCKETS; b++)
+            {
+                pSeries[id].buckets[b] += __atomic_load_n(&pBlock->series[id].buckets[b], __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+static void ReadRss(unsigned long *pRss, unsigned long *pHwm)
+{
+    char line[128];
+    FILE *f;
+
+    *pRss = 0;
+    *pHwm = 0;
+
+    f = fopen(PROC_SELF_STATUS, "r");
+    if(f == NULL)
+    {
+        return;
+    }
+    while(fgets(line, sizeof(line), f))
+    {
+        if(sscanf(line, "VmRSS: %lu", pRss) == 1)
+        {
+            continue;
+        }
+        (void)sscanf(line, "VmHWM: %lu", pHwm);
+    }
+    fclose(f);
+}
+
+static size_t GetQueues(WA_OSA_QStats_t *pStats)
+{
+    size_t n;
+
+    n = WA_OSA_QGetStats(pStats, QUEUES_MAX);
+    if(n > QUEUES_MAX)
+    {
+        WA_WARN("GetQueues(): %zu queues, only %d reported\n", n, QUEUES_MAX);
+        n = QUEUES_MAX;
+    }
+    return n;
+}
+
+static int Export(const char *file)
+{
+    WA_METRICS_Series_t series[WA_METRICS_MAX];
+    WA_OSA_QStats_t queues[QUEUES_MAX];
+    char tmpFile[256];
+    char labels[64];
+    unsigned long rss, hwm;
+    uint64_t cumulative;
+    size_t n, i;
+    int id, b;
+    FILE *f;
+
+    snprintf(tmpFile, sizeof(tmpFile), "%s.tmp", file);
+    f = fopen(tmpFile, "w");
+    if(f == NULL)
+    {
+        WA_ERROR("Export(): fopen(%s) failed\n", tmpFile);
+        return -1;
+    }
+
+    Snapshot(series);
+    for(id = 0; id < WA_METRICS_MAX; id++)
+    {
+        if(info[id].help != NULL)
+        {
+            fprintf(f, "# HELP %s %s\n# TYPE %s %s\n", info[id].name, info[id].help,
+                    info[id].name, info[id].histogram ? "histogram" : "counter");
+        }
+        if(!info[id].histogram)
+        {
+            fprintf(f, "%s %llu\n", info[id].name, (unsigned long long)series[id].count);
+            continue;
+        }
+
+        snprintf(labels, sizeof(labels), "%s%s", info[id].label ? info[id].label : "", info[id].label ? "," : "");
+        cumulative = 0;
+        for(b = 0; b < WA_METRICS_BUCKETS; b++)
+        {
+            cumulative += series[id].buckets[b];
+            if(b < WA_METRICS_BUCKETS - 1)
+            {
+                fprintf(f, "%s_bucket{%sle=\"%g\"} %llu\n", info[id].name, labels,
+                        bucketLe[b] / 1e6, (unsigned long long)cumulative);
+            }
+            else
+            {
+                fprintf(f, "%s_bucket{%sle=\"+Inf\"} %llu\n", info[id].name, labels, (unsigned long long)cumulative);
+            }
+        }
+        fprintf(f, "%s_sum%s%s%s %.6f\n", info[id].name, info[id].label ? "{" : "",
+                info[id].label ? info[id].label : "", info[id].label ? "}" : "", series[id].sum / 1e6);
+        fprintf(f, "%s_count%s%s%s %llu\n", info[id].name, info[id].label ? "{" : "",
+                info[id].label ? info[id].label : "", info[id].label ? "}" : "", (unsigned long long)series[id].count);
+    }
+
+    n = GetQueues(queues);
+    fprintf(f, "# HELP hwst_queue_depth Messages waiting in the agent queues.\n# TYPE hwst_queue_depth gauge\n");
+    for(i = 0; i < n; i++)
+    {
+        fprintf(f, "hwst_queue_depth{queue=\"%s\"} %ld\n", queues[i].name ? queues[i].name : "", queues[i].depth);
+    }
+    fprintf(f, "# HELP hwst_queue_depth_max High-water mark of the agent queues.\n# TYPE hwst_queue_depth_max gauge\n");
+    for(i = 0; i < n; i++)
+    {
+        fprintf(f, "hwst_queue_depth_max{queue=\"%s\"} %ld\n", queues[i].name ? queues[i].name : "", queues[i].hwm);
+    }
+    fprintf(f, "# HELP hwst_queue_capacity Capacity of the agent queues.\n# TYPE hwst_queue_capacity gauge\n");
+    for(i = 0; i < n; i++)
+    {
+        fprintf(f, "hwst_queue_capacity{queue=\"%s\"} %ld\n", queues[i].name ? queues[i].name : "", queues[i].capacity);
+    }
+    fprintf(f, "# HELP hwst_queue_send_timeouts_total Timed sends that found the queue full.\n# TYPE hwst_queue_send_timeouts_total counter\n");
+    for(i = 0; i < n; i++)
+    {
+        fprintf(f, "hwst_queue_send_timeouts_total{queue=\"%s\"} %lu\n", queues[i].name ? queues[i].name : "", queues[i].timeouts);
+    }
+
+    ReadRss(&rss, &hwm);
+    fprintf(f, "# HELP hwst_process_resident_bytes Resident set size of the agent.\n# TYPE hwst_process_resident_bytes gauge\n");
+    fprintf(f, "hwst_process_resident_bytes %lu\n", rss * 1024);
+    fprintf(f, "# HELP hwst_process_resident_max_bytes Peak resident set size of the agent.\n# TYPE hwst_process_resident_max_bytes gauge\n");
+    fprintf(f, "hwst_process_resident_max_bytes %lu\n", hwm * 1024);
+
+    if(fclose(f) != 0)
+    {
+        WA_ERROR("Export(): fclose(%s) failed\n", tmpFile);
+        remove(tmpFile);
+        return -1;
+    }
+    /* readers never see a partial file */
+    if(rename(tmpFile, file) != 0)
+    {
+        WA_ERROR("Export(): rename(%s) failed\n", file);
+        remove(tmpFile);
+        return -1;
+    }
+    return 0;
+}
+
+#ifdef WA_BENCH
+static int FineBucket(uint64_t us)
+{
+    int msb, b;
+
+    if(us < FINE_SUB)
+    {
+        return (int)us;
+    }
+    msb = 63 - __builtin_clzll(us);
+    b = (msb - FINE_SUB_BITS + 1) * FINE_SUB + (int)((us >> (msb - FINE_SUB_BITS)) & (FINE_SUB - 1));
+    return (b < WA_METRICS_FINE_BUCKETS) ? b : WA_METRICS_FINE_BUCKETS - 1;
+}
+#endif
+
+static void *ExportTask(void *p)
+{
+    unsigned int elapsed;
+
+    WA_ENTER("ExportTask()\n");
+
+    while(!WA_OSA_TaskCheckQuit())
+    {
+        (void)Export(exporter.file);
+
+        for(elapsed = 0; (elapsed < exporter.period * 1000) && !WA_OSA_TaskCheckQuit(); elapsed += EXPORT_STEP)
+        {
+            WA_OSA_TaskSleep(EXPORT_STEP);
+        }
+    }
+
+    WA_RETURN("ExportTask(): %p\n", NULL);
+    return NULL;
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,189 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+/**
+ * @file wa_metrics.h
+ *
+ * @brief Interface of the agent self metrics.
+ *
+ * Every task records into its own counter block, without locks. The blocks are
+ * merged on read, by the METRICS local procedure and by the optional exporter that
+ * periodically writes the metrics to a file in the Prometheus text format.
+ */
+
+/** @addtogroup WA_METRICS
+ *  @{
+ */
+
+#ifndef WA_METRICS_H
+#define WA_METRICS_H
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdint.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_json.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED DEFINITIONS
+ *****************************************************************************/
+
+/** Number of the histogram buckets, upper bounds 100us, 1ms, 10ms, 100ms, 1s, 10s, 100s, +Inf */
+#define WA_METRICS_BUCKETS 8
+
+#ifdef WA_BENCH
+/** Number of the fine histogram buckets, see \c WA_METRICS_GetFine() */
+#define WA_METRICS_FINE_BUCKETS 256
+#endif
+
+/*****************************************************************************
+ * EXPORTED TYPES
+ *****************************************************************************/
+typedef enum
+{
+    /* message latency per hop, from the send to the receive [us] */
+    WA_METRICS_HOP_INIT,        /**< to the INIT incoming queue */
+    WA_METRICS_HOP_DIAG,        /**< to the DIAG incoming queue */
+    WA_METRICS_HOP_INSTANCE,    /**< from the DIAG task to the start of the diag instance task */
+    WA_METRICS_HOP_COLLECTOR,   /**< from the finished instance to the instances collector */
+    WA_METRICS_HOP_COMM,        /**< to the COMM incoming queue */
+    WA_METRICS_DIAG_DURATION,   /**< diag instance run time [us] */
+    WA_METRICS_WS_TX_STALL,     /**< wait for the WS tx slot taken by the previous message [us] */
+    WA_METRICS_WS_TX_DROPS,     /**< messages dropped on the WS tx timeout */
+    WA_METRICS_SNMP_CALL,       /**< SNMP request round trip [us] */
+    WA_METRICS_SNMP_ERRORS,     /**< failed SNMP requests */
+    WA_METRICS_IARM_CALL,       /**< IARM bus call [us] */
+    WA_METRICS_IARM_ERRORS,     /**< failed IARM bus calls */
+    WA_METRICS_PLUGIN_LOAD,     /**< load and init of a diag plugin [us] */
+#ifdef WA_BENCH
+    WA_METRICS_ALLOCS,          /**< allocations through WA_OSA_Malloc(), jansson included, benchmark builds only */
+#endif
+    WA_METRICS_MAX
+} WA_METRICS_Id_t;
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @brief Initialises the metrics export.
+ * Recording does not depend on it and works from the process start.
+ *
+ * @param config the "metrics" configuration section, NULL for the defaults:
+ *        "file" (none) the file the metrics are exported to, "period" (60) [s]
+ *        the export period.
+ *
+ * @returns Operation status.
+ * @retval 0 for success, non-zero otherwise
+ */
+int WA_METRICS_Init(json_t *config);
+
+/**
+ * @brief Stops the metrics export.
+ *
+ * @returns Operation status.
+ * @retval 0 for success, non-zero otherwise
+ */
+int WA_METRICS_Exit(void);
+
+/**
+ * @brief Monotonic timestamp for the latency metrics.
+ *
+ * @returns Current time, in [us].
+ */
+uint64_t WA_METRICS_Now(void);
+
+/**
+ * @brief Increments a counter metric.
+ *
+ * @param id the metric
+ */
+void WA_METRICS_Inc(WA_METRICS_Id_t id);
+
+/**
+ * @brief Records a value of a histogram metric.
+ *
+ * @param id the metric
+ * @param us the value, in [us]
+ */
+void WA_METRICS_Observe(WA_METRICS_Id_t id, uint64_t us);
+
+/**
+ * @brief Records the time elapsed from a \c WA_METRICS_Now() timestamp.
+ *
+ * @param id the metric
+ * @param start the timestamp
+ */
+void WA_METRICS_Since(WA_METRICS_Id_t id, uint64_t start);
+
+/**
+ * @brief Sums a counter metric, or the number of the values of a histogram metric.
+ *
+ * @param id the metric
+ *
+ * @returns the count
+ */
+uint64_t WA_METRICS_Count(WA_METRICS_Id_t id);
+
+#ifdef WA_BENCH
+/**
+ * @brief Reads the fine histogram of a histogram metric, kept in the benchmark builds.
+ * The buckets are log-linear, 8 per power of two, so a percentile taken from them
+ * is within 12.5% of the value.
+ *
+ * @param id the metric
+ * @param[out] pCounts \c WA_METRICS_FINE_BUCKETS counts, bucket b holds the values
+ *             up to \c WA_METRICS_FineBound(b)
+ */
+void WA_METRICS_GetFine(WA_METRICS_Id_t id, uint64_t *pCounts);
+
+/**
+ * @brief Upper bound of a fine histogram bucket.
+ *
+ * @param b the bucket
+ *
+ * @returns the bound, in [us]
+ */
+uint64_t WA_METRICS_FineBound(int b);
+#endif
+
+/**
+ * @brief Collects all the metrics.
+ *
+ * @returns the metrics object, to be released by the caller
+ * @retval NULL error
+ */
+json_t *WA_METRICS_Get(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_METRICS_H */
+
+/* EOF */
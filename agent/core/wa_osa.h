@@ -78,6 +78,24 @@ typedef struct {
     json_t *json;
 }WA_OSA_Qjmsg_t;
 
+/** Statistics of a queue, see \c WA_OSA_QGetStats() */
+typedef struct
+{
+    const char *name; /**< as given to \c WA_OSA_QSetMetrics(), NULL if not given */
+    long depth; /**< messages waiting */
+    long hwm; /**< max messages waiting since the queue was created */
+    long capacity; /**< the queue deep */
+    unsigned long timeouts; /**< timed sends that found the queue full until the timeout */
+}WA_OSA_QStats_t;
+
+/** Implementations of the queues, see \c WA_OSA_QSetBackend() */
+typedef enum
+{
+    WA_OSA_Q_BACKEND_MQ = 0, /**< POSIX message queues, the default */
+    WA_OSA_Q_BACKEND_LOCAL, /**< process local ring, the messages are not copied through the kernel */
+    WA_OSA_Q_BACKEND_MAX
+}WA_OSA_qBackend_t;
+
 typedef enum
 {
     WA_OSA_SCHED_POLICY_NORMAL = 0,
@@ -454,6 +472,17 @@ extern void WA_OSA_Free(void * const ptr);
  */
 extern void * WA_OSA_QCreate(const unsigned int deep, long maxSize);
 
+/**
+ * @brief Selects the implementation of the queues created from now on.
+ * The existing queues keep theirs.
+ *
+ * @param backend the queue implementation
+ *
+ * @retval 0 success
+ * @retval -1 error
+ */
+extern int WA_OSA_QSetBackend(WA_OSA_qBackend_t backend);
+
 /**
  * @brief Destroys queue.
  *
@@ -464,6 +493,28 @@ extern void * WA_OSA_QCreate(const unsigned int deep, long maxSize);
  */
 extern int WA_OSA_QDestroy(void * const qHandle);
 
+/**
+ * @brief Names a queue in the statistics and enables the latency metric for it.
+ *
+ * @param qHandle valid queue handle
+ * @param name the queue name, a string that outlives the queue
+ * @param latencyMetric \c WA_METRICS_Id_t recording the time the messages spend in the queue, -1 for none
+ *
+ * @retval 0 success
+ * @retval -1 error
+ */
+extern int WA_OSA_QSetMetrics(void * const qHandle, const char *name, int latencyMetric);
+
+/**
+ * @brief Gets the statistics of all the existing queues.
+ *
+ * @param pStats array for the statistics
+ * @param max size of the \c pStats array
+ *
+ * @returns number of the existing queues, only the first \c max of them are filled in
+ */
+extern size_t WA_OSA_QGetStats(WA_OSA_QStats_t *pStats, size_t max);
+
 /**
  * @brief Sends a message over queue.
  *
@@ -0,0 +1,491 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_throttle.c
+ *
+ * @brief Implementation of the in-run throttling of heavy diags.
+ *
+ * The load is measured over the last sample period, without the agent's own share,
+ * so a heavy diag does not throttle itself. With PSI and the agent in its own cgroup
+ * it is the system stall (/proc/pressure/cpu, /proc/pressure/io) less the stall of
+ * the agent cgroup, otherwise the busy and iowait shares of /proc/stat less the
+ * agent's utime + stime and block I/O delay from /proc/self/stat.
+ */
+
+/** @addtogroup WA_THROTTLE
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_throttle.h"
+#include "wa_debug.h"
+#include "wa_osa.h"
+
+/*****************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define PROC_STAT "/proc/stat"
+#define PROC_PRESSURE_CPU "/proc/pressure/cpu"
+#define PROC_PRESSURE_IO "/proc/pressure/io"
+#define PROC_SELF_STAT "/proc/self/stat"
+#define PROC_SELF_CGROUP "/proc/self/cgroup"
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+#define PATH_LEN 256
+
+/* /proc/self/stat fields, counted from 1 */
+#define STAT_UTIME 14
+#define STAT_STIME 15
+#define STAT_BLKIO 42
+
+/* the load is re-measured at most that often, [ms] */
+#define SAMPLE_PERIOD 500
+
+/* a paused diag re-checks the load that often, [ms] */
+#define PAUSE_STEP 500
+
+#define DEFAULT_CPU_SLOW 40
+#define DEFAULT_CPU_PAUSE 70
+#define DEFAULT_IO_SLOW 20
+#define DEFAULT_IO_PAUSE 50
+#define DEFAULT_SLOW_DELAY 200
+#define DEFAULT_MAX_PAUSE 30000
+#define DEFAULT_MAX_TOTAL 60000
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+typedef enum
+{
+    WA_THROTTLE_LEVEL_NONE,
+    WA_THROTTLE_LEVEL_SLOW,
+    WA_THROTTLE_LEVEL_PAUSE
+} WA_THROTTLE_Level_t;
+
+typedef struct
+{
+    struct timespec timestamp;
+    unsigned long long busy;     /* /proc/stat [jiffies] */
+    unsigned long long iowait;
+    unsigned long long total;
+    unsigned long long selfCpu;  /* utime + stime of the agent [jiffies] */
+    unsigned long long selfIo;   /* block I/O delay of the agent, 0 without delay accounting [jiffies] */
+    bool psi;
+    unsigned long long cpuStall; /* PSI "some" total of the system [us] */
+    unsigned long long ioStall;
+    unsigned long long selfCpuStall; /* PSI "some" total of the agent cgroup [us] */
+    unsigned long long selfIoStall;
+} WA_THROTTLE_Sample_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static int ConfigInt(json_t *config, const char *name, int def);
+static unsigned int ElapsedMs(const struct timespec *from, const struct timespec *to);
+static int ReadStat(WA_THROTTLE_Sample_t *pSample);
+static int ReadSelf(WA_THROTTLE_Sample_t *pSample);
+static int ReadPressure(const char *file, unsigned long long *pStall);
+static void FindCgroup(void);
+static int Share(unsigned long long all, unsigned long long self, unsigned long long total);
+static WA_THROTTLE_Level_t Level(void);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+static struct
+{
+    void *mutex;
+    bool enabled;
+    int cpuSlow;
+    int cpuPause;
+    int ioSlow;
+    int ioPause;
+    unsigned int slowDelay;
+    unsigned int maxPause;
+    unsigned int maxTotal;
+    char cgPressureCpu[PATH_LEN]; /* empty when the agent has no cgroup of its own */
+    char cgPressureIo[PATH_LEN];
+    bool valid; /* 'last' holds a sample */
+    WA_THROTTLE_Sample_t last;
+    int cpu; /* load over the last sample period [%] */
+    int io;
+} throttle;
+
+/* accounting of the diag instance run by the task */
+static __thread struct
+{
+    bool active;
+    unsigned int throttled; /* [ms] */
+    unsigned int pauses;
+} task;
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+int WA_THROTTLE_Init(json_t *config)
+{
+    int status = -1;
+    json_t *jEnabled;
+
+    WA_ENTER("WA_THROTTLE_Init(config=%p)\n", config);
+
+    memset(&throttle, 0, sizeof(throttle));
+
+    jEnabled = config ? json_object_get(config, "enabled") : NULL;
+    throttle.enabled = jEnabled ? json_is_true(jEnabled) : true;
+    throttle.cpuSlow = ConfigInt(config, "cpu_slow", DEFAULT_CPU_SLOW);
+    throttle.cpuPause = ConfigInt(config, "cpu_pause", DEFAULT_CPU_PAUSE);
+    throttle.ioSlow = ConfigInt(config, "io_slow", DEFAULT_IO_SLOW);
+    throttle.ioPause = ConfigInt(config, "io_pause", DEFAULT_IO_PAUSE);
+    throttle.slowDelay = ConfigInt(config, "slow_delay", DEFAULT_SLOW_DELAY);
+    throttle.maxPause = ConfigInt(config, "max_pause", DEFAULT_MAX_PAUSE);
+    throttle.maxTotal = ConfigInt(config, "max_total", DEFAULT_MAX_TOTAL);
+
+    throttle.mutex = WA_OSA_MutexCreate();
+    if(throttle.mutex == NULL)
+    {
+        WA_ERROR("WA_THROTTLE_Init(): WA_OSA_MutexCreate() failed\n");
+        goto end;
+    }
+
+    FindCgroup();
+
+    /* the first sample, the load is known after the next one */
+    throttle.valid = (ReadStat(&throttle.last) == 0);
+
+    WA_INFO("WA_THROTTLE_Init(): %s, cpu %d/%d%%, io %d/%d%%, %s\n",
+            throttle.enabled ? "enabled" : "disabled",
+            throttle.cpuSlow, throttle.cpuPause, throttle.ioSlow, throttle.ioPause,
+            throttle.last.psi ? "psi" : "stat");
+    status = 0;
+
+    end:
+    WA_RETURN("WA_THROTTLE_Init(): %d\n", status);
+    return status;
+}
+
+int WA_THROTTLE_Exit(void)
+{
+    int status;
+
+    WA_ENTER("WA_THROTTLE_Exit()\n");
+
+    status = WA_OSA_MutexDestroy(throttle.mutex);
+    if(status != 0)
+    {
+        WA_ERROR("WA_THROTTLE_Exit(): WA_OSA_MutexDestroy(): %d\n", status);
+    }
+    throttle.mutex = NULL;
+
+    WA_RETURN("WA_THROTTLE_Exit(): %d\n", status);
+    return status;
+}
+
+void WA_THROTTLE_Begin(void)
+{
+    task.active = true;
+    task.throttled = 0;
+    task.pauses = 0;
+}
+
+unsigned int WA_THROTTLE_End(void)
+{
+    task.active = false;
+    return task.throttled;
+}
+
+bool WA_THROTTLE_Point(void)
+{
+    WA_THROTTLE_Level_t level;
+    struct timespec start, now;
+
+    if(WA_OSA_TaskCheckQuit())
+    {
+        return true;
+    }
+
+    if(!task.active || !throttle.enabled || (task.throttled >= throttle.maxTotal))
+    {
+        return false;
+    }
+
+    level = Level();
+    if(level == WA_THROTTLE_LEVEL_NONE)
+    {
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(level == WA_THROTTLE_LEVEL_SLOW)
+    {
+        WA_OSA_TaskSleep(throttle.slowDelay);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }
+    else
+    {
+        if(task.pauses++ == 0)
+        {
+            WA_INFO("WA_THROTTLE_Point(): paused, cpu %d%%, io %d%%\n", throttle.cpu, throttle.io);
+        }
+
+        /* until the load drops, the pause or the budget of the instance ends */
+        do
+        {
+            WA_OSA_TaskSleep(PAUSE_STEP);
+            clock_gettime(CLOCK_MONOTONIC, &now);
+        } while(!WA_OSA_TaskCheckQuit() &&
+                (ElapsedMs(&start, &now) < throttle.maxPause) &&
+                (task.throttled + ElapsedMs(&start, &now) < throttle.maxTotal) &&
+                (Level() == WA_THROTTLE_LEVEL_PAUSE));
+    }
+    task.throttled += ElapsedMs(&start, &now);
+
+    return WA_OSA_TaskCheckQuit();
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+static int ConfigInt(json_t *config, const char *name, int def)
+{
+    json_t *jValue = config ? json_object_get(config, name) : NULL;
+
+    return (json_is_integer(jValue) && (json_integer_value(jValue) >= 0)) ? (int)json_integer_value(jValue) : def;
+}
+
+static unsigned int ElapsedMs(const struct timespec *from, const struct timespec *to)
+{
+    return (to->tv_sec - from->tv_sec) * 1000 + (to->tv_nsec - from->tv_nsec) / 1000000;
+}
+
+static int ReadStat(WA_THROTTLE_Sample_t *pSample)
+{
+    unsigned long long user, nice, system, idle, iowait, irq, softirq, steal = 0;
+    FILE *f;
+    int n;
+
+    clock_gettime(CLOCK_MONOTONIC, &pSample->timestamp);
+
+    f = fopen(PROC_STAT, "r");
+    if(f == NULL)
+    {
+        WA_ERROR("ReadStat(): fopen(%s) failed\n", PROC_STAT);
+        return -1;
+    }
+    n = fscanf(f, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+            &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal);
+    fclose(f);
+    if(n < 7)
+    {
+        WA_ERROR("ReadStat(): unexpected %s format\n", PROC_STAT);
+        return -1;
+    }
+
+    pSample->busy = user + nice + system + irq + softirq + steal;
+    pSample->iowait = iowait;
+    pSample->total = pSample->busy + idle + iowait;
+
+    if(ReadSelf(pSample) != 0)
+    {
+        WA_ERROR("ReadStat(): unexpected %s format\n", PROC_SELF_STAT);
+        return -1;
+    }
+
+    pSample->psi = (throttle.cgPressureCpu[0] != '\0') &&
+                   (ReadPressure(PROC_PRESSURE_CPU, &pSample->cpuStall) == 0) &&
+                   (ReadPressure(PROC_PRESSURE_IO, &pSample->ioStall) == 0) &&
+                   (ReadPressure(throttle.cgPressureCpu, &pSample->selfCpuStall) == 0) &&
+                   (ReadPressure(throttle.cgPressureIo, &pSample->selfIoStall) == 0);
+    return 0;
+}
+
+static int ReadSelf(WA_THROTTLE_Sample_t *pSample)
+{
+    char buf[1024];
+    char *p, *save = NULL;
+    int field;
+    FILE *f;
+
+    f = fopen(PROC_SELF_STAT, "r");
+    if(f == NULL)
+    {
+        return -1;
+    }
+    p = fgets(buf, sizeof(buf), f);
+    fclose(f);
+
+    /* the command name may hold spaces, the fields are counted from its closing parenthesis */
+    if((p == NULL) || ((p = strrchr(buf, ')')) == NULL))
+    {
+        return -1;
+    }
+
+    pSample->selfCpu = 0;
+    pSample->selfIo = 0;
+    for(field = 3, p = strtok_r(p + 1, " ", &save); p != NULL; field++, p = strtok_r(NULL, " ", &save))
+    {
+        if((field == STAT_UTIME) || (field == STAT_STIME))
+        {
+            pSample->selfCpu += strtoull(p, NULL, 10);
+        }
+        else if(field == STAT_BLKIO)
+        {
+            pSample->selfIo = strtoull(p, NULL, 10);
+            break;
+        }
+    }
+    return (field > STAT_STIME) ? 0 : -1;
+}
+
+static int ReadPressure(const char *file, unsigned long long *pStall)
+{
+    FILE *f;
+    int n;
+
+    f = fopen(file, "r");
+    if(f == NULL)
+    {
+        /* no PSI in the kernel */
+        return -1;
+    }
+    n = fscanf(f, "some avg10=%*f avg60=%*f avg300=%*f total=%llu", pStall);
+    fclose(f);
+
+    return (n == 1) ? 0 : -1;
+}
+
+/* the cgroup v2 pressure files of the agent, the root cgroup would count everybody in */
+static void FindCgroup(void)
+{
+    char line[PATH_LEN];
+    size_t len;
+    FILE *f;
+
+    throttle.cgPressureCpu[0] = '\0';
+    throttle.cgPressureIo[0] = '\0';
+
+    f = fopen(PROC_SELF_CGROUP, "r");
+    if(f == NULL)
+    {
+        return;
+    }
+    while(fgets(line, sizeof(line), f) != NULL)
+    {
+        if(strncmp(line, "0::/", 4) != 0)
+        {
+            continue;
+        }
+        len = strcspn(line, "\n");
+        line[len] = '\0';
+        if(len > 4)
+        {
+            snprintf(throttle.cgPressureCpu, sizeof(throttle.cgPressureCpu), CGROUP_ROOT "%s/cpu.pressure", line + 3);
+            snprintf(throttle.cgPressureIo, sizeof(throttle.cgPressureIo), CGROUP_ROOT "%s/io.pressure", line + 3);
+        }
+        break;
+    }
+    fclose(f);
+}
+
+/* share of the total taken by the others than the agent [%] */
+static int Share(unsigned long long all, unsigned long long self, unsigned long long total)
+{
+    return (all > self) ? (int)((all - self) * 100 / total) : 0;
+}
+
+/* Caller must not hold the throttle.mutex */
+static WA_THROTTLE_Level_t Level(void)
+{
+    WA_THROTTLE_Level_t level = WA_THROTTLE_LEVEL_NONE;
+    WA_THROTTLE_Sample_t sample;
+    struct timespec now;
+    unsigned int elapsed;
+
+    if(WA_OSA_MutexLock(throttle.mutex))
+    {
+        WA_ERROR("Level(): WA_OSA_MutexLock() failed\n");
+        return level;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = ElapsedMs(&throttle.last.timestamp, &now);
+    if(!throttle.valid || (elapsed >= SAMPLE_PERIOD))
+    {
+        if(ReadStat(&sample) == 0)
+        {
+            if(throttle.valid && sample.psi && throttle.last.psi)
+            {
+                /* share of the wall time some task outside the agent was stalled */
+                throttle.cpu = Share(sample.cpuStall - throttle.last.cpuStall,
+                        sample.selfCpuStall - throttle.last.selfCpuStall, elapsed * 1000ULL);
+                throttle.io = Share(sample.ioStall - throttle.last.ioStall,
+                        sample.selfIoStall - throttle.last.selfIoStall, elapsed * 1000ULL);
+            }
+            else if(throttle.valid && (sample.total > throttle.last.total))
+            {
+                throttle.cpu = Share(sample.busy - throttle.last.busy,
+                        sample.selfCpu - throttle.last.selfCpu, sample.total - throttle.last.total);
+                throttle.io = Share(sample.iowait - throttle.last.iowait,
+                        sample.selfIo - throttle.last.selfIo, sample.total - throttle.last.total);
+            }
+            throttle.last = sample;
+            throttle.valid = true;
+        }
+    }
+
+    if((throttle.cpu >= throttle.cpuPause) || (throttle.io >= throttle.ioPause))
+    {
+        level = WA_THROTTLE_LEVEL_PAUSE;
+    }
+    else if((throttle.cpu >= throttle.cpuSlow) || (throttle.io >= throttle.ioSlow))
+    {
+        level = WA_THROTTLE_LEVEL_SLOW;
+    }
+
+    if(WA_OSA_MutexUnlock(throttle.mutex))
+    {
+        WA_ERROR("Level(): WA_OSA_MutexUnlock() failed\n");
+    }
+
+    return level;
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,108 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_throttle.h
+ *
+ * @brief Interface of the in-run throttling of heavy diags.
+ *
+ * Heavy diags call \c WA_THROTTLE_Point() at their chunk boundaries instead of
+ * \c WA_OSA_TaskCheckQuit(). When the CPU or I/O pressure from outside the agent
+ * is above the configured thresholds the calling diag is slowed down or paused there
+ * until the foreground load drops, within the configured time budget.
+ */
+
+/** @addtogroup WA_THROTTLE
+ *  @{
+ */
+
+#ifndef WA_THROTTLE_H
+#define WA_THROTTLE_H
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdbool.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_json.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @brief Initialises the throttling.
+ *
+ * @param config the "throttle" configuration section, NULL for the defaults:
+ *        "enabled" (true), "cpu_slow" (40), "cpu_pause" (70), "io_slow" (20), "io_pause" (50)
+ *        pressure thresholds [%], "slow_delay" (200) [ms] delay per point when slowed down,
+ *        "max_pause" (30000) [ms] longest single pause and "max_total" (60000) [ms] max
+ *        throttled time of one diag instance.
+ *
+ * @returns Operation status.
+ * @retval 0 for success, non-zero otherwise
+ */
+int WA_THROTTLE_Init(json_t *config);
+
+/**
+ * @brief Frees the throttling resources.
+ *
+ * @returns Operation status.
+ * @retval 0 for success, non-zero otherwise
+ */
+int WA_THROTTLE_Exit(void);
+
+/**
+ * @brief Starts the throttling accounting of the diag running in the calling task.
+ */
+void WA_THROTTLE_Begin(void);
+
+/**
+ * @brief Ends the throttling accounting of the diag running in the calling task.
+ *
+ * @returns Time the diag spent throttled since \c WA_THROTTLE_Begin(), in [ms].
+ */
+unsigned int WA_THROTTLE_End(void);
+
+/**
+ * @brief Throttling point, to be called by heavy diags between chunks of work.
+ * Depending on the current load returns at once, after a short delay or after a pause.
+ * Outside of \c WA_THROTTLE_Begin() / \c WA_THROTTLE_End() it only checks for quit.
+ *
+ * @retval true the task is requested to quit, as \c WA_OSA_TaskCheckQuit()
+ * @retval false continue the work
+ */
+bool WA_THROTTLE_Point(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_THROTTLE_H */
+
+/* EOF */
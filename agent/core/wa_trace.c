@@ -0,0 +1,533 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_trace.c
+ *
+ * @brief Implementation of the agent binary trace.
+ *
+ * Every task writes its events to its own ring, the only shared step is taking a
+ * ring from the pool on the first event. A ring left by an exited task is reused
+ * by the next one, the events keep the thread id of the task that recorded them.
+ */
+
+/** @addtogroup WA_TRACE
+ *  @{
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_trace.h"
+#include "wa_debug.h"
+#include "wa_crashhook.h"
+
+/*****************************************************************************
+ * GLOBAL VARIABLE DEFINITIONS
+ *****************************************************************************/
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+#define DEFAULT_FILE "/tmp/hwselftest.trace"
+#define DEFAULT_CRASH_FILE "/opt/logs/hwselftest.trace.crash"
+
+#define FILE_NAME_MAX 128
+
+/* longer format strings are cut in the dump */
+#define FMT_MAX 255
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+typedef struct
+{
+    uint64_t ts; /* CLOCK_MONOTONIC [ns] */
+    const char *fmt;
+    uint32_t tid;
+    uint16_t nargs;
+    char level;
+    uintptr_t args[WA_TRACE_MAX_ARGS];
+} WA_TRACE_Record_t;
+
+typedef struct WA_TRACE_Ring_tag
+{
+    struct WA_TRACE_Ring_tag *next;
+    int used;
+    uint32_t tid;
+    uint32_t head; /* events recorded so far, the next slot is head % WA_TRACE_RING_SIZE */
+    WA_TRACE_Record_t records[WA_TRACE_RING_SIZE];
+} WA_TRACE_Ring_t;
+
+/*
+ * Dump file layout, all fields little endian:
+ *   header: magic[8], uint32 version, uint32 pointer size, uint64 monotonic [ns],
+ *           uint64 realtime [ns], both taken at the dump
+ *   events: uint64 ts [ns], uint32 tid, uint16 nargs, uint8 level, uint8 fmt length,
+ *           uint64 args[WA_TRACE_MAX_ARGS], fmt (not terminated)
+ */
+#define HEADER_SIZE (8 + 4 + 4 + 8 + 8)
+#define EVENT_SIZE (8 + 4 + 2 + 1 + 1 + 8 * WA_TRACE_MAX_ARGS)
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static void CreateKey(void);
+static void ReleaseRing(void *p);
+static void AtForkChild(void);
+static WA_TRACE_Ring_t *TaskRing(void);
+static uint64_t Now(clockid_t clock);
+static unsigned int CollectArgs(const char *fmt, va_list ap, uintptr_t *args);
+static int WriteAll(int fd, const void *buf, size_t size);
+static void CrashDump(int sig);
+
+/*****************************************************************************
+ * LOCAL VARIABLE DECLARATIONS
+ *****************************************************************************/
+static bool enabled = true;
+static char file[FILE_NAME_MAX] = DEFAULT_FILE;
+static char crashFile[FILE_NAME_MAX] = DEFAULT_CRASH_FILE;
+
+static WA_TRACE_Ring_t *rings;
+static pthread_once_t keyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t ringKey;
+static __thread WA_TRACE_Ring_t *pTaskRing;
+
+static bool hooked;
+
+/* format of the events of an unmapped object */
+static const char forgotten[] = "(unloaded)";
+static int dumping;
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+
+int WA_TRACE_Init(json_t *config)
+{
+    int status = -1;
+    json_t *jEnabled;
+    const char *f = NULL, *cf = NULL;
+
+    WA_ENTER("WA_TRACE_Init(config=%p)\n", config);
+
+    if(config && json_unpack(config, "{s?s,s?s}", "file", &f, "crash_file", &cf))
+    {
+        WA_ERROR("WA_TRACE_Init(): invalid config\n");
+        goto end;
+    }
+    jEnabled = config ? json_object_get(config, "enabled") : NULL;
+    enabled = jEnabled ? json_is_true(jEnabled) : true;
+    if(f)
+    {
+        snprintf(file, sizeof(file), "%s", f);
+    }
+    if(cf)
+    {
+        snprintf(crashFile, sizeof(crashFile), "%s", cf);
+    }
+
+    if(enabled && (WA_UTILS_CRASHHOOK_Register(CrashDump) != 0))
+    {
+        WA_ERROR("WA_TRACE_Init(): WA_UTILS_CRASHHOOK_Register() failed\n");
+        goto end;
+    }
+    hooked = enabled;
+
+    WA_INFO("WA_TRACE_Init(): %s, file %s, crash file %s\n", enabled ? "enabled" : "disabled", file, crashFile);
+    status = 0;
+
+    end:
+    WA_RETURN("WA_TRACE_Init(): %d\n", status);
+    return status;
+}
+
+int WA_TRACE_Exit(void)
+{
+    WA_ENTER("WA_TRACE_Exit()\n");
+
+    if(hooked)
+    {
+        WA_UTILS_CRASHHOOK_Unregister(CrashDump);
+    }
+    hooked = false;
+
+    WA_RETURN("WA_TRACE_Exit(): %d\n", 0);
+    return 0;
+}
+
+void WA_TRACE_Event(char level, const char *fmt, unsigned int nargs,
+        uintptr_t a0, uintptr_t a1, uintptr_t a2, uintptr_t a3)
+{
+    WA_TRACE_Ring_t *pRing;
+    WA_TRACE_Record_t *pRec;
+
+    if(!enabled || ((pRing = TaskRing()) == NULL))
+    {
+        return;
+    }
+
+    pRec = &pRing->records[pRing->head & (WA_TRACE_RING_SIZE - 1)];
+    pRec->ts = Now(CLOCK_MONOTONIC);
+    __atomic_store_n(&pRec->fmt, fmt, __ATOMIC_RELAXED);
+    pRec->tid = pRing->tid;
+    pRec->nargs = nargs;
+    pRec->level = level;
+    pRec->args[0] = a0;
+    pRec->args[1] = a1;
+    pRec->args[2] = a2;
+    pRec->args[3] = a3;
+    __atomic_store_n(&pRing->head, pRing->head + 1, __ATOMIC_RELEASE);
+}
+
+void WA_TRACE_Log(int level, char trace, const char *fmt, ...)
+{
+    const char *traceFmt = fmt + sizeof(WA_TRACE_LOG_PREFIX) - 1;
+    uintptr_t args[WA_TRACE_MAX_ARGS] = {0};
+    unsigned int nargs;
+    va_list ap, aq;
+
+    va_start(ap, fmt);
+    if(enabled)
+    {
+        va_copy(aq, ap);
+        nargs = CollectArgs(traceFmt, aq, args);
+        va_end(aq);
+        WA_TRACE_Event(trace, traceFmt, nargs, args[0], args[1], args[2], args[3]);
+    }
+    rdk_logger_msg_vsprintf((rdk_LogLevel)level, "LOG.RDK.HWST", fmt, ap);
+    va_end(ap);
+}
+
+void WA_TRACE_Forget(const void *start, size_t size)
+{
+    WA_TRACE_Ring_t *pRing;
+    const char *fmt;
+    unsigned int i;
+
+    for(pRing = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); pRing != NULL; pRing = pRing->next)
+    {
+        for(i = 0; i < WA_TRACE_RING_SIZE; i++)
+        {
+            fmt = __atomic_load_n(&pRing->records[i].fmt, __ATOMIC_RELAXED);
+            if(((uintptr_t)fmt >= (uintptr_t)start) && ((uintptr_t)fmt - (uintptr_t)start < size))
+            {
+                /* the task may be recording over the slot, its new event stays */
+                (void)__atomic_compare_exchange_n(&pRing->records[i].fmt, &fmt, forgotten,
+                        false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+            }
+        }
+    }
+
+    /* a dump running now may have read an old format just before */
+    while(__atomic_load_n(&dumping, __ATOMIC_SEQ_CST) != 0)
+    {
+        sched_yield();
+    }
+}
+
+int WA_TRACE_Dump(const char *fileName, unsigned int *pRecords)
+{
+    WA_TRACE_Ring_t *pRing;
+    WA_TRACE_Record_t rec;
+    unsigned char buf[EVENT_SIZE + FMT_MAX];
+    uint32_t u32, head, n;
+    uint64_t u64;
+    unsigned int records = 0;
+    size_t len;
+    int fd, status = -1, i;
+
+    if(fileName == NULL)
+    {
+        fileName = file;
+    }
+
+    fd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0)
+    {
+        return -1;
+    }
+    __atomic_add_fetch(&dumping, 1, __ATOMIC_SEQ_CST);
+
+    memcpy(buf, WA_TRACE_MAGIC, 8);
+    u32 = WA_TRACE_VERSION;
+    memcpy(buf + 8, &u32, 4);
+    u32 = sizeof(uintptr_t);
+    memcpy(buf + 12, &u32, 4);
+    u64 = Now(CLOCK_MONOTONIC);
+    memcpy(buf + 16, &u64, 8);
+    u64 = Now(CLOCK_REALTIME);
+    memcpy(buf + 24, &u64, 8);
+    if(WriteAll(fd, buf, HEADER_SIZE) != 0)
+    {
+        goto end;
+    }
+
+    for(pRing = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); pRing != NULL; pRing = pRing->next)
+    {
+        head = __atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE);
+        n = head < WA_TRACE_RING_SIZE ? head : WA_TRACE_RING_SIZE;
+
+        /* oldest first; the task keeps running, so its newest events may be torn */
+        for(u32 = head - n; u32 != head; u32++)
+        {
+            rec = pRing->records[u32 & (WA_TRACE_RING_SIZE - 1)];
+            if(rec.fmt == NULL)
+            {
+                continue;
+            }
+            len = strnlen(rec.fmt, FMT_MAX);
+
+            memcpy(buf, &rec.ts, 8);
+            memcpy(buf + 8, &rec.tid, 4);
+            memcpy(buf + 12, &rec.nargs, 2);
+            buf[14] = (unsigned char)rec.level;
+            buf[15] = (unsigned char)len;
+            for(i = 0; i < WA_TRACE_MAX_ARGS; i++)
+            {
+                u64 = rec.args[i];
+                memcpy(buf + 16 + 8 * i, &u64, 8);
+            }
+            memcpy(buf + EVENT_SIZE, rec.fmt, len);
+            if(WriteAll(fd, buf, EVENT_SIZE + len) != 0)
+            {
+                goto end;
+            }
+            records++;
+        }
+    }
+    status = 0;
+
+    end:
+    __atomic_sub_fetch(&dumping, 1, __ATOMIC_SEQ_CST);
+    if(close(fd) != 0)
+    {
+        status = -1;
+    }
+    if(pRecords)
+    {
+        *pRecords = records;
+    }
+    return status;
+}
+
+const char *WA_TRACE_File(void)
+{
+    return file;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+static void CreateKey(void)
+{
+    /* no logging, it would record an event and recurse */
+    (void)pthread_key_create(&ringKey, ReleaseRing);
+    (void)pthread_atfork(NULL, NULL, AtForkChild);
+}
+
+static void AtForkChild(void)
+{
+    /* the forking task goes on in the child with its ring */
+    if(pTaskRing != NULL)
+    {
+        pTaskRing->tid = (uint32_t)syscall(SYS_gettid);
+    }
+}
+
+static void ReleaseRing(void *p)
+{
+    __atomic_store_n(&((WA_TRACE_Ring_t *)p)->used, 0, __ATOMIC_RELEASE);
+}
+
+static WA_TRACE_Ring_t *TaskRing(void)
+{
+    WA_TRACE_Ring_t *pRing;
+    int unused;
+
+    if(pTaskRing != NULL)
+    {
+        return pTaskRing;
+    }
+
+    pthread_once(&keyOnce, CreateKey);
+
+    for(pRing = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); pRing != NULL; pRing = pRing->next)
+    {
+        unused = 0;
+        if(__atomic_compare_exchange_n(&pRing->used, &unused, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+
+    if(pRing == NULL)
+    {
+        pRing = calloc(1, sizeof(WA_TRACE_Ring_t));
+        if(pRing == NULL)
+        {
+            return NULL;
+        }
+        pRing->used = 1;
+        pRing->next = __atomic_load_n(&rings, __ATOMIC_RELAXED);
+        while(!__atomic_compare_exchange_n(&rings, &pRing->next, pRing, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+    }
+
+    pRing->tid = (uint32_t)syscall(SYS_gettid);
+    pthread_setspecific(ringKey, pRing);
+    pTaskRing = pRing;
+    return pRing;
+}
+
+static uint64_t Now(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Takes the arguments of the format off the list, each by its own type, and keeps the
+ * first WA_TRACE_MAX_ARGS cast to integers the way WA_TRACE() does.
+ */
+static unsigned int CollectArgs(const char *fmt, va_list ap, uintptr_t *args)
+{
+    unsigned int nargs = 0;
+    uintptr_t v;
+    int longs;
+
+    for(; *fmt; ++fmt)
+    {
+        if((*fmt != '%') || (*++fmt == '%'))
+        {
+            continue;
+        }
+
+        for(; *fmt && strchr("-+ #0123456789.*", *fmt); ++fmt)
+        {
+            if(*fmt == '*')
+            {
+                v = (uintptr_t)va_arg(ap, int);
+                if(nargs < WA_TRACE_MAX_ARGS)
+                {
+                    args[nargs] = v;
+                }
+                ++nargs;
+            }
+        }
+
+        for(longs = 0; *fmt && strchr("hlLqjzt", *fmt); ++fmt)
+        {
+            /* size_t and ptrdiff_t are as wide as a long */
+            longs += (*fmt == 'h') ? 0 : strchr("lzt", *fmt) ? 1 : 2;
+        }
+
+        switch(*fmt)
+        {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            v = (longs >= 2) ? (uintptr_t)va_arg(ap, long long) :
+                (longs == 1) ? (uintptr_t)va_arg(ap, long) : (uintptr_t)va_arg(ap, int);
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            v = (longs >= 2) ? (uintptr_t)va_arg(ap, long double) : (uintptr_t)va_arg(ap, double);
+            break;
+        case 's':
+        case 'p':
+        case 'n':
+            v = (uintptr_t)va_arg(ap, void *);
+            break;
+        default:
+            /* unknown, nothing more can be told apart */
+            return nargs;
+        }
+
+        if(nargs < WA_TRACE_MAX_ARGS)
+        {
+            args[nargs] = v;
+        }
+        ++nargs;
+    }
+
+    return nargs;
+}
+
+static int WriteAll(int fd, const void *buf, size_t size)
+{
+    const unsigned char *p = buf;
+    ssize_t n;
+
+    while(size)
+    {
+        n = write(fd, p, size);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static void CrashDump(int sig)
+{
+    enabled = false;
+    (void)WA_TRACE_Dump(crashFile, NULL);
+}
+
+/* End of doxygen group */
+/*! @} */
+
+/* EOF */
@@ -0,0 +1,165 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file wa_trace.h
+ *
+ * @brief Interface of the agent binary trace.
+ *
+ * \c WA_ENTER, \c WA_RETURN and the other \c wa_debug.h macros record an event in
+ * the ring of the calling task: a timestamp, the address of the format string and
+ * the first \c WA_TRACE_MAX_ARGS arguments cast to integers. Nothing is formatted
+ * on the hot path; the rings are dumped to a file on request or on a crash and the
+ * file is decoded offline with hwst_trace_decode.
+ */
+
+/** @addtogroup WA_TRACE
+ *  @{
+ */
+
+#ifndef WA_TRACE_H
+#define WA_TRACE_H
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <stdint.h>
+
+/*****************************************************************************
+ * PROJECT-SPECIFIC INCLUDE FILES
+ *****************************************************************************/
+#include "wa_json.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*****************************************************************************
+ * EXPORTED DEFINITIONS
+ *****************************************************************************/
+
+/** Events kept per task, a power of 2 */
+#define WA_TRACE_RING_SIZE 256
+
+/** Arguments kept per event */
+#define WA_TRACE_MAX_ARGS 4
+
+/** Prefix of the syslog lines of \c WA_TRACE_Log(), not kept in the trace */
+#define WA_TRACE_LOG_PREFIX "HWST_LOG |"
+
+/** Dump file format, see hwst_trace_decode */
+#define WA_TRACE_MAGIC "HWSTTRC"
+#define WA_TRACE_VERSION 1
+
+/**
+ * Records an event, \c fmt must be a string literal.
+ * Arguments are cast to \c uintptr_t, strings are kept as their addresses only.
+ */
+#define WA_TRACE(level, fmt...) WA_TRACE_EVENT_(level, fmt)
+
+#define WA_TRACE_EVENT_(level, fmt, args...) \
+    WA_TRACE_Event(level, "" fmt, \
+            WA_TRACE_NARGS_(0, ##args, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), \
+            WA_TRACE_ARGS_(0, ##args, 0, 0, 0, 0))
+#define WA_TRACE_NARGS_(z, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16, n, ...) n
+#define WA_TRACE_ARGS_(z, a, b, c, d, ...) (uintptr_t)(a), (uintptr_t)(b), (uintptr_t)(c), (uintptr_t)(d)
+
+/*****************************************************************************
+ * EXPORTED FUNCTIONS
+ *****************************************************************************/
+
+/**
+ * @brief Initialises the trace and hooks the dump into the fatal signal handlers.
+ * Events are recorded from the process start, before the initialisation.
+ *
+ * @param config the "trace" configuration section, NULL for the defaults:
+ *        "enabled" (true), "file" ("/tmp/hwselftest.trace") the file written by
+ *        \c WA_TRACE_Dump() when no other is given, "crash_file"
+ *        ("/opt/logs/hwselftest.trace.crash") the file written on a crash.
+ *
+ * @returns Operation status.
+ * @retval 0 for success, non-zero otherwise
+ */
+int WA_TRACE_Init(json_t *config);
+
+/**
+ * @brief Removes the fatal signal hooks.
+ *
+ * @returns Operation status.
+ * @retval 0 for success, non-zero otherwise
+ */
+int WA_TRACE_Exit(void);
+
+/**
+ * @brief Records an event in the ring of the calling task, see \c WA_TRACE().
+ *
+ * @param level event level, one of '>' (enter), '<' (return), 'E', 'W', 'I', 'D'
+ * @param fmt the format string, must stay mapped, see \c WA_TRACE_Forget()
+ * @param nargs number of the format arguments, may be above \c WA_TRACE_MAX_ARGS
+ */
+void WA_TRACE_Event(char level, const char *fmt, unsigned int nargs,
+        uintptr_t a0, uintptr_t a1, uintptr_t a2, uintptr_t a3);
+
+/**
+ * @brief Records an event like \c WA_TRACE_Event() and writes the message to the RDK log.
+ * The arguments are evaluated once, by the caller, for both; see \c WA_ERROR() and the like.
+ *
+ * @param level the RDK log level
+ * @param trace the event level, see \c WA_TRACE_Event()
+ * @param fmt \c WA_TRACE_LOG_PREFIX followed by the format string, must stay mapped
+ */
+void WA_TRACE_Log(int level, char trace, const char *fmt, ...);
+
+/**
+ * @brief Drops the format strings of an object about to be unmapped, e.g. a diag plugin.
+ * The events stay, with a placeholder format. Returns once no dump reads the old ones.
+ *
+ * @param start the start of the object
+ * @param size size of the object
+ */
+void WA_TRACE_Forget(const void *start, size_t size);
+
+/**
+ * @brief Writes the rings of all the tasks to a file.
+ * Only async-signal-safe calls are used, so it may run from a signal handler.
+ *
+ * @param file the file, NULL for the configured one
+ * @param pRecords where to store the number of events written, might be NULL
+ *
+ * @returns Operation status.
+ * @retval 0 for success, non-zero otherwise
+ */
+int WA_TRACE_Dump(const char *file, unsigned int *pRecords);
+
+/**
+ * @brief Gets the file \c WA_TRACE_Dump() writes to by default.
+ *
+ * @returns the file name
+ */
+const char *WA_TRACE_File(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WA_TRACE_H */
+
+/* EOF */
@@ -0,0 +1,985 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file hwst_replay.c
+ *
+ * @brief Replays a JSON-RPC capture of the agent (see WA_COMM_RecordStart()) against
+ *        a running agent and diffs the replies with the recorded ones.
+ *
+ * The requests are sent over the WebSocket adapter at the recorded pace, divided by
+ * the speed. A request is never sent before the replies the client had received
+ * before it, so a client that waited for an "eod" still does. The replies are
+ * matched to the recorded ones by the request id and, for the "eod", by the diag
+ * instance its ack named. For each one the time from the request and the content
+ * are compared; the progress notifications are coalesced by the agent and only
+ * counted. Run the agent built with --enable-hw-sim to replay off the box.
+ *
+ * Exits with 0 when all the replies came, equal and not slower than the tolerance.
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <jansson.h>
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+/* must match core/wa_comm.h and core/wa_comm.c */
+#define CAPTURE_MAGIC "HWSTCAP"
+#define CAPTURE_VERSION 1
+#define HEADER_SIZE (8 + 4 + 4 + 8)
+#define FRAME_SIZE (8 + 4 + 4 + 1)
+
+#define DEFAULT_PORT 8003
+#define DEFAULT_TOLERANCE 50 /* [%] */
+#define DEFAULT_WAIT 30000 /* [ms] */
+#define SLOWER_FLOOR 5000 /* [us], a smaller difference is noise */
+#define IGNORED_MAX 16
+
+#define WS_KEY "dGhlIHNhbXBsZSBub25jZQ=="
+#define WS_HANDSHAKE_MAX 1024
+#define WS_FRAME_HEADER_MAX 14
+#define WS_MSG_MAX (16 * 1024 * 1024)
+#define WS_FIN 0x80
+#define WS_OPCODE_TEXT 0x1
+#define WS_OPCODE_CLOSE 0x8
+#define WS_OPCODE_CONTROL 0x8
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+typedef struct
+{
+    uint64_t ts; /* [us] since the start of the capture */
+    uint32_t connection;
+    char direction;
+    char *text;
+    json_t *json; /* NULL when not valid JSON */
+} Frame_t;
+
+/* A replayed request, its replay id is its index + 1 */
+typedef struct
+{
+    const Frame_t *pFrame;
+    uint64_t sent; /* [us] */
+    bool answered;
+} Request_t;
+
+typedef struct
+{
+    char *recorded;
+    char *replayed;
+    size_t request; /* index of the request that created it */
+} Instance_t;
+
+typedef struct
+{
+    json_t *json;
+    uint64_t ts; /* [us] */
+    bool matched;
+} Reply_t;
+
+typedef struct
+{
+    int fd;
+    double speed;
+    unsigned int tolerance;
+    unsigned int wait;
+    const char *ignored[IGNORED_MAX];
+    unsigned int ignoredCount;
+
+    Request_t *requests;
+    size_t requestsCount;
+    Instance_t *instances;
+    size_t instancesCount;
+    Reply_t *replies;
+    size_t repliesCount, repliesSize;
+
+    unsigned int matched, missing, different, slower, progress;
+} Replay_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static Frame_t *Load(const char *file, size_t *pCount);
+static void Dump(const Frame_t *frames, size_t count);
+static int Replay(Replay_t *pReplay, const Frame_t *frames, size_t count);
+static int Send(Replay_t *pReplay, const Frame_t *pFrame);
+static uint64_t Expect(Replay_t *pReplay, const Frame_t *pFrame);
+static Reply_t *Find(Replay_t *pReplay, const Frame_t *pFrame, size_t *pRequest, const char **pRecordedDiag);
+static void Compare(Replay_t *pReplay, const Frame_t *pFrame, const Reply_t *pReply, size_t request, const char *recordedDiag);
+static json_t *Normalize(const Replay_t *pReplay, json_t *json, json_t *id, const char *diag);
+static const char *Diag(json_t *json);
+static int Pump(Replay_t *pReplay, uint64_t until);
+static int WsConnect(int port);
+static int WsSend(int fd, const char *text, size_t len);
+static char *WsReceive(int fd);
+static int SendAll(int fd, const void *buf, size_t len);
+static int RecvAll(int fd, void *buf, size_t len);
+static uint64_t Now(void);
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+int main(int argc, char *argv[])
+{
+    Replay_t replay;
+    Frame_t *frames;
+    size_t count, i;
+    int port = DEFAULT_PORT, status = 1, opt;
+    bool dump = false;
+
+    memset(&replay, 0, sizeof(replay));
+    replay.speed = 1;
+    replay.tolerance = DEFAULT_TOLERANCE;
+    replay.wait = DEFAULT_WAIT;
+    replay.ignored[replay.ignoredCount++] = "timestamp";
+
+    while((opt = getopt(argc, argv, "dp:s:t:w:i:")) != -1)
+    {
+        switch(opt)
+        {
+        case 'd':
+            dump = true;
+            break;
+        case 'p':
+            port = atoi(optarg);
+            break;
+        case 's':
+            replay.speed = atof(optarg);
+            break;
+        case 't':
+            replay.tolerance = atoi(optarg);
+            break;
+        case 'w':
+            replay.wait = atoi(optarg);
+            break;
+        case 'i':
+            if(replay.ignoredCount < IGNORED_MAX)
+            {
+                replay.ignored[replay.ignoredCount++] = optarg;
+            }
+            break;
+        default:
+            optind = argc + 1;
+            break;
+        }
+    }
+
+    if(optind != argc - 1)
+    {
+        fprintf(stderr, "usage: %s [-d] [-p port] [-s speed] [-t tolerance] [-w wait] [-i key]... <capture file>\n"
+                "  -d  print the capture and exit\n"
+                "  -p  port of the agent WebSocket adapter (%d)\n"
+                "  -s  speed, 1 the recorded pace, 10 ten times faster, 0 as fast as the replies come (1)\n"
+                "  -t  slower than the recorded by more than this [%%] is a regression (%d)\n"
+                "  -w  wait for a reply [ms] (%d)\n"
+                "  -i  a key left out of the comparison, \"timestamp\" always is\n",
+                argv[0], DEFAULT_PORT, DEFAULT_TOLERANCE, DEFAULT_WAIT);
+        return 2;
+    }
+
+    frames = Load(argv[optind], &count);
+    if(frames == NULL)
+    {
+        return 1;
+    }
+
+    if(dump)
+    {
+        Dump(frames, count);
+        status = 0;
+        goto end;
+    }
+
+    replay.fd = WsConnect(port);
+    if(replay.fd < 0)
+    {
+        goto end;
+    }
+
+    status = Replay(&replay, frames, count);
+    close(replay.fd);
+
+    for(i = 0; i < replay.instancesCount; ++i)
+    {
+        free(replay.instances[i].recorded);
+        free(replay.instances[i].replayed);
+    }
+    free(replay.instances);
+    free(replay.requests);
+    for(i = 0; i < replay.repliesCount; ++i)
+    {
+        json_decref(replay.replies[i].json);
+    }
+    free(replay.replies);
+
+end:
+    for(i = 0; i < count; ++i)
+    {
+        free(frames[i].text);
+        json_decref(frames[i].json);
+    }
+    free(frames);
+    return status;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+static Frame_t *Load(const char *file, size_t *pCount)
+{
+    unsigned char hdr[HEADER_SIZE], buf[FRAME_SIZE];
+    Frame_t *frames = NULL, *pFrame;
+    size_t count = 0, size = 0;
+    uint32_t version, len;
+    FILE *f;
+
+    f = fopen(file, "rb");
+    if(f == NULL)
+    {
+        perror(file);
+        return NULL;
+    }
+
+    if((fread(hdr, 1, HEADER_SIZE, f) != HEADER_SIZE) || memcmp(hdr, CAPTURE_MAGIC, 8))
+    {
+        fprintf(stderr, "%s: not a capture\n", file);
+        fclose(f);
+        return NULL;
+    }
+    memcpy(&version, hdr + 8, 4);
+    if(version != CAPTURE_VERSION)
+    {
+        fprintf(stderr, "%s: unsupported version %u\n", file, version);
+        fclose(f);
+        return NULL;
+    }
+
+    while(fread(buf, 1, FRAME_SIZE, f) == FRAME_SIZE)
+    {
+        if(count == size)
+        {
+            size = size ? size * 2 : 256;
+            pFrame = realloc(frames, size * sizeof(Frame_t));
+            if(pFrame == NULL)
+            {
+                fprintf(stderr, "out of memory\n");
+                break;
+            }
+            frames = pFrame;
+        }
+        pFrame = &frames[count];
+        memcpy(&pFrame->ts, buf, 8);
+        memcpy(&pFrame->connection, buf + 8, 4);
+        memcpy(&len, buf + 12, 4);
+        pFrame->direction = (char)buf[16];
+        pFrame->text = malloc(len + 1);
+        if(pFrame->text == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            break;
+        }
+        if(fread(pFrame->text, 1, len, f) != len)
+        {
+            /* the agent stopped in the middle of a frame */
+            fprintf(stderr, "%s: truncated\n", file);
+            free(pFrame->text);
+            break;
+        }
+        pFrame->text[len] = '\0';
+        pFrame->json = ((pFrame->direction == '>') || (pFrame->direction == '<')) ?
+                json_loadb(pFrame->text, len, 0, NULL) : NULL;
+        count++;
+    }
+    fclose(f);
+
+    if(count == 0)
+    {
+        fprintf(stderr, "%s: no frames\n", file);
+        free(frames);
+        return NULL;
+    }
+
+    *pCount = count;
+    return frames;
+}
+
+static void Dump(const Frame_t *frames, size_t count)
+{
+    size_t i;
+
+    for(i = 0; i < count; ++i)
+    {
+        printf("%10.3f 0x%08" PRIx32 " %c %s\n", frames[i].ts / 1000.0, frames[i].connection,
+                frames[i].direction, frames[i].text);
+    }
+}
+
+static int Replay(Replay_t *pReplay, const Frame_t *frames, size_t count)
+{
+    uint64_t prevRecorded = frames[0].ts, prevReplayed = Now(), due;
+    unsigned int extra = 0;
+    const char *method;
+    size_t i;
+
+    pReplay->requests = calloc(count, sizeof(Request_t));
+    pReplay->instances = calloc(count, sizeof(Instance_t));
+    if(!pReplay->requests || !pReplay->instances)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    printf("# recorded [ms] replayed [ms] reply\n");
+    for(i = 0; i < count; ++i)
+    {
+        switch(frames[i].direction)
+        {
+        case '>':
+            /* the think time of the client, the time to the replies is the agent's */
+            due = prevReplayed + (pReplay->speed > 0 ? (uint64_t)((frames[i].ts - prevRecorded) / pReplay->speed) : 0);
+            if(Pump(pReplay, due) != 0)
+            {
+                fprintf(stderr, "the agent closed the connection\n");
+                return 1;
+            }
+            if(Send(pReplay, &frames[i]) != 0)
+            {
+                return 1;
+            }
+            prevReplayed = Now();
+            prevRecorded = frames[i].ts;
+            break;
+
+        case '<':
+            if(frames[i].json &&
+               (json_unpack(frames[i].json, "{s:s}", "method", &method) == 0) && strcmp(method, "eod"))
+            {
+                ++pReplay->progress;
+                break;
+            }
+            prevReplayed = Expect(pReplay, &frames[i]);
+            prevRecorded = frames[i].ts;
+            break;
+
+        default:
+            /* the connections come and go, the agent takes one WebSocket client at a time */
+            break;
+        }
+    }
+
+    for(i = 0; i < pReplay->repliesCount; ++i)
+    {
+        if(!pReplay->replies[i].matched && (json_unpack(pReplay->replies[i].json, "{s:s}", "method", &method) ||
+                                            !strcmp(method, "eod")))
+        {
+            ++extra;
+        }
+    }
+
+    printf("# %zu requests, %u replies matched, %u missing, %u extra, %u different, %u slower, %u progress notifications recorded\n",
+            pReplay->requestsCount, pReplay->matched, pReplay->missing, extra, pReplay->different, pReplay->slower,
+            pReplay->progress);
+
+    return (pReplay->missing || extra || pReplay->different || pReplay->slower) ? 1 : 0;
+}
+
+static int Send(Replay_t *pReplay, const Frame_t *pFrame)
+{
+    Request_t *pRequest;
+    json_t *json, *jid, *jparams;
+    const char *diag;
+    char *text;
+    size_t i;
+    int status;
+
+    if((pFrame->json == NULL) || !json_is_object(pFrame->json))
+    {
+        /* as recorded, the agent's answer to it is compared */
+        return WsSend(pReplay->fd, pFrame->text, strlen(pFrame->text));
+    }
+
+    json = json_deep_copy(pFrame->json);
+    if(json == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return -1;
+    }
+
+    /* the ids of all the recorded connections share the one connection */
+    jid = json_object_get(json, "id");
+    if(jid && !json_is_null(jid))
+    {
+        pRequest = &pReplay->requests[pReplay->requestsCount++];
+        pRequest->pFrame = pFrame;
+        json_object_set_new(json, "id", json_integer(pReplay->requestsCount));
+    }
+    else
+    {
+        pRequest = NULL;
+    }
+
+    /* a request about a recorded diag instance goes to the replayed one */
+    jparams = json_object_get(json, "params");
+    diag = Diag(jparams);
+    for(i = 0; diag && (i < pReplay->instancesCount); ++i)
+    {
+        if(!strcmp(pReplay->instances[i].recorded, diag))
+        {
+            json_object_set_new(jparams, "diag", json_string(pReplay->instances[i].replayed));
+            break;
+        }
+    }
+
+    text = json_dumps(json, JSON_COMPACT | JSON_PRESERVE_ORDER);
+    json_decref(json);
+    if(text == NULL)
+    {
+        fprintf(stderr, "json_dumps() error\n");
+        return -1;
+    }
+
+    if(pRequest)
+    {
+        pRequest->sent = Now();
+    }
+    status = WsSend(pReplay->fd, text, strlen(text));
+    free(text);
+    return status;
+}
+
+/* Returns when the reply came or stopped being waited for */
+static uint64_t Expect(Replay_t *pReplay, const Frame_t *pFrame)
+{
+    uint64_t deadline = Now() + pReplay->wait * 1000ULL;
+    const char *recordedDiag = NULL;
+    Reply_t *pReply;
+    size_t request;
+
+    for(;;)
+    {
+        pReply = Find(pReplay, pFrame, &request, &recordedDiag);
+        if(pReply)
+        {
+            pReply->matched = true;
+            ++pReplay->matched;
+            Compare(pReplay, pFrame, pReply, request, recordedDiag);
+            return pReply->ts;
+        }
+
+        if(request == (size_t)-1)
+        {
+            /* the request is not in the capture, it came before the recording started */
+            printf("%10s %10s SKIPPED %s\n", "-", "-", pFrame->text);
+            return Now();
+        }
+
+        if((Now() >= deadline) || (Pump(pReplay, deadline) != 0))
+        {
+            /* not to be taken for the reply to a later request with the same id */
+            pReplay->requests[request].answered = true;
+            ++pReplay->missing;
+            printf("%10s %10s MISSING %s\n", "-", "-", pFrame->text);
+            return Now();
+        }
+    }
+}
+
+/*
+ * Finds the reply to the recorded message, the request it answers is returned
+ * in pRequest or -1 if that is not known.
+ */
+static Reply_t *Find(Replay_t *pReplay, const Frame_t *pFrame, size_t *pRequest, const char **pRecordedDiag)
+{
+    json_t *jid = pFrame->json ? json_object_get(pFrame->json, "id") : NULL;
+    const char *diag = NULL, *replayedDiag = NULL;
+    json_int_t id;
+    size_t i, r = (size_t)-1;
+
+    *pRequest = (size_t)-1;
+
+    if(jid && !json_is_null(jid))
+    {
+        /* the oldest request of that connection with that id not answered yet */
+        for(i = 0; i < pReplay->requestsCount; ++i)
+        {
+            json_t *jrequestId = json_object_get(pReplay->requests[i].pFrame->json, "id");
+
+            if(!pReplay->requests[i].answered && (pReplay->requests[i].pFrame->connection == pFrame->connection) &&
+               json_equal(jrequestId, jid))
+            {
+                r = i;
+                break;
+            }
+        }
+        if(r == (size_t)-1)
+        {
+            return NULL;
+        }
+        *pRequest = r;
+
+        for(i = 0; i < pReplay->repliesCount; ++i)
+        {
+            if(!pReplay->replies[i].matched &&
+               (json_unpack(pReplay->replies[i].json, "{s:I}", "id", &id) == 0) && ((size_t)id == r + 1))
+            {
+                pReplay->requests[r].answered = true;
+                return &pReplay->replies[i];
+            }
+        }
+        return NULL;
+    }
+
+    /* an "eod", by the instance the ack named */
+    if(pFrame->json)
+    {
+        diag = Diag(json_object_get(pFrame->json, "params"));
+    }
+    for(i = 0; diag && (i < pReplay->instancesCount); ++i)
+    {
+        if(!strcmp(pReplay->instances[i].recorded, diag))
+        {
+            *pRequest = pReplay->instances[i].request;
+            *pRecordedDiag = pReplay->instances[i].recorded;
+            replayedDiag = pReplay->instances[i].replayed;
+            break;
+        }
+    }
+    if(replayedDiag == NULL)
+    {
+        return NULL;
+    }
+
+    for(i = 0; i < pReplay->repliesCount; ++i)
+    {
+        const char *method;
+
+        if(!pReplay->replies[i].matched &&
+           (json_unpack(pReplay->replies[i].json, "{s:s}", "method", &method) == 0) && !strcmp(method, "eod") &&
+           Diag(json_object_get(pReplay->replies[i].json, "params")) &&
+           !strcmp(Diag(json_object_get(pReplay->replies[i].json, "params")), replayedDiag))
+        {
+            return &pReplay->replies[i];
+        }
+    }
+    return NULL;
+}
+
+static void Compare(Replay_t *pReplay, const Frame_t *pFrame, const Reply_t *pReply, size_t request, const char *recordedDiag)
+{
+    const Request_t *pRequest = &pReplay->requests[request];
+    uint64_t recorded = pFrame->ts - pRequest->pFrame->ts;
+    uint64_t replayed = pReply->ts - pRequest->sent;
+    const char *diag, *verdict = "ok";
+    json_t *expected, *got;
+    Instance_t *pInstance;
+    char *text;
+    bool equal;
+
+    /* an ack names the instance, the "eod" and the later requests refer to it */
+    diag = Diag(json_object_get(pFrame->json, "result"));
+    if(diag && Diag(json_object_get(pReply->json, "result")))
+    {
+        pInstance = &pReplay->instances[pReplay->instancesCount++];
+        pInstance->recorded = strdup(diag);
+        pInstance->replayed = strdup(Diag(json_object_get(pReply->json, "result")));
+        pInstance->request = request;
+        recordedDiag = pInstance->recorded;
+    }
+
+    expected = Normalize(pReplay, pFrame->json, NULL, NULL);
+    got = Normalize(pReplay, pReply->json, json_object_get(pFrame->json, "id"), recordedDiag);
+    equal = expected && got && json_equal(expected, got);
+
+    if(!equal)
+    {
+        ++pReplay->different;
+        verdict = "DIFFERENT";
+    }
+    else if((replayed > recorded * (100 + pReplay->tolerance) / 100) && (replayed - recorded > SLOWER_FLOOR))
+    {
+        ++pReplay->slower;
+        verdict = "SLOWER";
+    }
+
+    printf("%10.3f %10.3f %s %s\n", recorded / 1000.0, replayed / 1000.0, verdict,
+            json_string_value(json_object_get(pRequest->pFrame->json, "method")) ?
+            json_string_value(json_object_get(pRequest->pFrame->json, "method")) : "?");
+    if(!equal)
+    {
+        printf("  - %s\n", pFrame->text);
+        text = got ? json_dumps(got, JSON_COMPACT | JSON_PRESERVE_ORDER) : NULL;
+        printf("  + %s\n", text ? text : "?");
+        free(text);
+    }
+
+    json_decref(expected);
+    json_decref(got);
+}
+
+/*
+ * A copy without the ignored keys, with the recorded id and diag instance in place
+ * of the replayed ones when given.
+ */
+static json_t *Normalize(const Replay_t *pReplay, json_t *json, json_t *id, const char *diag)
+{
+    json_t *copy, *jobject;
+    const char *objects[] = {"result", "params"};
+    unsigned int i;
+
+    copy = json ? json_deep_copy(json) : NULL;
+    if(copy == NULL)
+    {
+        return NULL;
+    }
+
+    if(id)
+    {
+        json_object_set(copy, "id", id);
+    }
+
+    for(i = 0; i < sizeof(objects) / sizeof(objects[0]); ++i)
+    {
+        jobject = json_object_get(copy, objects[i]);
+        if(diag && Diag(jobject))
+        {
+            json_object_set_new(jobject, "diag", json_string(diag));
+        }
+    }
+
+    /* at the top and in the "params" of a notification, where the "eod" has them */
+    for(i = 0; i < pReplay->ignoredCount; ++i)
+    {
+        json_object_del(copy, pReplay->ignored[i]);
+        json_object_del(json_object_get(copy, "params"), pReplay->ignored[i]);
+    }
+
+    return copy;
+}
+
+static const char *Diag(json_t *json)
+{
+    return json_string_value(json_object_get(json, "diag"));
+}
+
+/* Collects the replies until the given time */
+static int Pump(Replay_t *pReplay, uint64_t until)
+{
+    struct pollfd pfd;
+    Reply_t *pReply;
+    uint64_t now;
+    char *text;
+    int n;
+
+    for(;;)
+    {
+        now = Now();
+        pfd.fd = pReplay->fd;
+        pfd.events = POLLIN;
+        n = poll(&pfd, 1, (until > now) ? (int)((until - now + 999) / 1000) : 0);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        if(n == 0)
+        {
+            return 0;
+        }
+
+        text = WsReceive(pReplay->fd);
+        if(text == NULL)
+        {
+            return -1;
+        }
+
+        if(pReplay->repliesCount == pReplay->repliesSize)
+        {
+            pReplay->repliesSize = pReplay->repliesSize ? pReplay->repliesSize * 2 : 256;
+            pReply = realloc(pReplay->replies, pReplay->repliesSize * sizeof(Reply_t));
+            if(pReply == NULL)
+            {
+                fprintf(stderr, "out of memory\n");
+                free(text);
+                return -1;
+            }
+            pReplay->replies = pReply;
+        }
+
+        pReply = &pReplay->replies[pReplay->repliesCount];
+        pReply->ts = Now();
+        pReply->matched = false;
+        pReply->json = json_loads(text, 0, NULL);
+        free(text);
+        if(pReply->json != NULL)
+        {
+            ++pReplay->repliesCount;
+        }
+    }
+}
+
+static int WsConnect(int port)
+{
+    struct sockaddr_in address;
+    char buf[WS_HANDSHAKE_MAX];
+    size_t n;
+    int fd, on = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+    {
+        perror("socket()");
+        return -1;
+    }
+
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    /* the agent listens on the loopback only */
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if(connect(fd, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+        fprintf(stderr, "port %d: %s\n", port, strerror(errno));
+        goto err;
+    }
+
+    n = snprintf(buf, sizeof(buf), "GET / HTTP/1.1\r\nHost: 127.0.0.1:%d\r\nUpgrade: websocket\r\n"
+            "Connection: Upgrade\r\nSec-WebSocket-Key: " WS_KEY "\r\nSec-WebSocket-Version: 13\r\n\r\n", port);
+    if(SendAll(fd, buf, n) != 0)
+    {
+        fprintf(stderr, "handshake not sent\n");
+        goto err;
+    }
+
+    /* byte by byte, nothing past the handshake is to be read here */
+    for(n = 0; n < sizeof(buf) - 1; )
+    {
+        if(RecvAll(fd, buf + n, 1) != 0)
+        {
+            break;
+        }
+        ++n;
+        if((n >= 4) && !memcmp(buf + n - 4, "\r\n\r\n", 4))
+        {
+            break;
+        }
+    }
+    buf[n] = '\0';
+    if(strncmp(buf, "HTTP/1.1 101", 12))
+    {
+        /* the agent takes one client at a time */
+        fprintf(stderr, "handshake refused: %.32s\n", buf);
+        goto err;
+    }
+
+    return fd;
+
+err:
+    close(fd);
+    return -1;
+}
+
+static int WsSend(int fd, const char *text, size_t len)
+{
+    unsigned char header[WS_FRAME_HEADER_MAX];
+    size_t n, i;
+
+    header[0] = WS_FIN | WS_OPCODE_TEXT;
+    if(len < 126)
+    {
+        header[1] = 0x80 | len;
+        n = 2;
+    }
+    else if(len < 65536)
+    {
+        header[1] = 0x80 | 126;
+        header[2] = len >> 8;
+        header[3] = len & 0xff;
+        n = 4;
+    }
+    else
+    {
+        header[1] = 0x80 | 127;
+        for(i = 0; i < 8; ++i)
+        {
+            header[2 + i] = ((uint64_t)len >> (56 - 8 * i)) & 0xff;
+        }
+        n = 10;
+    }
+
+    /* a client must mask, the zero key leaves the payload as it is */
+    memset(header + n, 0, 4);
+    n += 4;
+
+    if((SendAll(fd, header, n) != 0) || (SendAll(fd, text, len) != 0))
+    {
+        fprintf(stderr, "send error: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/* Returns the next text message, NULL when the connection is closed */
+static char *WsReceive(int fd)
+{
+    unsigned char header[WS_FRAME_HEADER_MAX];
+    char *msg = NULL, *tmp;
+    size_t msgLen = 0;
+    uint64_t len;
+    unsigned int i, b;
+
+    for(;;)
+    {
+        if(RecvAll(fd, header, 2) != 0)
+        {
+            break;
+        }
+
+        /* the server frames are not masked */
+        len = header[1] & 0x7f;
+        if(len >= 126)
+        {
+            i = (len == 126) ? 2 : 8;
+            if(RecvAll(fd, header + 2, i) != 0)
+            {
+                break;
+            }
+            for(len = 0, b = 0; b < i; ++b)
+            {
+                len = (len << 8) | header[2 + b];
+            }
+        }
+        if(msgLen + len >= WS_MSG_MAX)
+        {
+            fprintf(stderr, "message too big\n");
+            break;
+        }
+
+        tmp = realloc(msg, msgLen + len + 1);
+        if(tmp == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            break;
+        }
+        msg = tmp;
+
+        if(RecvAll(fd, msg + msgLen, len) != 0)
+        {
+            break;
+        }
+
+        if((header[0] & 0x0f) == WS_OPCODE_CLOSE)
+        {
+            break;
+        }
+        if(header[0] & WS_OPCODE_CONTROL)
+        {
+            /* ping/pong, the payload is dropped */
+            continue;
+        }
+
+        msgLen += len;
+        if(header[0] & WS_FIN)
+        {
+            msg[msgLen] = '\0';
+            return msg;
+        }
+    }
+
+    free(msg);
+    return NULL;
+}
+
+static int SendAll(int fd, const void *buf, size_t len)
+{
+    const char *p = buf;
+    ssize_t n;
+
+    while(len > 0)
+    {
+        n = send(fd, p, len, MSG_NOSIGNAL);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int RecvAll(int fd, void *buf, size_t len)
+{
+    char *p = buf;
+    ssize_t n;
+
+    while(len > 0)
+    {
+        n = recv(fd, p, len, 0);
+        if(n <= 0)
+        {
+            if((n < 0) && (errno == EINTR))
+            {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static uint64_t Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* EOF */
@@ -0,0 +1,311 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+/**
+ * @file hwst_trace_decode.c
+ *
+ * @brief Offline decoder of the agent binary trace dumps (see core/wa_trace.c).
+ *
+ * Prints the events of all the tasks merged in time order, one per line:
+ * the wall clock time, the thread id, the level and the formatted message.
+ * String arguments are not in the dump, they are printed as their addresses.
+ *
+ * Standalone on purpose, to build on the host: cc -o hwst_trace_decode hwst_trace_decode.c
+ */
+
+/*****************************************************************************
+ * STANDARD INCLUDE FILES
+ *****************************************************************************/
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*****************************************************************************
+ * LOCAL DEFINITIONS
+ *****************************************************************************/
+/* must match core/wa_trace.h and core/wa_trace.c */
+#define TRACE_MAGIC "HWSTTRC"
+#define TRACE_VERSION 1
+#define TRACE_MAX_ARGS 4
+#define HEADER_SIZE (8 + 4 + 4 + 8 + 8)
+#define EVENT_SIZE (8 + 4 + 2 + 1 + 1 + 8 * TRACE_MAX_ARGS)
+
+/*****************************************************************************
+ * LOCAL TYPES
+ *****************************************************************************/
+typedef struct
+{
+    uint64_t ts;
+    uint32_t tid;
+    uint16_t nargs;
+    char level;
+    uint64_t args[TRACE_MAX_ARGS];
+    char fmt[256];
+} Event_t;
+
+/*****************************************************************************
+ * LOCAL FUNCTION PROTOTYPES
+ *****************************************************************************/
+static int CompareEvents(const void *a, const void *b);
+static void PrintMessage(const Event_t *pEvent, unsigned int ptrSize);
+
+/*****************************************************************************
+ * FUNCTION DEFINITIONS
+ *****************************************************************************/
+int main(int argc, char *argv[])
+{
+    FILE *f;
+    unsigned char hdr[HEADER_SIZE], buf[EVENT_SIZE];
+    uint32_t version, ptrSize;
+    uint64_t dumpMono, dumpReal, wall;
+    Event_t *events = NULL, *pEvent;
+    size_t count = 0, size = 0, i;
+    unsigned int len;
+    struct tm tm;
+    time_t sec;
+    char stamp[32];
+
+    if(argc != 2)
+    {
+        fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+        return 2;
+    }
+
+    f = fopen(argv[1], "rb");
+    if(f == NULL)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    if((fread(hdr, 1, HEADER_SIZE, f) != HEADER_SIZE) || memcmp(hdr, TRACE_MAGIC, 8))
+    {
+        fprintf(stderr, "%s: not a trace dump\n", argv[1]);
+        fclose(f);
+        return 1;
+    }
+    memcpy(&version, hdr + 8, 4);
+    memcpy(&ptrSize, hdr + 12, 4);
+    memcpy(&dumpMono, hdr + 16, 8);
+    memcpy(&dumpReal, hdr + 24, 8);
+    if(version != TRACE_VERSION)
+    {
+        fprintf(stderr, "%s: unsupported version %u\n", argv[1], version);
+        fclose(f);
+        return 1;
+    }
+
+    while(fread(buf, 1, EVENT_SIZE, f) == EVENT_SIZE)
+    {
+        if(count == size)
+        {
+            size = size ? size * 2 : 1024;
+            pEvent = realloc(events, size * sizeof(Event_t));
+            if(pEvent == NULL)
+            {
+                fprintf(stderr, "out of memory\n");
+                free(events);
+                fclose(f);
+                return 1;
+            }
+            events = pEvent;
+        }
+        pEvent = &events[count];
+        memcpy(&pEvent->ts, buf, 8);
+        memcpy(&pEvent->tid, buf + 8, 4);
+        memcpy(&pEvent->nargs, buf + 12, 2);
+        pEvent->level = (char)buf[14];
+        len = buf[15];
+        for(i = 0; i < TRACE_MAX_ARGS; i++)
+        {
+            memcpy(&pEvent->args[i], buf + 16 + 8 * i, 8);
+        }
+        if(fread(pEvent->fmt, 1, len, f) != len)
+        {
+            fprintf(stderr, "%s: truncated\n", argv[1]);
+            break;
+        }
+        pEvent->fmt[len] = '\0';
+        count++;
+    }
+    fclose(f);
+
+    qsort(events, count, sizeof(Event_t), CompareEvents);
+
+    for(i = 0; i < count; i++)
+    {
+        /* monotonic to wall clock, by the two timestamps taken at the dump */
+        wall = dumpReal - (dumpMono - events[i].ts);
+        sec = (time_t)(wall / 1000000000ULL);
+        gmtime_r(&sec, &tm);
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+        printf("%s.%06" PRIu64 " %5" PRIu32 " %c ", stamp, (uint64_t)((wall % 1000000000ULL) / 1000), events[i].tid, events[i].level);
+        PrintMessage(&events[i], ptrSize);
+    }
+
+    free(events);
+    return 0;
+}
+
+/*****************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************/
+static int CompareEvents(const void *a, const void *b)
+{
+    const Event_t *pA = a, *pB = b;
+
+    return (pA->ts > pB->ts) - (pA->ts < pB->ts);
+}
+
+/**
+ * Formats the message as printf() would, from the integer arguments kept in the dump.
+ */
+static void PrintMessage(const Event_t *pEvent, unsigned int ptrSize)
+{
+    const char *p = pEvent->fmt;
+    char spec[32];
+    size_t specLen;
+    unsigned int arg = 0;
+    int longs;
+    uint64_t v;
+    size_t i;
+    bool narrow;
+    bool newline = false;
+
+    while(*p)
+    {
+        if(*p != '%')
+        {
+            newline = (*p == '\n');
+            putchar(*p++);
+            continue;
+        }
+        if(p[1] == '%')
+        {
+            putchar('%');
+            p += 2;
+            continue;
+        }
+
+        /* flags, width and precision are kept, the length is replaced */
+        specLen = strspn(p + 1, "-+ #0123456789.*") + 1;
+        if(specLen >= sizeof(spec) - 4)
+        {
+            specLen = sizeof(spec) - 4;
+        }
+        memcpy(spec, p, specLen);
+        p += specLen;
+        spec[specLen] = '\0';
+        if(strchr(spec, '*'))
+        {
+            /* the width and precision arguments are skipped along */
+            for(i = 0; spec[i]; i++)
+            {
+                arg += (spec[i] == '*');
+            }
+            specLen = 1;
+        }
+
+        longs = 0;
+        while(strchr("hlLqjzt", *p) && *p)
+        {
+            longs += (*p == 'l' || *p == 'q' || *p == 'j' || *p == 'z' || *p == 't') ? 1 : 0;
+            longs += (*p == 'L') ? 2 : 0;
+            p++;
+        }
+        if(*p == '\0')
+        {
+            break;
+        }
+
+        if((arg >= pEvent->nargs) || (arg >= TRACE_MAX_ARGS))
+        {
+            /* not recorded */
+            fputs("?", stdout);
+            arg++;
+            p++;
+            continue;
+        }
+        v = pEvent->args[arg++];
+
+        /* values narrower than 64 bits were zero extended in the dump */
+        narrow = (longs < 2) && ((ptrSize < 8) || (longs == 0));
+        if(narrow)
+        {
+            v &= 0xffffffffULL;
+        }
+
+        switch(*p)
+        {
+        case 'd':
+        case 'i':
+            if(narrow)
+            {
+                v = (uint64_t)(int64_t)(int32_t)(uint32_t)v;
+            }
+            memcpy(spec + specLen, "lld", 4);
+            printf(spec, (long long)v);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            spec[specLen] = 'l';
+            spec[specLen + 1] = 'l';
+            spec[specLen + 2] = *p;
+            spec[specLen + 3] = '\0';
+            printf(spec, (unsigned long long)v);
+            break;
+        case 'c':
+            putchar((int)(v & 0xff));
+            break;
+        case 'p':
+            printf("0x%" PRIx64, v);
+            break;
+        case 's':
+            printf("<str@0x%" PRIx64 ">", v);
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+            /* recorded as an integer */
+            printf("%lld", (long long)v);
+            break;
+        default:
+            printf("<%%%c>", *p);
+            break;
+        }
+        p++;
+    }
+
+    if(!newline)
+    {
+        putchar('\n');
+    }
+}
+
+/* EOF */
@@ -37,6 +37,7 @@
 #include <signal.h>
 #include <semaphore.h>
 #include <sys/time.h>
+#include <time.h>
 #include <errno.h>
 
 #include "breakpad_wrapper.h"
@@ -49,14 +50,17 @@
 #include "wa_comm_ws.h"
 #include "wa_debug.h"
 #include "wa_diag.h"
-#include "wa_iarm.h"
 #include "wa_init.h"
 #include "wa_json.h"
 #include "wa_osa.h"
 #include "wa_stest.h"
-#include "wa_snmp_client.h"
 #include "wa_log.h"
 #include "wa_config.h"
+#include "wa_throttle.h"
+#include "wa_metrics.h"
+#include "wa_trace.h"
+#include "wa_rmf.h"
+#include "wa_sim.h"
 #include "wa_version.h"
 
 /*****************************************************************************
@@ -85,6 +89,7 @@ static void *childInitSem;
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
 static void sig_usr(int signo);
+static void phase_up(const char *phase, struct timespec *pStart);
 
 /*****************************************************************************
  * FUNCTION DEFINITIONS
@@ -96,6 +101,7 @@ int main(int argc, char *argv[])
     const char * configFileName = NULL;
     struct sigaction sa_new, sa_old;
     pid_t ppid, pid, sid;
+    struct timespec childStart, phaseStart;
 
     WA_ENTER("main(argc=%d) [PARENT]\n", argc);
 
@@ -173,6 +179,9 @@ int main(int argc, char *argv[])
 
     WA_ENTER("main(argc=%d) [CHILD]\n", argc);
 
+    clock_gettime(CLOCK_MONOTONIC, &childStart);
+    phaseStart = childStart;
+
     if(sigaction(SIGUSR1, &sa_old, NULL) == -1)
     {
         CLIENT_LOG("hwselftest: failed to restore previous signal handler for SIGUSR1");
@@ -199,6 +208,7 @@ int main(int argc, char *argv[])
         exitReason = 1;
         goto end;
     }
+    phase_up("osa", &phaseStart);
 
     quitCondVar = WA_OSA_CondCreate();
     if(quitCondVar == NULL)
@@ -215,26 +225,75 @@ int main(int argc, char *argv[])
         exitReason = 3;
         goto err_config;
     }
+    phase_up("config", &phaseStart);
 
-    status = WA_UTILS_IARM_Init();
+    status = WA_TRACE_Init(WA_CONFIG_GetSection("trace"));
     if(status != 0)
     {
-        WA_ERROR("WA_UTILS_IARM_Init():%d\n", status);
-        exitReason = 4;
-        goto err_iarm;
+        WA_ERROR("WA_TRACE_Init():%d\n", status);
+        exitReason = 3;
+        goto err_trace;
     }
+    phase_up("trace", &phaseStart);
+
+    /* IARM and SNMP come up with the first diag that needs them, see WA_DIAG_Need() */
 
-    status = WA_UTILS_SNMP_Init();
+#ifdef WA_STEST
+    status = WA_STEST_Run();
+#else
+    {
+        int rate;
+        const char *queue;
+        json_t *record;
+
+        if(json_unpack(WA_CONFIG_GetSection("comm"), "{s:i}", "progress_rate", &rate) == 0)
+        {
+            WA_COMM_SetProgressRate(rate > 0 ? rate : 0);
+        }
+
+        /* before WA_INIT_Init(), to have the connections from the start; the agent runs without */
+        if((json_unpack(WA_CONFIG_GetSection("comm"), "{s:o}", "record", &record) == 0) &&
+           (WA_COMM_RecordStart(record) != 0))
+        {
+            WA_ERROR("WA_COMM_RecordStart(): error, not recording\n");
+        }
+
+        /* before WA_INIT_Init(), which creates the queues */
+        if((json_unpack(WA_CONFIG_GetSection("osa"), "{s:s}", "queue", &queue) == 0) && !strcmp(queue, "local"))
+        {
+            WA_OSA_QSetBackend(WA_OSA_Q_BACKEND_LOCAL);
+        }
+    }
+
+    status = WA_THROTTLE_Init(WA_CONFIG_GetSection("throttle"));
     if(status != 0)
     {
-        WA_ERROR("WA_UTILS_SNMP_Init():%d\n", status);
-        exitReason = 5;
-        goto err_snmp;
+        WA_ERROR("WA_THROTTLE_Init():%d\n", status);
+        exitReason = 6;
+        goto err_throttle;
     }
+    phase_up("throttle", &phaseStart);
+
+    status = WA_METRICS_Init(WA_CONFIG_GetSection("metrics"));
+    if(status != 0)
+    {
+        WA_ERROR("WA_METRICS_Init():%d\n", status);
+        exitReason = 6;
+        goto err_metrics;
+    }
+    phase_up("metrics", &phaseStart);
+
+#ifdef WA_HW_SIM
+    status = WA_UTILS_SIM_StreamerStart(WA_UTILS_RMF_GetMediastreamerPort());
+    if(status != 0)
+    {
+        WA_ERROR("WA_UTILS_SIM_StreamerStart():%d\n", status);
+        exitReason = 6;
+        goto err_sim;
+    }
+    phase_up("sim", &phaseStart);
+#endif
 
-#ifdef WA_STEST
-    WA_STEST_Run();
-#else
     status = WA_INIT_Init(WA_CONFIG_GetAdapters(), WA_CONFIG_GetDiags());
     if(status != 0)
     {
@@ -242,7 +301,10 @@ int main(int argc, char *argv[])
         exitReason = 6;
         goto err_init;
     }
+    phase_up("init", &phaseStart);
 
+    /* the COMM is the last to come up, the listener is ready */
+    phase_up("agent", &childStart);
     WA_DBG("sending SIGUSR1\n");
     kill(ppid,SIGUSR1);  /* Send signal to parent process that initialization is complete */
 
@@ -278,22 +340,35 @@ int main(int argc, char *argv[])
     }
 
 err_init:
-#endif /* WA_STEST */
+#ifdef WA_HW_SIM
+    WA_UTILS_SIM_StreamerStop();
 
-    exitStatus = WA_UTILS_SNMP_Exit();
+err_sim:
+#endif
+    exitStatus = WA_METRICS_Exit();
     if(exitStatus != 0)
     {
-        WA_ERROR("WA_UTILS_SNMP_Exit(): error %d\n", exitStatus);
+        WA_ERROR("WA_METRICS_Exit(): error %d\n", exitStatus);
     }
 
-err_snmp:
-    exitStatus = WA_UTILS_IARM_Term();
+err_metrics:
+    exitStatus = WA_THROTTLE_Exit();
     if(exitStatus != 0)
     {
-        WA_ERROR("WA_UTILS_IARM_Term(): error %d\n", exitStatus);
+        WA_ERROR("WA_THROTTLE_Exit(): error %d\n", exitStatus);
     }
 
-err_iarm:
+err_throttle:
+    WA_COMM_RecordStop();
+#endif /* WA_STEST */
+
+    exitStatus = WA_TRACE_Exit();
+    if(exitStatus != 0)
+    {
+        WA_ERROR("WA_TRACE_Exit(): error %d\n", exitStatus);
+    }
+
+err_trace:
     exitStatus = WA_CONFIG_Exit();
     if(exitStatus != 0)
     {
@@ -328,6 +403,8 @@ end:
     else
         CLIENT_LOG("Agent exited");
 
+    WA_LOG_Exit();
+
     if (status)
         fprintf(stderr, "hwselftest: agent failed\n");
 
@@ -357,6 +434,17 @@ static void sig_usr(int signo)
         sem_post(childInitSem);
 }
 
+/* Reports the time since pStart and restarts it */
+static void phase_up(const char *phase, struct timespec *pStart)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    WA_INFO("main(): %s up in %ld ms\n", phase,
+            (now.tv_sec - pStart->tv_sec) * 1000 + (now.tv_nsec - pStart->tv_nsec) / 1000000);
+    *pStart = now;
+}
+
 /* End of doxygen group */
 /*! @} */
 
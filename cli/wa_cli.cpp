@@ -57,6 +57,10 @@ using namespace hwselftest;
 #define cliprintf(str, ...) printf(HWSELFTESTCLI_NAME ": " str, ##__VA_ARGS__)
 #define cliprintferr(str, ...) fprintf(stderr, HWSELFTESTCLI_NAME ": " str, ##__VA_ARGS__)
 
+/* HwTestResult2 telemetry of a periodic run skipped by the admission */
+#define SKIPPED_DRAM_TELEMETRY "N,N,N,N,N,N,N,N,N,N,N,N,N,N,F-254" /* WA_DIAG_ERRCODE_DRAM_THRESHOLD_EXCEEDED */
+#define SKIPPED_CPU_TELEMETRY  "N,N,N,N,N,N,N,N,N,N,N,N,N,N,F-255" /* WA_DIAG_ERRCODE_CPU_THRESHOLD_EXCEEDED */
+
 /*****************************************************************************
  * LOCAL TYPES
  *****************************************************************************/
@@ -64,7 +68,8 @@ using namespace hwselftest;
 /*****************************************************************************
  * LOCAL FUNCTION PROTOTYPES
  *****************************************************************************/
-static bool selftest_execute(wa_wsclient *pInst);
+static bool selftest_execute(wa_wsclient *pInst, bool load_aware = false);
+static bool selftest_execute_periodic(wa_wsclient *pInst);
 static bool selftest_enable_ptr(wa_wsclient *pInst, const char* freq, const char* cpu, const char* dram);
 #if WA_DEBUG
 static bool selftest_results(wa_wsclient *pInst, char **out_results);
@@ -90,6 +95,7 @@ int main(int argc, char * const argv[])
     enum {
         CMD_NONE,
         CMD_EXECUTE,
+        CMD_EXECUTE_PERIODIC,
         CMD_ENABLE_PTR // DELIA-42670: Added for a separate argument to not to club PTR set operations with existing code and leave existing logic untouched
 #if WA_DEBUG
         ,
@@ -144,7 +150,8 @@ int main(int argc, char * const argv[])
                 "    -h,--help        - show this help message\n" \
                 "\n" \
                 "commands:\n" \
-                "    execute          - executes the test suite\n"
+                "    execute          - executes the test suite\n" \
+                "    execute-periodic - executes the test suite if the system load allows it\n"
 #if WA_DEBUG
                 "    enable           - enables hwselftest\n" \
                 "    disable          - disables hwselftest\n" \
@@ -165,6 +172,9 @@ int main(int argc, char * const argv[])
         else if (!strcasecmp(argv[i], "execute"))
             cmd = CMD_EXECUTE;
 
+        else if (!strcasecmp(argv[i], "execute-periodic"))
+            cmd = CMD_EXECUTE_PERIODIC;
+
         /* DELIA-42670: 'enable-ptr' is called from hwst_init.sh with other required arguments for PTR set operation */
         /* Works correctly only with the same order and number of arguments passed */
         /* Usage: '/usr/bin/hwselftestcli enable-ptr <FREQ> <CPU> <DRAM>' */
@@ -237,6 +247,10 @@ int main(int argc, char * const argv[])
         status = selftest_execute(pInst);
         break;
 
+    case CMD_EXECUTE_PERIODIC:
+        status = selftest_execute_periodic(pInst);
+        break;
+
     case CMD_ENABLE_PTR:
         status = selftest_enable_ptr(pInst, freq, cpu, dram);
         break;
@@ -302,7 +316,7 @@ int main(int argc, char * const argv[])
 /*****************************************************************************
  * LOCAL FUNCTION DEFINITIONS
  *****************************************************************************/
-static bool selftest_execute(wa_wsclient *pInst)
+static bool selftest_execute(wa_wsclient *pInst, bool load_aware)
 {
     bool status;
 
@@ -314,11 +328,18 @@ static bool selftest_execute(wa_wsclient *pInst)
     }
     else
     {
-        status = pInst->execute_tests(true /* execute from cli */);
+        if (verbose_flag)
+        {
+            pInst->set_diag_callback([](const std::string& diag, const std::string& result) {
+                cliprintf("%s: %s\n", diag.c_str(), result.c_str());
+            });
+        }
+
+        status = pInst->execute_tests(true /* execute from cli */, load_aware);
         if (status)
         {
             cliprintf("self test scheduled\n");
-            status = pInst->wait();
+            status = pInst->wait(); /* blocks until the run completes or times out */
             if(status)
                 cliprintf("self test finished\n");
             else
@@ -326,10 +347,33 @@ static bool selftest_execute(wa_wsclient *pInst)
         }
         else
             cliprintferr("ERROR: failed to schedule self test\n");
+
+        pInst->set_diag_callback(nullptr);
     }
     return status;
 }
 
+static bool selftest_execute_periodic(wa_wsclient *pInst)
+{
+    std::string load;
+    hwst::Admission::verdict_t verdict = pInst->check_load(load);
+    const char *telemetry;
+
+    if (verdict == hwst::Admission::admit)
+    {
+        pInst->log("[PTR] Test execution triggered (" + load + ").\n");
+        return selftest_execute(pInst, true /* defer heavy diags while the load is high */);
+    }
+
+    telemetry = (verdict == hwst::Admission::deferDram) ? SKIPPED_DRAM_TELEMETRY : SKIPPED_CPU_TELEMETRY;
+    cliprintf("self test skipped, %s (%s)\n", hwst::Admission::verdictStr(verdict), load.c_str());
+    pInst->log(std::string("HwTestResult2: ") + telemetry + "\n");
+    t2_event_s((char *)"hwtest2_split", (char *)telemetry);
+    pInst->log("[PTR] Test execution skipped, no resources (" + load + ").\n");
+
+    return true;
+}
+
 static bool selftest_enable_ptr(wa_wsclient *pInst, const char* freq, const char* cpu, const char* dram)
 {
     if (!selftest_enable(pInst, true))
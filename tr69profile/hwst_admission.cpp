@@ -0,0 +1,397 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include <stdio.h>
+
+#include "hwst_admission.hpp"
+
+//#define HWST_DEBUG 1
+#ifdef HWST_DEBUG
+#define HWST_DBG(str) do {std::cout << "HWST_DBG |" << str << std::endl;} while(false)
+#else
+#define HWST_DBG(str) do {} while(false)
+#endif
+
+/* number of samples kept in the sliding window */
+#define WINDOW_SIZE 5
+
+/* min interval between samples taken while a run is in progress */
+#define REFRESH_INTERVAL std::chrono::seconds(1)
+
+/* predicted cost of a diag with no history yet [%] */
+#define DEFAULT_COST 5.0
+
+/* weight of the latest run in the cost average */
+#define COST_WEIGHT 0.3
+
+/* min time with no diag running to take its load as the new baseline */
+#define BASELINE_INTERVAL std::chrono::seconds(1)
+
+namespace hwst {
+
+Admission::Admission(const std::string &procRoot, const std::string &historyFile):
+    procRoot(procRoot),
+    historyFile(historyFile),
+    baseline(0),
+    accounting(false)
+{
+    HWST_DBG("Admission:" + procRoot);
+    load();
+}
+
+const char *Admission::verdictStr(verdict_t verdict)
+{
+    switch(verdict)
+    {
+    case admit:
+        return "admitted";
+    case deferDram:
+        return "not enough DRAM";
+    case deferCpu:
+        return "CPU load too high";
+    case deferPressure:
+        return "resource pressure too high";
+    }
+    return "unknown";
+}
+
+bool Admission::readStat(Sample &s) const
+{
+    std::ifstream stat(procRoot + "/stat");
+    std::string cpu;
+    uint64_t user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+
+    /* older kernels may miss the trailing fields, they stay 0 */
+    stat >> cpu >> user >> nice >> system >> idle;
+    if(!stat || (cpu != "cpu"))
+        return false;
+    stat >> iowait >> irq >> softirq >> steal;
+
+    s.busy = user + nice + system + irq + softirq + steal;
+    s.total = s.busy + idle + iowait;
+    return s.total != 0;
+}
+
+bool Admission::readMeminfo(Sample &s) const
+{
+    std::ifstream meminfo(procRoot + "/meminfo");
+    std::string key;
+    long value, memFree = -1, buffers = 0, cached = 0;
+
+    s.memAvailable = -1;
+    while(meminfo >> key >> value)
+    {
+        if(key == "MemAvailable:")
+            s.memAvailable = value;
+        else if(key == "MemFree:")
+            memFree = value;
+        else if(key == "Buffers:")
+            buffers = value;
+        else if(key == "Cached:")
+            cached = value;
+        meminfo.ignore(64, '\n');
+    }
+
+    /* kernels before 3.14 have no MemAvailable */
+    if((s.memAvailable < 0) && (memFree >= 0))
+        s.memAvailable = memFree + buffers + cached;
+
+    return s.memAvailable >= 0;
+}
+
+void Admission::readPressure(Sample &s) const
+{
+    static const char *resources[] = {"cpu", "memory", "io"};
+
+    s.pressure = -1;
+    for(auto r: resources)
+    {
+        std::ifstream psi(procRoot + "/pressure/" + r);
+        std::string line;
+        double avg10;
+
+        /* some avg10=1.23 avg60=0.50 avg300=0.10 total=12345 */
+        if(std::getline(psi, line) && (sscanf(line.c_str(), "some avg10=%lf", &avg10) == 1))
+            s.pressure = std::max(s.pressure, avg10);
+    }
+}
+
+bool Admission::sample(Sample &s) const
+{
+    if(!readStat(s))
+        return false;
+
+    readMeminfo(s);
+    readPressure(s);
+    return true;
+}
+
+/* Fills the window with samples taken over (samples - 1) * interval. */
+bool Admission::observe(unsigned int samples, std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> apiLock(apiMutex);
+    Sample s;
+
+    window.clear();
+    for(unsigned int i = 0; i < samples; i++)
+    {
+        if(i)
+            std::this_thread::sleep_for(interval);
+
+        if(!sample(s))
+            return false;
+
+        window.push_back(s);
+        if(window.size() > WINDOW_SIZE)
+            window.pop_front();
+    }
+    lastSample = std::chrono::steady_clock::now();
+    baseline = cpuLoad();
+    accounted = idleFrom = window.back();
+    idleAt = lastSample;
+    accounting = true;
+
+    return true;
+}
+
+void Admission::refresh()
+{
+    Sample s;
+    auto now = std::chrono::steady_clock::now();
+
+    if(!window.empty() && (now - lastSample < REFRESH_INTERVAL))
+        return;
+
+    if(sample(s))
+    {
+        window.push_back(s);
+        if(window.size() > WINDOW_SIZE)
+            window.pop_front();
+        lastSample = now;
+        account(s);
+    }
+}
+
+/* Splits the load since the last accounted sample among the diags running in the meantime */
+void Admission::account(const Sample &s)
+{
+    auto now = std::chrono::steady_clock::now();
+
+    if(!accounting)
+    {
+        accounted = idleFrom = s;
+        idleAt = now;
+        accounting = true;
+        return;
+    }
+
+    if(s.total <= accounted.total)
+        return;
+
+    if(!running.empty())
+    {
+        uint64_t slice = s.total - accounted.total;
+        double share = std::max(0.0, cpuLoad(accounted, s) - baseline) * slice / running.size();
+
+        for(auto &r: running)
+        {
+            r.second.total += slice;
+            r.second.charged += share;
+        }
+    }
+    else if(now - idleAt >= BASELINE_INTERVAL)
+    {
+        baseline = cpuLoad(idleFrom, s);
+        idleFrom = s;
+        idleAt = now;
+    }
+    accounted = s;
+}
+
+double Admission::cpuLoad(const Sample &from, const Sample &to) const
+{
+    if(to.total > from.total)
+        return 100.0 * (to.busy - from.busy) / (to.total - from.total);
+
+    /* no time passed, fall back to the load since boot */
+    return to.total ? 100.0 * to.busy / to.total : 0;
+}
+
+double Admission::cpuLoad() const
+{
+    return window.empty() ? 0 : cpuLoad(window.front(), window.back());
+}
+
+long Admission::memAvailable() const
+{
+    long mem = -1;
+
+    for(auto const& s: window)
+    {
+        if((s.memAvailable >= 0) && ((mem < 0) || (s.memAvailable < mem)))
+            mem = s.memAvailable;
+    }
+    return mem;
+}
+
+double Admission::pressure() const
+{
+    double p = -1;
+
+    for(auto const& s: window)
+        p = std::max(p, s.pressure);
+    return p;
+}
+
+/* Predicts whether the system can take the diag (or a run, for an empty name) right now */
+Admission::verdict_t Admission::check(const Limits &limits, const std::string &diag)
+{
+    std::lock_guard<std::mutex> apiLock(apiMutex);
+    long mem;
+    double p;
+
+    refresh();
+
+    mem = memAvailable();
+    if((mem >= 0) && (mem / 1024 < limits.dramMin))
+        return deferDram;
+
+    p = pressure();
+    if((p >= 0) && (p > limits.pressureMax))
+        return deferPressure;
+
+    if(cpuLoad() + (diag.empty() ? 0 : cost(diag)) > limits.cpuMax)
+        return deferCpu;
+
+    return admit;
+}
+
+double Admission::cost(const std::string &diag)
+{
+    auto it = costs.find(diag);
+    return (it != costs.end()) ? it->second.cpu : DEFAULT_COST;
+}
+
+void Admission::started(const std::string &diag)
+{
+    std::lock_guard<std::mutex> apiLock(apiMutex);
+    Sample s;
+
+    if(sample(s))
+    {
+        account(s);
+        running[diag] = running_t({0, 0});
+    }
+}
+
+/* The share of the diag in the load above the baseline over its lifetime is taken as its cost */
+void Admission::finished(const std::string &diag, bool record)
+{
+    std::lock_guard<std::mutex> apiLock(apiMutex);
+    Sample s;
+    auto it = running.find(diag);
+
+    if(it == running.end())
+        return;
+
+    if(!sample(s))
+        record = false;
+    else
+        account(s);
+
+    if(record && it->second.total)
+    {
+        double added = it->second.charged / it->second.total;
+        auto c = costs.find(diag);
+
+        if(c == costs.end())
+            costs[diag] = cost_t({added, 1});
+        else
+        {
+            c->second.cpu = (1 - COST_WEIGHT) * c->second.cpu + COST_WEIGHT * added;
+            c->second.runs++;
+        }
+        HWST_DBG("Admission: " + diag + " cost:" + std::to_string(costs[diag].cpu));
+    }
+    running.erase(it);
+
+    if(running.empty())
+    {
+        idleFrom = accounted;
+        idleAt = std::chrono::steady_clock::now();
+    }
+}
+
+void Admission::load()
+{
+    std::ifstream history(historyFile);
+    std::string line;
+
+    while(std::getline(history, line))
+    {
+        std::istringstream ss(line);
+        std::string diag;
+        cost_t c;
+
+        if(ss >> diag >> c.cpu >> c.runs)
+            costs[diag] = c;
+    }
+}
+
+bool Admission::save()
+{
+    std::lock_guard<std::mutex> apiLock(apiMutex);
+    std::string tmp = historyFile + ".tmp";
+
+    {
+        std::ofstream history(tmp, std::ios::trunc);
+        for(auto const& c: costs)
+            history << c.first << " " << c.second.cpu << " " << c.second.runs << "\n";
+        if(!history.flush())
+            return false;
+    }
+
+    return rename(tmp.c_str(), historyFile.c_str()) == 0;
+}
+
+std::string Admission::describe()
+{
+    std::lock_guard<std::mutex> apiLock(apiMutex);
+    std::ostringstream ss;
+    long mem = memAvailable();
+    double p = pressure();
+
+    ss << "CPU load: " << (int)(cpuLoad() + 0.5) << " %, free DRAM: ";
+    if(mem >= 0)
+        ss << mem / 1024 << " MB";
+    else
+        ss << "unknown";
+    if(p >= 0)
+        ss << ", pressure: " << p << " %";
+    return ss.str();
+}
+
+} // namespace hwst
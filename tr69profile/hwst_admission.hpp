@@ -0,0 +1,118 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef _HWST_ADMISSION_
+#define _HWST_ADMISSION_
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <stdint.h>
+
+namespace hwst {
+
+/* Load-aware admission of test runs and of single diags within a run.
+ * The system load is sampled from the procfs (stat, meminfo and PSI) over a sliding window,
+ * the cost of each diag is predicted from the load it caused in the previous runs.
+ * The load above the baseline is split evenly among the diags running at the same time,
+ * the baseline follows the load while no diag runs.
+ * The procfs root is configurable so that the controller can be driven by synthetic fixtures.
+ */
+class Admission
+{
+public:
+    enum verdict_t {
+        admit,
+        deferDram,
+        deferCpu,
+        deferPressure
+    };
+
+    struct Limits
+    {
+        int cpuMax;          /* max CPU load [%] */
+        int dramMin;         /* min available memory [MB] */
+        double pressureMax;  /* max PSI "some avg10" of cpu, memory or io [%] */
+        int maxDefer;        /* how long a diag can be deferred before it is skipped [s] */
+    };
+
+    struct Sample
+    {
+        uint64_t busy;       /* [jiffies] */
+        uint64_t total;      /* [jiffies] */
+        long memAvailable;   /* [kB], -1 if not known */
+        double pressure;     /* highest of the PSI values [%], -1 if PSI is not available */
+    };
+
+    Admission(const std::string &procRoot = "/proc", const std::string &historyFile = "/opt/.hwselftest_diag_costs");
+    bool observe(unsigned int samples, std::chrono::milliseconds interval);
+    verdict_t check(const Limits &limits, const std::string &diag = "");
+    double cost(const std::string &diag);
+    void started(const std::string &diag);
+    void finished(const std::string &diag, bool record);
+    bool save();
+    std::string describe();
+    static const char *verdictStr(verdict_t verdict);
+
+private:
+    struct cost_t
+    {
+        double cpu;          /* CPU load added by the diag [%], averaged over runs */
+        unsigned int runs;
+    };
+
+    struct running_t
+    {
+        uint64_t total;      /* [jiffies] accounted since the diag started */
+        double charged;      /* its share of the load above the baseline, [%] * [jiffies] */
+    };
+
+    bool sample(Sample &s) const;
+    bool readStat(Sample &s) const;
+    bool readMeminfo(Sample &s) const;
+    void readPressure(Sample &s) const;
+    void refresh();
+    void account(const Sample &s);
+    double cpuLoad(const Sample &from, const Sample &to) const;
+    double cpuLoad() const;
+    long memAvailable() const;
+    double pressure() const;
+    void load();
+
+    std::mutex apiMutex;
+    const std::string procRoot;
+    const std::string historyFile;
+    std::deque<Sample> window;
+    std::chrono::steady_clock::time_point lastSample;
+    double baseline;
+    Sample accounted;        /* the load up to here is split among the running diags */
+    Sample idleFrom;         /* no diag running since, the baseline is taken from here on */
+    std::chrono::steady_clock::time_point idleAt;
+    bool accounting;
+    std::map<std::string, cost_t> costs;
+    std::map<std::string, running_t> running;
+};
+
+} // namespace hwst
+
+#endif // _HWST_ADMISSION_
@@ -18,9 +18,11 @@
 */
 
 #include <iostream>
+#include <string.h>
+
 #include "hwst_comm.hpp"
+#include "hwst_conn.hpp"
 #include "hwst_diag.hpp"
-#include "hwst_ws.hpp"
 #include "jansson.h"
 
 //#define HWST_DEBUG 1
@@ -30,90 +32,128 @@
 #define HWST_DBG(str) do {} while(false)
 #endif
 
-using hwst::Ws;
+using hwst::Conn;
 using hwst::Diag;
 
 namespace hwst {
 
-Comm::Comm(cb_t cbConnected_, cb_t cbDisconnected_, cb_t cbReceived_):
+/* Comm is a session on the shared agent connection; it only tracks the requests it sent */
+Comm::Comm(std::shared_ptr<Conn> conn, cb_t cbConnected_, cb_t cbDisconnected_, cb_t cbReceived_):
     cbExtConnected(cbConnected_),
     cbExtDisconnected(cbDisconnected_),
     cbExtReceived(cbReceived_),
+    conn(conn),
     connected(false)
 {
-    using namespace std::placeholders;
-
-    ws = Ws::CreateInstance(std::bind(&Comm::cbConnected, this),
-        std::bind(&Comm::cbDisconnected, this),
-        std::bind(&Comm::cbReceived, this, _1));
-
     HWST_DBG("hwst_comm");
 }
 
 Comm::~Comm()
 {
     HWST_DBG("~hwst_comm");
-    cbDisconnected();
     disconnect();
+    cbDisconnected();
 }
 
-int Comm::connect(std::string host, std::string port, int timeout)
+int Comm::connect()
 {
     int status;
     HWST_DBG("comm-connect");
-    status = ws->connect(host, port, timeout);
+    status = conn->attach(shared_from_this());
     return status;
 }
 
 void Comm::disconnect()
 {
     HWST_DBG("comm-disconnect");
-    ws->disconnect();
+    conn->detach(this);
+}
+
+std::string Comm::request(std::string method, std::string params, std::string id)
+{
+    return std::string("{\"jsonrpc\": \"2.0\", \"method\": \"") + method +
+        std::string("\", \"params\":") + (params.empty() ? "[]" : params) + std::string(", \"id\": ") + id + std::string("}");
 }
 
 int Comm::sendRaw(std::string method, std::string params, std::string id)
 {
     HWST_DBG("comm-sendRaw");
 
-    std::string request;
+    std::string req = request(method, params, id);
+    HWST_DBG("request:" + req);
 
-    request = std::string("{\"jsonrpc\": \"2.0\", \"method\": \"") + method +
-        std::string("\", \"params\":") + (params.empty() ? "[]" : params) + std::string(", \"id\": ") + id + std::string("}");
-    HWST_DBG("request:" + request);
+    return conn->send(req);
+}
 
-    return ws->send(request);
+bool Comm::allocId(std::shared_ptr<Diag> diag, unsigned int &id)
+{
+    std::lock_guard<std::recursive_mutex> apiLock(apiMutex);
+
+    id = conn->nextId();
+    return byIdMap.insert(std::pair<unsigned int, std::shared_ptr<Diag>>(id, diag)).second;
 }
 
 int Comm::send(std::shared_ptr<Diag> diag)
 {
-    HWST_DBG("comm-send-#1");
     int status = -1;
-    std::map<unsigned int, std::shared_ptr<Diag>>::iterator it;
-    std::string request;
+    unsigned int id;
     HWST_DBG("comm-send");
 
+    if(!allocId(diag, id))
+        goto end;
+
+    diag->setIssued();
+    status = sendRaw(diag->name, diag->params, std::to_string(id));
+    if(status != 0)
     {
         std::lock_guard<std::recursive_mutex> apiLock(apiMutex);
-        for(int i=sendId++; byIdMap.count(sendId); ++sendId)
+        byIdMap.erase(id);
+    }
+end:
+    if(status != 0)
+        diag->setError();
+
+    return status;
+}
+
+int Comm::sendBatch(const std::vector<std::shared_ptr<Diag>> &diags)
+{
+    int status = -1;
+    std::vector<std::pair<unsigned int, std::shared_ptr<Diag>>> issued;
+    std::string batch;
+    unsigned int id;
+    HWST_DBG("comm-sendBatch:" + std::to_string(diags.size()));
+
+    if(diags.size() == 1)
+        return send(diags.front());
+
+    for(auto const& diag: diags)
+    {
+        if(!allocId(diag, id))
         {
-            if(i == sendId)
-                goto end;
+            diag->setError();
+            continue;
         }
-        auto result = byIdMap.insert(std::pair<unsigned int, std::shared_ptr<Diag>>(sendId,diag));
-        if(result.second == false)
-            goto end;
+        diag->setIssued();
+        batch += (batch.empty() ? "[" : ",") + request(diag->name, diag->params, std::to_string(id));
+        issued.push_back(std::make_pair(id, diag));
     }
 
-    diag->setIssued();
-    status = sendRaw(diag->name, diag->params, std::to_string(sendId));
+    if(issued.empty())
+        return diags.empty() ? 0 : -1;
+
+    batch += "]";
+    HWST_DBG("request:" + batch);
+    status = conn->send(batch);
     if(status != 0)
     {
         std::lock_guard<std::recursive_mutex> apiLock(apiMutex);
-        byIdMap.erase(it);
+        for(auto const& i: issued)
+        {
+            byIdMap.erase(i.first);
+            i.second->setError();
+        }
     }
-end:
-    if(status != 0)
-        diag->setError();
 
     return status;
 }
@@ -149,23 +189,45 @@ void Comm::cbDisconnected()
     HWST_DBG("comm-cbDisconnected");
 }
 
-void Comm::cbReceived(std::string msg)
+/* Called for every message on the shared connection, the ones of other sessions are ignored */
+void Comm::cbReceived(json_t *json)
 {
-    json_error_t jerror;
-    int status;
-    json_t *jId, *jResult, *jp;
-    char *s;
-    bool gotId = false;
-    int id;
-    std::string option;
-
-
     HWST_DBG("comm-cbReceived");
 
-    std::unique_ptr<json_t, decltype(json_decref)*> json(json_loadb(msg.c_str(), msg.length(), JSON_DISABLE_EOF_CHECK, &jerror), json_decref);
     if(json == nullptr)
         goto end;
 
+    if(json_is_array(json))
+    {
+        /* batch response, handle each element on its own */
+        size_t index;
+        json_t *jElem;
+
+        json_array_foreach(json, index, jElem)
+        {
+            std::unique_ptr<json_t, decltype(json_decref)*> elem(json_incref(jElem), json_decref);
+            handleMsg(elem);
+        }
+    }
+    else
+    {
+        std::unique_ptr<json_t, decltype(json_decref)*> msg(json_incref(json), json_decref);
+        handleMsg(msg);
+    }
+
+end:
+    HWST_DBG("comm::cbReceived#1");
+    cbExtReceived();
+    HWST_DBG("comm::cbReceived#2");
+    return;
+}
+
+void Comm::handleMsg(std::unique_ptr<json_t, decltype(json_decref)*> &json)
+{
+    int status;
+    char *s;
+    int id;
+
     /* check for "id" - although any type is allowed, this implementation is limited to
      * support only null and int
      */
@@ -179,7 +241,6 @@ void Comm::cbReceived(std::string msg)
             HWST_DBG("json id is not int");
             goto end;
         }
-        gotId = true;
     }
 
     /* check for "jsonrpc 2.0" */
@@ -214,9 +275,6 @@ void Comm::cbReceived(std::string msg)
 
     HWST_DBG("invalid json");
 end:
-    HWST_DBG("comm::cbReceived#1");
-    cbExtReceived();
-    HWST_DBG("comm::cbReceived#2");
     return;
 }
 
@@ -354,11 +412,12 @@ int Comm::handleMsgMethod(std::unique_ptr<json_t, decltype(json_decref)*> &json)
 {
     int status;
     char *m, *d, *dt;
-    int id, progress, estatus, filterenable, fstatus;
+    int progress, estatus, filterenable, fstatus;
     json_t *jParams, *jData;
     std::string method, diag;
     std::map<std::string, std::shared_ptr<Diag>>::iterator it;
     std::string data;
+    Diag::Usage usage = Diag::Usage();
     std::unique_lock<std::recursive_mutex> apiLock(apiMutex, std::defer_lock);
 
     /* check for "method" */
@@ -452,6 +511,23 @@ int Comm::handleMsgMethod(std::unique_ptr<json_t, decltype(json_decref)*> &json)
             HWST_DBG("got data:");
         }
 
+        /* check for "usage", agents before the resource accounting do not send it */
+        {
+            json_int_t wall, cpu, rss, read, written, subprocesses;
+
+            usage.valid = (json_unpack(jParams, "{s:{s:I,s:I,s:I,s:I,s:I,s:I}}", "usage",
+                "wall", &wall, "cpu", &cpu, "rss", &rss, "read", &read, "written", &written, "subprocesses", &subprocesses) == 0);
+            if(usage.valid)
+            {
+                usage.wall = wall;
+                usage.cpu = cpu;
+                usage.rss = rss;
+                usage.read = read;
+                usage.written = written;
+                usage.subprocesses = subprocesses;
+            }
+        }
+
         if(json_unpack(jParams, "{ss}", "diag", &d) == 0) //d will be released when releasing json object
         {
             diag = std::string(d);
@@ -469,6 +545,7 @@ int Comm::handleMsgMethod(std::unique_ptr<json_t, decltype(json_decref)*> &json)
                 HWST_DBG("data:");
                 it->second->setFinished(estatus, data);
                 it->second->setFilterStatus(filterenable, fstatus);
+                it->second->setUsage(usage);
                 HWST_DBG("setFinished");
                 byHInstanceMap.erase(it);
                 HWST_DBG("erased");
@@ -25,28 +25,31 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 #include <functional>
 #include "jansson.h"
 
 namespace hwst {
 
+class Conn;
 class Diag;
-class Ws;
 
-class Comm
+class Comm: public std::enable_shared_from_this<Comm>
 {
 public:
     using cb_t = std::function<void(void)>;
 
-    Comm(cb_t cbConnected_, cb_t cbDisconnected_, cb_t cbReceived_);
+    Comm(std::shared_ptr<Conn> conn, cb_t cbConnected_, cb_t cbDisconnected_, cb_t cbReceived_);
     ~Comm();
-    int connect(std::string host, std::string port, int timeout);
+    int connect();
     void disconnect();
     int send(std::shared_ptr<Diag> diag);
+    int sendBatch(const std::vector<std::shared_ptr<Diag>> &diags);
     int sendRaw(std::string method, std::string params, std::string id);
     void cbConnected();
     void cbDisconnected();
-    void cbReceived(std::string msg);
+    void cbReceived(json_t *json);
+    void handleMsg(std::unique_ptr<json_t, decltype(json_decref)*> &json);
     int handleMsgResult(std::unique_ptr<json_t, decltype(json_decref)*> &json);
     int handleMsgError(std::unique_ptr<json_t, decltype(json_decref)*> &json);
     int handleMsgMethod(std::unique_ptr<json_t, decltype(json_decref)*> &json);
@@ -57,10 +60,11 @@ private:
     cb_t cbExtReceived;
 
     std::recursive_mutex apiMutex;
-    std::shared_ptr<Ws> ws;
-    std::condition_variable cv;
+    std::shared_ptr<Conn> conn;
     bool connected;
-    unsigned int sendId;
+
+    bool allocId(std::shared_ptr<Diag> diag, unsigned int &id);
+    std::string request(std::string method, std::string params, std::string id);
     std::map<unsigned int, std::shared_ptr<Diag>> byIdMap;
     std::map<std::string, std::shared_ptr<Diag>> byHInstanceMap;
 };
@@ -0,0 +1,323 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#include <iostream>
+#include <memory>
+
+#include "hwst_conn.hpp"
+#include "hwst_comm.hpp"
+#include "hwst_ws.hpp"
+#include "jansson.h"
+
+//#define HWST_DEBUG 1
+#ifdef HWST_DEBUG
+#define HWST_DBG(str) do {std::cout << "HWST_DBG |" << str << std::endl;} while(false)
+#else
+#define HWST_DBG(str) do {} while(false)
+#endif
+
+//#define USE_PRCTL_FOR_THREAD_NAME 1
+#ifdef USE_PRCTL_FOR_THREAD_NAME
+#include <sys/prctl.h> //for debug thread name
+#endif
+
+/* how often an open connection is pinged, [s] */
+#define HEARTBEAT_PERIOD 5
+
+/* how long an unused connection is kept open, [s]; the agent quits once it gets closed */
+#define LINGER_TIMEOUT 30
+
+namespace hwst {
+
+std::weak_ptr<Conn> Conn::instance;
+
+std::shared_ptr<Conn> Conn::CreateInstance(std::string host, std::string port, int timeout)
+{
+    static std::mutex createMutex;
+    std::lock_guard<std::mutex> createLock(createMutex);
+
+    HWST_DBG("Conn create");
+    std::shared_ptr<Conn> conn = instance.lock();
+    if(conn == nullptr)
+    {
+        conn.reset(new Conn(host, port, timeout));
+        Conn::instance = conn;
+    }
+    return conn;
+}
+
+Conn::Conn(std::string host, std::string port, int timeout):
+    host(host),
+    port(port),
+    timeout(timeout),
+    dispatching(0),
+    connected(false),
+    working(true),
+    sendId(0),
+    lastUsed(std::chrono::steady_clock::now())
+{
+    using namespace std::placeholders;
+
+    ws = Ws::CreateInstance(std::bind(&Conn::cbConnected, this),
+        std::bind(&Conn::cbDisconnected, this),
+        std::bind(&Conn::cbReceived, this, _1, _2));
+
+    thd = std::unique_ptr<std::thread>(new std::thread(&Conn::worker, this));
+
+    HWST_DBG("hwst_conn");
+}
+
+Conn::~Conn()
+{
+    HWST_DBG("~hwst_conn");
+    {
+        std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+        working = false;
+    }
+    sessionsCond.notify_all();
+    thd->join();
+    thd.reset();
+
+    std::lock_guard<std::mutex> connLock(connMutex);
+    ws->disconnect();
+}
+
+/* Registers the session, connecting to the agent if not connected yet.
+ * The session gets its cbConnected() once the connection is usable. */
+int Conn::attach(std::shared_ptr<Comm> comm)
+{
+    std::lock_guard<std::mutex> connLock(connMutex);
+    bool wasConnected;
+    int status = 0;
+    HWST_DBG("conn-attach");
+
+    {
+        std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+        sessions[comm.get()] = comm;
+        lastUsed = std::chrono::steady_clock::now();
+        wasConnected = connected;
+    }
+
+    if(wasConnected)
+    {
+        HWST_DBG("conn-attach-shared");
+        comm->cbConnected();
+    }
+    else if(reconnect() != 0)
+    {
+        std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+        sessions.erase(comm.get());
+        status = -1;
+    }
+
+    HWST_DBG("conn-attach status:" + std::to_string(status));
+    return status;
+}
+
+void Conn::detach(Comm *comm)
+{
+    HWST_DBG("conn-detach");
+    std::unique_lock<std::mutex> sessionsLock(sessionsMutex);
+    sessions.erase(comm);
+    lastUsed = std::chrono::steady_clock::now();
+
+    /* a callback in flight may still be using it, except the ones of this thread, it may be detaching from one */
+    sessionsCond.wait(sessionsLock, [&]{
+        auto self = dispatchers.find(std::this_thread::get_id());
+        return dispatching == (self != dispatchers.end() ? self->second : 0);
+    });
+}
+
+int Conn::send(std::string msg)
+{
+    {
+        std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+        lastUsed = std::chrono::steady_clock::now();
+    }
+    return ws->send(msg);
+}
+
+/* Request ids are shared by all the sessions, so that the replies can be told apart */
+unsigned int Conn::nextId()
+{
+    return ++sendId;
+}
+
+/* must be called with connMutex held */
+int Conn::reconnect()
+{
+    int status;
+    HWST_DBG("conn-reconnect");
+
+    /* drop what is left of a lost connection */
+    ws->disconnect();
+
+    status = ws->connect(host, port, timeout);
+    if(status != 0)
+        ws->disconnect();
+
+    return status;
+}
+
+void Conn::cbConnected()
+{
+    std::vector<std::shared_ptr<Comm>> comms;
+    HWST_DBG("conn-cbConnected");
+
+    {
+        std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+        connected = true;
+        lastUsed = std::chrono::steady_clock::now();
+        comms = beginDispatch();
+    }
+
+    for(auto &comm: comms)
+        comm->cbConnected();
+    endDispatch(comms);
+}
+
+void Conn::cbDisconnected()
+{
+    std::vector<std::shared_ptr<Comm>> comms;
+    HWST_DBG("conn-cbDisconnected");
+
+    {
+        std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+
+        /* a connection that never became usable was not announced to anyone */
+        if(!connected)
+            return;
+
+        connected = false;
+        comms = beginDispatch();
+    }
+
+    for(auto &comm: comms)
+        comm->cbDisconnected();
+    endDispatch(comms);
+}
+
+/* msg points into the receive buffer of the Ws, it is parsed once for all the sessions */
+void Conn::cbReceived(const char *msg, size_t length)
+{
+    json_error_t jerror;
+    HWST_DBG("conn-cbReceived");
+
+    std::unique_ptr<json_t, decltype(json_decref)*> json(json_loadb(msg, length, JSON_DISABLE_EOF_CHECK, &jerror), json_decref);
+
+    std::vector<std::shared_ptr<Comm>> comms;
+    {
+        std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+        lastUsed = std::chrono::steady_clock::now();
+        comms = beginDispatch();
+    }
+
+    for(auto &comm: comms)
+        comm->cbReceived(json.get());
+    endDispatch(comms);
+}
+
+/* must be called with sessionsMutex held, the sessions being destroyed are skipped */
+std::vector<std::shared_ptr<Comm>> Conn::beginDispatch()
+{
+    std::vector<std::shared_ptr<Comm>> comms;
+
+    for(auto &session: sessions)
+    {
+        std::shared_ptr<Comm> comm = session.second.lock();
+        if(comm)
+            comms.push_back(comm);
+    }
+    ++dispatching;
+    ++dispatchers[std::this_thread::get_id()];
+    return comms;
+}
+
+/* the references are dropped before a detach() waiting for the callbacks may return */
+void Conn::endDispatch(std::vector<std::shared_ptr<Comm>> &comms)
+{
+    comms.clear();
+    {
+        std::lock_guard<std::mutex> sessionsLock(sessionsMutex);
+        auto self = dispatchers.find(std::this_thread::get_id());
+        if(--self->second == 0)
+            dispatchers.erase(self);
+        --dispatching;
+    }
+    sessionsCond.notify_all();
+}
+
+void Conn::worker()
+{
+#ifdef USE_PRCTL_FOR_THREAD_NAME
+    prctl(PR_SET_NAME,"heartbeat",0,0,0);
+#endif
+    enum { none, ping, close, reopen } action;
+    std::unique_lock<std::mutex> sessionsLock(sessionsMutex);
+
+    HWST_DBG("Conn-loop-begin");
+    while(working)
+    {
+        sessionsCond.wait_for(sessionsLock, std::chrono::seconds(HEARTBEAT_PERIOD), [&]{return !working;});
+        if(!working)
+            break;
+        sessionsLock.unlock();
+
+        {
+            std::lock_guard<std::mutex> connLock(connMutex);
+
+            /* re-evaluated under connMutex, so that no attach() can slip in before a close */
+            sessionsLock.lock();
+            if(connected)
+                action = (sessions.empty() &&
+                    (std::chrono::steady_clock::now() - lastUsed >= std::chrono::seconds(LINGER_TIMEOUT))) ? close : ping;
+            else
+                action = sessions.empty() ? none : reopen;
+            sessionsLock.unlock();
+
+            switch(action)
+            {
+            case ping:
+                HWST_DBG("conn-ping");
+                if(ws->ping() != 0)
+                {
+                    HWST_DBG("conn-ping failed");
+                    ws->disconnect(); /* the loss is reported through cbDisconnected() */
+                }
+                break;
+            case close:
+                HWST_DBG("conn-linger expired");
+                ws->disconnect();
+                break;
+            case reopen:
+                reconnect();
+                break;
+            case none:
+            default:
+                break;
+            }
+        }
+
+        sessionsLock.lock();
+    }
+    HWST_DBG("Conn-loop-finished");
+}
+
+} // namespace hwst
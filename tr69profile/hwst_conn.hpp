@@ -0,0 +1,91 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef _HWST_CONN_
+#define _HWST_CONN_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+
+namespace hwst {
+
+class Comm;
+class Ws;
+
+/* Connection manager.
+ * Keeps the single agent connection open across requests and multiplexes it between
+ * the attached Comm sessions. Incoming messages are offered to every session, each of
+ * them picks up the ones matching its own request ids and diag instance handles.
+ * The connection is kept alive with pings, re-established on the next attach after
+ * a loss and closed after it stays unused for a while, so that the agent can quit.
+ * The sessions are called back without sessionsMutex held, as they take their own
+ * locks and call back into Conn; detach() waits for a callback in flight to return.
+ */
+class Conn
+{
+public:
+    static std::shared_ptr<Conn> CreateInstance(std::string host, std::string port, int timeout);
+    ~Conn();
+    int attach(std::shared_ptr<Comm> comm);
+    void detach(Comm *comm);
+    int send(std::string msg);
+    unsigned int nextId();
+    void cbConnected();
+    void cbDisconnected();
+    void cbReceived(const char *msg, size_t length);
+
+private:
+    static std::weak_ptr<Conn> instance;
+    Conn(std::string host, std::string port, int timeout);
+    int reconnect();
+    void worker();
+    std::vector<std::shared_ptr<Comm>> beginDispatch();
+    void endDispatch(std::vector<std::shared_ptr<Comm>> &comms);
+
+    std::string host;
+    std::string port;
+    int timeout;
+
+    std::shared_ptr<Ws> ws;
+    std::mutex connMutex;        /* serializes connect/disconnect/ping, never taken from the ws callbacks */
+    std::mutex sessionsMutex;    /* guards the members below */
+    std::condition_variable sessionsCond;
+    std::map<Comm *, std::weak_ptr<Comm>> sessions;
+    unsigned int dispatching;    /* callbacks in flight */
+    std::map<std::thread::id, unsigned int> dispatchers; /* the callbacks in flight per thread */
+    bool connected;
+    bool working;
+    std::atomic<unsigned int> sendId;
+    std::chrono::steady_clock::time_point lastUsed;
+    std::unique_ptr<std::thread> thd;
+};
+
+} // namespace hwst
+
+#endif // _HWST_CONN_
@@ -106,6 +106,7 @@ void Diag::setFinished(int s, std::string data)
     HWST_DBG("setStatus:" + std::to_string(s) + " data:" + data);
     switch(status.state)
     {
+    case issued: /* finished without any progress report, e.g. cancelled before the start */
     case running:
         setState(finished);
         status.status = s;
@@ -115,7 +116,6 @@ void Diag::setFinished(int s, std::string data)
         break;
     case disabled:
     case enabled:
-    case issued:
     case finished:
     case error:
     default:
@@ -260,4 +260,12 @@ void Diag::setFilterStatus(int fe, int fs)
     status.filter_status = fs;
 }
 
+void Diag::setUsage(const Usage &usage)
+{
+    std::lock_guard<std::recursive_mutex> apiLock(apiMutex);
+
+    HWST_DBG("Usage wall:" + std::to_string(usage.wall) + " cpu:" + std::to_string(usage.cpu));
+    status.usage = usage;
+}
+
 } // namespace hwst
@@ -30,12 +30,14 @@ namespace hwst {
 
 class Comm;
 class Scenario;
+class Sched;
 class DiagPrevResults;
 
 class Diag
 {
     friend class hwst::Comm;
     friend class hwst::Scenario;
+    friend class hwst::Sched;
     friend class hwst::DiagPrevResults;
     friend std::ostream& operator<<(std::ostream& os, const Diag& diag);
     friend bool operator== (const Diag &diag1, const Diag &diag2);
@@ -65,6 +67,18 @@ public:
         DEFAULT_RESULT_VALUE = -200
     };
 
+    /* resources used by the agent to run the diag */
+    struct Usage
+    {
+        bool valid;
+        unsigned int wall; /* [ms] */
+        unsigned int cpu; /* [ms] */
+        unsigned long rss; /* peak RSS growth [kB] */
+        unsigned long long read; /* [B] */
+        unsigned long long written; /* [B] */
+        unsigned int subprocesses;
+    };
+
     struct Status
     {
         state_t state;
@@ -74,6 +88,7 @@ public:
         bool modified;
         int filter_enable;
         int filter_status;
+        Usage usage;
     };
 
     const std::string params;
@@ -102,6 +117,7 @@ private:
     void setProgress(int progress);
     void setFinished(int s, std::string data);
     void setFilterStatus(int fe, int fs);
+    void setUsage(const Usage &usage);
     void setError();
 };
 
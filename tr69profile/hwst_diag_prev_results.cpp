@@ -21,7 +21,7 @@
 #include <memory>
 #include <sstream>
 #include <string.h>
-#include <fstream>
+#include <stdlib.h>
 
 #include "hwst_diag_prev_results.hpp"
 #include "hwst_comm.hpp"
@@ -36,6 +36,7 @@
 #include "libIBus.h"
 #include "libIARMCore.h"
 #include "hostIf_tr69ReqHandler.h"
+#include "wa_results.h"
 
 //#define HWST_DEBUG 1
 #ifdef HWST_DEBUG
@@ -47,7 +48,6 @@
 #define DEFAULT_RESULT_VALUE -200
 #define BUFFER_LENGTH      512
 #define MESSAGE_LENGTH     8192 * 4 /* On reference from xdiscovery.log which shows data length can be more than 5000 */ /* Increased the value 4 times because of DELIA-38611 */
-#define HWST_RESULTS_FILE  "/tmp/hwselftest.results"
 
 std::string timeZoneInfo;
 
@@ -67,12 +67,12 @@ std::string DiagPrevResults::getPresentationName() const
 std::string DiagPrevResults::getStrStatus() const
 {
     std::string results;
+    char *payload = nullptr;
 
-    std::ifstream results_file(HWST_RESULTS_FILE); /* Let the process reach here to read results file, so that the running tests finishes updating it by then  */
-    if (results_file.is_open())
+    if (WA_UTILS_RESULTS_Read(WA_UTILS_RESULTS_FILE, &payload, nullptr) == 0)
     {
-        getline(results_file, results);
-        results_file.close();
+        results = payload;
+        free(payload);
     }
     return results;
 }
@@ -17,13 +17,12 @@
  * limitations under the License.
 */
 
-#include <chrono>
-#include <ctime>
-#include <iomanip>
-#include <sstream>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <pthread.h>
 #include "hwst_log.hpp"
+#include "wa_logwriter.h"
 
 //#define HWST_DEBUG 1
 #ifdef HWST_DEBUG
@@ -34,11 +33,36 @@
 
 /* Log to stdout (systemd journal) by default */
 #ifdef HWST_LOG_TO_FILE
-#define HWST_LOG_FILE "/opt/logs/hwselftest.log"
+#define HWST_LOG_FILE WA_UTILS_LOGWRITER_FILE
 #endif
 
+#define HWST_LOG_MARK "HWST_LOG |"
+
 namespace hwst {
 
+namespace {
+
+pthread_once_t writerOnce = PTHREAD_ONCE_INIT;
+
+void flushWriter()
+{
+    WA_UTILS_LOGWRITER_Flush();
+}
+
+/* The profile lives in the TR-069 host process, so the writer leaves its signals alone
+ * and the queued lines are written out at exit only. */
+void startWriter()
+{
+#ifdef HWST_LOG_TO_FILE
+    if (WA_UTILS_LOGWRITER_Init(HWST_LOG_FILE, WA_UTILS_LOGWRITER_MAX_SIZE, false) == 0)
+#else
+    if (WA_UTILS_LOGWRITER_Init(NULL, 0, false) == 0)
+#endif
+        std::atexit(flushWriter);
+}
+
+} // namespace
+
 Log::Log()
 {
     HWST_DBG("hwst_log()");
@@ -51,23 +75,20 @@ Log::~Log()
 
 std::string Log::format(std::string text)
 {
-    std::chrono::system_clock::time_point tnow = std::chrono::system_clock::now();
-    std::time_t t = std::chrono::system_clock::to_time_t(tnow);
-    struct tm now = *std::gmtime(&t);
-    std::ostringstream os;
-
-    os << "HWST_LOG |" <<(now.tm_year + 1900) << "-" <<
-        std::setfill('0') << std::setw(2) << (now.tm_mon + 1) << "-" <<
-        std::setfill('0') << std::setw(2) << (now.tm_mday) << " " <<
-        std::setfill('0') << std::setw(2) << (now.tm_hour) << ":" <<
-        std::setfill('0') << std::setw(2) << (now.tm_min) << ":" <<
-        std::setfill('0') << std::setw(2) << (now.tm_sec) << " " <<
-        text;
-    return os.str();;
+    char header[64];
+    size_t len = WA_UTILS_LOGWRITER_Header(HWST_LOG_MARK, header, sizeof(header));
+
+    return std::string(header, len) + text;
 }
 
 void Log::writeToLog(std::string text)
 {
+    pthread_once(&writerOnce, startWriter);
+
+    bool eol = text.empty() || (text[text.size() - 1] != '\n');
+    if (WA_UTILS_LOGWRITER_Write(NULL, text.c_str(), eol) == 0)
+        return;
+
 #ifdef HWST_LOG_TO_FILE
     std::ofstream file(HWST_LOG_FILE, std::ofstream::out | std::ofstream::app);
     file << text;
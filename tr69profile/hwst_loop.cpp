@@ -0,0 +1,192 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#include <iostream>
+
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "hwst_loop.hpp"
+
+//#define HWST_DEBUG 1
+#ifdef HWST_DEBUG
+#define HWST_DBG(str) do {std::cout << "HWST_DBG |" << str << std::endl;} while(false)
+#else
+#define HWST_DBG(str) do {} while(false)
+#endif
+
+//#define USE_PRCTL_FOR_THREAD_NAME 1
+#ifdef USE_PRCTL_FOR_THREAD_NAME
+#include <sys/prctl.h> //for debug thread name
+#endif
+
+#define MAX_EVENTS 8
+
+namespace hwst {
+
+std::weak_ptr<Loop> Loop::instance;
+
+std::shared_ptr<Loop> Loop::CreateInstance()
+{
+    static std::mutex createMutex;
+    std::lock_guard<std::mutex> createLock(createMutex);
+
+    HWST_DBG("Loop create");
+    std::shared_ptr<Loop> loop = instance.lock();
+    if(loop == nullptr)
+    {
+        loop.reset(new Loop());
+        if((loop->epollFd < 0) || (loop->wakeFd < 0) || (loop->thd == nullptr))
+            return nullptr;
+        Loop::instance = loop;
+    }
+    return loop;
+}
+
+Loop::Loop():
+    epollFd(-1),
+    wakeFd(-1),
+    dispatching(false),
+    working(true)
+{
+    struct epoll_event ev = {};
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if(epollFd < 0)
+        goto end;
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(wakeFd < 0)
+        goto end;
+
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd;
+    if(epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) != 0)
+        goto end;
+
+    thd = std::unique_ptr<std::thread>(new std::thread(&Loop::worker, this));
+
+end:
+    HWST_DBG("hwst_loop");
+}
+
+Loop::~Loop()
+{
+    HWST_DBG("~hwst_loop");
+    if(thd != nullptr)
+    {
+        uint64_t one = 1;
+        {
+            std::lock_guard<std::mutex> handlersLock(handlersMutex);
+            working = false;
+        }
+        if(write(wakeFd, &one, sizeof(one)) < 0)
+            HWST_DBG("loop wakeup failed");
+        thd->join();
+        thd.reset();
+    }
+    if(wakeFd >= 0)
+        close(wakeFd);
+    if(epollFd >= 0)
+        close(epollFd);
+}
+
+int Loop::add(int fd, uint32_t events, handler_t handler)
+{
+    std::lock_guard<std::mutex> handlersLock(handlersMutex);
+    struct epoll_event ev = {};
+
+    ev.events = events;
+    ev.data.fd = fd;
+    if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        return -1;
+
+    handlers[fd] = std::make_shared<handler_t>(handler);
+    return 0;
+}
+
+/* Once this returns no handler is running and the one of the fd will not be called again.
+ * Called from a handler it returns right away. */
+void Loop::remove(int fd)
+{
+    std::unique_lock<std::mutex> handlersLock(handlersMutex);
+
+    if(handlers.erase(fd))
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
+
+    /* also wait when already removed, the handler may still be finishing its own removal */
+    if(std::this_thread::get_id() != loopThreadId)
+        handlersCond.wait(handlersLock, [&]{return !dispatching;});
+}
+
+void Loop::worker()
+{
+#ifdef USE_PRCTL_FOR_THREAD_NAME
+    prctl(PR_SET_NAME,"looper",0,0,0);
+#endif
+    struct epoll_event events[MAX_EVENTS];
+    int n;
+
+    {
+        std::lock_guard<std::mutex> handlersLock(handlersMutex);
+        loopThreadId = std::this_thread::get_id();
+    }
+
+    HWST_DBG("Loop-begin");
+    for(;;)
+    {
+        n = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if((n < 0) && (errno != EINTR))
+        {
+            HWST_DBG("epoll_wait failed");
+            break;
+        }
+
+        std::unique_lock<std::mutex> handlersLock(handlersMutex);
+        if(!working)
+            break;
+
+        for(int i = 0; i < n; i++)
+        {
+            if(events[i].data.fd == wakeFd)
+                continue;
+
+            /* the handler may be removed while an earlier one of this batch runs */
+            auto it = handlers.find(events[i].data.fd);
+            if(it == handlers.end())
+                continue;
+
+            std::shared_ptr<handler_t> handler = it->second;
+            dispatching = true;
+            handlersLock.unlock();
+
+            (*handler)(events[i].events);
+
+            handlersLock.lock();
+            dispatching = false;
+            handlersCond.notify_all();
+        }
+    }
+    HWST_DBG("Loop-finished");
+}
+
+} // namespace hwst
@@ -0,0 +1,66 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+#ifndef _HWST_LOOP_
+#define _HWST_LOOP_
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <stdint.h>
+
+namespace hwst {
+
+/* Event loop shared by all the tr69profile connections.
+ * One thread waits on epoll and calls the handler registered for a ready descriptor.
+ */
+class Loop
+{
+public:
+    using handler_t = std::function<void(uint32_t events)>;
+
+    static std::shared_ptr<Loop> CreateInstance();
+    ~Loop();
+    int add(int fd, uint32_t events, handler_t handler);
+    void remove(int fd);
+
+private:
+    static std::weak_ptr<Loop> instance;
+    Loop();
+    void worker();
+
+    int epollFd;
+    int wakeFd;
+    std::mutex handlersMutex;
+    std::condition_variable handlersCond;
+    std::map<int, std::shared_ptr<handler_t>> handlers;
+    bool dispatching;
+    bool working;
+    std::thread::id loopThreadId;
+    std::unique_ptr<std::thread> thd;
+};
+
+} // namespace hwst
+
+#endif // _HWST_LOOP_
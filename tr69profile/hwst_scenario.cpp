@@ -140,6 +140,13 @@ int Scenario::nextToRun(std::shared_ptr<Diag> &diag)
                 switch(checkDependencies(&e - &elements[0]))
                 {
                 case 1:
+                    if(gate && !gate(e.diag))
+                    {
+                        status = 0;
+                        HWST_DBG("Scenario: deferred:" + e.diag->name);
+                        /* held back, try others */
+                        break;
+                    }
                     /* ready to run */
                     status = 1;
                     diag = e.diag;
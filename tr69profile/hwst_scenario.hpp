@@ -20,6 +20,7 @@
 #ifndef _HWST_SCENARIO_
 #define _HWST_SCENARIO_
 
+#include <functional>
 #include <string>
 #include <memory>
 #include <mutex>
@@ -56,9 +57,13 @@ class Scenario
     friend DiagPrevResults;
 
 public:
+    /* decides if a diag ready to run may be started now, if not it stays pending */
+    using gate_t = std::function<bool(const std::shared_ptr<Diag> &diag)>;
+
     Scenario();
     virtual ~Scenario();
     virtual bool init(const std::string& client = "", const std::vector<std::string>& diags = {}, const std::string& param = "") = 0;
+    void setGate(gate_t g) { gate = g; }
 
 protected:
     int getElement(const std::string& elem_name);
@@ -71,6 +76,7 @@ protected:
 private:
     std::mutex apiMutex;
     std::vector<group_t> groups;
+    gate_t gate;
     int checkDependencies(int e);//-1: stop with error, 0:wait, 1:dependencies satisfied
     bool checkAllDone();
 };
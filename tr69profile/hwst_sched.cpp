@@ -33,6 +33,7 @@
 #include "hwst_diagfactory.hpp"
 #include "hwst_diag_sysinfo.hpp"
 #include "hwst_comm.hpp"
+#include "hwst_conn.hpp"
 #include "hwst_log.hpp"
 
 //#define HWST_DEBUG 1
@@ -47,7 +48,11 @@
 #include <sys/prctl.h> //for debug thread name
 #endif
 
+/* how often diags held back by the admission are reconsidered, [s] */
+#define DEFER_RETRY 5
+
 using hwst::Comm;
+using hwst::Conn;
 
 namespace hwst {
 
@@ -77,9 +82,12 @@ Sched::Sched(std::string host, std::string port, int timeout):
     timeout(timeout),
     working(false),
     state(idle),
-    standAloneTest(false)
+    standAloneTest(false),
+    deferring(false)
 {
     HWST_DBG("Sched");
+    /* the agent connection is shared with the other schedulers and outlives single runs */
+    conn = Conn::CreateInstance(host, port, timeout);
     telemetryLogInit();
 }
 
@@ -109,6 +117,7 @@ Sched::~Sched()
     }
     if(comm != nullptr)
     {
+        comm->disconnect();
         comm.reset();
     }
 }
@@ -131,7 +140,16 @@ void Sched::worker(void)
             std::unique_lock<std::mutex> condLock(cbMutex);
             HWST_DBG("worker-waiting");
             if(!cbHappened)
-                cbCond.wait(condLock, [&]{return cbHappened;});
+            {
+                if(deferring)
+                {
+                    /* nothing may come from the agent, so look at the deferred diags again later */
+                    if(!cbCond.wait_for(condLock, std::chrono::seconds(DEFER_RETRY), [&]{return cbHappened;}))
+                        update = true;
+                }
+                else
+                    cbCond.wait(condLock, [&]{return cbHappened;});
+            }
             cbHappened = false;
             HWST_DBG("worker-notified");
             if(!connected)
@@ -147,15 +165,26 @@ void Sched::worker(void)
             }
         }
 
+        std::vector<std::pair<std::string, std::string>> completed;
+        diagCb_t cb;
+
         if(doDisconnect)
         {
-            std::lock_guard<std::mutex> apiLock(apiMutex);
-            working = false;
-            state = finished;
+            {
+                std::lock_guard<std::mutex> apiLock(apiMutex);
+                working = false;
+                state = finished;
+                /* leave the shared connection, once no callback is using the session */
+                if(comm != nullptr)
+                    comm->disconnect();
+                comm.reset();
+            }
+            doneCond.notify_all();
         }
         else if(doUpdate)
         {
             std::lock_guard<std::mutex> apiLock(apiMutex);
+            cb = diagCb;
 
             {
                 std::lock_guard<std::recursive_mutex> elementsLock(scenario->elementsMutex);
@@ -175,10 +204,16 @@ void Sched::worker(void)
                         if (!summary.empty())
                             summary += "\n";
                         summary += tmp;
+                        if (admission)
+                            admission->finished(e.diag->name, (s.state == Diag::finished) && (s.status != Diag::CANCELLED));
+                        if (cb)
+                            completed.emplace_back(e.diag->name, e.diag->getPresentationResult());
                     }
                 }
             }
 
+            std::vector<std::shared_ptr<Diag>> batch;
+            deferring = false;
             do
             {
                 std::shared_ptr<Diag> diag;
@@ -220,6 +255,11 @@ void Sched::worker(void)
                             comm->sendRaw("TESTRUN", "{\"state\": \"finish\"}", "null");
                         }
 
+                        if (admission)
+                            admission->save();
+
+                        if(comm != nullptr)
+                            comm->disconnect();
                         comm.reset();
                     }
                     break;
@@ -227,11 +267,21 @@ void Sched::worker(void)
                     break;
                 case 1:
                     HWST_DBG("Running: " + diag->getName());
-                    comm->send(diag);
+                    /* issued now, so that nextToRun() moves on to the next one */
+                    diag->setIssued();
+                    batch.push_back(diag);
                     break;
                 }
             }while(status == 1);
+
+            /* start all runnable diags with a single message */
+            if(!batch.empty() && comm)
+                comm->sendBatch(batch);
         }
+
+        /* outside of apiMutex, so that the callback may call get() */
+        for(auto const& c: completed)
+            cb(c.first, c.second);
     }
 
     HWST_DBG("Sched-loop-finished");
@@ -240,6 +290,9 @@ void Sched::worker(void)
 void Sched::telemetryLog(bool testResult)
 {
     std::string diag_result;
+    /* <wall ms>:<cpu ms>:<peak rss growth kB>:<read+written kB>:<subprocesses> of each diag */
+    std::vector<std::string> diag_usage(NUM_ELEMENTS, "N");
+    bool any_usage = false;
     for(auto const& e: scenario->elements)
     {
         Diag::Status s = e.diag->getStatus(true);
@@ -274,6 +327,14 @@ void Sched::telemetryLog(bool testResult)
             int index = it->second;
             diag_result.copy(telemetryResults[index], diag_result.length(), 0);
             telemetryResults[index][diag_result.length()] = '\0';
+
+            if (s.usage.valid)
+            {
+                diag_usage[index] = std::to_string(s.usage.wall) + ":" + std::to_string(s.usage.cpu) + ":" +
+                    std::to_string(s.usage.rss) + ":" + std::to_string((s.usage.read + s.usage.written) / 1024) + ":" +
+                    std::to_string(s.usage.subprocesses);
+                any_usage = true;
+            }
         }
     }
 
@@ -295,6 +356,21 @@ void Sched::telemetryLog(bool testResult)
     comm->sendRaw("LOG", "{\"rawmessage\": \"" + telemetry_resultHeader + "\"}", "null");
     comm->sendRaw("LOG", "{\"rawmessage\": \"" + telemetry_result + "\"}", "null");
     t2_event_s("hwtest2_split", (char*)telemetry_log.c_str());
+
+    if (any_usage)
+    {
+        std::string usage_log;
+        for(int i=0; i< NUM_ELEMENTS; i++)
+        {
+            usage_log.append(diag_usage[i]);
+            if (i + 1 < NUM_ELEMENTS)
+                usage_log.append(",");
+        }
+
+        std::string telemetry_usage = Log().format("HwTestUsage: " + usage_log);
+        comm->sendRaw("LOG", "{\"rawmessage\": \"" + telemetry_usage + "\"}", "null");
+        t2_event_s("hwtestUsage_split", (char*)usage_log.c_str());
+    }
     telemetryLogInit();
 }
 
@@ -416,6 +492,68 @@ int Sched::get(std::string &result)
     return status;
 }
 
+/* Blocks until the running scenario completes or the timeout expires.
+ * Returns the same codes as get(): 1 finished (result set), 0 still running, -1 idle. */
+int Sched::wait(std::string &result, std::chrono::milliseconds timeout)
+{
+    HWST_DBG("sched-WAIT");
+    {
+        std::unique_lock<std::mutex> apiLock(apiMutex);
+        doneCond.wait_for(apiLock, timeout, [&]{return state != running;});
+    }
+    return get(result);
+}
+
+void Sched::setDiagCallback(diagCb_t cb)
+{
+    std::lock_guard<std::mutex> apiLock(apiMutex);
+    diagCb = cb;
+}
+
+/* Makes the following runs load-aware, a null adm turns it off */
+void Sched::setAdmission(std::shared_ptr<Admission> adm, const Admission::Limits &limits)
+{
+    std::lock_guard<std::mutex> apiLock(apiMutex);
+    admission = adm;
+    admissionLimits = limits;
+}
+
+/* Scenario gate, called from the worker: light diags run now, the ones the system cannot
+ * take at the moment wait until the load drops, or are skipped after admissionLimits.maxDefer. */
+bool Sched::admit(const std::shared_ptr<Diag> &diag)
+{
+    Admission::verdict_t verdict = admission->check(admissionLimits, diag->name);
+    auto now = std::chrono::steady_clock::now();
+
+    if(verdict == Admission::admit)
+    {
+        admission->started(diag->name);
+        return true;
+    }
+
+    if(deferred.empty())
+        deferStart = now;
+
+    if(std::find(deferred.begin(), deferred.end(), diag->name) == deferred.end())
+    {
+        deferred.push_back(diag->name);
+        Log().writeToLog(Log().format("[TR69] " + diag->getName() + " deferred, " + Admission::verdictStr(verdict) + " (" + admission->describe() + ")\n"));
+    }
+
+    if(now - deferStart >= std::chrono::seconds(admissionLimits.maxDefer))
+    {
+        Log().writeToLog(Log().format("[TR69] " + diag->getName() + " skipped, " + Admission::verdictStr(verdict) + "\n"));
+        diag->setIssued();
+        diag->setFinished(Diag::CANCELLED, "");
+        /* pick it up as finished right away */
+        cbUpdate();
+        return false;
+    }
+
+    deferring = true;
+    return false;
+}
+
 int Sched::issue(const std::vector<std::string>& jobs, const std::string& client, const std::string& param)
 {
     int status = -1;
@@ -434,6 +572,8 @@ int Sched::issue(const std::vector<std::string>& jobs, const std::string& client
         cbCond.notify_all();
         thd->join();
         thd.reset();
+        if(comm != nullptr)
+            comm->disconnect();
         comm.reset();
         state = idle;
         /* no break */
@@ -474,6 +614,11 @@ int Sched::issue(const std::vector<std::string>& jobs, const std::string& client
 
         HWST_DBG("Scenario created");
 
+        deferring = false;
+        deferred.clear();
+        if (admission)
+            scenario->setGate(std::bind(&Sched::admit, this, std::placeholders::_1));
+
         connected = false;
         update = false;
         working = true;
@@ -487,11 +632,12 @@ int Sched::issue(const std::vector<std::string>& jobs, const std::string& client
             break;
         }
 
-        comm = std::shared_ptr<Comm>(new Comm(std::bind(&Sched::cbConnected, this),
+        comm = std::shared_ptr<Comm>(new Comm(conn,
+            std::bind(&Sched::cbConnected, this),
             std::bind(&Sched::cbDisconnected, this),
             std::bind(&Sched::cbUpdate, this)));
 
-        if(comm->connect(host, port, timeout) != 0)
+        if(comm->connect() != 0)
         {
             HWST_DBG("Could not connect");
             {
@@ -20,7 +20,9 @@
 #ifndef _HWST_SCHED_
 #define _HWST_SCHED_
 
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <string>
 #include <memory>
 #include <mutex>
@@ -28,12 +30,15 @@
 #include <vector>
 #include <map>
 
+#include "hwst_admission.hpp"
+
 #define NUM_ELEMENTS 15
 #define BUFFERLEN 256
 
 namespace hwst {
 
 class Comm;
+class Conn;
 class Diag;
 class Scenario;
 
@@ -46,15 +51,23 @@ public:
         finished
     };
 
+    /* called from the worker thread, without any Sched lock held, for each diag that completed */
+    using diagCb_t = std::function<void(const std::string &name, const std::string &result)>;
+
     Sched(std::string host, std::string port, int timeout);
     ~Sched();
     int issue(const std::vector<std::string>& jobs, const std::string& client = "", const std::string& param = "");
     int get(std::string &result);
+    int wait(std::string &result, std::chrono::milliseconds timeout);
+    void setDiagCallback(diagCb_t cb);
+    void setAdmission(std::shared_ptr<Admission> adm, const Admission::Limits &limits);
 
 
 private:
     state_t state;
     std::mutex apiMutex;
+    std::condition_variable doneCond;
+    diagCb_t diagCb;
     std::mutex diagsMutex;
     std::string host;
     std::string port;
@@ -76,12 +89,19 @@ private:
     void telemetryFilterLog();
     bool multipleInstances();
     void failedTelemetryLog(std::string);
+    bool admit(const std::shared_ptr<Diag> &diag);
     std::unique_ptr<std::thread> thd;
+    std::shared_ptr<Conn> conn;
     std::shared_ptr<Comm> comm;
     std::unique_ptr<Scenario> scenario;
     std::string summary;
     bool quiet;
     bool standAloneTest;
+    std::shared_ptr<Admission> admission;
+    Admission::Limits admissionLimits;
+    bool deferring;
+    std::chrono::steady_clock::time_point deferStart;
+    std::vector<std::string> deferred;
 };
 
 } // namespace hwst
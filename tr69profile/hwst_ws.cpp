@@ -17,14 +17,25 @@
  * limitations under the License.
 */
 
+
+#include <algorithm>
+#include <chrono>
 #include <iostream>
-#include <thread>
 #include <mutex>
-#include <new>
 
-#include "hwst_ws.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
 
-#include <pthread.h>
+#include "hwst_ws.hpp"
+#include "hwst_loop.hpp"
 
 //#define HWST_DEBUG 1
 #ifdef HWST_DEBUG
@@ -33,276 +44,614 @@
 #define HWST_DBG(str) do {} while(false)
 #endif
 
-//#define USE_PRCTL_FOR_THREAD_NAME 1
-#ifdef USE_PRCTL_FOR_THREAD_NAME
-#include <sys/prctl.h> //for debug thread name
-#endif
+#define FLUSH_TIMEOUT 2000 /* [ms] */
+
+#define DEFAULT_CONNECT_TIMEOUT 10 /* [s] */
 
-#define FLUSH_TIMEOUT 2000000
+#define RANDOM_DEVICE "/dev/urandom"
+
+#define RX_CHUNK 4096
+#define MAX_HANDSHAKE_RESPONSE 4096
+#define MAX_MESSAGE (1024 * 1024)
+
+#define WS_OP_CONTINUATION 0x0
+#define WS_OP_TEXT 0x1
+#define WS_OP_BINARY 0x2
+#define WS_OP_CLOSE 0x8
+#define WS_OP_PING 0x9
+#define WS_OP_PONG 0xA
+
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
 
 namespace hwst {
 
-extern "C" {
+using deadline_t = std::chrono::steady_clock::time_point;
 
-noPollPtr npMutexCreate()
+static void sha1(const std::string &in, uint8_t digest[20])
 {
-    return static_cast<noPollPtr>(new (std::nothrow) std::recursive_mutex());
-}
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string msg = in;
+    uint64_t bits = (uint64_t)in.size() * 8;
 
-void npMutexDestroy(noPollPtr m)
-{
-    if(m) delete static_cast<std::recursive_mutex*>(m);
+    msg += (char)0x80;
+    while((msg.size() % 64) != 56)
+        msg += (char)0;
+    for(int i = 7; i >= 0; i--)
+        msg += (char)(bits >> (i * 8));
+
+    for(size_t chunk = 0; chunk < msg.size(); chunk += 64)
+    {
+        uint32_t w[80];
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+
+        for(int i = 0; i < 16; i++)
+            w[i] = ((uint32_t)(uint8_t)msg[chunk + 4*i] << 24) | ((uint32_t)(uint8_t)msg[chunk + 4*i + 1] << 16) |
+                ((uint32_t)(uint8_t)msg[chunk + 4*i + 2] << 8) | (uint32_t)(uint8_t)msg[chunk + 4*i + 3];
+        for(int i = 16; i < 80; i++)
+        {
+            uint32_t t = w[i-3] ^ w[i-8] ^ w[i-14] ^ w[i-16];
+            w[i] = (t << 1) | (t >> 31);
+        }
+
+        for(int i = 0; i < 80; i++)
+        {
+            uint32_t f, k, t;
+            if(i < 20)      { f = (b & c) | (~b & d);           k = 0x5A827999; }
+            else if(i < 40) { f = b ^ c ^ d;                    k = 0x6ED9EBA1; }
+            else if(i < 60) { f = (b & c) | (b & d) | (c & d);  k = 0x8F1BBCDC; }
+            else            { f = b ^ c ^ d;                    k = 0xCA62C1D6; }
+            t = ((a << 5) | (a >> 27)) + f + e + k + w[i];
+            e = d; d = c; c = (b << 30) | (b >> 2); b = a; a = t;
+        }
+
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    for(int i = 0; i < 20; i++)
+        digest[i] = (uint8_t)(h[i / 4] >> (24 - 8 * (i % 4)));
 }
 
-void npMutexLock(noPollPtr m)
+static std::string base64(const uint8_t *data, size_t length)
 {
-    if(m) static_cast<std::recursive_mutex*>(m)->lock();
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+
+    for(size_t i = 0; i < length; i += 3)
+    {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if(i + 1 < length) v |= (uint32_t)data[i + 1] << 8;
+        if(i + 2 < length) v |= data[i + 2];
+
+        out += table[(v >> 18) & 0x3f];
+        out += table[(v >> 12) & 0x3f];
+        out += (i + 1 < length) ? table[(v >> 6) & 0x3f] : '=';
+        out += (i + 2 < length) ? table[v & 0x3f] : '=';
+    }
+    return out;
 }
 
-void npMutexUnlock(noPollPtr m)
+/* returns the value of the given HTTP header, empty if not present */
+static std::string headerValue(const std::string &response, const char *name)
 {
-    if(m) static_cast<std::recursive_mutex*>(m)->unlock();
+    size_t nameLen = strlen(name);
+    size_t pos = response.find("\r\n");
+
+    while(pos != std::string::npos)
+    {
+        size_t line = pos + 2;
+        size_t end = response.find("\r\n", line);
+        if(end == std::string::npos)
+            break;
+
+        if((end - line > nameLen) && (response[line + nameLen] == ':') &&
+            !strncasecmp(response.c_str() + line, name, nameLen))
+        {
+            size_t value = response.find_first_not_of(" \t", line + nameLen + 1);
+            return (value < end) ? response.substr(value, end - value) : std::string();
+        }
+        pos = end;
+    }
+    return std::string();
 }
 
-void npMessageCb(noPollCtx *ctx, noPollConn *conn, noPollMsg *msg, noPollPtr user_data)
+static int waitFd(int sock, short events, deadline_t deadline)
 {
-    HWST_DBG("npMessageCb");
-    const char *payload = (const char *)nopoll_msg_get_payload(msg);
+    struct pollfd pfd = {sock, events, 0};
+    int status;
 
-    if(payload)
-        Ws::cbReceived(payload);
-    HWST_DBG("npMessageCb-END");
+    do
+    {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if(left < 0)
+            left = 0;
+        status = poll(&pfd, 1, (int)left);
+    }while((status < 0) && (errno == EINTR));
+
+    return (status > 0) ? 0 : -1;
 }
 
-/* This callback is coming from two sources;
- * - the nopoll_loop_wait(), if closed externally
- * - nopoll_conn_close(), if closed intentionally
- */
-void npClosedCb(noPollCtx *ctx, noPollConn *conn, noPollPtr user_data)
+static int writeAll(int sock, const char *data, size_t length, deadline_t deadline)
 {
-    HWST_DBG("npClosedCb");
-    Ws::cbDisconnected();
-    HWST_DBG("npClosedCb-END");
+    while(length)
+    {
+        ssize_t n = ::send(sock, data, length, MSG_NOSIGNAL);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            if(((errno != EAGAIN) && (errno != EWOULDBLOCK)) || (waitFd(sock, POLLOUT, deadline) != 0))
+                return -1;
+            continue;
+        }
+        data += n;
+        length -= n;
+    }
+    return 0;
 }
 
-void npConnFree(noPollConn *conn)
+/* the masking keys and the handshake nonce must not be predictable, RFC 6455 10.3 */
+static int readRandom(void *buf, size_t length)
 {
-    HWST_DBG("npConnFree");
-    nopoll_conn_close(conn);
-    HWST_DBG("npConnFree-END");
-}
+    int rd = open(RANDOM_DEVICE, O_RDONLY | O_CLOEXEC);
+    char *p = (char *)buf;
 
-} // extern "C"
+    if(rd < 0)
+        return -1;
+    while(length)
+    {
+        ssize_t n = read(rd, p, length);
+        if(n < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            break;
+        }
+        if(n == 0)
+            break;
+        p += n;
+        length -= n;
+    }
+    close(rd);
 
-std::weak_ptr<Ws> Ws::instance;
+    return length ? -1 : 0;
+}
 
 std::shared_ptr<Ws> Ws::CreateInstance(cbConnected_t cbConnected_, cbDisconnected_t cbDisconnected_, cbReceived_t cbReceived_)
 {
     HWST_DBG("Ws create");
-    std::shared_ptr<Ws> ws = instance.lock();
-    if(ws == nullptr)
-    {
-        ws.reset(new Ws(cbConnected_, cbDisconnected_, cbReceived_));
-        Ws::instance = ws;
-    }
-    return ws;
+    return std::shared_ptr<Ws>(new Ws(cbConnected_, cbDisconnected_, cbReceived_));
 }
 
 Ws::Ws(cbConnected_t cbConnected_, cbDisconnected_t cbDisconnected_, cbReceived_t cbReceived_):
+    fd(-1),
     cbExtConnected(cbConnected_),
     cbExtDisconnected(cbDisconnected_),
     cbExtReceived(cbReceived_),
-    ctx(nullptr, nopoll_ctx_unref),
-    conn(nullptr, nopoll_conn_close),
-    connected(false)
+    loop(Loop::CreateInstance()),
+    maskNext(sizeof(maskPool) / sizeof(maskPool[0])),
+    rxLen(0),
+    fragmented(false)
 {
-    nopoll_thread_handlers(npMutexCreate,
-	npMutexDestroy,
-	npMutexLock,
-	npMutexUnlock);
-
-    ctx = ctx_t(nopoll_ctx_new(), nopoll_ctx_unref);
-    if(ctx == nullptr)
-        goto end;
-
-end:
     HWST_DBG("hwst_ws");
 }
 
 Ws::~Ws()
 {
-    if(ctx == nullptr)
-        goto end;
-
     disconnect();
-
-end:
     HWST_DBG("~hwst_ws");
 }
 
-void Ws::npLoop(void)
+int Ws::handshake(int sock, const std::string &host, const std::string &port, int timeout)
 {
-#ifdef USE_PRCTL_FOR_THREAD_NAME
-    prctl(PR_SET_NAME,"looper",0,0,0);
-#endif
-    HWST_DBG("starting loop");
-    nopoll_loop_wait(ctx.get(), 0);
-    HWST_DBG("loop finished");
-}
+    deadline_t deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
+    uint8_t nonce[16];
+    uint8_t digest[20];
+    std::string key, request, response;
+    size_t headerEnd = std::string::npos;
 
-void Ws::cbConnected()
-{
-    std::shared_ptr<Ws> ws = instance.lock();
-    if(ws == nullptr)
-        goto end;
+    if(readRandom(nonce, sizeof(nonce)) != 0)
+    {
+        HWST_DBG("hwst_ws: " RANDOM_DEVICE " failed");
+        return -1;
+    }
+    key = base64(nonce, sizeof(nonce));
+
+    request = "GET / HTTP/1.1\r\n"
+        "Host: " + host + ":" + port + "\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Origin: http://" + host + "\r\n"
+        "Sec-WebSocket-Key: " + key + "\r\n"
+        "Sec-WebSocket-Version: 13\r\n\r\n";
+
+    if(writeAll(sock, request.data(), request.size(), deadline) != 0)
+        return -1;
+
+    rxBuf.resize(std::max(rxBuf.size(), (size_t)RX_CHUNK));
+    rxLen = 0;
+    while(headerEnd == std::string::npos)
+    {
+        ssize_t n;
+
+        if((rxLen == MAX_HANDSHAKE_RESPONSE) || (waitFd(sock, POLLIN, deadline) != 0))
+            return -1;
+
+        n = recv(sock, rxBuf.data() + rxLen, MAX_HANDSHAKE_RESPONSE - rxLen, 0);
+        if(n == 0)
+            return -1;
+        if(n < 0)
+        {
+            if((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK))
+                continue;
+            return -1;
+        }
+        rxLen += n;
+
+        response.assign(rxBuf.data(), rxLen);
+        headerEnd = response.find("\r\n\r\n");
+    }
+    response.resize(headerEnd + 2);
 
+    if(response.compare(0, 13, "HTTP/1.1 101 ") != 0)
     {
-        std::lock_guard<std::recursive_mutex> apiLock(ws->apiMutex);
-        HWST_DBG("wa::cbCconnected ENTER");
-        ws->cbExtConnected();
+        HWST_DBG("ws-handshake rejected:" + response.substr(0, response.find("\r\n")));
+        return -1;
     }
 
-end:
-    HWST_DBG("cbConnected");
-    return;
+    sha1(key + WS_GUID, digest);
+    if(headerValue(response, "Sec-WebSocket-Accept") != base64(digest, sizeof(digest)))
+    {
+        HWST_DBG("ws-handshake bad accept");
+        return -1;
+    }
+
+    /* keep whatever the server sent right after the handshake */
+    rxLen -= headerEnd + 4;
+    memmove(rxBuf.data(), rxBuf.data() + headerEnd + 4, rxLen);
+
+    return 0;
 }
 
-void Ws::cbDisconnected()
+int Ws::connect(std::string host, std::string port, int timeout)
 {
-    std::shared_ptr<Ws> ws = instance.lock();
-    if(ws == nullptr)
-        goto end;
+    std::lock_guard<std::recursive_mutex> apiLock(apiMutex);
+    HWST_DBG("wa::connect ENTER");
+    int status = -1;
+    int sock = -1;
+    struct addrinfo hints = {};
+    struct addrinfo *res = NULL;
+    deadline_t deadline;
 
     {
-        std::unique_lock<std::mutex> condLock(ws->cbMutex);
-        HWST_DBG("wa::cbDisconnect ENTER");
-        ws->connected = false;
-        ws->cbExtDisconnected();
+        std::lock_guard<std::mutex> txLock(txMutex);
+        if(fd >= 0)
+        {
+            status = 0;
+            goto end;
+        }
     }
 
-    HWST_DBG("cbDisconnected-notify");
-    ws->cbCond.notify_all();
-    HWST_DBG("cbDisconnected-finished");
+    if(loop == nullptr)
+        goto end;
 
-end:
-    return;
-}
+    if(timeout <= 0)
+        timeout = DEFAULT_CONNECT_TIMEOUT;
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeout);
 
-void Ws::cbReceived(std::string msg)
-{
-    std::shared_ptr<Ws> ws = instance.lock();
-    if(ws == nullptr)
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if(getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0)
         goto end;
 
+    for(struct addrinfo *ai = res; ai != NULL; ai = ai->ai_next)
     {
-        std::lock_guard<std::recursive_mutex> apiLock(ws->apiMutex);
-        HWST_DBG("wa::cbReceive ENTER");
-        ws->cbExtReceived(msg);
-    }
-end:
-    return;
-}
+        int err = 0;
+        socklen_t errLen = sizeof(err);
 
-int Ws::connect(std::string host, std::string port, int timeout)
-{
-    std::lock_guard<std::recursive_mutex> apiLock(apiMutex);
-    HWST_DBG("wa::connect ENTER");
-    int status = -1;
-    int npStatus;
+        sock = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+        if(sock < 0)
+            continue;
 
-    if(ctx == nullptr)
-        goto end;
+        if((::connect(sock, ai->ai_addr, ai->ai_addrlen) == 0) ||
+            ((errno == EINPROGRESS) && (waitFd(sock, POLLOUT, deadline) == 0) &&
+            (getsockopt(sock, SOL_SOCKET, SO_ERROR, &err, &errLen) == 0) && (err == 0)))
+            break;
 
-    if(conn != nullptr)
+        close(sock);
+        sock = -1;
+    }
+    freeaddrinfo(res);
+
+    if(sock < 0)
     {
-        status = 0;
+        HWST_DBG("wa::connect cannot connect");
         goto end;
     }
-    conn = conn_t(nopoll_conn_new(ctx.get(), host.c_str(), port.c_str(), NULL, NULL, NULL, NULL), nopoll_conn_close);
-    if((conn == nullptr) || !nopoll_conn_is_ok (conn.get()))
-        goto end;
-    connected = true;
 
-    nopoll_conn_set_on_close(conn.get(), npClosedCb, NULL);
-    nopoll_conn_set_on_msg(conn.get(), npMessageCb, &cbExtReceived);
-    /* This callback does not for for client. The client must poll
-    nopoll_conn_set_on_ready(conn.get(), npReadyCb, &cbExtConnected);
-    */
-    if(timeout <= 0)
-        timeout = 10; //as we go away from nopoll no separate thread for polling on_ready
-
-    HWST_DBG("wa::connect set non-blocking");
-    if(nopoll_conn_set_sock_block(nopoll_conn_socket(conn.get()), nopoll_false) == nopoll_false)
+    HWST_DBG("wa::connect handshake");
+    if(handshake(sock, host, port, timeout) != 0)
     {
-        HWST_DBG("wa::connect cannot set non-blocking socket");
+        close(sock);
         goto end;
     }
-    HWST_DBG("wa::connect wait ready");
-    if(nopoll_conn_wait_for_status_until_connection_ready (conn.get(), timeout, &npStatus,  NULL) == nopoll_true)
+    fragmented = false;
+    fragBuf.clear();
+
     {
-        HWST_DBG("wa::connect ready");
-        status = 0;
-        cbConnected();
-        npThread = std::unique_ptr<std::thread>(new std::thread(&Ws::npLoop, this));
+        std::lock_guard<std::mutex> txLock(txMutex);
+        fd = sock;
     }
 
+    if(loop->add(sock, EPOLLIN | EPOLLRDHUP, std::bind(&Ws::cbReadable, this, std::placeholders::_1)) != 0)
+    {
+        std::lock_guard<std::mutex> txLock(txMutex);
+        fd = -1;
+        close(sock);
+        goto end;
+    }
+
+    HWST_DBG("wa::connect ready");
+    status = 0;
+    cbExtConnected();
+
 end:
     HWST_DBG("wa::connect status:" + std::to_string(status));
 
     return status;
 }
 
-int Ws::send(std::string msg)
+int Ws::sendFrame(uint8_t opcode, const char *data, size_t length)
 {
-    HWST_DBG("wa::send #1");
-    std::lock_guard<std::recursive_mutex> apiLock(apiMutex);
-    HWST_DBG("wa::send");
-    int status = -1;
-    int length;
+    std::lock_guard<std::mutex> txLock(txMutex);
+    uint32_t mask;
+    size_t header;
 
-    if(!nopoll_conn_is_ready(conn.get()))
-        goto end;
+    if(fd < 0)
+        return -1;
 
-    length = nopoll_conn_send_text(conn.get(), msg.c_str(),msg.length());
-    length = nopoll_conn_flush_writes (conn.get(), FLUSH_TIMEOUT, length);
-    if(length == msg.length())
-        status = 0;
+    /* client frames are always masked */
+    txBuf.resize(14 + length);
+    txBuf[0] = (char)(0x80 | opcode);
+    if(length < 126)
+    {
+        txBuf[1] = (char)(0x80 | length);
+        header = 2;
+    }
+    else if(length <= 0xffff)
+    {
+        txBuf[1] = (char)(0x80 | 126);
+        txBuf[2] = (char)(length >> 8);
+        txBuf[3] = (char)length;
+        header = 4;
+    }
+    else
+    {
+        txBuf[1] = (char)(0x80 | 127);
+        for(int i = 0; i < 8; i++)
+            txBuf[2 + i] = (char)((uint64_t)length >> (56 - 8 * i));
+        header = 10;
+    }
+
+    if(maskNext == sizeof(maskPool) / sizeof(maskPool[0]))
+    {
+        if(readRandom(maskPool, sizeof(maskPool)) != 0)
+            return -1;
+        maskNext = 0;
+    }
+    mask = maskPool[maskNext++];
+    memcpy(&txBuf[header], &mask, 4);
+    for(size_t i = 0; i < length; i++)
+        txBuf[header + 4 + i] = data[i] ^ txBuf[header + (i & 3)];
 
+    return writeAll(fd, txBuf.data(), header + 4 + length,
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(FLUSH_TIMEOUT));
+}
+
+int Ws::send(const std::string &msg)
+{
+    HWST_DBG("wa::send");
+    int status = sendFrame(WS_OP_TEXT, msg.data(), msg.size());
     HWST_DBG("ws-send:" + std::to_string(status));
-end:
     return status;
 }
 
+int Ws::ping()
+{
+    HWST_DBG("wa::ping");
+    int status = sendFrame(WS_OP_PING, NULL, 0);
+    HWST_DBG("ws-ping:" + std::to_string(status));
+    return status;
+}
+
+/* Closes the given connection once, from either the api or the loop thread.
+ * The loop handler is no longer running when this returns, so the disconnection is
+ * fully reported before another connect() can start.
+ */
+void Ws::closeConn(int sock)
+{
+    loop->remove(sock);
+
+    {
+        std::lock_guard<std::mutex> txLock(txMutex);
+        if(fd != sock)
+            return;
+        fd = -1;
+    }
+
+    close(sock);
+    HWST_DBG("ws-closed");
+    cbExtDisconnected();
+}
+
 void Ws::disconnect()
 {
     std::lock_guard<std::recursive_mutex> apiLock(apiMutex);
     HWST_DBG("wa::disconnect ENTER");
-    if(conn == nullptr)
+    const char normalClosure[] = {0x03, (char)0xe8}; /* 1000 */
+    int sock;
+
+    {
+        std::lock_guard<std::mutex> txLock(txMutex);
+        sock = fd;
+    }
+    if(sock < 0)
         goto end;
 
-    nopoll_loop_stop(ctx.get());
+    sendFrame(WS_OP_CLOSE, normalClosure, sizeof(normalClosure));
+    closeConn(sock);
+
+end:
+    HWST_DBG("ws-disconnect");
+}
+
+void Ws::cbReadable(uint32_t events)
+{
+    ssize_t n;
+    int sock;
 
-    if(npThread != nullptr)
     {
-        HWST_DBG("ws-disconnect-join");
-        npThread->join();
-        HWST_DBG("ws-disconnect-joined");
-        npThread.reset();
+        std::lock_guard<std::mutex> txLock(txMutex);
+        sock = fd;
     }
+    if(sock < 0)
+        return;
 
-    HWST_DBG("ws-disconnect-close");
+    if(rxBuf.size() - rxLen < RX_CHUNK)
+        rxBuf.resize(std::max(rxBuf.size() * 2, (size_t)(2 * RX_CHUNK)));
 
-    nopoll_conn_close(conn.get());
+    n = recv(sock, rxBuf.data() + rxLen, rxBuf.size() - rxLen, 0);
+    if(n < 0)
+    {
+        if((errno == EINTR) || (errno == EAGAIN) || (errno == EWOULDBLOCK))
+            return;
+        HWST_DBG("ws-recv error");
+        closeConn(sock);
+        return;
+    }
+    if(n == 0)
     {
-        std::unique_lock<std::mutex> condLock(cbMutex);
-        HWST_DBG("ws-disconnect-waiting");
-        cbCond.wait(condLock, [&]{return !connected;});
-        HWST_DBG("ws-disconnect-confirmed");
+        HWST_DBG("ws-closed by peer");
+        closeConn(sock);
+        return;
     }
-    conn.release(); //since nopoll_conn_close() is already done no .reset() must be called.
+    rxLen += n;
 
-end:
-    HWST_DBG("ws-disconnect");
+    if(parseFrames() != 0)
+        closeConn(sock);
+}
+
+/* Handles all the complete frames in rxBuf, the payloads are unmasked and delivered in place.
+ * Returns non-zero when the connection has to be closed.
+ */
+int Ws::parseFrames()
+{
+    size_t pos = 0;
+    int status = 0;
+
+    while(status == 0)
+    {
+        size_t avail = rxLen - pos;
+        const uint8_t *p = (const uint8_t *)rxBuf.data() + pos;
+        bool fin, masked;
+        uint8_t opcode;
+        uint64_t length;
+        size_t header = 2;
+        char *payload;
+
+        if(avail < 2)
+            break;
+
+        fin = p[0] & 0x80;
+        opcode = p[0] & 0x0f;
+        masked = p[1] & 0x80;
+        length = p[1] & 0x7f;
+
+        if(length == 126)
+        {
+            if(avail < 4)
+                break;
+            length = ((uint64_t)p[2] << 8) | p[3];
+            header = 4;
+        }
+        else if(length == 127)
+        {
+            if(avail < 10)
+                break;
+            length = 0;
+            for(int i = 0; i < 8; i++)
+                length = (length << 8) | p[2 + i];
+            header = 10;
+        }
+        if(masked)
+            header += 4;
+
+        if(length > MAX_MESSAGE)
+        {
+            HWST_DBG("ws-frame too long");
+            status = 1;
+            break;
+        }
+        if(avail < header + length)
+            break;
+
+        payload = rxBuf.data() + pos + header;
+        if(masked)
+        {
+            const uint8_t *key = p + header - 4;
+            for(size_t i = 0; i < length; i++)
+                payload[i] ^= key[i & 3];
+        }
+
+        switch(opcode)
+        {
+        case WS_OP_TEXT:
+        case WS_OP_BINARY:
+            if(fin)
+                cbExtReceived(payload, length);
+            else
+            {
+                fragBuf.assign(payload, payload + length);
+                fragmented = true;
+            }
+            break;
+        case WS_OP_CONTINUATION:
+            if(!fragmented || (fragBuf.size() + length > MAX_MESSAGE))
+            {
+                status = 1;
+                break;
+            }
+            fragBuf.insert(fragBuf.end(), payload, payload + length);
+            if(fin)
+            {
+                cbExtReceived(fragBuf.data(), fragBuf.size());
+                fragBuf.clear();
+                fragmented = false;
+            }
+            break;
+        case WS_OP_CLOSE:
+            sendFrame(WS_OP_CLOSE, payload, std::min(length, (uint64_t)2));
+            status = 1;
+            break;
+        case WS_OP_PING:
+            sendFrame(WS_OP_PONG, payload, length);
+            break;
+        case WS_OP_PONG:
+            break;
+        default:
+            status = 1;
+            break;
+        }
+
+        pos += header + length;
+    }
+
+    if(pos)
+    {
+        rxLen -= pos;
+        memmove(rxBuf.data(), rxBuf.data() + pos, rxLen);
+    }
+
+    return status;
 }
 
 } // namespace hwst
@@ -17,60 +17,68 @@
  * limitations under the License.
 */
 
+
 #ifndef _HWST_WS_
 #define _HWST_WS_
 
-#include <condition_variable>
 #include <functional>
-#include <thread>
 #include <mutex>
 #include <memory>
+#include <string>
+#include <vector>
 
-#include "nopoll.h"
+#include <stddef.h>
+#include <stdint.h>
 
 namespace hwst {
 
+class Loop;
+
+/* Minimal WebSocket client (RFC 6455) driven by the shared event Loop.
+ * Received frames are parsed in place in a reusable buffer and handed over as
+ * a pointer and length, valid only for the duration of the callback.
+ */
 class Ws
 {
 public:
     using cbConnected_t = std::function<void(void)>;
     using cbDisconnected_t = std::function<void(void)>;
-    using cbReceived_t = std::function<void(std::string)>;
+    using cbReceived_t = std::function<void(const char *msg, size_t length)>;
 
-    /* Note: The nopoll patched implementation is buggy, it does not free allocated memory but also
-     *       it does free the user provided pointer, which should not be touched, that causes crash.
-     *       Because of that the Ws class is created as singleton, not passing any pointers
-     *       into nopoll.
-     */
     static std::shared_ptr<Ws> CreateInstance(cbConnected_t cbConnected_, cbDisconnected_t cbDisconnected_, cbReceived_t cbReceived_);
     ~Ws();
     int connect(std::string host, std::string port, int timeout);
-    int send(std::string msg);
+    int send(const std::string &msg);
+    int ping();
     void disconnect();
-    static void cbConnected();
-    static void cbDisconnected();
-    static void cbReceived(std::string msg);
 
 private:
-    static std::weak_ptr<Ws> instance;
     Ws(cbConnected_t cbConnected_, cbDisconnected_t cbDisconnected_, cbReceived_t cbReceived_);
-    std::recursive_mutex apiMutex;
-    std::mutex cbMutex;
-    std::condition_variable cbCond;
-    bool connected;
+    int handshake(int sock, const std::string &host, const std::string &port, int timeout);
+    int sendFrame(uint8_t opcode, const char *data, size_t length);
+    void closeConn(int sock);
+    void cbReadable(uint32_t events);
+    int parseFrames();
+
+    std::recursive_mutex apiMutex;  /* connect/disconnect */
+    std::mutex txMutex;             /* guards fd and the tx members */
+    int fd;
 
     cbConnected_t cbExtConnected;
     cbDisconnected_t cbExtDisconnected;
     cbReceived_t cbExtReceived;
 
-    typedef std::unique_ptr<noPollCtx, decltype(nopoll_ctx_unref)*> ctx_t;
-    ctx_t ctx;
-    
-    typedef std::unique_ptr<noPollConn, decltype(nopoll_conn_close)*> conn_t;
-    conn_t conn;
+    std::shared_ptr<Loop> loop;
+
+    std::vector<char> txBuf;
+    uint32_t maskPool[64];          /* masking keys from /dev/urandom, used up to maskNext */
+    size_t maskNext;
 
-    std::unique_ptr<std::thread> npThread;
-    void npLoop();
+    /* used from the loop thread only, once connected */
+    std::vector<char> rxBuf;
+    size_t rxLen;
+    std::vector<char> fragBuf;
+    bool fragmented;
 };
 
 } // namespace hwst
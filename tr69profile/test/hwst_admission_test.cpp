@@ -0,0 +1,120 @@
+/*
+ * If not stated otherwise in this file or this component's Licenses.txt file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2017 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*/
+
+
+
+/* Unit test of the load-aware admission driven by synthetic /proc fixtures, build on the host with:
+ *   g++ -std=c++11 -pthread -I.. hwst_admission_test.cpp ../hwst_admission.cpp
+ */
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "hwst_admission.hpp"
+
+#define CHECK(x) do { if(!(x)) { std::cout << "HWST_DBG |FAILED " << __FILE__ << ":" << __LINE__ << ": " << #x << std::endl; return -1; } } while(0)
+
+#define COST_EQ(a, b) (std::fabs((a) - (b)) < 0.01)
+
+/* the same variable the profile reads, see wa_wsclient::check_load() */
+#define PROC_ROOT_ENV "HWST_PROC_ROOT"
+
+/* jiffies since boot, busy of them */
+static void WriteStat(const std::string &root, unsigned long busy, unsigned long total)
+{
+    std::ofstream(root + "/stat") << "cpu  " << busy << " 0 0 " << total - busy << " 0 0 0 0\n";
+}
+
+static void WriteMeminfo(const std::string &root)
+{
+    std::ofstream(root + "/meminfo") << "MemTotal: 2097152 kB\nMemAvailable: 1048576 kB\n";
+}
+
+/* Two diags overlapping, each is charged its share of the load above the baseline */
+static int TestOverlap(const std::string &root, const std::string &history)
+{
+    hwst::Admission adm(getenv(PROC_ROOT_ENV), history);
+
+    WriteStat(root, 10, 100);
+    CHECK(adm.observe(1, std::chrono::milliseconds(0))); /* baseline 10 % */
+    adm.started("a");
+
+    WriteStat(root, 60, 200); /* 50 %: a alone */
+    adm.started("b");
+
+    WriteStat(root, 140, 300); /* 80 %: a and b */
+    adm.finished("a", true);
+
+    WriteStat(root, 170, 400); /* 30 %: b alone */
+    adm.finished("b", true);
+
+    /* a: (40 * 100 + 70 * 100 / 2) / 200, b: (70 * 100 / 2 + 20 * 100) / 200 */
+    CHECK(COST_EQ(adm.cost("a"), 37.5));
+    CHECK(COST_EQ(adm.cost("b"), 27.5));
+    return 0;
+}
+
+/* The load while no diag runs becomes the new baseline */
+static int TestBaseline(const std::string &root, const std::string &history)
+{
+    hwst::Admission adm(getenv(PROC_ROOT_ENV), history);
+    hwst::Admission::Limits limits = {100, 0, 100, 0};
+
+    WriteStat(root, 10, 100);
+    CHECK(adm.observe(1, std::chrono::milliseconds(0))); /* baseline 10 % */
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    WriteStat(root, 50, 200); /* 40 % idle */
+    CHECK(adm.check(limits) == hwst::Admission::admit);
+    adm.started("c");
+
+    WriteStat(root, 110, 300); /* 60 % */
+    adm.finished("c", true);
+
+    CHECK(COST_EQ(adm.cost("c"), 20.0));
+    return 0;
+}
+
+int main(void)
+{
+    char dir[] = "/tmp/hwst_admission_XXXXXX";
+    std::string root, history;
+    int status;
+
+    if(mkdtemp(dir) == NULL)
+        return 1;
+    root = dir;
+    history = root + "/costs";
+    setenv(PROC_ROOT_ENV, dir, 1);
+    WriteMeminfo(root);
+
+    status = ((TestOverlap(root, history) != 0) || (TestBaseline(root, history) != 0)) ? 1 : 0;
+    if(status == 0)
+        std::cout << "HWST_DBG |tests passed" << std::endl;
+
+    unlink((root + "/stat").c_str());
+    unlink((root + "/meminfo").c_str());
+    rmdir(dir);
+    return status;
+}
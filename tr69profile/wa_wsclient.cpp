@@ -20,6 +20,7 @@
 /*****************************************************************************
  * STANDARD INCLUDE FILES
  *****************************************************************************/
+#include <chrono>
 #include <string>
 #include <sstream>
 #include <sys/types.h>
@@ -66,7 +67,7 @@ const char *HWSELFTEST_ENABLE_FILE = "/tmp/.hwselftest_enable";
 const char *HWSELFTEST_SETTINGS_FILE = "/tmp/.hwselftest_settings";
 
 const int CONNECTION_TIMEOUT = 60; // sec /* Increased timeout value, fix for DELIA-42225  */
-const int PREV_RESULTS_FETCH_TIMEOUT = 1000; // msec
+const int PREV_RESULTS_FETCH_TIMEOUT = 2000; // msec - doubled for Dunfell (TCHXI6-1355)
 
 const char *SYSTEMD_SERVICE_PATH = "/run/systemd/system";
 const char *HWSELFTEST_RUNNER_TIMER = "hwselftest-runner.timer";
@@ -83,6 +84,12 @@ const char *HWST_CPU_THRESHOLD_NAME = "HWST_CPU_THRESHOLD";
 const int DEFAULT_DRAM_THRESHOLD = 50; // MB
 const char *HWST_DRAM_THRESHOLD_NAME = "HWST_DRAM_THRESHOLD";
 
+const double ADMISSION_PRESSURE_THRESHOLD = 20.0; // percent of PSI "some avg10"
+const int ADMISSION_MAX_DEFER = 600; // sec - how long heavy diags may wait for the load to drop
+const int ADMISSION_SAMPLES = 5;
+const int ADMISSION_SAMPLE_INTERVAL = 1000; // msec
+const char *ADMISSION_PROC_ROOT_ENV = "HWST_PROC_ROOT"; // points the admission at synthetic /proc fixtures
+
 const char *HWSELFTEST_TUNE_TYPE_FILE = "/tmp/.hwselftest_tunetype";
 const char *HWSELFTEST_TUNE_RESULTS_FILE = "/opt/logs/hwselftest.tuneresults";
 
@@ -100,10 +107,12 @@ const char *UPTIME_FILE = "/proc/uptime";
 namespace hwselftest {
 
 wa_wsclient::wa_wsclient():
-    _hwst_scheduler(new hwst::Sched(HWSELFTEST_AGENT_SERVER_ADDR, HWSELFTEST_AGENT_SERVER_PORT, CONNECTION_TIMEOUT)),
     _runner_service(SYSTEMD_SERVICE_PATH, HWSELFTEST_RUNNER_SERVICE),
     _runner_timer(SYSTEMD_SERVICE_PATH, HWSELFTEST_RUNNER_TIMER),
-    _settings(HWSELFTEST_SETTINGS_FILE)
+    _settings(HWSELFTEST_SETTINGS_FILE),
+    _hwst_scheduler(new hwst::Sched(HWSELFTEST_AGENT_SERVER_ADDR, HWSELFTEST_AGENT_SERVER_PORT, CONNECTION_TIMEOUT)),
+    _hwst_query_scheduler(new hwst::Sched(HWSELFTEST_AGENT_SERVER_ADDR, HWSELFTEST_AGENT_SERVER_PORT, CONNECTION_TIMEOUT)),
+    _load_aware(false)
 {
     _runner_timer.set_description("RDK Hardware Self Test periodic run timer");
     _runner_timer.set_unit(HWSELFTEST_RUNNER_SERVICE);
@@ -124,6 +133,7 @@ wa_wsclient::wa_wsclient():
 
 wa_wsclient::~wa_wsclient()
 {
+    delete _hwst_query_scheduler;
     delete _hwst_scheduler;
 }
 
@@ -196,34 +206,45 @@ bool wa_wsclient::enable(bool enable)
  */
 bool wa_wsclient::get_results(std::string& results)
 {
-    int retval = false;
+    WA_UTILS_RESULTS_Stamp_t stamp;
+    std::shared_ptr<const results_snapshot> snapshot = std::atomic_load(&_results_snapshot);
 
-    if (_hwst_scheduler)
+    // the results file is read directly, the agent is neither started nor asked
+    if (WA_UTILS_RESULTS_GetStamp(WA_UTILS_RESULTS_FILE, &stamp) != 0)
     {
-        std::string test_results;
+        WA_DBG("wa_wsclient::get_results(): returning 'not initiated'\n");
+        results = "Not Initiated";
+        return true; // will always return something
+    }
 
-        WA_DBG("wa_wsclient::get_results(): attempting to retrieve previous results from agent...\n");
+    if (!snapshot || !WA_UTILS_RESULTS_StampEqual(&snapshot->stamp, &stamp))
+    {
+        char *payload = nullptr;
+        std::shared_ptr<results_snapshot> fresh(new results_snapshot());
 
-        if (execute("previous_results", test_results))
+        if (WA_UTILS_RESULTS_Read(WA_UTILS_RESULTS_FILE, &payload, &fresh->stamp) == 0)
         {
-            _last_result = test_results;
-            WA_DBG("wa_wsclient::get_results(): retrieved last results from agent\n");
+            fresh->results = payload;
+            free(payload);
+            WA_DBG("wa_wsclient::get_results(): loaded new results snapshot\n");
         }
-
-        if (_last_result.empty())
+        else
         {
-            // no results available
-            WA_DBG("wa_wsclient::get_results(): returning 'not initiated'\n");
-            _last_result = "Not Initiated";
+            // keep serving the previous snapshot, if any
+            WA_DBG("wa_wsclient::get_results(): results file not readable\n");
+            if (!snapshot)
+                fresh->results = "Not Initiated";
+            else
+                fresh->results = snapshot->results;
+            fresh->stamp = stamp;
         }
 
-        retval = true; // will always return something
-        results = _last_result;
+        std::atomic_store(&_results_snapshot, std::shared_ptr<const results_snapshot>(fresh));
+        snapshot = fresh;
     }
-    else
-        WA_DBG("wa_wsclient::get_results(): scheduler not avaialable\n");
 
-    return retval;
+    results = snapshot->results;
+    return true;
 }
 
 /**
@@ -257,20 +278,57 @@ bool wa_wsclient::get_capabilities(std::string& caps)
     return retval;
 }
 
+/**
+ * @brief Samples the system load and decides whether a periodic test run may start now.
+ * @param[out] load Description of the observed load.
+ * @return Admission verdict, hwst::Admission::admit if the run may start
+ */
+hwst::Admission::verdict_t wa_wsclient::check_load(std::string& load)
+{
+    const char *procRoot = getenv(ADMISSION_PROC_ROOT_ENV);
+
+    if (!_admission)
+        _admission = std::make_shared<hwst::Admission>(procRoot ? procRoot : "/proc");
+
+    if (!_admission->observe(ADMISSION_SAMPLES, std::chrono::milliseconds(ADMISSION_SAMPLE_INTERVAL)))
+    {
+        /* no load info, behave as before the admission existed */
+        load = "load unknown";
+        return hwst::Admission::admit;
+    }
+
+    load = _admission->describe();
+    return _admission->check(admission_limits());
+}
+
+hwst::Admission::Limits wa_wsclient::admission_limits()
+{
+    hwst::Admission::Limits limits;
+
+    limits.cpuMax = std::stoi(_settings.get(HWST_CPU_THRESHOLD_NAME));
+    limits.dramMin = std::stoi(_settings.get(HWST_DRAM_THRESHOLD_NAME));
+    limits.pressureMax = ADMISSION_PRESSURE_THRESHOLD;
+    limits.maxDefer = ADMISSION_MAX_DEFER;
+    return limits;
+}
+
 /**
  * @brief This function is used to start at test run of the whole HW SelfTest test suite
  * @param[in] cli True if executed by CLI, False if by TR69 client.
+ * @param[in] load_aware True to hold back the diags the system cannot take at the moment, see check_load().
  * @return Status of the operation
  * @retval true   Operation succeeded
  * @retval false  Operation failed
  */
-bool wa_wsclient::execute_tests(bool cli)
+bool wa_wsclient::execute_tests(bool cli, bool load_aware)
 {
     int retval = false;
 
     if (_hwst_scheduler)
     {
         WA_DBG("wa_wsclient::execute_tests(): attempting to execute tests...\n");
+        _load_aware = load_aware && _admission;
+        _hwst_scheduler->setAdmission(_load_aware ? _admission : nullptr, admission_limits());
         int status = _hwst_scheduler->issue({}, (cli? HWSELFTEST_WSCLIENT_PERIODIC : HWSELFTEST_WSCLIENT_REMOTE));
 
         switch(status)
@@ -308,6 +366,8 @@ bool wa_wsclient::execute_tune_test(bool cli, const std::string &param)
     if (_hwst_scheduler)
     {
         WA_DBG("wa_wsclient::execute_tune_test(): attempting to execute tune test...\n");
+        _load_aware = false;
+        _hwst_scheduler->setAdmission(nullptr, admission_limits());
         int status = _hwst_scheduler->issue({"tuner_status"}, (cli? HWSELFTEST_WSCLIENT_PERIODIC : HWSELFTEST_WSCLIENT_REMOTE), param);
 
         switch(status)
@@ -341,18 +401,12 @@ bool wa_wsclient::wait()
 {
     int status = 0;
     std::string test_result;
-    int count = EXECUTION_TIMEOUT;
     bool result = false;
 
     if (_hwst_scheduler)
     {
-        // wait for the tests to finish
-        do {
-            status = _hwst_scheduler->get(test_result);
-            if(status != 0)
-                break;
-            usleep(1000000);
-        } while (--count);
+        // block until the tests finish or the deadline passes
+        status = _hwst_scheduler->wait(test_result, std::chrono::seconds(EXECUTION_TIMEOUT + (_load_aware ? ADMISSION_MAX_DEFER : 0)));
 
         if(status == 0)
             WA_DBG("wa_wsclient::wait(): operation timed out\n");
@@ -365,6 +419,16 @@ bool wa_wsclient::wait()
     return result;
 }
 
+/**
+ * @brief Register a callback invoked as each diag of a scheduled run completes
+ * @param[in] cb Callback receiving the diag name and its result, empty to unregister.
+ */
+void wa_wsclient::set_diag_callback(const diag_callback_t& cb)
+{
+    if (_hwst_scheduler)
+        _hwst_scheduler->setDiagCallback(cb);
+}
+
 /**
  * @brief This function is used to enable/disable the hwselftest periodic run feature.
  * @param[in] enable True to enable periodic running, False to disable.
@@ -664,23 +728,18 @@ bool wa_wsclient::execute(const std::string& diag, std::string& result)
 {
     int retval = false;
 
-    if (_hwst_scheduler)
+    if (_hwst_query_scheduler)
     {
         int status = 0;
 
         WA_DBG("wa_wsclient::execute(): attempting to execute diag %s...\n", diag.c_str());
 
         // ask agent for previous results...
-        status = _hwst_scheduler->issue({diag});
+        status = _hwst_query_scheduler->issue({diag});
         if (status == 0)
         {
             // wait for the results to arrive...
-            int count = (PREV_RESULTS_FETCH_TIMEOUT / 100);
-            do {
-                usleep(200 * 1000); /* Increased from (100 * 1000) to (200 * 1000) for Dunfell (TCHXI6-1355) */
-                status = _hwst_scheduler->get(result);
-                count--;
-            } while ((status != 1) && count);
+            status = _hwst_query_scheduler->wait(result, std::chrono::milliseconds(PREV_RESULTS_FETCH_TIMEOUT));
 
             if (status == 1)
             {
@@ -23,6 +23,8 @@
 /*****************************************************************************
  * STANDARD INCLUDE FILES
  *****************************************************************************/
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -31,6 +33,8 @@
  *****************************************************************************/
 #include "wa_service.h"
 #include "wa_settings.h"
+#include "wa_results.h"
+#include "hwst_admission.hpp"
 
 /*****************************************************************************
  * EXPORTED CLASSES
@@ -50,16 +54,20 @@ typedef enum
 
 class wa_wsclient final {
 public:
+    typedef std::function<void(const std::string& diag, const std::string& result)> diag_callback_t;
+
     static wa_wsclient *instance();
 
     bool is_enabled() const;
     bool enable(bool toggle = true);
 
-    bool execute_tests(bool cli = false);
+    hwst::Admission::verdict_t check_load(std::string& load);
+    bool execute_tests(bool cli = false, bool load_aware = false);
     bool execute_tune_test(bool cli = false, const std::string& param = "");
     bool get_results(std::string& results);
     bool get_capabilities(std::string& caps);
     bool wait();
+    void set_diag_callback(const diag_callback_t& cb);
 
     bool enable_periodic(bool toggle = true, bool destroy = false, bool quiet = false);
     bool set_periodic_frequency(bool *invalidParam, unsigned int frequency);
@@ -77,6 +85,13 @@ private:
     void operator=(wa_wsclient const &) = delete;
 
     bool execute(const std::string& diag, std::string& results);
+    hwst::Admission::Limits admission_limits();
+
+    struct results_snapshot
+    {
+        WA_UTILS_RESULTS_Stamp_t stamp;
+        std::string results;
+    };
 
     wa_service _runner_service;
     wa_service _runner_timer;
@@ -84,8 +99,11 @@ private:
     wa_settings _settings;
 
     std::vector<std::string> _available_diags;
-    std::string _last_result;
+    std::shared_ptr<const results_snapshot> _results_snapshot; /* accessed with std::atomic_load/store only */
     hwst::Sched *_hwst_scheduler;
+    hwst::Sched *_hwst_query_scheduler; /* single diag queries, may run alongside a test run */
+    std::shared_ptr<hwst::Admission> _admission;
+    bool _load_aware;
 };
 
 } // namespace hwselftest